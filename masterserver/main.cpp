@@ -108,6 +108,12 @@ static	QueryIPQueue			g_ShortFloodQueue( 3 );
 // [BB] Do we want to hide servers that ignore our ban list?
 static	bool					g_bHideBanIgnoringServers = false;
 
+// Huffman encoded packets we answer LAUNCHER_MASTER_CHALLENGE with. They only depend on
+// the server list, so they are only rebuilt when a server is added, removed or changes
+// whether it enforces our ban list.
+static	std::vector<std::vector<UCHAR> >	g_ServerListPackets;
+static	bool					g_bServerListPacketsOutdated = true;
+
 //*****************************************************************************
 //	CLASSES
 
@@ -387,6 +393,7 @@ void MASTERSERVER_AddServer( const SERVER_s &Server, std::set<SERVER_s, SERVERCo
 		addedServer->lLastReceived = g_lCurrentTime;						
 		if ( &ServerSet == &g_Servers )
 		{
+			g_bServerListPacketsOutdated = true;
 			printf( "+ Adding %s (revision %d) to the server list.\n", addedServer->Address.ToString(), addedServer->iServerRevision );
 			MASTERSERVER_SendBanlistToServer( *addedServer );
 		}
@@ -395,6 +402,70 @@ void MASTERSERVER_AddServer( const SERVER_s &Server, std::set<SERVER_s, SERVERCo
 	}
 }
 
+//*****************************************************************************
+//
+// Assembles and encodes the packets that tell launchers about all servers on our list,
+// grouping the ports of all servers on the same IP into one MSC_SERVERBLOCK entry.
+void MASTERSERVER_BuildServerListPackets( void )
+{
+	const unsigned long ulMaxPacketSize = 1024;
+	unsigned long ulPacketNum = 0;
+
+	std::set<SERVER_s, SERVERCompFunc>::const_iterator it = g_Servers.begin();
+
+	g_ServerListPackets.clear();
+	g_MessageBuffer.Clear();
+	g_MessageBuffer.ByteStream.WriteLong( MSC_BEGINSERVERLISTPART );
+	g_MessageBuffer.ByteStream.WriteByte( ulPacketNum );
+	g_MessageBuffer.ByteStream.WriteByte( MSC_SERVERBLOCK );
+	unsigned long ulSizeOfPacket = 6; // 4 (MSC_BEGINSERVERLISTPART) + 1 (0) + 1 (MSC_SERVERBLOCK)
+
+	while ( it != g_Servers.end() )
+	{
+		NETADDRESS_s serverAddress = it->Address;
+		std::vector<USHORT> serverPortList;
+
+		do {
+			// [BB] Possibly omit servers that don't enforce our ban list.
+			if ( ( it->bEnforcesBanList == true ) || ( g_bHideBanIgnoringServers == false ) )
+				serverPortList.push_back ( it->Address.usPort );
+			++it;
+		} while ( ( it != g_Servers.end() ) && it->Address.CompareNoPort( serverAddress ) );
+
+		// [BB] All servers on this IP ignore the list, nothing to send.
+		if ( serverPortList.size() == 0 )
+			continue;
+
+		const unsigned long ulServerBlockNetSize = MASTERSERVER_CalcServerIPBlockNetSize( serverAddress, serverPortList );
+
+		// [BB] If sending this block would cause the current packet to exceed ulMaxPacketSize ...
+		if ( ulSizeOfPacket + ulServerBlockNetSize > ulMaxPacketSize - 1 )
+		{
+			// [BB] ... close the current packet and start a new one.
+			g_MessageBuffer.ByteStream.WriteByte( 0 ); // [BB] Terminate MSC_SERVERBLOCK by sending 0 ports.
+			g_MessageBuffer.ByteStream.WriteByte( MSC_ENDSERVERLISTPART );
+			g_ServerListPackets.push_back( std::vector<UCHAR>( ));
+			NETWORK_EncodePacket( &g_MessageBuffer, g_ServerListPackets.back() );
+
+			g_MessageBuffer.Clear();
+			++ulPacketNum;
+			ulSizeOfPacket = 5;
+			g_MessageBuffer.ByteStream.WriteLong( MSC_BEGINSERVERLISTPART );
+			g_MessageBuffer.ByteStream.WriteByte( ulPacketNum );
+			g_MessageBuffer.ByteStream.WriteByte( MSC_SERVERBLOCK );
+		}
+		ulSizeOfPacket += ulServerBlockNetSize;
+		MASTERSERVER_SendServerIPBlockToLauncher ( serverAddress, serverPortList, &g_MessageBuffer.ByteStream );
+	}
+	g_MessageBuffer.ByteStream.WriteByte( 0 ); // [BB] Terminate MSC_SERVERBLOCK by sending 0 ports.
+	g_MessageBuffer.ByteStream.WriteByte( MSC_ENDSERVERLIST );
+	g_ServerListPackets.push_back( std::vector<UCHAR>( ));
+	NETWORK_EncodePacket( &g_MessageBuffer, g_ServerListPackets.back() );
+
+	g_MessageBuffer.Clear();
+	g_bServerListPacketsOutdated = false;
+}
+
 //*****************************************************************************
 //
 void MASTERSERVER_ParseCommands( BYTESTREAM_s *pByteStream )
@@ -505,7 +576,11 @@ void MASTERSERVER_ParseCommands( BYTESTREAM_s *pByteStream )
 				{
 					currentServer->lLastReceived = g_lCurrentTime;
 					// [BB] The server possibly changed the ban setting, so update it.
-					currentServer->bEnforcesBanList = newServer.bEnforcesBanList;
+					if ( currentServer->bEnforcesBanList != newServer.bEnforcesBanList )
+					{
+						currentServer->bEnforcesBanList = newServer.bEnforcesBanList;
+						g_bServerListPacketsOutdated = true;
+					}
 				}
 			}
 
@@ -611,55 +686,11 @@ void MASTERSERVER_ParseCommands( BYTESTREAM_s *pByteStream )
 
 			case LAUNCHER_MASTER_CHALLENGE:
 
-				const unsigned long ulMaxPacketSize = 1024;
-				unsigned long ulPacketNum = 0;
-
-				std::set<SERVER_s, SERVERCompFunc>::const_iterator it = g_Servers.begin();
+				if ( g_bServerListPacketsOutdated )
+					MASTERSERVER_BuildServerListPackets( );
 
-				g_MessageBuffer.ByteStream.WriteLong( MSC_BEGINSERVERLISTPART );
-				g_MessageBuffer.ByteStream.WriteByte( ulPacketNum );
-				g_MessageBuffer.ByteStream.WriteByte( MSC_SERVERBLOCK );
-				unsigned long ulSizeOfPacket = 6; // 4 (MSC_BEGINSERVERLISTPART) + 1 (0) + 1 (MSC_SERVERBLOCK)
-
-				while ( it != g_Servers.end() )
-				{
-					NETADDRESS_s serverAddress = it->Address;
-					std::vector<USHORT> serverPortList;
-
-					do {
-						// [BB] Possibly omit servers that don't enforce our ban list.
-						if ( ( it->bEnforcesBanList == true ) || ( g_bHideBanIgnoringServers == false ) )
-							serverPortList.push_back ( it->Address.usPort );
-						++it;
-					} while ( ( it != g_Servers.end() ) && it->Address.CompareNoPort( serverAddress ) );
-
-					// [BB] All servers on this IP ignore the list, nothing to send.
-					if ( serverPortList.size() == 0 )
-						continue;
-
-					const unsigned long ulServerBlockNetSize = MASTERSERVER_CalcServerIPBlockNetSize( serverAddress, serverPortList );
-
-					// [BB] If sending this block would cause the current packet to exceed ulMaxPacketSize ...
-					if ( ulSizeOfPacket + ulServerBlockNetSize > ulMaxPacketSize - 1 )
-					{
-						// [BB] ... close the current packet and start a new one.
-						g_MessageBuffer.ByteStream.WriteByte( 0 ); // [BB] Terminate MSC_SERVERBLOCK by sending 0 ports.
-						g_MessageBuffer.ByteStream.WriteByte( MSC_ENDSERVERLISTPART );
-						NETWORK_LaunchPacket( &g_MessageBuffer, AddressFrom );
-
-						g_MessageBuffer.Clear();
-						++ulPacketNum;
-						ulSizeOfPacket = 5;
-						g_MessageBuffer.ByteStream.WriteLong( MSC_BEGINSERVERLISTPART );
-						g_MessageBuffer.ByteStream.WriteByte( ulPacketNum );
-						g_MessageBuffer.ByteStream.WriteByte( MSC_SERVERBLOCK );
-					}
-					ulSizeOfPacket += ulServerBlockNetSize;
-					MASTERSERVER_SendServerIPBlockToLauncher ( serverAddress, serverPortList, &g_MessageBuffer.ByteStream );
-				}
-				g_MessageBuffer.ByteStream.WriteByte( 0 ); // [BB] Terminate MSC_SERVERBLOCK by sending 0 ports.
-				g_MessageBuffer.ByteStream.WriteByte( MSC_ENDSERVERLIST );
-				NETWORK_LaunchPacket( &g_MessageBuffer, AddressFrom );
+				for ( unsigned int i = 0; i < g_ServerListPackets.size(); ++i )
+					NETWORK_LaunchEncodedPacket( &g_ServerListPackets[i][0], static_cast<int>( g_ServerListPackets[i].size() ), AddressFrom );
 				return;
 			}
 		}
@@ -684,6 +715,8 @@ void MASTERSERVER_CheckTimeouts( std::set<SERVER_s, SERVERCompFunc> &ServerSet )
 			// [BB] The standard does not require set::erase to return the incremented operator,
 			// that's why we must use the post increment operator here.
 			ServerSet.erase ( it++ );
+			if ( &ServerSet == &g_Servers )
+				g_bServerListPacketsOutdated = true;
 			continue;
 		}
 		else
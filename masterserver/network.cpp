@@ -274,7 +274,6 @@ NETADDRESS_s NETWORK_GetFromAddress( void )
 //
 void NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address )
 {
-	LONG				lNumBytes;
 	INT					iNumBytesOut = sizeof(g_ucHuffmanBuffer);
 
 	pBuffer->ulCurrentSize = pBuffer->CalcSize();
@@ -283,13 +282,45 @@ void NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address )
 	if ( pBuffer->ulCurrentSize == 0 )
 		return;
 
+	HUFFMAN_Encode( (unsigned char *)pBuffer->pbData, g_ucHuffmanBuffer, pBuffer->ulCurrentSize, &iNumBytesOut );
+
+	NETWORK_LaunchEncodedPacket( g_ucHuffmanBuffer, iNumBytesOut, Address );
+}
+
+//*****************************************************************************
+//
+// Huffman encodes the contents of the buffer, so that the result can be sent
+// several times with NETWORK_LaunchEncodedPacket.
+void NETWORK_EncodePacket( NETBUFFER_s *pBuffer, std::vector<UCHAR> &Encoded )
+{
+	INT					iNumBytesOut = sizeof(g_ucHuffmanBuffer);
+
+	pBuffer->ulCurrentSize = pBuffer->CalcSize();
+	Encoded.clear();
+
+	// Nothing to do.
+	if ( pBuffer->ulCurrentSize == 0 )
+		return;
+
+	HUFFMAN_Encode( (unsigned char *)pBuffer->pbData, g_ucHuffmanBuffer, pBuffer->ulCurrentSize, &iNumBytesOut );
+	Encoded.assign( g_ucHuffmanBuffer, g_ucHuffmanBuffer + iNumBytesOut );
+}
+
+//*****************************************************************************
+//
+void NETWORK_LaunchEncodedPacket( const UCHAR *pucData, int iNumBytes, NETADDRESS_s Address )
+{
+	LONG				lNumBytes;
+
+	// Nothing to do.
+	if ( iNumBytes == 0 )
+		return;
+
 	// Convert the IP address to a socket address.
 	struct sockaddr_in SocketAddress;
 	Address.ToSocketAddress( reinterpret_cast<sockaddr&>(SocketAddress) );
 
-	HUFFMAN_Encode( (unsigned char *)pBuffer->pbData, g_ucHuffmanBuffer, pBuffer->ulCurrentSize, &iNumBytesOut );
-
-	lNumBytes = sendto( g_NetworkSocket, (const char*)g_ucHuffmanBuffer, iNumBytesOut, 0, reinterpret_cast<sockaddr*>(&SocketAddress), sizeof( SocketAddress ));
+	lNumBytes = sendto( g_NetworkSocket, (const char*)pucData, iNumBytes, 0, reinterpret_cast<sockaddr*>(&SocketAddress), sizeof( SocketAddress ));
 
 	// If sendto returns -1, there was an error.
 	if ( lNumBytes == -1 )
@@ -233,9 +233,9 @@ class ActorParameter(SpecParameter):
 		self.readnetid = netid # Remember the netid variable name for checks
 
 		# Write the code to read in the netid
-		writer.declare('int', netid)
-		# [SB] NetIDs are ushorts now, so ensure they are interpreted as such.
-		writer.writeline('{netid} = static_cast<unsigned short>(bytestream->ReadShort());'.format(**locals()))
+		writer.declare('unsigned int', netid)
+		# NetIDs are 32 bits wide and take two or four bytes, see BYTESTREAM_s::ReadNetID.
+		writer.writeline('{netid} = bytestream->ReadNetID();'.format(**locals()))
 
 	def writereadchecks(self, writer, command, reference, **args):
 		netid = self.readnetid
@@ -251,7 +251,7 @@ class ActorParameter(SpecParameter):
 					   allownull=('nullallowed' in self.attributes) and 'true' or 'false', **locals()))
 
 	def writesend(self, writer, command, reference, **args):
-		writer.writeline('command.addShort( this->{reference} ? this->{reference}->NetID : 0 );'.format(**locals()))
+		writer.writeline('command.addNetID( this->{reference} ? this->{reference}->NetID : 0 );'.format(**locals()))
 
 # ----------------------------------------------------------------------------------------------------------------------
 
@@ -566,15 +566,16 @@ class NameParameter(SpecParameter):
 
 # ----------------------------------------------------------------------------------------------------------------------
 
-class NetidParameter(ShortParameter):
-	def writeread(self, writer, command, reference):
-		readfunction = 'Read' + self.methodname()
-		casttype = self.cxxtypename
-		writer.writeline('command.{reference} = static_cast<{casttype}>(bytestream->{readfunction}());'.format(**locals()))
+class NetidParameter(ByteParameter):
+	def methodname(self):
+		return 'NetID'
+
+	def writesend(self, writer, command, reference):
+		writer.writeline('command.addNetID( this->{reference} );'.format(**locals()))
 
 	@property
 	def cxxtypename(self):
-		return 'unsigned short'
+		return 'unsigned int'
 
 # ----------------------------------------------------------------------------------------------------------------------
 
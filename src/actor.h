@@ -1157,7 +1157,7 @@ public:
 	int			FixedColormap;
 
 	// ID used to identify this actor over network games.
-	unsigned short NetID;
+	unsigned int NetID;
 
 	// Pointer to the pickup spot this item was spawned from.
 	ABaseMonsterInvasionSpot		*pMonsterSpot;
@@ -1375,6 +1375,17 @@ void PrintMiscActorInfo(AActor * query);
 template <typename T>
 class IDList
 {
+public:
+	enum
+	{
+		// The table starts out with this many IDs and doubles whenever all of
+		// them are in use, up to NETID_MAXSIZE. IDs below 32768 take two bytes
+		// on the wire, larger ones four (see BYTESTREAM_s::WriteNetID), so the
+		// IDs are only handed out round robin within this range until it's full.
+		NETID_INITIALSIZE	= 32768,
+		NETID_MAXSIZE		= 1 << 24,
+	};
+
 private:
 	// List of all possible network ID's for an actor. Slot is true if it available for use.
 	typedef struct
@@ -1385,15 +1396,30 @@ private:
 		// If this node is occupied, this is the actor occupying it.
 		T	*pActor;
 
+		// If this node is free, these are the free nodes before and after
+		// it in the free list (0 if there is none).
+		unsigned int	prevFree;
+		unsigned int	nextFree;
+
 	} IDNODE_t;
 
-	IDNODE_t _entries[ static_cast<unsigned int>(( std::numeric_limits<unsigned short>::max )( )) + 1];
-	unsigned short _firstFreeID;
+	TArray<IDNODE_t> _entries;
+
+	// The free nodes form a FIFO: getNewID takes the first one and freeID
+	// appends to the last one. So both are O(1), and like the old round robin
+	// search a freed ID is only handed out again after all the others that
+	// were free before it.
+	unsigned int _firstFreeID;
+	unsigned int _lastFreeID;
 
-	inline bool isIndexValid ( const unsigned short netID ) const
+	inline bool isIndexValid ( const unsigned int netID ) const
 	{
-		return ( netID > 0 );
+		return ( netID > 0 ) && ( netID < _entries.Size( ));
 	}
+
+	void grow ( const unsigned int size );
+	void unlinkFreeID ( const unsigned int netID );
+
 public:
 	void clear ( );
 
@@ -1405,20 +1431,19 @@ public:
 		clear ( );
 	}
 
-	void useID ( const unsigned short netID, T *actor );
+	void useID ( const unsigned int netID, T *actor );
+
+	void freeID ( const unsigned int netID );
+
+	unsigned int getNewID ( );
 
-	void freeID ( const unsigned short netID )
+	// Number of IDs in the table, used or free.
+	unsigned int size ( ) const
 	{
-		if ( isIndexValid ( netID ) )
-		{
-			_entries[netID].bFree = true;
-			_entries[netID].pActor = NULL;
-		}
+		return _entries.Size( );
 	}
 
-	unsigned short getNewID ( );
-
-	T* findPointerByID ( const unsigned short netID ) const
+	T* findPointerByID ( const unsigned int netID ) const
 	{
 		if ( isIndexValid ( netID ) == false )
 			return ( NULL );
@@ -44,73 +44,158 @@
 //
 // Filename: astar.cpp
 //
-// Description: 
+// Description: Bot pathing over a navigation graph of the map.
+//
+// The graph is built once per map, from a set of GL nodes that is made just for
+// it: every subsector is a node, and every seg that a player can walk across is
+// an edge to the subsector behind it. Since the subsectors are convex, a bot can
+// always walk straight from one crossing to the next. The graph only depends on
+// the map, so it's cached by the map's checksum.
+//
+// Paths are searched in two steps: first over the sectors, then over the
+// subsectors of the sectors along (and next to) that route. Every path that is
+// found is stored in a shared cache as the next crossing to take towards its goal
+// from each node along it, so that bots heading to the same goal from anywhere
+// on a known route don't have to search at all.
 //
 //-----------------------------------------------------------------------------
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <algorithm>
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#define getpid _getpid
+#endif
 
 #include "astar.h"
+#include "cmdlib.h"
 #include "doomstat.h"
+#include "g_level.h"
 #include "gi.h"
+#include "m_misc.h"
 #include "m_random.h"
+#include "m_swap.h"
+#include "md5.h"
+#include "nodebuild.h"
 #include "p_lnspec.h"
 #include "p_local.h"
-#include "p_trace.h"
+#include "p_setup.h"
+#include "po_man.h"
+#include "r_state.h"
 #include "i_system.h"
 #include "stats.h"
 #include "botpath.h"
+#include "bots.h"
 #include "doomerrors.h"
+#include "templates.h"
+
+//*****************************************************************************
+//	DEFINES
+
+#define	ASTAR_CACHE_HEADER_SIZE		( 4 + 4 + 4 + 16 + 16 )
+
+// Results of a search.
+enum
+{
+	ASTAR_FOUND,
+	ASTAR_UNREACHABLE,
+	ASTAR_GAVEUP,
+	ASTAR_DEFERRED,
+};
+
+//*****************************************************************************
+//	STRUCTURES
+
+typedef struct
+{
+	LONG				lTotalCost;
+	LONG				lIdx;
+
+} ASTARHEAPENTRY_t;
+
+//*****************************************************************************
+// An entry of the path cache: the edge to take from a node towards a goal.
+typedef struct
+{
+	LONG				lEdge;
+	LONG				lCostToGoal;
+
+} ASTARHOP_t;
 
 //*****************************************************************************
 //	VARIABLES
 
-static	LONG			g_lNumHorizontalNodes;
-static	LONG			g_lNumVerticalNodes;
-static	LONG			g_lMapXMin;
-static	LONG			g_lMapYMin;
-static	LONG			g_lMapXMax;
-static	LONG			g_lMapYMax;
-static	LONG			g_lNodeListSize;
-static	LONG			g_lNumSearchedNodes;
-static	cycle_t			g_PathingCycles;
-static	ASTARNODE_t		*g_aMasterNodeList = NULL;
-static	ULONG			g_ulPriorityQueuePosition[MAX_PATHS];
-static	ASTARNODE_t		**g_apOpenListPriorityQueue[MAX_PATHS];
-static	ASTARPATH_t		g_aPaths[MAX_PATHS];
-static	LONG			g_lCurrentPathIdx;
-static	FRandom			g_RandomRoamSeed( "RoamSeed" );
-static	bool			g_bIsInitialized;
+static	TArray<ASTARGRAPHNODE_t>	g_Nodes;
+static	TArray<ASTAREDGE_t>			g_Edges;
+static	TArray<ASTARBSPNODE_t>		g_BSP;
+
+// The sector level of the graph.
+static	TArray<POS_t>				g_SectorCenters;
+static	TArray<ULONG>				g_ulSectorEdgeStart;
+static	TArray<LONG>				g_lSectorEdges;
+
+// Per-search state, valid where the stamp matches the current search.
+static	TArray<LONG>				g_lSearchCost;
+static	TArray<LONG>				g_lSearchParent;
+static	TArray<ULONG>				g_ulOpenStamp;
+static	TArray<ULONG>				g_ulClosedStamp;
+static	TArray<LONG>				g_lSectorCost;
+static	TArray<LONG>				g_lSectorParent;
+static	TArray<ULONG>				g_ulSectorOpenStamp;
+static	TArray<ULONG>				g_ulSectorClosedStamp;
+static	TArray<ULONG>				g_ulCorridorStamp;
+static	ULONG						g_ulSearchStamp;
+static	TArray<ASTARHEAPENTRY_t>	g_Heap;
+
+// The shared path cache, keyed by goal node, damage avoidance and node.
+static	TMap<QWORD, ASTARHOP_t>		g_PathCache;
+
+// Pairs of nodes that are known to be unreachable, until the given tic.
+static	TMap<QWORD, LONG>			g_UnreachableCache;
+
+static	LONG				g_lNumSearchedNodes;
+static	LONG				g_lSearchTic;
+static	float				g_fSearchDebt;
+static	ULONG				g_ulNumCacheHits;
+static	ULONG				g_ulNumSearches;
+static	cycle_t				g_PathingCycles;
+static	ASTARPATH_t			g_aPaths[MAX_PATHS];
+static	FRandom				g_RandomRoamSeed( "RoamSeed" );
+static	bool				g_bIsInitialized;
 
 //*****************************************************************************
 //	PROTOTYPES
 
-static	bool			astar_PathNextNode( ASTARPATH_t *pPath );
-static	ASTARNODE_t		*astar_GetNodeFromPoint( POS_t Point );
-static	LONG			astar_GetCostToGoalEstimate( ASTARPATH_t *pPath, ASTARNODE_t *pNode );
-static	void			astar_PushNodeToStack( ASTARNODE_t *pNode, ASTARPATH_t *pPath );
-static	bool			astar_PullNodeFromOpenList( ASTARPATH_t *pPath );
-static	void			astar_ProcessNextPathNode( ASTARPATH_t *pPath, ASTARNODE_t *pNode, LONG lAddedCost, LONG lDirection );
-static	ASTARNODE_t		*astar_GetNode( LONG lXNodeIdx, LONG lYNodeIdx );
-static	void			astar_InsertToPriorityQueue( ASTARNODE_t *pNode );
-static	ASTARNODE_t		*astar_PopFromPriorityQueue( void );
-static	void			astar_FixUpPriorityQueue( ULONG ulPosition );
-static	void			astar_FixDownPriorityQueue( ULONG ulStartPosition, ULONG ulEndPosition );
-static	bool			astar_IsPriorityQueueEmpty( void );
-static	void			astar_Exchange( ASTARNODE_t **pNode1, ASTARNODE_t **pNode2 );
-static	ULONG			astar_GetTotalCost( ASTARNODE_t *pNode );
+static	bool			astar_BuildGraph( void );
+static	void			astar_BuildSectorGraph( void );
+static	FString			astar_CacheName( const BYTE abChecksum[16], bool bCreate );
+static	bool			astar_LoadCache( const BYTE abChecksum[16] );
+static	void			astar_SaveCache( const BYTE abChecksum[16] );
+static	LONG			astar_GetNodeFromPoint( fixed_t X, fixed_t Y );
+static	LONG			astar_GetDamageCost( sector_t *pSector );
+static	bool			astar_IsDoorSector( sector_t *pSector );
+static	LONG			astar_GetCostToGoalEstimate( const POS_t &From, const POS_t &Goal );
+static	void			astar_HeapPush( LONG lTotalCost, LONG lIdx );
+static	bool			astar_HeapPop( LONG &lIdx );
+static	ULONG			astar_NextSearchStamp( void );
+static	bool			astar_MarkCorridor( LONG lStartSector, LONG lGoalSector );
+static	int				astar_SearchNodes( LONG lStart, LONG lGoal, bool bAvoidDamage, bool bInCorridor, LONG lGiveUpLimit, TArray<LONG> &Edges, LONG &lCost );
+static	int				astar_FindPath( LONG lStart, LONG lGoal, bool bAvoidDamage, float fMaxSearchNodes, LONG lGiveUpLimit, TArray<LONG> &Edges, LONG &lCost );
+static	QWORD			astar_CacheKey( LONG lNode, LONG lGoal, bool bAvoidDamage );
+static	bool			astar_LookupPath( LONG lStart, LONG lGoal, bool bAvoidDamage, TArray<LONG> &Edges, LONG &lCost );
+static	void			astar_StorePath( LONG lGoal, bool bAvoidDamage, const TArray<LONG> &Edges );
+static	void			astar_BlockEdge( LONG lEdge );
+static	void			astar_ShowPath( ASTARPATH_t *pPath );
 
 //*****************************************************************************
 //	FUNCTIONS
 
 void ASTAR_Construct( void )
 {
-	ULONG	ulIdx;
-
-	for ( ulIdx = 0; ulIdx < MAX_PATHS; ulIdx++ )
-		g_apOpenListPriorityQueue[ulIdx] = NULL;
-
 	g_bIsInitialized = false;
 }
 
@@ -118,90 +203,75 @@ void ASTAR_Construct( void )
 //
 void ASTAR_BuildNodes( void )
 {
-	ULONG	ulIdx;
-	ULONG	ulIdx2;
+	const unsigned int	ulStartTime = I_MSTime( );
+	BYTE				abChecksum[16];
+	bool				bHaveChecksum = false;
 
-	g_lMapXMax = INT_MIN;
-	g_lMapYMax = INT_MIN;
+	ASTAR_ClearNodes( );
 
-	for ( ulIdx = 0; ulIdx < (ULONG)numvertexes; ulIdx++ )
+	// The graph is cached by the map's checksum.
+	MapData *pMap = P_OpenMapData( level.mapname, false );
+	if ( pMap != NULL )
 	{
-		if ( vertexes[ulIdx].x > g_lMapXMax )
-			g_lMapXMax = vertexes[ulIdx].x;
-    
-		if ( vertexes[ulIdx].y > g_lMapYMax )
-			g_lMapYMax = vertexes[ulIdx].y;
+		pMap->GetChecksum( abChecksum );
+		delete pMap;
+		bHaveChecksum = true;
 	}
 
-	g_lMapXMin = bmaporgx;
-	g_lMapYMin = bmaporgy;
-
-//	g_lNumHorizontalNodes = ((( g_lMapXMax - g_lMapXMin ) / FRACUNIT ) / ASTAR_NODE_SIZE );
-//	g_lNumVerticalNodes = ((( g_lMapYMax - g_lMapYMin ) / FRACUNIT ) / ASTAR_NODE_SIZE );
-	g_lNumHorizontalNodes = ( g_lMapXMax >> ASTAR_NODE_SHIFT ) - ( g_lMapXMin >> ASTAR_NODE_SHIFT ) + 1;
-	g_lNumVerticalNodes = ( g_lMapYMax >> ASTAR_NODE_SHIFT ) - ( g_lMapYMin >> ASTAR_NODE_SHIFT ) + 1;
-
-	g_lNodeListSize = ( g_lNumHorizontalNodes * g_lNumVerticalNodes );
-
-	// Allocate a bunch of nodes for the master node list. The size of the master node list
-	// is the maximum number of nodes per search: length * width.
-	// [BB] This is certainly more memory than we want to assign for the bots...
-	if ( sizeof ( ASTARNODE_t ) * g_lNodeListSize > INT_MAX )
+	if ( bHaveChecksum && astar_LoadCache( abChecksum ))
 	{
-		Printf ( "Unable to allocate bot nodes. Disabling bots on this map.\n");
-		g_bIsInitialized = true;
-		return;
+		DPrintf( "Loaded bot navigation graph from the cache in %u ms\n", I_MSTime( ) - ulStartTime );
 	}
-	g_aMasterNodeList = new ASTARNODE_t[g_lNodeListSize];
-
-	for ( ulIdx = 0; ulIdx < (ULONG)g_lNumHorizontalNodes; ulIdx++ )
+	else if ( astar_BuildGraph( ))
 	{
-		for ( ulIdx2 = 0; ulIdx2 < (ULONG)g_lNumVerticalNodes; ulIdx2++ )
-		{
-			g_aMasterNodeList[( ulIdx * g_lNumVerticalNodes ) + ulIdx2].lXNodeIdx = ulIdx;
-			g_aMasterNodeList[( ulIdx * g_lNumVerticalNodes ) + ulIdx2].lYNodeIdx = ulIdx2;
-			g_aMasterNodeList[( ulIdx * g_lNumVerticalNodes ) + ulIdx2].Position = ASTAR_GetPositionFromIndex( ulIdx, ulIdx2 );
-		}
+		DPrintf( "Built bot navigation graph (%d nodes, %d edges) in %u ms\n", g_Nodes.Size( ), g_Edges.Size( ), I_MSTime( ) - ulStartTime );
+		if ( bHaveChecksum )
+			astar_SaveCache( abChecksum );
+	}
+	else
+	{
+		Printf ( "Unable to build bot nodes. Disabling bots on this map.\n");
+		ASTAR_ClearNodes( );
+		g_bIsInitialized = true;
+		return;
 	}
 
-	for ( ulIdx = 0; ulIdx < (ULONG)g_lNodeListSize; ulIdx++ )
+	astar_BuildSectorGraph( );
+
+	const ULONG ulNumNodes = g_Nodes.Size( );
+	g_lSearchCost.Resize( ulNumNodes );
+	g_lSearchParent.Resize( ulNumNodes );
+	g_ulOpenStamp.Resize( ulNumNodes );
+	g_ulClosedStamp.Resize( ulNumNodes );
+	g_lSectorCost.Resize( numsectors );
+	g_lSectorParent.Resize( numsectors );
+	g_ulSectorOpenStamp.Resize( numsectors );
+	g_ulSectorClosedStamp.Resize( numsectors );
+	g_ulCorridorStamp.Resize( numsectors );
+	memset( &g_ulOpenStamp[0], 0, ulNumNodes * sizeof( ULONG ));
+	memset( &g_ulClosedStamp[0], 0, ulNumNodes * sizeof( ULONG ));
+	if ( numsectors > 0 )
 	{
-		for ( ulIdx2 = 0; ulIdx2 < MAX_PATHS; ulIdx2++ )
-		{
-			g_aMasterNodeList[ulIdx].bOnClosed[ulIdx2] = false;
-			g_aMasterNodeList[ulIdx].bOnOpen[ulIdx2] = false;
-			g_aMasterNodeList[ulIdx].lCostFromStart[ulIdx2] = 0;
-			g_aMasterNodeList[ulIdx].lTotalCost[ulIdx2] = 0;
-			g_aMasterNodeList[ulIdx].pParent[ulIdx2] = NULL;
-		}
+		memset( &g_ulSectorOpenStamp[0], 0, numsectors * sizeof( ULONG ));
+		memset( &g_ulSectorClosedStamp[0], 0, numsectors * sizeof( ULONG ));
+		memset( &g_ulCorridorStamp[0], 0, numsectors * sizeof( ULONG ));
 	}
+	g_ulSearchStamp = 0;
 
-	for ( ulIdx = 0; ulIdx < MAX_PATHS; ulIdx++ )
+	for ( ULONG ulIdx = 0; ulIdx < MAX_PATHS; ulIdx++ )
 	{
-		g_aPaths[ulIdx].bInGoalNode = false;
-		g_aPaths[ulIdx].lStackPos = 0;
-		g_aPaths[ulIdx].pActor = NULL;
-		g_aPaths[ulIdx].paVisualizations = (AActor **)M_Malloc( sizeof(AActor *) * g_lNodeListSize );
-		for ( ulIdx2 = 0; ulIdx2 < (ULONG)g_lNodeListSize; ulIdx2++ )
-			g_aPaths[ulIdx].paVisualizations[ulIdx2] = NULL;
-		g_aPaths[ulIdx].pCurrentNode = NULL;
-		g_aPaths[ulIdx].pStartNode = NULL;
-		g_aPaths[ulIdx].pGoalNode = NULL;
-		for ( ulIdx2 = 0; ulIdx2 < MAX_NODES_IN_PATH; ulIdx2++ )
-			g_aPaths[ulIdx].pNodeStack[ulIdx2] = NULL;
 		g_aPaths[ulIdx].ulFlags = 0;
-		g_aPaths[ulIdx].ulNextStep = 0;
-		g_aPaths[ulIdx].ulNumSearchedNodes = 0;
-
-		g_ulPriorityQueuePosition[ulIdx] = 0;
-		g_apOpenListPriorityQueue[ulIdx] = (ASTARNODE_t **)M_Malloc( sizeof(ASTARNODE_t *) * ( g_lNodeListSize + 1 ));
-		for ( ulIdx2 = 0; ulIdx2 < (ULONG)g_lNodeListSize; ulIdx2++ )
-			g_apOpenListPriorityQueue[ulIdx][ulIdx2] = NULL;
+		g_aPaths[ulIdx].Waypoints.Clear( );
+		g_aPaths[ulIdx].lTotalCost = 0;
+		g_aPaths[ulIdx].pActor = NULL;
+		g_aPaths[ulIdx].Visualizations.Clear( );
 	}
 
 	g_lNumSearchedNodes = 0;
-
-	g_lCurrentPathIdx = -1;
+	g_lSearchTic = -1;
+	g_fSearchDebt = 0;
+	g_ulNumCacheHits = 0;
+	g_ulNumSearches = 0;
 
 	g_bIsInitialized = true;
 }
@@ -210,21 +280,39 @@ void ASTAR_BuildNodes( void )
 //
 void ASTAR_ClearNodes( void )
 {
-	ULONG	ulIdx;
-
-	delete[] g_aMasterNodeList;
-	g_aMasterNodeList = NULL;
-
-	for ( ulIdx = 0; ulIdx < MAX_PATHS; ulIdx++ )
+	for ( ULONG ulIdx = 0; ulIdx < MAX_PATHS; ulIdx++ )
 	{
-		M_Free( g_apOpenListPriorityQueue[ulIdx] );
-		g_apOpenListPriorityQueue[ulIdx] = NULL;
+		g_aPaths[ulIdx].ulFlags = 0;
+		g_aPaths[ulIdx].Waypoints.Clear( );
+		g_aPaths[ulIdx].pActor = NULL;
 
-		M_Free( g_aPaths[ulIdx].paVisualizations );
-		g_aPaths[ulIdx].paVisualizations = NULL;
+		// This can happen in the middle of a level (see ASTAR_BuildNodes), so the
+		// visualizations are still around. P_FreeLevelData calls this before it
+		// destroys the level's actors.
+		for ( ULONG ulIdx2 = 0; ulIdx2 < g_aPaths[ulIdx].Visualizations.Size( ); ulIdx2++ )
+			g_aPaths[ulIdx].Visualizations[ulIdx2]->Destroy( );
+		g_aPaths[ulIdx].Visualizations.Clear( );
 	}
 
-	g_lNodeListSize = 0;
+	g_Nodes.Clear( );
+	g_Edges.Clear( );
+	g_BSP.Clear( );
+	g_SectorCenters.Clear( );
+	g_ulSectorEdgeStart.Clear( );
+	g_lSectorEdges.Clear( );
+	g_lSearchCost.Clear( );
+	g_lSearchParent.Clear( );
+	g_ulOpenStamp.Clear( );
+	g_ulClosedStamp.Clear( );
+	g_lSectorCost.Clear( );
+	g_lSectorParent.Clear( );
+	g_ulSectorOpenStamp.Clear( );
+	g_ulSectorClosedStamp.Clear( );
+	g_ulCorridorStamp.Clear( );
+	g_Heap.Clear( );
+	g_PathCache.Clear( );
+	g_UnreachableCache.Clear( );
+
 	g_bIsInitialized = false;
 }
 
@@ -239,159 +327,91 @@ bool ASTAR_IsInitialized( void )
 //
 ASTARRETURNSTRUCT_t ASTAR_Path( ULONG ulPathIdx, POS_t GoalPoint, float fMaxSearchNodes, LONG lGiveUpLimit )
 {
-//	ASTARNODE_t				*pStartNode;
 	ASTARRETURNSTRUCT_t		ReturnVal;
-	POS_t					StartPoint;
 	ASTARPATH_t				*pPath;
+	LONG					lStartNode;
+	LONG					lGoalNode;
 
-	g_lCurrentPathIdx = ulPathIdx;
+	ReturnVal.bIsGoal = false;
+	ReturnVal.pNode = NULL;
+	ReturnVal.ulFlags = 0;
+	ReturnVal.lTotalCost = 0;
 
 	pPath = &g_aPaths[ulPathIdx];
 	pPath->pActor = players[ulPathIdx % MAXPLAYERS].mo;
 
-	StartPoint.x = pPath->pActor->x;
-	StartPoint.y = pPath->pActor->y;
-
-	pPath->pGoalNode = astar_GetNodeFromPoint( GoalPoint );
-	if ( pPath->pGoalNode == NULL )
+	// Without a graph, nothing can be reached.
+	if ( g_Nodes.Size( ) == 0 )
 	{
-		Printf( "WARNING! Cannot path to location: (%d, %d)\n", GoalPoint.x / FRACUNIT, GoalPoint.y / FRACUNIT );
-		ReturnVal.bIsGoal = false;
-		ReturnVal.pNode = NULL;
-		ReturnVal.ulFlags = 0;
-		ReturnVal.lTotalCost = 0;
-
+		ReturnVal.ulFlags = PF_COMPLETE;
 		return ( ReturnVal );
 	}
 
-	pPath->pStartNode = astar_GetNodeFromPoint( StartPoint );
-	if ( pPath->pStartNode == NULL )
-	{
-		// [BB] The bot spawned outside the map. This really should NOT happen.
-		// But if it does, we have to do something about it, otherwise ST will
-		// crash. So we kill the bot and hope he respawns inside the level.
-		Printf( "WARNING! Cannot find start point: (%d, %d)\n", StartPoint.x / FRACUNIT, StartPoint.y / FRACUNIT );
-		ReturnVal.bIsGoal = false;
-		ReturnVal.pNode = NULL;
-		ReturnVal.ulFlags = 0;
-		ReturnVal.lTotalCost = 0;
-
-		pPath->pActor->Die(NULL, NULL);
-		return ( ReturnVal );
-	}
-
-//	ASTAR_ClearPath( pPath );
+	lStartNode = astar_GetNodeFromPoint( pPath->pActor->x, pPath->pActor->y );
+	lGoalNode = astar_GetNodeFromPoint( GoalPoint.x, GoalPoint.y );
 
 	// Has the path has already been built? If so, simply return the next node on the path.
 	if ( pPath->ulFlags & PF_COMPLETE )
 	{
-//		POS_t			CurPos;
-		POS_t			DestPos;
-//		sector_t		*pSector;
-//		fixed_t			vx;
-//		fixed_t			vy;
-//		fixed_t			vz;
-//		fixed_t			Angle;
-//		fixed_t			Pitch;
-//		FTraceResults	TraceResults;
 		ULONG			ulResults;
 
-//		CurPos.x = pPath->pActor->x;
-//		CurPos.y = pPath->pActor->y;
-//		CurPos.z = pPath->pActor->z;
+		// We were not able to find a path.
+		if (( pPath->ulFlags & PF_SUCCESS ) == false )
+		{
+			ReturnVal.ulFlags = pPath->ulFlags;
+			return ( ReturnVal );
+		}
 
-		if ( pPath->lStackPos <= 0 )
+		if ( pPath->Waypoints.Size( ) == 0 )
 			I_Error( "ASTAR_Path: Bot pathing stack position went below 0!" );
 
-		DestPos = pPath->pNodeStack[pPath->lStackPos - 1]->Position;
-//		pSector = pPath->pActor->Sector;
-
-//		Angle = R_PointToAngle2( CurPos.x, CurPos.y, DestPos.x, DestPos.y ) >> ANGLETOFINESHIFT;
-//		Pitch = 0;
-
-//		vx = FixedMul( finecosine[Pitch], finecosine[Angle] );
-//		vy = FixedMul( finecosine[Pitch], finesine[Angle] );
-//		vz = finesine[Pitch];
-
 		// If we for some reason cannot reach the next node in our goal, we need to repath.
-/*
-		if ( Trace( CurPos.x,
-			CurPos.y,
-			pSector->floorplane.ZatPoint( CurPos.x, CurPos.y ) + gameinfo.StepHeight,
-			pSector,
-			vx,
-			vy,
-			vz,
-			ASTAR_NODE_SIZE * FRACUNIT,
-			MF_SOLID|MF_SHOOTABLE,
-			0,
-			pPath->pActor,
-			TraceResults ))
-*/
-		ulResults = BOTPATH_TryWalk( pPath->pActor, pPath->pActor->x, pPath->pActor->y, pPath->pActor->z, DestPos.x, DestPos.y );
+		ulResults = BOTPATH_TryWalk( pPath->pActor, pPath->pActor->x, pPath->pActor->y, pPath->pActor->z, pPath->Waypoints.Last( ).Position.x, pPath->Waypoints.Last( ).Position.y );
 		if ( ulResults & BOTPATH_OBSTRUCTED )
 		{
+			// Don't send anyone else this way for a while.
+			astar_BlockEdge( pPath->Waypoints.Last( ).lEdge );
+
 			// If this is a roaming path, just pick another roam location. Otherwise, try to
 			// salvage it.
 			if ( pPath->pActor->player->pSkullBot->m_ulPathType == BOTPATHTYPE_ROAM )
 			{
 				pPath->pActor->player->pSkullBot->m_ulPathType = BOTPATHTYPE_NONE;
 
-				ReturnVal.bIsGoal = false;
-				ReturnVal.lTotalCost = 0;
-				ReturnVal.pNode = NULL;
 				ReturnVal.ulFlags = PF_COMPLETE;
-
 				return ( ReturnVal );
 			}
 
-			ASTAR_ClearPath( g_lCurrentPathIdx );
+			ASTAR_ClearPath( ulPathIdx );
 
 			// Retain a few things.
 			pPath->pActor = players[ulPathIdx % MAXPLAYERS].mo;
-			pPath->pGoalNode = astar_GetNodeFromPoint( GoalPoint );
-			pPath->pStartNode = astar_GetNodeFromPoint( StartPoint );
 		}
 		else
 		{
 			// If we've reached the node we've been heading to, it's time to pop a new node
 			// off the stack.
-			if ( pPath->pStartNode == pPath->pNodeStack[pPath->lStackPos - 1] )
-			{
-				// If there is no new node to pop, this must be the goal node.
-				if ( pPath->lStackPos == 1 )
-				{
-					ReturnVal.pNode = pPath->pNodeStack[pPath->lStackPos - 1];
-					ReturnVal.bIsGoal = true;
-				}
-				else
-				{
-					pPath->lStackPos--;
-					ReturnVal.pNode = pPath->pNodeStack[pPath->lStackPos - 1];
-					ReturnVal.bIsGoal = false;
-				}
-			}
-			else
+			if (( pPath->Waypoints.Size( ) > 1 ) && ( lStartNode == pPath->Waypoints.Last( ).lNode ))
+				pPath->Waypoints.Pop( );
+
+			// The crossings are only there to get around corners, so skip one if the
+			// next is in reach already.
+			if ( pPath->Waypoints.Size( ) > 1 )
 			{
-				ReturnVal.pNode = pPath->pNodeStack[pPath->lStackPos - 1];
-				ReturnVal.bIsGoal = false;
+				const ASTARNODE_t &After = pPath->Waypoints[pPath->Waypoints.Size( ) - 2];
+				if (( BOTPATH_TryWalk( pPath->pActor, pPath->pActor->x, pPath->pActor->y, pPath->pActor->z, After.Position.x, After.Position.y ) & (BOTPATH_OBSTRUCTED|BOTPATH_DAMAGINGSECTOR)) == false )
+					pPath->Waypoints.Pop( );
 			}
 
+			// If there is no new node to pop, this must be the goal node.
+			ReturnVal.pNode = &pPath->Waypoints.Last( );
+			ReturnVal.bIsGoal = (( pPath->Waypoints.Size( ) == 1 ) && ( lStartNode == ReturnVal.pNode->lNode ));
 			ReturnVal.ulFlags = pPath->ulFlags;
-			ReturnVal.lTotalCost = pPath->pGoalNode->lTotalCost[g_lCurrentPathIdx];
-
-//			unclock( g_PathingCycles );
+			ReturnVal.lTotalCost = pPath->lTotalCost;
 			return ( ReturnVal );
 		}
 	}
 
-	g_PathingCycles.Reset();
-
-	g_PathingCycles.Clock();
-
-	// Begin the pathing process.
-	g_lNumSearchedNodes = 0;
-
 	// If the path has not been initialized, we need to set some things up.
 	if (( pPath->ulFlags & PF_INITIALIZED ) == false )
 	{
@@ -403,99 +423,85 @@ ASTARRETURNSTRUCT_t ASTAR_Path( ULONG ulPathIdx, POS_t GoalPoint, float fMaxSear
 			pSubSector = R_PointInSubsector( GoalPoint.x, GoalPoint.y );
 			if (( GoalPoint.z - pSubSector->sector->floorplane.ZatPoint( GoalPoint.x, GoalPoint.y )) > (( 36 * FRACUNIT ) + pPath->pActor->height ))
 			{
-				ReturnVal.bIsGoal = false;
-				ReturnVal.lTotalCost = 0;
-				ReturnVal.pNode = NULL;
 				ReturnVal.ulFlags = PF_COMPLETE;
-
 				return ( ReturnVal );
 			}
 		}
 
-		// Estimate the total cost to the goal from this node.
-		pPath->pStartNode->lCostFromStart[g_lCurrentPathIdx] = 0;
-		pPath->pStartNode->lTotalCost[g_lCurrentPathIdx] = pPath->pStartNode->lCostFromStart[g_lCurrentPathIdx] + astar_GetCostToGoalEstimate( pPath, pPath->pStartNode );
-
-		// The start node does not have a parent.
-		pPath->pStartNode->pParent[g_lCurrentPathIdx] = NULL;
-
-		// Put this node on the open list.
-		pPath->pStartNode->bOnOpen[g_lCurrentPathIdx] = true;
-		astar_InsertToPriorityQueue( pPath->pStartNode );
-
-		pPath->pStartNode->bOnClosed[g_lCurrentPathIdx] = false;
-		pPath->pStartNode->lDirection[g_lCurrentPathIdx] = 0;
-//		pPath->pStartNode->ulFlags[g_lCurrentPathIdx] = 0;
-
-		// The first thing to do in our pathing algorithm is pull a node from the open list.
-		pPath->ulNextStep = ASTAR_NS_PULLFROMOPENLIST;
-
-		// All done!
 		pPath->ulFlags |= PF_INITIALIZED;
 
 		// The VERY first thing we can do is test to see if there's a straight path betwen the
 		// bot and his goal.
 		if (( BOTPATH_TryWalk( pPath->pActor, pPath->pActor->x, pPath->pActor->y, pPath->pActor->z, GoalPoint.x, GoalPoint.y ) & (BOTPATH_OBSTRUCTED|BOTPATH_DAMAGINGSECTOR)) == false )
 		{
+			ASTARNODE_t	Goal;
+
+			Goal.Position = GoalPoint;
+			Goal.lNode = lGoalNode;
+			Goal.lEdge = -1;
+			pPath->Waypoints.Clear( );
+			pPath->Waypoints.Push( Goal );
 			pPath->ulFlags |= PF_COMPLETE|PF_SUCCESS;
-			astar_PushNodeToStack( pPath->pGoalNode, pPath );
+			pPath->lTotalCost = P_AproxDistance( pPath->pActor->x - GoalPoint.x, pPath->pActor->y - GoalPoint.y );
 
 			ReturnVal.bIsGoal = true;
-			ReturnVal.lTotalCost = P_AproxDistance( pPath->pActor->x - GoalPoint.x, pPath->pActor->y - GoalPoint.y );
-			ReturnVal.pNode = pPath->pGoalNode;
+			ReturnVal.lTotalCost = pPath->lTotalCost;
+			ReturnVal.pNode = &pPath->Waypoints.Last( );
 			ReturnVal.ulFlags = pPath->ulFlags;
-
-			g_PathingCycles.Unclock();
 			return ( ReturnVal );
 		}
 	}
 
-	if (( fMaxSearchNodes > 0 ) && ( fMaxSearchNodes < 1 ))
-	{
-		if (( gametic % (LONG)( 1.0f / fMaxSearchNodes )) == 0 )
-			astar_PathNextNode( pPath );
-	}
-	else
+	g_PathingCycles.Reset();
+	g_PathingCycles.Clock();
+
+	// Roaming bots have no reason to walk through damaging sectors at all.
+	const bool		bAvoidDamage = ( pPath->pActor->player->pSkullBot->m_ulPathType == BOTPATHTYPE_ROAM );
+	TArray<LONG>	Edges;
+	LONG			lCost = 0;
+
+	switch ( astar_FindPath( lStartNode, lGoalNode, bAvoidDamage, fMaxSearchNodes, lGiveUpLimit, Edges, lCost ))
 	{
-		while ( astar_PathNextNode( pPath ) == false )
+	case ASTAR_FOUND:
 		{
-			if (( fMaxSearchNodes > 0 ) && ( g_lNumSearchedNodes >= fMaxSearchNodes ))
-				break;
-
-			if (( lGiveUpLimit > 0 ) && ( pPath->ulNumSearchedNodes >= (ULONG)lGiveUpLimit ))
+			ASTARNODE_t	Waypoint;
+
+			// The waypoints are used like a stack, so the goal goes in first.
+			pPath->Waypoints.Clear( );
+			Waypoint.Position = GoalPoint;
+			Waypoint.lNode = lGoalNode;
+			Waypoint.lEdge = -1;
+			pPath->Waypoints.Push( Waypoint );
+			for ( int i = static_cast<int>( Edges.Size( )) - 1; i >= 0; i-- )
 			{
-				// We've exceeded the give up limit. So, label the path as complete.
-				pPath->ulFlags |= PF_COMPLETE;
-				break;
+				Waypoint.Position = g_Edges[Edges[i]].Crossing;
+				Waypoint.lNode = g_Edges[Edges[i]].lToNode;
+				Waypoint.lEdge = Edges[i];
+				pPath->Waypoints.Push( Waypoint );
 			}
+
+			pPath->ulFlags |= PF_COMPLETE|PF_SUCCESS;
+			pPath->lTotalCost = lCost;
+
+			if ( botdebug_shownodes )
+				astar_ShowPath( pPath );
+
+			ReturnVal.pNode = &pPath->Waypoints.Last( );
+			ReturnVal.lTotalCost = lCost;
 		}
+		break;
+	case ASTAR_UNREACHABLE:
+	case ASTAR_GAVEUP:
+
+		pPath->ulFlags |= PF_COMPLETE;
+		break;
+	default:
+
+		// Out of time for this tic. Try again on the next.
+		break;
 	}
 
 	ReturnVal.ulFlags = pPath->ulFlags;
-	if ( pPath->ulFlags & PF_COMPLETE )
-	{
-		 if ( pPath->ulFlags & PF_SUCCESS )
-		 {
-			// We have not yet completed a path to the goal.
-			ReturnVal.pNode = pPath->pNodeStack[pPath->lStackPos - 1];
-			ReturnVal.bIsGoal = false;
-			ReturnVal.lTotalCost = pPath->pGoalNode->lTotalCost[g_lCurrentPathIdx];
-		 }
-		 // Were not able to find a path.
-		 else
-		 {
-			ReturnVal.pNode = NULL;
-			ReturnVal.bIsGoal = false;
-			ReturnVal.lTotalCost = 0;
-		 }
-	}
-	else
-	{
-		// We have not yet completed a path to the goal.
-		ReturnVal.pNode = NULL;
-		ReturnVal.bIsGoal = false;
-		ReturnVal.lTotalCost = 0;
-	}
 
 	g_PathingCycles.Unclock();
 	return ( ReturnVal );
@@ -505,29 +511,7 @@ ASTARRETURNSTRUCT_t ASTAR_Path( ULONG ulPathIdx, POS_t GoalPoint, float fMaxSear
 //
 POS_t ASTAR_GetPosition( ASTARNODE_t *pNode )
 {
-	POS_t	Position;
-
-//	pNode->lXNodeIdx << ASTAR_NODE_SHIFT + (( g_lMapXMin >> ASTAR_NODE_SHIFT ) << ASTAR_NODE_SHIFT )
-//	Position.x = ( pNode->lXNodeIdx << ASTAR_NODE_SHIFT ) + (((( g_lMapXMin / FRACUNIT ) / 64 ) * 64 ) * FRACUNIT ) + ( 32 << FRACBITS );
-//	Position.y = ( pNode->lYNodeIdx << ASTAR_NODE_SHIFT ) + (((( g_lMapYMin / FRACUNIT ) / 64 ) * 64 ) * FRACUNIT ) + ( 32 << FRACBITS );
-	Position.x = ( pNode->lXNodeIdx << ASTAR_NODE_SHIFT ) + (( g_lMapXMin >> ASTAR_NODE_SHIFT ) << ASTAR_NODE_SHIFT ) + ( 32 << FRACBITS );
-	Position.y = ( pNode->lYNodeIdx << ASTAR_NODE_SHIFT ) + (( g_lMapYMin >> ASTAR_NODE_SHIFT ) << ASTAR_NODE_SHIFT ) + ( 32 << FRACBITS );
-	Position.z = 0;
-
-	return ( Position );
-}
-
-//*****************************************************************************
-//
-POS_t ASTAR_GetPositionFromIndex( LONG lXIdx, LONG lYIdx )
-{
-	POS_t	Position;
-
-	Position.x = ( lXIdx << ASTAR_NODE_SHIFT ) + (( g_lMapXMin >> ASTAR_NODE_SHIFT ) << ASTAR_NODE_SHIFT ) + ( 32 << FRACBITS );
-	Position.y = ( lYIdx << ASTAR_NODE_SHIFT ) + (( g_lMapYMin >> ASTAR_NODE_SHIFT ) << ASTAR_NODE_SHIFT ) + ( 32 << FRACBITS );
-	Position.z = 0;
-
-	return ( Position );
+	return ( pNode->Position );
 }
 
 //*****************************************************************************
@@ -539,14 +523,10 @@ void ASTAR_ClearVisualizations( void )
 
 	for ( ulIdx = 0; ulIdx < MAX_PATHS; ulIdx++ )
 	{
-		for ( ulIdx2 = 0; ulIdx2 < (ULONG)g_lNodeListSize; ulIdx2++ )
-		{
-			if ( g_aPaths[ulIdx].paVisualizations[ulIdx2] != NULL )
-			{
-				g_aPaths[ulIdx].paVisualizations[ulIdx2]->Destroy( );
-				g_aPaths[ulIdx].paVisualizations[ulIdx2] = NULL;
-			}
-		}
+		for ( ulIdx2 = 0; ulIdx2 < g_aPaths[ulIdx].Visualizations.Size( ); ulIdx2++ )
+			g_aPaths[ulIdx].Visualizations[ulIdx2]->Destroy( );
+
+		g_aPaths[ulIdx].Visualizations.Clear( );
 	}
 }
 
@@ -554,25 +534,24 @@ void ASTAR_ClearVisualizations( void )
 //
 void ASTAR_ShowCosts( POS_t Position )
 {
-	ASTARNODE_t	*pNode;
+	LONG	lNode;
 
-	pNode = astar_GetNodeFromPoint( Position );
+	lNode = astar_GetNodeFromPoint( Position.x, Position.y );
+	if ( lNode < 0 )
+		return;
 
-	if ( pNode )
+	const ASTARGRAPHNODE_t &Node = g_Nodes[lNode];
+	Printf( "Node %d (sector %d, component %d), %d edges\n", static_cast<int> (lNode), static_cast<int> (Node.lSector), static_cast<int> (Node.lComponent), static_cast<int> (Node.ulNumEdges) );
+	for ( ULONG ulIdx = Node.ulFirstEdge; ulIdx < Node.ulFirstEdge + Node.ulNumEdges; ulIdx++ )
 	{
-		Printf( "(%d, %d) (%s)\n", static_cast<int> (pNode->lXNodeIdx), static_cast<int> (pNode->lYNodeIdx), pNode->lDirection[1] == 0 ? "N" :
-			pNode->lDirection[1] == 1 ? "NE" : 
-			pNode->lDirection[1] == 2 ? "E" : 
-			pNode->lDirection[1] == 3 ? "SE" : 
-			pNode->lDirection[1] == 4 ? "S" : 
-			pNode->lDirection[1] == 5 ? "SW" : 
-			pNode->lDirection[1] == 6 ? "W" : 
-			pNode->lDirection[1] == 7 ? "NW" : "UNKNOWN"
-		);
-		Printf( "From start (g): %d\n", static_cast<int> (pNode->lCostFromStart[1]) );
-		Printf( "From goal (h): %d\n", static_cast<int> (pNode->lTotalCost[1] - pNode->lCostFromStart[1]) );
-		Printf( "Total (f): %d\n", static_cast<int> (pNode->lTotalCost[1]) );
+		const ASTAREDGE_t &Edge = g_Edges[ulIdx];
+		Printf( "  -> %d: cost %d%s%s%s%s\n", static_cast<int> (Edge.lToNode), static_cast<int> (Edge.lCost),
+			( Edge.ulFlags & ASTAREDGE_JUMP ) ? " jump" : "",
+			( Edge.ulFlags & ASTAREDGE_DOOR ) ? " door" : "",
+			( Edge.ulFlags & ASTAREDGE_DAMAGING ) ? " damaging" : "",
+			( Edge.lBlockedUntil > gametic ) ? " blocked" : "" );
 	}
+	Printf( "Cached hops: %d\n", static_cast<int> (g_PathCache.CountUsed( )) );
 }
 
 //*****************************************************************************
@@ -581,368 +560,821 @@ void ASTAR_ClearPath( LONG lPathIdx )
 {
 	ULONG	ulIdx;
 
-	g_ulPriorityQueuePosition[lPathIdx] = 0;
+	for ( ulIdx = 0; ulIdx < g_aPaths[lPathIdx].Visualizations.Size( ); ulIdx++ )
+		g_aPaths[lPathIdx].Visualizations[ulIdx]->Destroy( );
+	g_aPaths[lPathIdx].Visualizations.Clear( );
 
-	g_aPaths[lPathIdx].bInGoalNode = false;
-	g_aPaths[lPathIdx].lStackPos = 0;
 	g_aPaths[lPathIdx].pActor = NULL;
-	for ( ulIdx = 0; ulIdx < (ULONG)g_lNodeListSize; ulIdx++ )
+	g_aPaths[lPathIdx].Waypoints.Clear( );
+	g_aPaths[lPathIdx].lTotalCost = 0;
+	g_aPaths[lPathIdx].ulFlags = 0;
+}
+
+//*****************************************************************************
+//
+// Picks the center of a random subsector that is reachable from the given
+// position and between 128 and 512 units away from it along each axis, like the
+// old grid did.
+//
+void ASTAR_SelectRandomMapLocation( POS_t *pPos, fixed_t X, fixed_t Y )
+{
+	LONG	lNode;
+	LONG	lComponent;
+	LONG	lCandidate;
+	ULONG	ulTries;
+
+	pPos->x = X;
+	pPos->y = Y;
+	pPos->z = 0;
+
+	if ( g_Nodes.Size( ) == 0 )
+		return;
+
+	lNode = astar_GetNodeFromPoint( X, Y );
+	lComponent = g_Nodes[lNode].lComponent;
+
+	lCandidate = lNode;
+	for ( ulTries = 0; ulTries < 64; ulTries++ )
 	{
-		if ( g_aPaths[lPathIdx].paVisualizations[ulIdx] != NULL )
-		{
-			g_aPaths[lPathIdx].paVisualizations[ulIdx]->Destroy( );
-			g_aPaths[lPathIdx].paVisualizations[ulIdx] = NULL;
-		}
+		const LONG lIdx = g_RandomRoamSeed( g_Nodes.Size( ));
+		if ( g_Nodes[lIdx].lComponent != lComponent )
+			continue;
 
-		g_apOpenListPriorityQueue[lPathIdx][ulIdx] = NULL;
+		const fixed_t XDist = abs( g_Nodes[lIdx].Position.x - X );
+		const fixed_t YDist = abs( g_Nodes[lIdx].Position.y - Y );
+		if (( XDist > 512 * FRACUNIT ) || ( YDist > 512 * FRACUNIT ))
+			continue;
 
-		g_aMasterNodeList[ulIdx].bOnClosed[lPathIdx] = false;
-		g_aMasterNodeList[ulIdx].bOnOpen[lPathIdx] = false;
-		g_aMasterNodeList[ulIdx].lCostFromStart[lPathIdx] = 0;
-		g_aMasterNodeList[ulIdx].lTotalCost[lPathIdx] = 0;
-		g_aMasterNodeList[ulIdx].pParent[lPathIdx] = NULL;
+		lCandidate = lIdx;
+		if (( XDist >= 128 * FRACUNIT ) || ( YDist >= 128 * FRACUNIT ))
+			break;
 	}
-	g_aPaths[lPathIdx].pCurrentNode = NULL;
-	g_aPaths[lPathIdx].pStartNode = NULL;
-	g_aPaths[lPathIdx].pGoalNode = NULL;
-	for ( ulIdx = 0; ulIdx < MAX_NODES_IN_PATH; ulIdx++ )
-		g_aPaths[lPathIdx].pNodeStack[ulIdx] = NULL;
-	g_aPaths[lPathIdx].ulFlags = 0;
-	g_aPaths[lPathIdx].ulNextStep = 0;
-	g_aPaths[lPathIdx].ulNumSearchedNodes = 0;
+
+	pPos->x = g_Nodes[lCandidate].Position.x;
+	pPos->y = g_Nodes[lCandidate].Position.y;
 }
 
+//*****************************************************************************
 //*****************************************************************************
 //
-void ASTAR_SelectRandomMapLocation( POS_t *pPos, fixed_t X, fixed_t Y )
+// Builds the graph from a set of GL nodes made for it. The game's own nodes
+// can't be used, since they don't have to be GL nodes, and regular nodes don't
+// have segs along the partition lines between two subsectors of the same sector.
+//
+static bool astar_BuildGraph( void )
 {
-	LONG	lXIdx;
-	LONG	lYIdx;
-	LONG	lXNode;
-	LONG	lYNode;
-
-	lXNode = ( X >> ASTAR_NODE_SHIFT ) - ( g_lMapXMin >> ASTAR_NODE_SHIFT );
-	lYNode = ( Y >> ASTAR_NODE_SHIFT ) - ( g_lMapYMin >> ASTAR_NODE_SHIFT );
+	node_t			*pNodes = NULL;
+	seg_t			*pSegs = NULL;
+	glsegextra_t	*pSegExtras = NULL;
+	subsector_t		*pSubsectors = NULL;
+	vertex_t		*pVertices = NULL;
+	int				lNumNodes = 0;
+	int				lNumSegs = 0;
+	int				lNumSubsectors = 0;
+	int				lNumVertices = 0;
+
+	// Polyobjects move, so their lines are left out. Whether they're in the way is
+	// only found out while walking.
+	TArray<bool>	PolyLines( numlines );
+	for ( int i = 0; i < numlines; i++ )
+		PolyLines.Push( false );
+	for ( int i = 0; i < po_NumPolyobjs; i++ )
+	{
+		for ( unsigned int j = 0; j < polyobjs[i].Linedefs.Size( ); j++ )
+			PolyLines[static_cast<int>( polyobjs[i].Linedefs[j] - lines )] = true;
+	}
 
-	if ( g_lNumHorizontalNodes <= 3 )
+	TArray<line_t>	Lines( numlines );
+	TArray<int>		LineIndices( numlines );
+	for ( int i = 0; i < numlines; i++ )
 	{
-		do
+		if ( PolyLines[i] == false )
 		{
-			lXIdx = g_RandomRoamSeed ( g_lNumHorizontalNodes );
-		} while ( labs( lXNode - lXIdx ) > 8 );
+			Lines.Push( lines[i] );
+			LineIndices.Push( i );
+		}
 	}
-	else
+
+	if ( Lines.Size( ) == 0 )
+		return ( false );
+
 	{
-		do
+		TArray<FNodeBuilder::FPolyStart> polyspots, anchors;
+		FNodeBuilder::FLevel leveldata =
 		{
-			lXIdx = g_RandomRoamSeed ( g_lNumHorizontalNodes );
-		} while (( labs( lXNode - lXIdx ) > 8 ) || ( labs( lXNode - lXIdx ) < 2 ));
+			vertexes, numvertexes,
+			sides, numsides,
+			&Lines[0], static_cast<int>( Lines.Size( )),
+			0, 0, 0, 0
+		};
+		leveldata.FindMapBounds ();
+		FNodeBuilder builder (leveldata, polyspots, anchors, true);
+		builder.Extract (pNodes, lNumNodes,
+			pSegs, pSegExtras, lNumSegs,
+			pSubsectors, lNumSubsectors,
+			pVertices, lNumVertices);
 	}
 
-	if ( g_lNumVerticalNodes <= 3 )
+	// The BSP, to find the node a point is in.
+	g_BSP.Resize( lNumNodes );
+	for ( int i = 0; i < lNumNodes; i++ )
 	{
-		do
+		g_BSP[i].x = pNodes[i].x;
+		g_BSP[i].y = pNodes[i].y;
+		g_BSP[i].dx = pNodes[i].dx;
+		g_BSP[i].dy = pNodes[i].dy;
+		for ( int j = 0; j < 2; j++ )
 		{
-			lYIdx = g_RandomRoamSeed ( g_lNumVerticalNodes );
-		} while ( labs( lYNode - lYIdx ) > 8 );
+			if ((size_t)pNodes[i].children[j] & 1)
+				g_BSP[i].alChildren[j] = ~static_cast<LONG>( (subsector_t *)((BYTE *)pNodes[i].children[j] - 1) - pSubsectors );
+			else
+				g_BSP[i].alChildren[j] = static_cast<LONG>( (node_t *)pNodes[i].children[j] - pNodes );
+		}
 	}
-	else
+
+	// One node per subsector.
+	TArray<LONG>	SegSubsectors( lNumSegs );
+	SegSubsectors.Resize( lNumSegs );
+	g_Nodes.Resize( lNumSubsectors );
+	for ( int i = 0; i < lNumSubsectors; i++ )
 	{
-		do
+		ASTARGRAPHNODE_t	&Node = g_Nodes[i];
+		sector_t			*pSector = NULL;
+		double				fX = 0;
+		double				fY = 0;
+
+		for ( DWORD j = 0; j < pSubsectors[i].numlines; j++ )
 		{
-			lYIdx = g_RandomRoamSeed ( g_lNumVerticalNodes );
-		} while (( labs( lYNode - lYIdx ) > 8 ) || ( labs( lYNode - lYIdx ) < 2 ));
-	}
+			const seg_t *pSeg = &pSubsectors[i].firstline[j];
 
-	*pPos = ASTAR_GetPositionFromIndex( lXIdx, lYIdx );
-}
+			SegSubsectors[static_cast<int>( pSeg - pSegs )] = i;
+			fX += pSeg->v1->x;
+			fY += pSeg->v1->y;
+			if (( pSector == NULL ) && ( pSeg->sidedef != NULL ))
+				pSector = pSeg->sidedef->sector;
+		}
 
-//*****************************************************************************
-//*****************************************************************************
-//
-static bool astar_PathNextNode( ASTARPATH_t *pPath )
-{
-	ASTARNODE_t		*pNewNode;
-	LONG			lAddedCost;
+		if ( pSubsectors[i].numlines > 0 )
+		{
+			fX /= pSubsectors[i].numlines;
+			fY /= pSubsectors[i].numlines;
+		}
 
-	g_lNumSearchedNodes++;
-	pPath->ulNumSearchedNodes++;
+		Node.Position.x = static_cast<fixed_t>( fX );
+		Node.Position.y = static_cast<fixed_t>( fY );
+		if ( pSector == NULL )
+			pSector = R_PointInSubsector( Node.Position.x, Node.Position.y )->sector;
+		Node.Position.z = pSector->floorplane.ZatPoint( Node.Position.x, Node.Position.y );
+		Node.lSector = static_cast<LONG>( pSector - sectors );
+		Node.ulFirstEdge = 0;
+		Node.ulNumEdges = 0;
+		Node.lComponent = -1;
+	}
 
-	// First, determine the next step.
-	switch ( pPath->ulNextStep )
+	// An edge for each seg that can be walked across.
+	for ( int i = 0; i < lNumSubsectors; i++ )
 	{
-	case ASTAR_NS_PULLFROMOPENLIST:
+		ASTARGRAPHNODE_t	&Node = g_Nodes[i];
 
-		if ( astar_PullNodeFromOpenList( pPath ))
-			return ( true );
+		Node.ulFirstEdge = g_Edges.Size( );
+		for ( DWORD j = 0; j < pSubsectors[i].numlines; j++ )
+		{
+			const seg_t *pSeg = &pSubsectors[i].firstline[j];
+			const int lSeg = static_cast<int>( pSeg - pSegs );
+			LONG lToNode;
 
-		pPath->ulNextStep = ASTAR_NS_LOOKABOVE;
-		break;
-	case ASTAR_NS_LOOKABOVE:
+			if ( pSeg->linedef != NULL )
+			{
+				const line_t *pLine = &lines[LineIndices[static_cast<int>( pSeg->linedef - &Lines[0] )]];
 
-		pNewNode = astar_GetNode( pPath->pCurrentNode->lXNodeIdx, pPath->pCurrentNode->lYNodeIdx + 1 );
-		lAddedCost = 64;
+				if (( pLine->backsector == NULL ) || ( pSeg->backsector == NULL ))
+					continue;
+				if ( pLine->flags & ( ML_BLOCKING|ML_BLOCKEVERYTHING|ML_BLOCK_PLAYERS ))
+					continue;
+			}
 
-		astar_ProcessNextPathNode( pPath, pNewNode, lAddedCost, 0 );
+			// Find the subsector on the other side. Segs without a partner are
+			// probed just behind their middle.
+			const fixed_t MidX = pSeg->v1->x / 2 + pSeg->v2->x / 2;
+			const fixed_t MidY = pSeg->v1->y / 2 + pSeg->v2->y / 2;
+			if ( pSegExtras[lSeg].PartnerSeg < static_cast<DWORD>( lNumSegs ))
+			{
+				lToNode = SegSubsectors[pSegExtras[lSeg].PartnerSeg];
+			}
+			else
+			{
+				const double fDX = static_cast<double>( pSeg->v2->x - pSeg->v1->x );
+				const double fDY = static_cast<double>( pSeg->v2->y - pSeg->v1->y );
+				const double fLength = sqrt( fDX * fDX + fDY * fDY );
+				if ( fLength < 1 )
+					continue;
 
-		pPath->ulNextStep = ASTAR_NS_LOOKABOVEFORWARD;
-		break;
-	case ASTAR_NS_LOOKABOVEFORWARD:
+				lToNode = astar_GetNodeFromPoint( MidX - static_cast<fixed_t>( fDY / fLength * FRACUNIT ), MidY + static_cast<fixed_t>( fDX / fLength * FRACUNIT ));
+			}
 
-		pNewNode = astar_GetNode( pPath->pCurrentNode->lXNodeIdx + 1, pPath->pCurrentNode->lYNodeIdx + 1 );
-		lAddedCost = 91;
+			if (( lToNode < 0 ) || ( lToNode == i ))
+				continue;
+
+			sector_t *pFrom = &sectors[Node.lSector];
+			sector_t *pTo = &sectors[g_Nodes[lToNode].lSector];
+			const fixed_t FromFloor = pFrom->floorplane.ZatPoint( MidX, MidY );
+			const fixed_t ToFloor = pTo->floorplane.ZatPoint( MidX, MidY );
+			const fixed_t Opening = MIN( pFrom->ceilingplane.ZatPoint( MidX, MidY ), pTo->ceilingplane.ZatPoint( MidX, MidY )) - MAX( FromFloor, ToFloor );
+
+			ASTAREDGE_t	Edge;
+			Edge.lFromNode = i;
+			Edge.lToNode = lToNode;
+			Edge.Crossing.x = MidX;
+			Edge.Crossing.y = MidY;
+			Edge.Crossing.z = ToFloor;
+			Edge.ulFlags = 0;
+			Edge.lBlockedUntil = 0;
+			Edge.lCost = 1
+				+ P_AproxDistance( MidX - Node.Position.x, MidY - Node.Position.y ) / FRACUNIT
+				+ P_AproxDistance( g_Nodes[lToNode].Position.x - MidX, g_Nodes[lToNode].Position.y - MidY ) / FRACUNIT;
+
+			// Closed doors can be opened.
+			if ( Opening < ASTAR_PLAYER_HEIGHT )
+			{
+				if ( astar_IsDoorSector( pTo ) == false )
+					continue;
 
-		astar_ProcessNextPathNode( pPath, pNewNode, lAddedCost, 1 );
+				Edge.ulFlags |= ASTAREDGE_DOOR;
+				Edge.lCost += ASTAR_DOOR_COST;
+			}
 
-		pPath->ulNextStep = ASTAR_NS_LOOKFORWARD;
-		break;
-	case ASTAR_NS_LOOKFORWARD:
+			if ( ToFloor - FromFloor > ASTAR_MAX_JUMP )
+				continue;
+			if ( ToFloor - FromFloor > ASTAR_STEP_HEIGHT )
+			{
+				Edge.ulFlags |= ASTAREDGE_JUMP;
+				Edge.lCost += ASTAR_JUMP_COST;
+			}
 
-		pNewNode = astar_GetNode( pPath->pCurrentNode->lXNodeIdx + 1, pPath->pCurrentNode->lYNodeIdx );
-		lAddedCost = 64;
+			// If this sector is a damaging sector, make it more costly to go through here.
+			if ( astar_GetDamageCost( pTo ) > 0 )
+			{
+				Edge.ulFlags |= ASTAREDGE_DAMAGING;
+				Edge.lCost += astar_GetDamageCost( pTo );
+			}
 
-		astar_ProcessNextPathNode( pPath, pNewNode, lAddedCost, 2 );
+			g_Edges.Push( Edge );
+		}
+		Node.ulNumEdges = g_Edges.Size( ) - Node.ulFirstEdge;
+	}
 
-		pPath->ulNextStep = ASTAR_NS_LOOKBELOWFORWARD;
-		break;
-	case ASTAR_NS_LOOKBELOWFORWARD:
+	delete[] pNodes;
+	delete[] pSegs;
+	delete[] pSegExtras;
+	delete[] pSubsectors;
+	delete[] pVertices;
 
-		pNewNode = astar_GetNode( pPath->pCurrentNode->lXNodeIdx + 1, pPath->pCurrentNode->lYNodeIdx - 1 );
-		lAddedCost = 91;
+	return ( g_Nodes.Size( ) > 0 );
+}
 
-		astar_ProcessNextPathNode( pPath, pNewNode, lAddedCost, 3 );
+//*****************************************************************************
+//
+// Sets up everything that is derived from the graph: the components, and the
+// sector level of the graph used by the hierarchical search.
+//
+static void astar_BuildSectorGraph( void )
+{
+	TArray<LONG>	Stack;
+	LONG			lNumComponents = 0;
+
+	// Components, treating the edges as two-way. Bots only need this to not pick
+	// roam locations they can't possibly get to.
+	TArray<ULONG>	ulIncomingStart;
+	TArray<LONG>	lIncoming;
+	ulIncomingStart.Resize( g_Nodes.Size( ) + 1 );
+	memset( &ulIncomingStart[0], 0, ulIncomingStart.Size( ) * sizeof( ULONG ));
+	for ( ULONG ulIdx = 0; ulIdx < g_Edges.Size( ); ulIdx++ )
+		ulIncomingStart[g_Edges[ulIdx].lToNode + 1]++;
+	for ( ULONG ulIdx = 0; ulIdx < g_Nodes.Size( ); ulIdx++ )
+		ulIncomingStart[ulIdx + 1] += ulIncomingStart[ulIdx];
+	lIncoming.Resize( g_Edges.Size( ));
+	{
+		TArray<ULONG>	ulFill( g_Nodes.Size( ));
+		for ( ULONG ulIdx = 0; ulIdx < g_Nodes.Size( ); ulIdx++ )
+			ulFill.Push( ulIncomingStart[ulIdx] );
+		for ( ULONG ulIdx = 0; ulIdx < g_Edges.Size( ); ulIdx++ )
+			lIncoming[ulFill[g_Edges[ulIdx].lToNode]++] = g_Edges[ulIdx].lFromNode;
+	}
 
-		pPath->ulNextStep = ASTAR_NS_LOOKBELOW;
-		break;
-	case ASTAR_NS_LOOKBELOW:
+	for ( ULONG ulIdx = 0; ulIdx < g_Nodes.Size( ); ulIdx++ )
+		g_Nodes[ulIdx].lComponent = -1;
 
-		pNewNode = astar_GetNode( pPath->pCurrentNode->lXNodeIdx, pPath->pCurrentNode->lYNodeIdx - 1 );
-		lAddedCost = 64;
+	for ( ULONG ulIdx = 0; ulIdx < g_Nodes.Size( ); ulIdx++ )
+	{
+		if ( g_Nodes[ulIdx].lComponent >= 0 )
+			continue;
 
-		astar_ProcessNextPathNode( pPath, pNewNode, lAddedCost, 4 );
+		g_Nodes[ulIdx].lComponent = lNumComponents;
+		Stack.Push( ulIdx );
+		LONG lNode;
+		while ( Stack.Pop( lNode ))
+		{
+			const ASTARGRAPHNODE_t &Node = g_Nodes[lNode];
+			for ( ULONG ulEdge = Node.ulFirstEdge; ulEdge < Node.ulFirstEdge + Node.ulNumEdges; ulEdge++ )
+			{
+				const LONG lTo = g_Edges[ulEdge].lToNode;
+				if ( g_Nodes[lTo].lComponent < 0 )
+				{
+					g_Nodes[lTo].lComponent = lNumComponents;
+					Stack.Push( lTo );
+				}
+			}
+			for ( ULONG ulIn = ulIncomingStart[lNode]; ulIn < ulIncomingStart[lNode + 1]; ulIn++ )
+			{
+				const LONG lFrom = lIncoming[ulIn];
+				if ( g_Nodes[lFrom].lComponent < 0 )
+				{
+					g_Nodes[lFrom].lComponent = lNumComponents;
+					Stack.Push( lFrom );
+				}
+			}
+		}
+		lNumComponents++;
+	}
 
-		pPath->ulNextStep = ASTAR_NS_LOOKBELOWBACK;
-		break;
-	case ASTAR_NS_LOOKBELOWBACK:
+	// The center of each sector is the average of the centers of its subsectors.
+	TArray<double>	fSums;
+	TArray<LONG>	lCounts;
+	fSums.Resize( numsectors * 2 );
+	lCounts.Resize( numsectors );
+	g_SectorCenters.Resize( numsectors );
+	for ( int i = 0; i < numsectors; i++ )
+	{
+		fSums[i * 2] = fSums[i * 2 + 1] = 0;
+		lCounts[i] = 0;
+	}
+	for ( ULONG ulIdx = 0; ulIdx < g_Nodes.Size( ); ulIdx++ )
+	{
+		const LONG lSector = g_Nodes[ulIdx].lSector;
+		fSums[lSector * 2] += g_Nodes[ulIdx].Position.x;
+		fSums[lSector * 2 + 1] += g_Nodes[ulIdx].Position.y;
+		lCounts[lSector]++;
+	}
+	for ( int i = 0; i < numsectors; i++ )
+	{
+		g_SectorCenters[i].x = lCounts[i] ? static_cast<fixed_t>( fSums[i * 2] / lCounts[i] ) : 0;
+		g_SectorCenters[i].y = lCounts[i] ? static_cast<fixed_t>( fSums[i * 2 + 1] / lCounts[i] ) : 0;
+		g_SectorCenters[i].z = 0;
+	}
 
-		pNewNode = astar_GetNode( pPath->pCurrentNode->lXNodeIdx - 1, pPath->pCurrentNode->lYNodeIdx - 1 );
-		lAddedCost = 91;
+	// Two sectors are connected if any edge leads from one into the other.
+	TArray<QWORD>	Pairs;
+	for ( ULONG ulIdx = 0; ulIdx < g_Edges.Size( ); ulIdx++ )
+	{
+		const LONG lFrom = g_Nodes[g_Edges[ulIdx].lFromNode].lSector;
+		const LONG lTo = g_Nodes[g_Edges[ulIdx].lToNode].lSector;
+		if ( lFrom != lTo )
+			Pairs.Push(( static_cast<QWORD>( lFrom ) << 32 ) | static_cast<DWORD>( lTo ));
+	}
+	if ( Pairs.Size( ) > 0 )
+		std::sort( &Pairs[0], &Pairs[0] + Pairs.Size( ));
 
-		astar_ProcessNextPathNode( pPath, pNewNode, lAddedCost, 5 );
+	g_ulSectorEdgeStart.Resize( numsectors + 1 );
+	memset( &g_ulSectorEdgeStart[0], 0, ( numsectors + 1 ) * sizeof( ULONG ));
+	g_lSectorEdges.Clear( );
+	for ( ULONG ulIdx = 0; ulIdx < Pairs.Size( ); ulIdx++ )
+	{
+		if (( ulIdx > 0 ) && ( Pairs[ulIdx] == Pairs[ulIdx - 1] ))
+			continue;
 
-		pPath->ulNextStep = ASTAR_NS_LOOKBACK;
-		break;
-	case ASTAR_NS_LOOKBACK:
+		g_ulSectorEdgeStart[static_cast<LONG>( Pairs[ulIdx] >> 32 ) + 1]++;
+		g_lSectorEdges.Push( static_cast<LONG>( Pairs[ulIdx] & 0xFFFFFFFF ));
+	}
+	for ( int i = 0; i < numsectors; i++ )
+		g_ulSectorEdgeStart[i + 1] += g_ulSectorEdgeStart[i];
+}
 
-		pNewNode = astar_GetNode( pPath->pCurrentNode->lXNodeIdx - 1, pPath->pCurrentNode->lYNodeIdx );
-		lAddedCost = 64;
+//*****************************************************************************
+//
+static FString astar_CacheName( const BYTE abChecksum[16], bool bCreate )
+{
+	FString path = M_GetCachePath( bCreate );
+	path += "/botnav";
+	if ( bCreate )
+		CreatePath( path );
+
+	path += '/';
+	for ( int i = 0; i < 16; i++ )
+		path.AppendFormat( "%02x", abChecksum[i] );
+	path += ".nav";
+	return path;
+}
 
-		astar_ProcessNextPathNode( pPath, pNewNode, lAddedCost, 6 );
+//*****************************************************************************
+//
+static void astar_WriteLong( TArray<BYTE> &Data, LONG lValue )
+{
+	const DWORD dwValue = LittleLong( static_cast<DWORD>( lValue ));
+	const BYTE *pbValue = reinterpret_cast<const BYTE *>( &dwValue );
+	for ( int i = 0; i < 4; i++ )
+		Data.Push( pbValue[i] );
+}
 
-		pPath->ulNextStep = ASTAR_NS_LOOKABOVEBACK;
-		break;
-	case ASTAR_NS_LOOKABOVEBACK:
+//*****************************************************************************
+//
+static LONG astar_ReadLong( const BYTE *&pbData )
+{
+	DWORD dwValue;
+	memcpy( &dwValue, pbData, 4 );
+	pbData += 4;
+	return ( static_cast<LONG>( LittleLong( dwValue )));
+}
 
-		pNewNode = astar_GetNode( pPath->pCurrentNode->lXNodeIdx - 1, pPath->pCurrentNode->lYNodeIdx - 1 );
-		lAddedCost = 91;
+//*****************************************************************************
+//
+static bool astar_LoadCache( const BYTE abChecksum[16] )
+{
+	FString path = astar_CacheName( abChecksum, false );
+	FILE *pFile = fopen( path, "rb" );
+	if ( pFile == NULL )
+		return ( false );
+
+	BYTE abHeader[ASTAR_CACHE_HEADER_SIZE];
+	TArray<BYTE> Data;
+	bool bRead = ( fread( abHeader, 1, ASTAR_CACHE_HEADER_SIZE, pFile ) == ASTAR_CACHE_HEADER_SIZE );
+	if ( bRead )
+	{
+		BYTE abBuffer[4096];
+		size_t Count;
+		while (( Count = fread( abBuffer, 1, sizeof( abBuffer ), pFile )) > 0 )
+		{
+			const unsigned int ulPos = Data.Reserve( static_cast<unsigned int>( Count ));
+			memcpy( &Data[ulPos], abBuffer, Count );
+		}
+	}
+	fclose( pFile );
+
+	if (( bRead == false ) || memcmp( abHeader, "NAV1", 4 ) || ( Data.Size( ) < 12 ))
+		return ( false );
+
+	const BYTE *pbHeader = abHeader + 4;
+	if (( astar_ReadLong( pbHeader ) != numsectors ) || ( astar_ReadLong( pbHeader ) != numlines ) || memcmp( abHeader + 12, abChecksum, 16 ))
+		return ( false );
+
+	BYTE abDataChecksum[16];
+	MD5Context md5;
+	md5.Update( &Data[0], Data.Size( ));
+	md5.Final( abDataChecksum );
+	if ( memcmp( abHeader + 28, abDataChecksum, 16 ))
+		return ( false );
+
+	const BYTE *pbData = &Data[0];
+	const LONG lNumNodes = astar_ReadLong( pbData );
+	const LONG lNumEdges = astar_ReadLong( pbData );
+	const LONG lNumBSP = astar_ReadLong( pbData );
+	if (( lNumNodes <= 0 ) || ( lNumEdges < 0 ) || ( lNumBSP < 0 ) ||
+		( Data.Size( ) != 12 + 4 * ( 6 * static_cast<QWORD>( lNumNodes ) + 7 * static_cast<QWORD>( lNumEdges ) + 6 * static_cast<QWORD>( lNumBSP ))))
+	{
+		return ( false );
+	}
 
-		astar_ProcessNextPathNode( pPath, pNewNode, lAddedCost, 7 );
+	// Everything is range checked, so that a bad file can't crash the game.
+	g_Nodes.Resize( lNumNodes );
+	for ( LONG i = 0; i < lNumNodes; i++ )
+	{
+		ASTARGRAPHNODE_t &Node = g_Nodes[i];
+		Node.Position.x = astar_ReadLong( pbData );
+		Node.Position.y = astar_ReadLong( pbData );
+		Node.Position.z = astar_ReadLong( pbData );
+		Node.lSector = astar_ReadLong( pbData );
+		Node.ulFirstEdge = astar_ReadLong( pbData );
+		Node.ulNumEdges = astar_ReadLong( pbData );
+		Node.lComponent = -1;
+		if (( Node.lSector < 0 ) || ( Node.lSector >= numsectors ) || ( Node.ulFirstEdge > static_cast<ULONG>( lNumEdges )) || ( Node.ulNumEdges > static_cast<ULONG>( lNumEdges ) - Node.ulFirstEdge ))
+		{
+			g_Nodes.Clear( );
+			return ( false );
+		}
+	}
 
-		// Now that we've checked all the adjacent nodes, add the parent node to the closed list.
-		if ( pPath->pCurrentNode->bOnClosed[g_lCurrentPathIdx] == false )
+	g_Edges.Resize( lNumEdges );
+	for ( LONG i = 0; i < lNumEdges; i++ )
+	{
+		ASTAREDGE_t &Edge = g_Edges[i];
+		Edge.lFromNode = astar_ReadLong( pbData );
+		Edge.lToNode = astar_ReadLong( pbData );
+		Edge.Crossing.x = astar_ReadLong( pbData );
+		Edge.Crossing.y = astar_ReadLong( pbData );
+		Edge.Crossing.z = astar_ReadLong( pbData );
+		Edge.lCost = astar_ReadLong( pbData );
+		Edge.ulFlags = astar_ReadLong( pbData );
+		Edge.lBlockedUntil = 0;
+		if (( Edge.lFromNode < 0 ) || ( Edge.lFromNode >= lNumNodes ) || ( Edge.lToNode < 0 ) || ( Edge.lToNode >= lNumNodes ) || ( Edge.lCost <= 0 ))
 		{
-			pPath->pCurrentNode->bOnClosed[g_lCurrentPathIdx] = true;
+			g_Nodes.Clear( );
+			g_Edges.Clear( );
+			return ( false );
+		}
+	}
 
-			if ( botdebug_shownodes )
+	g_BSP.Resize( lNumBSP );
+	for ( LONG i = 0; i < lNumBSP; i++ )
+	{
+		ASTARBSPNODE_t &BSPNode = g_BSP[i];
+		BSPNode.x = astar_ReadLong( pbData );
+		BSPNode.y = astar_ReadLong( pbData );
+		BSPNode.dx = astar_ReadLong( pbData );
+		BSPNode.dy = astar_ReadLong( pbData );
+		for ( int j = 0; j < 2; j++ )
+		{
+			// Children always come before their parents.
+			BSPNode.alChildren[j] = astar_ReadLong( pbData );
+			if (( BSPNode.alChildren[j] >= i ) || ( ~BSPNode.alChildren[j] >= lNumNodes ))
 			{
-				if ( pPath->paVisualizations[( pPath->pCurrentNode->lXNodeIdx * g_lNumVerticalNodes ) + pPath->pCurrentNode->lYNodeIdx] == NULL )
-					pPath->paVisualizations[( pPath->pCurrentNode->lXNodeIdx * g_lNumVerticalNodes ) + pPath->pCurrentNode->lYNodeIdx] = Spawn( PClass::FindClass( "PathNode" ), pPath->pCurrentNode->Position.x, pPath->pCurrentNode->Position.y, ONFLOORZ, NO_REPLACE );
-
-				AActor * pPathNode = pPath->paVisualizations[( pPath->pCurrentNode->lXNodeIdx * g_lNumVerticalNodes ) + pPath->pCurrentNode->lYNodeIdx];
-				pPathNode->SetState( pPathNode->SpawnState + ASTAR_FRAME_INCLOSED );
+				g_Nodes.Clear( );
+				g_Edges.Clear( );
+				g_BSP.Clear( );
+				return ( false );
 			}
 		}
-
-
-		pPath->ulNextStep = ASTAR_NS_PULLFROMOPENLIST;
-		break;
 	}
 
-	// We haven't finished creating the path, so return false.
-	return ( false );
+	return ( true );
 }
 
 //*****************************************************************************
 //
-static ASTARNODE_t *astar_GetNodeFromPoint( POS_t Point )
+// Like the node cache, the file is written under a temporary name and then
+// renamed, so that an incomplete file is never picked up.
+//
+static void astar_SaveCache( const BYTE abChecksum[16] )
 {
-	LONG	lXNode;
-	LONG	lYNode;
+	TArray<BYTE> Data;
 
-//	lXNode = ( Point.x - g_lMapXMin ) >> ASTAR_NODE_SHIFT;
-//	lYNode = ( Point.y - g_lMapYMin ) >> ASTAR_NODE_SHIFT;
-	lXNode = ( Point.x >> ASTAR_NODE_SHIFT ) - ( g_lMapXMin >> ASTAR_NODE_SHIFT );
-	lYNode = ( Point.y >> ASTAR_NODE_SHIFT ) - ( g_lMapYMin >> ASTAR_NODE_SHIFT );
+	astar_WriteLong( Data, g_Nodes.Size( ));
+	astar_WriteLong( Data, g_Edges.Size( ));
+	astar_WriteLong( Data, g_BSP.Size( ));
+	for ( ULONG ulIdx = 0; ulIdx < g_Nodes.Size( ); ulIdx++ )
+	{
+		const ASTARGRAPHNODE_t &Node = g_Nodes[ulIdx];
+		astar_WriteLong( Data, Node.Position.x );
+		astar_WriteLong( Data, Node.Position.y );
+		astar_WriteLong( Data, Node.Position.z );
+		astar_WriteLong( Data, Node.lSector );
+		astar_WriteLong( Data, Node.ulFirstEdge );
+		astar_WriteLong( Data, Node.ulNumEdges );
+	}
+	for ( ULONG ulIdx = 0; ulIdx < g_Edges.Size( ); ulIdx++ )
+	{
+		const ASTAREDGE_t &Edge = g_Edges[ulIdx];
+		astar_WriteLong( Data, Edge.lFromNode );
+		astar_WriteLong( Data, Edge.lToNode );
+		astar_WriteLong( Data, Edge.Crossing.x );
+		astar_WriteLong( Data, Edge.Crossing.y );
+		astar_WriteLong( Data, Edge.Crossing.z );
+		astar_WriteLong( Data, Edge.lCost );
+		astar_WriteLong( Data, Edge.ulFlags );
+	}
+	for ( ULONG ulIdx = 0; ulIdx < g_BSP.Size( ); ulIdx++ )
+	{
+		const ASTARBSPNODE_t &BSPNode = g_BSP[ulIdx];
+		astar_WriteLong( Data, BSPNode.x );
+		astar_WriteLong( Data, BSPNode.y );
+		astar_WriteLong( Data, BSPNode.dx );
+		astar_WriteLong( Data, BSPNode.dy );
+		astar_WriteLong( Data, BSPNode.alChildren[0] );
+		astar_WriteLong( Data, BSPNode.alChildren[1] );
+	}
+
+	TArray<BYTE> Header;
+	Header.Push( 'N' );
+	Header.Push( 'A' );
+	Header.Push( 'V' );
+	Header.Push( '1' );
+	astar_WriteLong( Header, numsectors );
+	astar_WriteLong( Header, numlines );
+	for ( int i = 0; i < 16; i++ )
+		Header.Push( abChecksum[i] );
+
+	BYTE abDataChecksum[16];
+	MD5Context md5;
+	md5.Update( &Data[0], Data.Size( ));
+	md5.Final( abDataChecksum );
+	for ( int i = 0; i < 16; i++ )
+		Header.Push( abDataChecksum[i] );
+
+	FString path = astar_CacheName( abChecksum, true );
+	FString temppath;
+	temppath.Format( "%s.%d.tmp", path.GetChars( ), static_cast<int>( getpid( )));
+
+	FILE *pFile = fopen( temppath, "wb" );
+	if ( pFile == NULL )
+		return;
 
-	if (( lXNode >= g_lNumHorizontalNodes ) || ( lXNode < 0 ) ||
-		( lYNode >= g_lNumVerticalNodes ) || ( lYNode < 0 ))
+	const bool bWritten = ( fwrite( &Header[0], 1, Header.Size( ), pFile ) == Header.Size( ))
+		&& ( fwrite( &Data[0], 1, Data.Size( ), pFile ) == Data.Size( ));
+
+	if (( fclose( pFile ) != 0 ) || ( bWritten == false ))
 	{
-		return ( NULL );
+		remove( temppath );
+		return;
 	}
 
-	return ( astar_GetNode( lXNode, lYNode ));
+#ifdef _WIN32
+	remove( path );
+#endif
+	if ( rename( temppath, path ) != 0 )
+		remove( temppath );
 }
 
 //*****************************************************************************
 //
-static LONG astar_GetCostToGoalEstimate( ASTARPATH_t *pPath, ASTARNODE_t *pNode )
+static LONG astar_GetNodeFromPoint( fixed_t X, fixed_t Y )
 {
-	return ( P_AproxDistance( pNode->Position.x - pPath->pGoalNode->Position.x, pNode->Position.y - pPath->pGoalNode->Position.y ) / FRACUNIT );
-/*
-	POS_t	PosGoal;
-	POS_t	PosNode;
-
-	PosNode = ASTAR_GetPosition( pNode );
-	PosGoal = ASTAR_GetPosition( pPath->pGoalNode );
+	// A single subsector is a special case.
+	if ( g_BSP.Size( ) == 0 )
+		return ( g_Nodes.Size( ) > 0 ? 0 : -1 );
 
-	return ( P_AproxDistance( PosNode.x - PosGoal.x, PosNode.y - PosGoal.y ));
-
-//	return (( labs( pPath->pGoalNode->lXNodeIdx - pNode->lXNodeIdx ) + ( labs( pPath->pGoalNode->lYNodeIdx - pNode->lYNodeIdx ))) * 64 );
+	LONG lIdx = g_BSP.Size( ) - 1;
+	do
+	{
+		const ASTARBSPNODE_t &BSPNode = g_BSP[lIdx];
+		lIdx = BSPNode.alChildren[DMulScale32( Y - BSPNode.y, BSPNode.dx, BSPNode.x - X, BSPNode.dy ) > 0];
+	} while ( lIdx >= 0 );
 
-	LONG	lXDiff;
-	LONG	lYDiff;
+	return ( ~lIdx );
+}
 
-	lXDiff = (( pPath->pGoalNode->lXNodeIdx - pNode->lXNodeIdx ) * 64 ) * (( pPath->pGoalNode->lXNodeIdx - pNode->lXNodeIdx ) * 64 );
-	lYDiff = (( pPath->pGoalNode->lYNodeIdx - pNode->lYNodeIdx ) * 64 ) * (( pPath->pGoalNode->lYNodeIdx - pNode->lYNodeIdx ) * 64 );
+//*****************************************************************************
+//
+static LONG astar_GetDamageCost( sector_t *pSector )
+{
+	switch ( pSector->special )
+	{
+	case dDamage_Hellslime:
 
-//	lXDiff *= lXDiff;
-//	lYDiff *= lYDiff;
+		return ( 32 );
+	case dDamage_SuperHellslime:
+	case dLight_Strobe_Hurt:
 
-	// Fixme: THIS IS EXTREMELY EXPENSIVE! Revise.
-	return ( (LONG)sqrt( lXDiff + lYDiff ));
+		return ( 64 );
+	case dDamage_Nukage:
+	case dDamage_LavaWimpy:
+	case dScroll_EastLavaDamage:
 
-	return ( (LONG)sqrt(((( pPath->pGoalNode->lXNodeIdx - pNode->lXNodeIdx ) * 64 ) ^ 2 ) + ((( pPath->pGoalNode->lYNodeIdx - pNode->lYNodeIdx ) * 64 ) ^ 2 )));
+		return ( 16 );
+	case dDamage_LavaHefty:
 
-//	return (( labs( pPath->pGoalNode->lXNodeIdx - pNode->lXNodeIdx ) + labs( pPath->pGoalNode->lYNodeIdx - pNode->lYNodeIdx )) * 15 );
+		return ( 24 );
+	default:
 
-	return (( labs( pPath->pGoalNode->lXNodeIdx - pNode->lXNodeIdx ) * labs( pPath->pGoalNode->lXNodeIdx - pNode->lXNodeIdx )) + 
-			( labs( pPath->pGoalNode->lYNodeIdx - pNode->lYNodeIdx ) * labs( pPath->pGoalNode->lYNodeIdx - pNode->lYNodeIdx )));
-*/
+		return ( 0 );
+	}
 }
 
 //*****************************************************************************
 //
-static void astar_PushNodeToStack( ASTARNODE_t *pNode, ASTARPATH_t *pPath )
+// Same test as BOTPATH_TryWalk: a sector that is too low to walk into is
+// considered a door if one of its lines opens it.
+//
+static bool astar_IsDoorSector( sector_t *pSector )
 {
-	if ( pPath->lStackPos == MAX_NODES_IN_PATH )
-		I_Error( "astar_PushNodeToStack: Number of nodes in path exceeded!" );
+	for ( LONG lIdx = 0; lIdx < pSector->linecount; lIdx++ )
+	{
+		if (( pSector->lines[lIdx]->special == Door_Open ) || ( pSector->lines[lIdx]->special == Door_Raise ))
+			return ( true );
+	}
 
-	pPath->pNodeStack[pPath->lStackPos++] = pNode;
+	return ( false );
 }
 
 //*****************************************************************************
 //
-static bool astar_PullNodeFromOpenList( ASTARPATH_t *pPath )
+static LONG astar_GetCostToGoalEstimate( const POS_t &From, const POS_t &Goal )
 {
-	// If there aren't any nodes left in the open list, we're done.
-	if ( astar_IsPriorityQueueEmpty( ))
-	{
-		pPath->ulFlags |= PF_COMPLETE;
-		return ( true );
-	}
+	return ( P_AproxDistance( From.x - Goal.x, From.y - Goal.y ) / FRACUNIT );
+}
 
-	// Get the lowest cost node from the open stack.
-	pPath->pCurrentNode = astar_PopFromPriorityQueue( );
-	pPath->pCurrentNode->bOnOpen[g_lCurrentPathIdx] = false;
+//*****************************************************************************
+//
+static void astar_HeapPush( LONG lTotalCost, LONG lIdx )
+{
+	ULONG ulPosition = g_Heap.Reserve( 1 );
 
-	if ( botdebug_shownodes )
+	while ( ulPosition > 0 )
 	{
-		if ( pPath->paVisualizations[( pPath->pCurrentNode->lXNodeIdx * g_lNumVerticalNodes ) + pPath->pCurrentNode->lYNodeIdx] == NULL )
-			pPath->paVisualizations[( pPath->pCurrentNode->lXNodeIdx * g_lNumVerticalNodes ) + pPath->pCurrentNode->lYNodeIdx] = Spawn( PClass::FindClass( "PathNode" ), pPath->pCurrentNode->Position.x, pPath->pCurrentNode->Position.y, ONFLOORZ, NO_REPLACE );
+		const ULONG ulParent = ( ulPosition - 1 ) / 2;
+		if ( g_Heap[ulParent].lTotalCost <= lTotalCost )
+			break;
 
-		AActor * pPathNode = pPath->paVisualizations[( pPath->pCurrentNode->lXNodeIdx * g_lNumVerticalNodes ) + pPath->pCurrentNode->lYNodeIdx];
-		pPathNode->SetState( pPathNode->SpawnState + ASTAR_FRAME_OFFOPEN );
+		g_Heap[ulPosition] = g_Heap[ulParent];
+		ulPosition = ulParent;
 	}
 
-	// If this node is the goal node, we've found the goal node. Now we can construct a path
-	// back to the goal node.
-	if ( pPath->pCurrentNode == pPath->pGoalNode )
-	{
-		ASTARNODE_t	*pNextNode;
-		bool		bPushNextNode = true;
+	g_Heap[ulPosition].lTotalCost = lTotalCost;
+	g_Heap[ulPosition].lIdx = lIdx;
+}
 
-		// Construct path.
-		pNextNode = pPath->pGoalNode;
-		while ( pNextNode->pParent[g_lCurrentPathIdx] && pNextNode->pParent[g_lCurrentPathIdx]->pParent[g_lCurrentPathIdx] )
-		{
-			if (( bPushNextNode ) || ( pNextNode->lDirection[g_lCurrentPathIdx] != pNextNode->pParent[g_lCurrentPathIdx]->lDirection[g_lCurrentPathIdx] ))
-			{
-				astar_PushNodeToStack( pNextNode, pPath );
+//*****************************************************************************
+//
+static bool astar_HeapPop( LONG &lIdx )
+{
+	if ( g_Heap.Size( ) == 0 )
+		return ( false );
 
-				if ( botdebug_shownodes )
-				{
-					if ( pPath->paVisualizations[( pNextNode->lXNodeIdx * g_lNumVerticalNodes ) + pNextNode->lYNodeIdx] == NULL )
-						pPath->paVisualizations[( pNextNode->lXNodeIdx * g_lNumVerticalNodes ) + pNextNode->lYNodeIdx] = Spawn( PClass::FindClass( "PathNode" ), pNextNode->Position.x, pNextNode->Position.y, ONFLOORZ, NO_REPLACE );
+	lIdx = g_Heap[0].lIdx;
 
-					AActor * pPathNode = pPath->paVisualizations[( pNextNode->lXNodeIdx * g_lNumVerticalNodes ) + pNextNode->lYNodeIdx];
-					pPathNode ->SetState( pPathNode->SpawnState + ASTAR_FRAME_ONPATH );
-				}
-			}
+	ASTARHEAPENTRY_t Last;
+	g_Heap.Pop( Last );
 
-			if (( pNextNode == pPath->pGoalNode ) || ( pNextNode->lDirection[g_lCurrentPathIdx] != pNextNode->pParent[g_lCurrentPathIdx]->lDirection[g_lCurrentPathIdx] ))
-				bPushNextNode = true;
-			else
-				bPushNextNode = false;
+	const ULONG ulSize = g_Heap.Size( );
+	if ( ulSize == 0 )
+		return ( true );
 
-			pNextNode = pNextNode->pParent[g_lCurrentPathIdx];
-		}
+	ULONG ulPosition = 0;
+	while ( ulPosition * 2 + 1 < ulSize )
+	{
+		ULONG ulChild = ulPosition * 2 + 1;
+		if (( ulChild + 1 < ulSize ) && ( g_Heap[ulChild + 1].lTotalCost < g_Heap[ulChild].lTotalCost ))
+			ulChild++;
+		if ( Last.lTotalCost <= g_Heap[ulChild].lTotalCost )
+			break;
 
-		// If there's 1 or less nodes in the path, just push the goal node.
-		if ( pPath->lStackPos == 0 )
-			astar_PushNodeToStack( pPath->pGoalNode, pPath );
-		else if ( pPath->lStackPos > 1 )
+		g_Heap[ulPosition] = g_Heap[ulChild];
+		ulPosition = ulChild;
+	}
+	g_Heap[ulPosition] = Last;
+	return ( true );
+}
+
+//*****************************************************************************
+//
+static ULONG astar_NextSearchStamp( void )
+{
+	// When the stamps wrap around, old stamps could match again.
+	if ( ++g_ulSearchStamp == 0 )
+	{
+		if ( g_Nodes.Size( ) > 0 )
 		{
-			ASTARNODE_t		*pNode;
-			ASTARNODE_t		*pNecessaryNodeList[MAX_NODES_IN_PATH];
-			LONG			lListPos;
-			LONG			lStackPos;
-			POS_t			GoalPos;
-			POS_t			NodePos;
-
-			lListPos = 0;
-			lStackPos = 1;
-			pNode = pPath->pNodeStack[pPath->lStackPos - lStackPos];
-			GoalPos = ASTAR_GetPositionFromIndex( pPath->pGoalNode->lXNodeIdx, pPath->pGoalNode->lYNodeIdx );
-			while (( pNode != pPath->pGoalNode ) && ( pNode != pPath->pGoalNode->pParent[g_lCurrentPathIdx] ))
-			{
-				NodePos = ASTAR_GetPositionFromIndex( pNode->lXNodeIdx, pNode->lYNodeIdx );
-				pNecessaryNodeList[lListPos++] = pNode;
+			memset( &g_ulOpenStamp[0], 0, g_Nodes.Size( ) * sizeof( ULONG ));
+			memset( &g_ulClosedStamp[0], 0, g_Nodes.Size( ) * sizeof( ULONG ));
+		}
+		if ( numsectors > 0 )
+		{
+			memset( &g_ulSectorOpenStamp[0], 0, numsectors * sizeof( ULONG ));
+			memset( &g_ulSectorClosedStamp[0], 0, numsectors * sizeof( ULONG ));
+			memset( &g_ulCorridorStamp[0], 0, numsectors * sizeof( ULONG ));
+		}
+		g_ulSearchStamp = 1;
+	}
 
-				if ( BOTPATH_TryWalk( pPath->pActor, NodePos.x, NodePos.y, pPath->pActor->z, GoalPos.x, GoalPos.y ) & (BOTPATH_OBSTRUCTED|BOTPATH_DAMAGINGSECTOR) )
-				{
-					lStackPos++;
-					pNode = pPath->pNodeStack[pPath->lStackPos - lStackPos];
-				}
-				else
-				{
-					ULONG	ulIdx;
+	return ( g_ulSearchStamp );
+}
 
-					for ( ulIdx = 0; ulIdx < MAX_NODES_IN_PATH; ulIdx++ )
-						pPath->pNodeStack[ulIdx] = NULL;
+//*****************************************************************************
+//
+// First level of the search: finds a route over the sectors, and marks the
+// sectors along it and next to it as the corridor the second level searches in.
+// Returns false if the goal's sector can't be reached at all.
+//
+static bool astar_MarkCorridor( LONG lStartSector, LONG lGoalSector )
+{
+	const ULONG ulStamp = astar_NextSearchStamp( );
+	LONG lSector;
 
-					pPath->lStackPos = 0;
-					astar_PushNodeToStack( pPath->pGoalNode, pPath );
+	g_Heap.Clear( );
+	g_lSectorCost[lStartSector] = 0;
+	g_lSectorParent[lStartSector] = -1;
+	g_ulSectorOpenStamp[lStartSector] = ulStamp;
+	astar_HeapPush( astar_GetCostToGoalEstimate( g_SectorCenters[lStartSector], g_SectorCenters[lGoalSector] ), lStartSector );
 
-					for ( ulIdx = 0; ulIdx < (ULONG)lListPos; ulIdx++ )
-						astar_PushNodeToStack( pNecessaryNodeList[ulIdx], pPath );
+	while ( astar_HeapPop( lSector ))
+	{
+		if ( g_ulSectorClosedStamp[lSector] == ulStamp )
+			continue;
+		g_ulSectorClosedStamp[lSector] = ulStamp;
 
-					break;
-				}
+		if ( lSector == lGoalSector )
+		{
+			for ( LONG lRoute = lGoalSector; lRoute >= 0; lRoute = g_lSectorParent[lRoute] )
+			{
+				g_ulCorridorStamp[lRoute] = ulStamp;
+				for ( ULONG ulIdx = g_ulSectorEdgeStart[lRoute]; ulIdx < g_ulSectorEdgeStart[lRoute + 1]; ulIdx++ )
+					g_ulCorridorStamp[g_lSectorEdges[ulIdx]] = ulStamp;
 			}
+			return ( true );
 		}
 
-		pPath->ulFlags |= PF_COMPLETE|PF_SUCCESS;
-		return ( true );
+		for ( ULONG ulIdx = g_ulSectorEdgeStart[lSector]; ulIdx < g_ulSectorEdgeStart[lSector + 1]; ulIdx++ )
+		{
+			const LONG lNext = g_lSectorEdges[ulIdx];
+			if ( g_ulSectorClosedStamp[lNext] == ulStamp )
+				continue;
+
+			const LONG lNewCost = g_lSectorCost[lSector] + 1 + astar_GetCostToGoalEstimate( g_SectorCenters[lSector], g_SectorCenters[lNext] );
+			if (( g_ulSectorOpenStamp[lNext] == ulStamp ) && ( lNewCost >= g_lSectorCost[lNext] ))
+				continue;
+
+			g_ulSectorOpenStamp[lNext] = ulStamp;
+			g_lSectorCost[lNext] = lNewCost;
+			g_lSectorParent[lNext] = lSector;
+			astar_HeapPush( lNewCost + astar_GetCostToGoalEstimate( g_SectorCenters[lNext], g_SectorCenters[lGoalSector] ), lNext );
+		}
 	}
 
 	return ( false );
@@ -950,248 +1382,263 @@ static bool astar_PullNodeFromOpenList( ASTARPATH_t *pPath )
 
 //*****************************************************************************
 //
-static void astar_ProcessNextPathNode( ASTARPATH_t *pPath, ASTARNODE_t *pNode, LONG lAddedCost, LONG lDirection )
+// Second level of the search: A* over the subsectors. Fills Edges with the
+// edges from lStart to lGoal.
+//
+static int astar_SearchNodes( LONG lStart, LONG lGoal, bool bAvoidDamage, bool bInCorridor, LONG lGiveUpLimit, TArray<LONG> &Edges, LONG &lCost )
 {
-	LONG	lNewCost;
+	const ULONG ulCorridorStamp = g_ulSearchStamp;
+	const ULONG ulStamp = astar_NextSearchStamp( );
+	const POS_t &Goal = g_Nodes[lGoal].Position;
+	LONG lNode;
+	LONG lNumExpanded = 0;
+
+	// The stamps may have just wrapped around, which cleared the corridor.
+	if ( bInCorridor && ( ulStamp < ulCorridorStamp ))
+		bInCorridor = false;
+
+	g_Heap.Clear( );
+	g_lSearchCost[lStart] = 0;
+	g_lSearchParent[lStart] = -1;
+	g_ulOpenStamp[lStart] = ulStamp;
+	astar_HeapPush( astar_GetCostToGoalEstimate( g_Nodes[lStart].Position, Goal ), lStart );
+
+	while ( astar_HeapPop( lNode ))
+	{
+		if ( g_ulClosedStamp[lNode] == ulStamp )
+			continue;
+		g_ulClosedStamp[lNode] = ulStamp;
 
-	if ( pNode == NULL )
-		return;
+		// We've found the goal node. Now we can construct a path back to it.
+		if ( lNode == lGoal )
+		{
+			Edges.Clear( );
+			for ( LONG lEdge = g_lSearchParent[lGoal]; lEdge >= 0; lEdge = g_lSearchParent[g_Edges[lEdge].lFromNode] )
+				Edges.Push( lEdge );
 
-	// This node is on the closed list. Don't do anything with it.
-	if ( pNode->bOnClosed[g_lCurrentPathIdx] )
-		return;
+			for ( ULONG ulIdx = 0; ulIdx < Edges.Size( ) / 2; ulIdx++ )
+				swapvalues( Edges[ulIdx], Edges[Edges.Size( ) - 1 - ulIdx] );
 
-	// Issue a small penalty for changing directions.
-	if ( lDirection != pPath->pCurrentNode->lDirection[g_lCurrentPathIdx] )
-		lAddedCost = (LONG)( lAddedCost * 1.5 );
+			lCost = g_lSearchCost[lGoal];
+			return ( ASTAR_FOUND );
+		}
 
-	// Check if it's possible to get to this new node.
-	{
-		POS_t			CurPos;
-		POS_t			DestPos;
-		sector_t		*pSector;
-//		fixed_t			vx;
-//		fixed_t			vy;
-//		fixed_t			vz;
-//		fixed_t			Angle;
-//		fixed_t			Pitch;
-//		FTraceResults	TraceResults;
-		ULONG			ulResults;
-		fixed_t			Distance;
+		g_lNumSearchedNodes++;
+		if (( lGiveUpLimit > 0 ) && ( ++lNumExpanded > lGiveUpLimit ))
+			return ( ASTAR_GAVEUP );
 
-		if ( pPath->pCurrentNode == pPath->pStartNode )
-		{
-			CurPos.x = pPath->pActor->x;
-			CurPos.y = pPath->pActor->y;
-		}
-		else
-			CurPos = pPath->pCurrentNode->Position;
-
-		DestPos = pNode->Position;
-		pSector = R_PointInSubsector( CurPos.x, CurPos.y )->sector;
-
-//		Angle = R_PointToAngle2( CurPos.x, CurPos.y, DestPos.x, DestPos.y ) >> ANGLETOFINESHIFT;
-//		Pitch = 0;
-	
-//		vx = FixedMul( finecosine[Pitch], finecosine[Angle/* >> ANGLETOFINESHIFT*/] );
-//		vy = FixedMul( finecosine[Pitch], finesine[Angle/* >> ANGLETOFINESHIFT*/] );
-//		vz = finesine[Pitch];
-
-		// THIS NEEDS TO CHANGE IF ASTAR_NODE_SIZE EVER CHANGES!!!
-		if (( lDirection == 0 ) ||
-			( lDirection == 2 ) ||
-			( lDirection == 4 ) ||
-			( lDirection == 6 ))
-		{
-			Distance = 64 * FRACUNIT;
-		}
-		else
+		const ASTARGRAPHNODE_t &Node = g_Nodes[lNode];
+		for ( ULONG ulIdx = Node.ulFirstEdge; ulIdx < Node.ulFirstEdge + Node.ulNumEdges; ulIdx++ )
 		{
-			Distance = 91 * FRACUNIT;
+			const ASTAREDGE_t &Edge = g_Edges[ulIdx];
+			const LONG lNext = Edge.lToNode;
+
+			if ( Edge.lBlockedUntil > gametic )
+				continue;
+			if ( bAvoidDamage && ( Edge.ulFlags & ASTAREDGE_DAMAGING ))
+				continue;
+			if ( bInCorridor && ( g_ulCorridorStamp[g_Nodes[lNext].lSector] != ulCorridorStamp ))
+				continue;
+			if ( g_ulClosedStamp[lNext] == ulStamp )
+				continue;
+
+			// If this node is already in the open list, and this path to the node isn't any better,
+			// don't do anything.
+			const LONG lNewCost = g_lSearchCost[lNode] + Edge.lCost;
+			if (( g_ulOpenStamp[lNext] == ulStamp ) && ( lNewCost >= g_lSearchCost[lNext] ))
+				continue;
+
+			g_ulOpenStamp[lNext] = ulStamp;
+			g_lSearchCost[lNext] = lNewCost;
+			g_lSearchParent[lNext] = ulIdx;
+			astar_HeapPush( lNewCost + astar_GetCostToGoalEstimate( g_Nodes[lNext].Position, Goal ), lNext );
 		}
-/*
-		if ( Trace( CurPos.x,
-			CurPos.y,
-			pSector->floorplane.ZatPoint( CurPos.x, CurPos.y ) + gameinfo.StepHeight,
-			pSector,
-			vx,
-			vy,
-			vz,
-			Distance,
-			MF_SOLID|MF_SHOOTABLE,
-			0,
-			pPath->pActor,
-			TraceResults ))
-		{
-			return;
-		}
-*/
-		ulResults = BOTPATH_TryWalk( pPath->pActor, CurPos.x, CurPos.y, pSector->floorplane.ZatPoint( CurPos.x, CurPos.y ), DestPos.x, DestPos.y );
-		if (( ulResults & BOTPATH_OBSTRUCTED ) || (( pPath->pActor->player->pSkullBot->m_ulPathType == BOTPATHTYPE_ROAM ) && ( ulResults & BOTPATH_DAMAGINGSECTOR )))
-			return;
-
-		// If this sector is a damaging sector, make it more costly to go through here.
-		switch ( pSector->special )
-		{
-		case dDamage_End:
-
-			break;
-		case dDamage_Hellslime:
-
-			lAddedCost += 32;
-			break;
-		case dDamage_SuperHellslime:
-		case dLight_Strobe_Hurt:
+	}
 
-			lAddedCost += 64;
-			break;
-		case dDamage_Nukage:
-		case dDamage_LavaWimpy:
-		case dScroll_EastLavaDamage:
+	return ( ASTAR_UNREACHABLE );
+}
 
-			lAddedCost += 16;
-			break;
-		case dDamage_LavaHefty:
+//*****************************************************************************
+//
+static int astar_FindPath( LONG lStart, LONG lGoal, bool bAvoidDamage, float fMaxSearchNodes, LONG lGiveUpLimit, TArray<LONG> &Edges, LONG &lCost )
+{
+	// Someone may have been here before.
+	if ( astar_LookupPath( lStart, lGoal, bAvoidDamage, Edges, lCost ))
+	{
+		g_ulNumCacheHits++;
+		return ( ASTAR_FOUND );
+	}
 
-			lAddedCost += 24;
-			break;
-		default:
+	if ( g_Nodes[lStart].lComponent != g_Nodes[lGoal].lComponent )
+		return ( ASTAR_UNREACHABLE );
 
-			break;
-		}
+	const QWORD qwPairKey = ( static_cast<QWORD>( lGoal ) << 32 ) | static_cast<DWORD>( lStart );
+	LONG *plUnreachableUntil = g_UnreachableCache.CheckKey( qwPairKey );
+	if ( plUnreachableUntil != NULL )
+	{
+		if ( *plUnreachableUntil > gametic )
+			return ( ASTAR_UNREACHABLE );
+		g_UnreachableCache.Remove( qwPairKey );
 	}
 
-	lNewCost = pPath->pCurrentNode->lCostFromStart[g_lCurrentPathIdx] + lAddedCost;// + astar_TraverseCost( pPath->pCurrentNode, pNode );
+	// Only so many nodes are searched per tic, across all bots, on average. A
+	// search always runs to the end once it has started, so it may go beyond
+	// that. The nodes it searched beyond the budget are paid back in the
+	// following tics, during which no new search starts. The give up limit is
+	// the only limit of a single search. Without one, a search still can't take
+	// more than twice the number of nodes, since each of the two passes below
+	// expands every node at most once.
+	if ( g_lSearchTic != gametic )
+	{
+		if (( fMaxSearchNodes >= 1 ) && ( g_lSearchTic >= 0 ))
+			g_fSearchDebt = MAX( 0.0f, g_fSearchDebt + g_lNumSearchedNodes - fMaxSearchNodes * ( gametic - g_lSearchTic ));
+		else
+			g_fSearchDebt = 0;
 
-	// If this node is already in the open list, and this path to the node isn't any better,
-	// don't do anything.
-	if (( pNode->bOnOpen[g_lCurrentPathIdx] ) && ( lNewCost >= pNode->lCostFromStart[g_lCurrentPathIdx] ))
+		g_lSearchTic = gametic;
+		g_lNumSearchedNodes = 0;
+	}
+	if (( fMaxSearchNodes > 0 ) && ( fMaxSearchNodes < 1 ))
 	{
-		return;
+		if (( gametic % (LONG)( 1.0f / fMaxSearchNodes )) != 0 )
+			return ( ASTAR_DEFERRED );
 	}
-	// Store the new or improved information.
-	else
+	else if (( fMaxSearchNodes > 0 ) && ( g_fSearchDebt + g_lNumSearchedNodes >= fMaxSearchNodes ))
 	{
-		pNode->pParent[g_lCurrentPathIdx] = pPath->pCurrentNode;
-		pNode->lDirection[g_lCurrentPathIdx] = lDirection;
-		if ( pPath->pCurrentNode == pNode )
-			I_Error( "astar_ProcessNextPathNode: Parent node same as child node!" );
-		pNode->lCostFromStart[g_lCurrentPathIdx] = lNewCost;
-		pNode->lTotalCost[g_lCurrentPathIdx] = pNode->lCostFromStart[g_lCurrentPathIdx] + astar_GetCostToGoalEstimate( pPath, pNode );
-
-		if ( pNode->bOnOpen[g_lCurrentPathIdx] == false )
-		{
-			pNode->bOnOpen[g_lCurrentPathIdx] = true;
-			astar_InsertToPriorityQueue( pNode );
+		return ( ASTAR_DEFERRED );
+	}
 
-			if ( botdebug_shownodes )
-			{
-				if ( pPath->paVisualizations[( pNode->lXNodeIdx * g_lNumVerticalNodes ) + pNode->lYNodeIdx] == NULL )
-					pPath->paVisualizations[( pNode->lXNodeIdx * g_lNumVerticalNodes ) + pNode->lYNodeIdx] = Spawn( PClass::FindClass( "PathNode" ), pNode->Position.x, pNode->Position.y, ONFLOORZ, NO_REPLACE );
+	g_ulNumSearches++;
 
-				AActor *pPathNode = pPath->paVisualizations[( pNode->lXNodeIdx * g_lNumVerticalNodes ) + pNode->lYNodeIdx];
-				pPathNode->SetState( pPathNode->SpawnState + ASTAR_FRAME_INOPEN );
-			}
+	int lResult = ASTAR_UNREACHABLE;
+	if ( astar_MarkCorridor( g_Nodes[lStart].lSector, g_Nodes[lGoal].lSector ))
+	{
+		const LONG lSearchedBefore = g_lNumSearchedNodes;
+
+		// The sectors are only a rough guide. If there's no way through the
+		// corridor, search everything, with what's left of the give up limit.
+		lResult = astar_SearchNodes( lStart, lGoal, bAvoidDamage, true, lGiveUpLimit, Edges, lCost );
+		if ( lResult == ASTAR_UNREACHABLE )
+		{
+			LONG lLimitLeft = lGiveUpLimit;
+			if ( lGiveUpLimit > 0 )
+				lLimitLeft = lGiveUpLimit - ( g_lNumSearchedNodes - lSearchedBefore );
+
+			if (( lGiveUpLimit > 0 ) && ( lLimitLeft <= 0 ))
+				lResult = ASTAR_GAVEUP;
+			else
+				lResult = astar_SearchNodes( lStart, lGoal, bAvoidDamage, false, lLimitLeft, Edges, lCost );
 		}
 	}
-}
 
-//*****************************************************************************
-//
-static ASTARNODE_t *astar_GetNode( LONG lXNodeIdx, LONG lYNodeIdx )
-{
-	if (( lXNodeIdx >= g_lNumHorizontalNodes ) || ( lXNodeIdx < 0 ) ||
-		( lYNodeIdx >= g_lNumVerticalNodes ) || ( lYNodeIdx < 0 ))
-	{
-		return ( NULL );
-	}
+	if ( lResult == ASTAR_FOUND )
+		astar_StorePath( lGoal, bAvoidDamage, Edges );
+	else if (( lResult == ASTAR_UNREACHABLE ) && ( bAvoidDamage == false ))
+		g_UnreachableCache[qwPairKey] = gametic + ASTAR_BLOCKED_TICS;
 
-	return ( &g_aMasterNodeList[( lXNodeIdx * g_lNumVerticalNodes ) + lYNodeIdx] );
+	return ( lResult );
 }
 
 //*****************************************************************************
 //
-static void astar_InsertToPriorityQueue( ASTARNODE_t *pNode )
+static QWORD astar_CacheKey( LONG lNode, LONG lGoal, bool bAvoidDamage )
 {
-	g_apOpenListPriorityQueue[g_lCurrentPathIdx][++g_ulPriorityQueuePosition[g_lCurrentPathIdx]] = pNode;
-
-	// Resort the priority queue.
-	astar_FixUpPriorityQueue( g_ulPriorityQueuePosition[g_lCurrentPathIdx] );
+	return (( static_cast<QWORD>( lGoal ) << 32 ) | ( bAvoidDamage ? 0x80000000u : 0 ) | static_cast<DWORD>( lNode ));
 }
 
 //*****************************************************************************
 //
-static ASTARNODE_t *astar_PopFromPriorityQueue( void )
-{
-	astar_Exchange( &g_apOpenListPriorityQueue[g_lCurrentPathIdx][g_ulPriorityQueuePosition[g_lCurrentPathIdx]], &g_apOpenListPriorityQueue[g_lCurrentPathIdx][1] );
-	astar_FixDownPriorityQueue( 1, g_ulPriorityQueuePosition[g_lCurrentPathIdx] - 1 );
-
-	return ( g_apOpenListPriorityQueue[g_lCurrentPathIdx][g_ulPriorityQueuePosition[g_lCurrentPathIdx]--] );
-}
-
-//*****************************************************************************
+// Follows the cached hops from lStart to lGoal. Each hop leads to a node whose
+// cost to the goal is lower, so this can't loop.
 //
-static void astar_FixUpPriorityQueue( ULONG ulPosition )
+static bool astar_LookupPath( LONG lStart, LONG lGoal, bool bAvoidDamage, TArray<LONG> &Edges, LONG &lCost )
 {
-	while (( ulPosition > 1 ) &&
-		( astar_GetTotalCost( g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulPosition] ) < astar_GetTotalCost( g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulPosition / 2] )))
+	LONG		lNode = lStart;
+	LONG		lLastCost = INT_MAX;
+	ASTARHOP_t	*pHop;
+
+	Edges.Clear( );
+	lCost = 0;
+	while ( lNode != lGoal )
 	{
-		astar_Exchange( &g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulPosition], &g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulPosition / 2] );
-		ulPosition /= 2;
+		const QWORD qwKey = astar_CacheKey( lNode, lGoal, bAvoidDamage );
+
+		pHop = g_PathCache.CheckKey( qwKey );
+		if (( pHop == NULL ) || ( pHop->lCostToGoal >= lLastCost ))
+			return ( false );
+
+		const ASTAREDGE_t &Edge = g_Edges[pHop->lEdge];
+		if ( Edge.lBlockedUntil > gametic )
+		{
+			g_PathCache.Remove( qwKey );
+			return ( false );
+		}
+
+		if ( lNode == lStart )
+			lCost = pHop->lCostToGoal;
+
+		Edges.Push( pHop->lEdge );
+		lLastCost = pHop->lCostToGoal;
+		lNode = Edge.lToNode;
 	}
+
+	return ( true );
 }
 
 //*****************************************************************************
 //
-static void astar_FixDownPriorityQueue( ULONG ulStartPosition, ULONG ulEndPosition )
+// Remembers the way to lGoal from every node along a path that was found.
+// Existing hops are only replaced by cheaper ones.
+//
+static void astar_StorePath( LONG lGoal, bool bAvoidDamage, const TArray<LONG> &Edges )
 {
-	ULONG		ulChild;
-	ASTARNODE_t	*pTempNode;
+	LONG	lCostToGoal = 0;
+
+	if ( g_PathCache.CountUsed( ) + Edges.Size( ) > ASTAR_MAX_CACHED_HOPS )
+		g_PathCache.Clear( );
 
-	pTempNode = g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulStartPosition];
-	while (( ulStartPosition * 2 ) < ulEndPosition )
+	for ( int i = static_cast<int>( Edges.Size( )) - 1; i >= 0; i-- )
 	{
-		ulChild = ulStartPosition * 2;
+		const ASTAREDGE_t &Edge = g_Edges[Edges[i]];
+		const QWORD qwKey = astar_CacheKey( Edge.lFromNode, lGoal, bAvoidDamage );
 
-		// If there is a right child and it is bigger than the left child, move it.
-		if (( ulChild < ulEndPosition ) && ( astar_GetTotalCost( g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulChild + 1] ) < astar_GetTotalCost( g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulChild] )))
-			ulChild++;
+		lCostToGoal += Edge.lCost;
 
-		// Move child up?
-		if ( astar_GetTotalCost( g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulChild] ) < astar_GetTotalCost( pTempNode ))
-			g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulStartPosition] = g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulChild];
-		else
-			break;
+		ASTARHOP_t *pHop = g_PathCache.CheckKey( qwKey );
+		if (( pHop != NULL ) && ( pHop->lCostToGoal <= lCostToGoal ))
+			continue;
 
-		ulStartPosition = ulChild;
+		ASTARHOP_t Hop;
+		Hop.lEdge = Edges[i];
+		Hop.lCostToGoal = lCostToGoal;
+		g_PathCache[qwKey] = Hop;
 	}
-
-	g_apOpenListPriorityQueue[g_lCurrentPathIdx][ulStartPosition] = pTempNode;
 }
 
 //*****************************************************************************
 //
-static bool astar_IsPriorityQueueEmpty( void )
+static void astar_BlockEdge( LONG lEdge )
 {
-	return ( g_ulPriorityQueuePosition[g_lCurrentPathIdx] == 0 );
-}
-
-//*****************************************************************************
-//
-static void astar_Exchange( ASTARNODE_t **pNode1, ASTARNODE_t **pNode2 )
-{
-	ASTARNODE_t	*pNode3;
+	if (( lEdge < 0 ) || ( static_cast<ULONG>( lEdge ) >= g_Edges.Size( )))
+		return;
 
-	pNode3 = *pNode1;
-	*pNode1 = *pNode2;
-	*pNode2 = pNode3;
+	g_Edges[lEdge].lBlockedUntil = gametic + ASTAR_BLOCKED_TICS;
 }
 
 //*****************************************************************************
 //
-static ULONG astar_GetTotalCost( ASTARNODE_t *pNode )
+static void astar_ShowPath( ASTARPATH_t *pPath )
 {
-	return ( pNode == NULL ? 0 : pNode->lTotalCost[g_lCurrentPathIdx] );
+	const PClass *pType = PClass::FindClass( "PathNode" );
+	if ( pType == NULL )
+		return;
+
+	for ( ULONG ulIdx = 0; ulIdx < pPath->Waypoints.Size( ); ulIdx++ )
+	{
+		AActor *pPathNode = Spawn( pType, pPath->Waypoints[ulIdx].Position.x, pPath->Waypoints[ulIdx].Position.y, ONFLOORZ, NO_REPLACE );
+		pPathNode->SetState( pPathNode->SpawnState + ASTAR_FRAME_ONPATH );
+		pPath->Visualizations.Push( pPathNode );
+	}
 }
 
 //*****************************************************************************
@@ -1201,9 +1648,12 @@ ADD_STAT( pathing )
 {
 	FString	Out;
 
-	Out.Format( "Pathing cycles = %04.1f ms (%3d nodes pathed)", 
+	Out.Format( "Pathing cycles = %04.1f ms (%3d nodes pathed, %u searches, %u cached, %u hops)",
 		g_PathingCycles.TimeMS(),
-		static_cast<int> (g_lNumSearchedNodes)
+		static_cast<int> (g_lNumSearchedNodes),
+		static_cast<unsigned int> (g_ulNumSearches),
+		static_cast<unsigned int> (g_ulNumCacheHits),
+		static_cast<unsigned int> (g_PathCache.CountUsed( ))
 		);
 
 	return ( Out );
@@ -44,7 +44,7 @@
 //
 // Filename: astar.h
 //
-// Description: 
+// Description: Bot pathing over a navigation graph of the map.
 //
 //-----------------------------------------------------------------------------
 
@@ -57,18 +57,8 @@
 //*****************************************************************************
 //	DEFINES
 
-// Size of each astar node.
-#define	ASTAR_NODE_SIZE			64
-
-#define	ASTAR_NODE_SHIFT		22
-
 #define	MAX_PATHS				( MAXPLAYERS * 2 )
 
-#define	MAX_NODES_IN_PATH		128
-
-// Maximum number of nodes that can be pathed in a tick.
-#define	MAX_NODES_TO_SEARCH		1//256
-
 // The path has been initialized.
 #define	PF_INITIALIZED			1
 
@@ -83,46 +73,98 @@
 #define	ASTAR_FRAME_INCLOSED	2
 #define	ASTAR_FRAME_ONPATH		3
 
-// Possible next steps in the pathing process.
-#define	ASTAR_NS_PULLFROMOPENLIST		0
-#define	ASTAR_NS_LOOKABOVE				1
-#define	ASTAR_NS_LOOKABOVEFORWARD		2
-#define	ASTAR_NS_LOOKFORWARD			3
-#define	ASTAR_NS_LOOKBELOWFORWARD		4
-#define	ASTAR_NS_LOOKBELOW				5
-#define	ASTAR_NS_LOOKBELOWBACK			6
-#define	ASTAR_NS_LOOKBACK				7
-#define	ASTAR_NS_LOOKABOVEBACK			8
+// Height of the players the navigation graph is built for, the height they can
+// walk up, and the highest ledge they can jump onto (see BOTPATH_TryWalk).
+#define	ASTAR_PLAYER_HEIGHT		( 56 * FRACUNIT )
+#define	ASTAR_STEP_HEIGHT		( 24 * FRACUNIT )
+#define	ASTAR_MAX_JUMP			( 60 * FRACUNIT )
+
+// Extra cost of crossings that need a jump or a door to be opened.
+#define	ASTAR_JUMP_COST			32
+#define	ASTAR_DOOR_COST			64
+
+// A crossing that turned out to be blocked while following a path isn't used
+// again for this many tics.
+#define	ASTAR_BLOCKED_TICS		( 5 * TICRATE )
+
+// The shared path cache is flushed once it holds this many entries.
+#define	ASTAR_MAX_CACHED_HOPS	65536
+
+// Edge flags.
+#define	ASTAREDGE_JUMP			1
+#define	ASTAREDGE_DOOR			2
+#define	ASTAREDGE_DAMAGING		4
 
 //*****************************************************************************
 //	STRUCTURES
 
-typedef struct ASTARNODE_s
+// A node of the navigation graph. Each one is a convex subsector of the map,
+// taken from a set of GL nodes built for the navigation graph.
+typedef struct
 {
-	// The XY Node indicies this node is in.
-	LONG				lXNodeIdx;
-	LONG				lYNodeIdx;
-
-	// The XY coordinates of the center of this node.
+	// Center of the subsector. z is the floor height there.
 	POS_t				Position;
 
-	// Parent of this node.
-	struct ASTARNODE_s		*pParent[MAX_PATHS];
+	// Sector the subsector belongs to. Sectors are the clusters of the
+	// hierarchical search.
+	LONG				lSector;
+
+	// Edges leaving this node.
+	ULONG				ulFirstEdge;
+	ULONG				ulNumEdges;
+
+	// Nodes that can't reach each other are in different components.
+	LONG				lComponent;
+
+} ASTARGRAPHNODE_t;
+
+//*****************************************************************************
+// A walkable crossing from one node into another.
+typedef struct
+{
+	LONG				lFromNode;
+	LONG				lToNode;
+
+	// Middle of the seg that is crossed. z is the floor height on the far side.
+	POS_t				Crossing;
 
-	// Cost of getting from the start node to this node.
-	LONG				lCostFromStart[MAX_PATHS];
+	// Cost of getting from the center of lFromNode to the center of lToNode.
+	LONG				lCost;
 
-	// lCostFromStart (g, or "gone") + h, or "heuristic".
-	LONG				lTotalCost[MAX_PATHS];
+	// ASTAREDGE_* flags.
+	ULONG				ulFlags;
 
-	// Is this node on the open list?
-	bool				bOnOpen[MAX_PATHS];
+	// The edge is ignored until this tic (not saved in the cache).
+	LONG				lBlockedUntil;
 
-	// Is this node on the closed list?
-	bool				bOnClosed[MAX_PATHS];
+} ASTAREDGE_t;
 
-	// Direction this node.
-	LONG				lDirection[MAX_PATHS];
+//*****************************************************************************
+// BSP of the navigation graph, to find the node a point is in.
+typedef struct
+{
+	fixed_t				x;
+	fixed_t				y;
+	fixed_t				dx;
+	fixed_t				dy;
+
+	// Index of the child node, or ~index of the graph node for leaves.
+	LONG				alChildren[2];
+
+} ASTARBSPNODE_t;
+
+//*****************************************************************************
+// A waypoint of a path.
+typedef struct ASTARNODE_s
+{
+	// Where to walk to.
+	POS_t				Position;
+
+	// The graph node the bot is in once the waypoint has been reached.
+	LONG				lNode;
+
+	// Edge this waypoint crosses, or -1 for the goal.
+	LONG				lEdge;
 
 } ASTARNODE_t;
 
@@ -149,35 +191,17 @@ typedef struct
 	// Flags for this path (initialized, complete, successful, etc.)
 	ULONG			ulFlags;
 
-	// The list of all the nodes to follow in this path.
-	ASTARNODE_t		*pNodeStack[MAX_NODES_IN_PATH];
-
-	// Current position in the node stack.
-	LONG			lStackPos;
-
-	// Has the goal node been reached?
-	bool			bInGoalNode;
-
-	// The next step in the pathing process.
-	ULONG			ulNextStep;
+	// The waypoints to follow in this path. The last one is the next to walk to.
+	TArray<ASTARNODE_t>	Waypoints;
 
-	// The current node being used in the pathing process.
-	ASTARNODE_t		*pCurrentNode;
-
-	// The starting node in this path. The actor doing the pathing lies in this node.
-	ASTARNODE_t		*pStartNode;
-
-	// The goal node in this path.
-	ASTARNODE_t		*pGoalNode;
+	// The total cost of the path.
+	LONG			lTotalCost;
 
 	// Actor this path belongs to.
 	AActor			*pActor;
 
-	// How many nodes have been searched?
-	ULONG			ulNumSearchedNodes;
-
-	// Dynamic array of visualizations for this path.
-	AActor			**paVisualizations;
+	// Visualizations for this path.
+	TArray<AActor *>	Visualizations;
 
 } ASTARPATH_t;
 
@@ -190,7 +214,6 @@ void				ASTAR_ClearNodes( void );
 bool				ASTAR_IsInitialized( void );
 ASTARRETURNSTRUCT_t	ASTAR_Path( ULONG ulIdx, POS_t GoalPoint, float fMaxSearchNodes, LONG lGiveUpLimit );
 POS_t				ASTAR_GetPosition( ASTARNODE_t *pNode );
-POS_t				ASTAR_GetPositionFromIndex( LONG lXIdx, LONG lYIdx );
 void				ASTAR_ClearVisualizations( void );
 void				ASTAR_ShowCosts( POS_t Position );
 void				ASTAR_ClearPath( LONG lPathIdx );
@@ -788,7 +788,7 @@ void BOTCMD_DoChatStringSubstitutions( CSkullBot *pBot, FString &Input )
 
 //*****************************************************************************
 //
-bool BOTCMD_IgnoreItem( CSkullBot *pBot, unsigned short netID, bool bVisibilityCheck )
+bool BOTCMD_IgnoreItem( CSkullBot *pBot, unsigned int netID, bool bVisibilityCheck )
 {
 	AActor *pActor = g_ActorNetIDList.findPointerByID ( netID );
 	if (( pActor == NULL ) ||
@@ -824,9 +824,9 @@ void botcmd_ValidatePlayerID( const LONG lPlayerID, const char *pszFunctionName
 
 //*****************************************************************************
 //
-void botcmd_ValidateItemNetID( const unsigned short netID, const char *pszFunctionName )
+void botcmd_ValidateItemNetID( const unsigned int netID, const char *pszFunctionName )
 {
-	botcmd_CheckIfInputIsValid( netID, static_cast<LONG>(( std::numeric_limits<unsigned short>::max )( )) + 1, pszFunctionName, "Illegal item index" );
+	botcmd_CheckIfInputIsValid( static_cast<LONG>( netID ), IDList<AActor>::NETID_MAXSIZE, pszFunctionName, "Illegal item index" );
 }
 
 //*****************************************************************************
@@ -921,7 +921,7 @@ int botcmd_LookForItemType( CSkullBot *pBot, const char *FunctionName )
 	bool visibilityCheck = !!pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1];
 	pBot->PopStack( );
 
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, FunctionName );
@@ -929,7 +929,8 @@ int botcmd_LookForItemType( CSkullBot *pBot, const char *FunctionName )
 	while (( BOTCMD_IgnoreItem( pBot, netID, visibilityCheck )) ||
 		( g_ActorNetIDList.findPointerByID( netID )->GetClass( )->IsDescendantOf( RUNTIME_CLASS( T )) == false ))
 	{
-		if ( netID == ( std::numeric_limits<unsigned short>::max )( ))
+		// There are no used IDs beyond the end of the table.
+		if ( netID + 1 >= g_ActorNetIDList.size( ))
 			return -1;
 
 		netID++;
@@ -966,7 +967,7 @@ int botcmd_LookForItemWithFlag( CSkullBot *pBot, const int Flag, const char *Fun
 	bool visibilityCheck = !!pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1];
 	pBot->PopStack( );
 
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, FunctionName );
@@ -974,7 +975,7 @@ int botcmd_LookForItemWithFlag( CSkullBot *pBot, const int Flag, const char *Fun
 	while (( BOTCMD_IgnoreItem( pBot, netID, visibilityCheck )) ||
 		(( g_ActorNetIDList.findPointerByID( netID )->STFlags & Flag ) == false ))
 	{
-		if ( netID == ( std::numeric_limits<unsigned short>::max )( ))
+		if ( netID + 1 >= g_ActorNetIDList.size( ))
 			return -1;
 
 		netID++;
@@ -1624,7 +1625,7 @@ static void botcmd_Roam( CSkullBot *pBot )
 //
 static void botcmd_GetPathingCostToItem( CSkullBot *pBot )
 {
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, "botcmd_GetPathingCostToItem" );
@@ -1659,7 +1660,7 @@ static void botcmd_GetPathingCostToItem( CSkullBot *pBot )
 //
 static void botcmd_GetDistanceToItem( CSkullBot *pBot )
 {
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, "botcmd_GetDistanceToItem" );
@@ -1678,7 +1679,7 @@ static void botcmd_GetDistanceToItem( CSkullBot *pBot )
 //
 static void botcmd_GetItemName( CSkullBot *pBot )
 {
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, "botcmd_GetItemName" );
@@ -1699,7 +1700,7 @@ static void botcmd_GetItemName( CSkullBot *pBot )
 //
 static void botcmd_IsItemVisible( CSkullBot *pBot )
 {
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, "botcmd_IsItemVisible" );
@@ -1742,7 +1743,7 @@ static void botcmd_IsItemVisible( CSkullBot *pBot )
 //
 static void botcmd_SetGoal( CSkullBot *pBot )
 {
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, "botcmd_SetGoal" );
@@ -1973,7 +1974,7 @@ static void botcmd_ChangeWeapon( CSkullBot *pBot )
 //
 static void botcmd_GetWeaponFromItem( CSkullBot *pBot )
 {
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, "botcmd_GetWeaponFromItem" );
@@ -1999,7 +2000,7 @@ static void botcmd_GetWeaponFromItem( CSkullBot *pBot )
 //
 static void botcmd_IsWeaponOwned( CSkullBot *pBot )
 {
-	unsigned short netID = static_cast<unsigned short>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
+	unsigned int netID = static_cast<unsigned int>( pBot->m_ScriptData.alStack[pBot->m_ScriptData.lStackPosition - 1] );
 	pBot->PopStack( );
 
 	botcmd_ValidateItemNetID( netID, "botcmd_IsWeaponOwned" );
@@ -86,6 +86,8 @@ static TArray<FLatchedValue> SavedServerInfoValues;
 
 bool FBaseCVar::m_DoNoSet = false;
 bool FBaseCVar::m_UseCallback = false;
+FBaseCVar *FBaseCVar::HashTable[FBaseCVar::HASH_SIZE];
+unsigned int FBaseCVar::Generation = 0;
 
 FBaseCVar *CVars = NULL;
 
@@ -119,6 +121,7 @@ FBaseCVar::FBaseCVar (const char *var_name, DWORD flags, void (*callback)(FBaseC
 	m_Callback = callback;
 	Flags = 0;
 	Name = NULL;
+	m_HashNext = NULL;
 
 	if (var_name)
 	{
@@ -126,6 +129,7 @@ FBaseCVar::FBaseCVar (const char *var_name, DWORD flags, void (*callback)(FBaseC
 		Name = copystring (var_name);
 		m_Next = CVars;
 		CVars = this;
+		LinkToHash ();
 	}
 
 	if (var)
@@ -164,11 +168,53 @@ FBaseCVar::~FBaseCVar ()
 			else
 				CVars = m_Next;
 		}
+		UnlinkFromHash ();
 		C_RemoveTabCommand(Name);
 		delete[] Name;
 	}
 }
 
+//===========================================================================
+//
+// FBaseCVar :: LinkToHash
+//
+// New cvars go to the front of their chain, so that a name registered twice
+// resolves to the newest cvar, just like it does in the CVars list.
+//
+//===========================================================================
+
+void FBaseCVar::LinkToHash ()
+{
+	FBaseCVar **bucket = &HashTable[MakeKey (Name) % HASH_SIZE];
+
+	m_HashNext = *bucket;
+	*bucket = this;
+	Generation++;
+}
+
+//===========================================================================
+//
+// FBaseCVar :: UnlinkFromHash
+//
+//===========================================================================
+
+void FBaseCVar::UnlinkFromHash ()
+{
+	FBaseCVar **link = &HashTable[MakeKey (Name) % HASH_SIZE];
+
+	while (*link != NULL)
+	{
+		if (*link == this)
+		{
+			*link = m_HashNext;
+			break;
+		}
+		link = &(*link)->m_HashNext;
+	}
+	m_HashNext = NULL;
+	Generation++;
+}
+
 void FBaseCVar::ForceSet (UCVarValue value, ECVarType type, bool nouserinfosend)
 {
 	DoSet (value, type);
@@ -347,7 +393,12 @@ void FBaseCVar::SetGenericRep (UCVarValue value, ECVarType type)
 
 	// [TP] Inform RCON clients about server setting changes
 	if (( NETWORK_GetState() == NETSTATE_SERVER ) && ( Flags & ( CVAR_SENSITIVESERVERSETTING | CVAR_SERVERINFO )))
+	{
 		SERVERCOMMANDS_SyncCVarToAdmins( *this );
+
+		// Launcher responses contain many of these settings.
+		SERVER_MASTER_InvalidateLauncherResponses( );
+	}
 }
 
 bool FBaseCVar::ToBool (UCVarValue value, ECVarType type)
@@ -1616,22 +1667,32 @@ void C_ForgetCVars (void)
 FBaseCVar *FindCVar (const char *var_name, FBaseCVar **prev)
 {
 	FBaseCVar *var;
-	FBaseCVar *dummy;
 
 	if (var_name == NULL)
 		return NULL;
 
-	if (prev == NULL)
-		prev = &dummy;
+	// Only callers that want to unlink the cvar need to know its
+	// predecessor in the CVars list, everyone else can use the hash.
+	if (prev != NULL)
+	{
+		var = CVars;
+		*prev = NULL;
+		while (var)
+		{
+			if (stricmp (var->GetName (), var_name) == 0)
+				break;
+			*prev = var;
+			var = var->m_Next;
+		}
+		return var;
+	}
 
-	var = CVars;
-	*prev = NULL;
+	var = FBaseCVar::HashTable[MakeKey (var_name) % FBaseCVar::HASH_SIZE];
 	while (var)
 	{
 		if (stricmp (var->GetName (), var_name) == 0)
 			break;
-		*prev = var;
-		var = var->m_Next;
+		var = var->m_HashNext;
 	}
 	return var;
 }
@@ -1643,7 +1704,7 @@ FBaseCVar *FindCVarSub (const char *var_name, int namelen)
 	if (var_name == NULL)
 		return NULL;
 
-	var = CVars;
+	var = FBaseCVar::HashTable[MakeKey (var_name, namelen) % FBaseCVar::HASH_SIZE];
 	while (var)
 	{
 		const char *probename = var->GetName ();
@@ -1653,11 +1714,16 @@ FBaseCVar *FindCVarSub (const char *var_name, int namelen)
 		{
 			break;
 		}
-		var = var->m_Next;
+		var = var->m_HashNext;
 	}
 	return var;
 }
 
+unsigned int C_GetCVarGeneration ()
+{
+	return FBaseCVar::Generation;
+}
+
 //===========================================================================
 //
 // C_CreateCVar
@@ -1944,11 +2010,11 @@ CCMD (unset)
 
 CCMD (get)
 {
-	FBaseCVar *var, *prev;
+	FBaseCVar *var;
 
 	if (argv.argc() >= 2)
 	{
-		if ( (var = FindCVar (argv[1], &prev)) )
+		if ( (var = FindCVar (argv[1], NULL)) )
 		{
 			UCVarValue val;
 			val = var->GetGenericRep (CVAR_String);
@@ -1967,12 +2033,12 @@ CCMD (get)
 
 CCMD (toggle)
 {
-	FBaseCVar *var, *prev;
+	FBaseCVar *var;
 	UCVarValue val;
 
 	if (argv.argc() > 1)
 	{
-		if ( (var = FindCVar (argv[1], &prev)) )
+		if ( (var = FindCVar (argv[1], NULL)) )
 		{
 			if (IsUnsafe(var))
 			{
@@ -181,6 +181,17 @@ private:
 	void (*m_Callback)(FBaseCVar &);
 	FBaseCVar *m_Next;
 
+	// Case-insensitive index over all named cvars so that FindCVar doesn't
+	// have to walk the whole CVars list. The table is zero-initialized static
+	// data, so it is usable while the static cvars are being constructed.
+	enum { HASH_SIZE = 509 };
+	static FBaseCVar *HashTable[HASH_SIZE];
+	static unsigned int Generation;
+	FBaseCVar *m_HashNext;
+
+	void LinkToHash ();
+	void UnlinkFromHash ();
+
 	static bool m_UseCallback;
 	static bool m_DoNoSet;
 
@@ -195,6 +206,7 @@ private:
 	friend void C_SetCVarsToDefaults (void);
 	friend void FilterCompactCVars (TArray<FBaseCVar *> &cvars, uint32 filter);
 	friend void C_DeinitConsole();
+	friend unsigned int C_GetCVarGeneration ();
 
 	// [AK] CHAT_Destruct needs access to FBaseCVar::m_UseCallback.
 	friend void CHAT_Destruct (void);
@@ -219,6 +231,10 @@ void C_BackupCVars (void);
 FBaseCVar *FindCVar (const char *var_name, FBaseCVar **prev);
 FBaseCVar *FindCVarSub (const char *var_name, int namelen);
 
+// Changes whenever a named cvar is created or destroyed. Code that caches
+// cvar pointers must drop its cache when this no longer matches.
+unsigned int C_GetCVarGeneration ();
+
 // Create a new cvar with the specified name and type
 FBaseCVar *C_CreateCVar(const char *var_name, ECVarType var_type, DWORD flags);
 
@@ -816,7 +816,7 @@ void CLIENTCOMMANDS_InfoCheat( AActor* mobj, bool extended )
 		return;
 
 	CLIENT_GetLocalBuffer( )->ByteStream.WriteByte( CLC_INFOCHEAT );
-	CLIENT_GetLocalBuffer( )->ByteStream.WriteShort( mobj->NetID );
+	CLIENT_GetLocalBuffer( )->ByteStream.WriteNetID( mobj->NetID );
 	CLIENT_GetLocalBuffer( )->ByteStream.WriteByte( extended );
 }
 
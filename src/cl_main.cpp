@@ -1973,7 +1973,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 
 			case SVC2_PLAYBOUNCESOUND:
 				{
-					AActor *pActor = CLIENT_FindThingByNetID( pByteStream->ReadShort() );
+					AActor *pActor = CLIENT_FindThingByNetID( pByteStream->ReadNetID() );
 					const bool bOnfloor = !!pByteStream->ReadByte();
 					if ( pActor )
 						pActor->PlayBounceSound ( bOnfloor );
@@ -1982,7 +1982,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 
 			case SVC2_SETTHINGREACTIONTIME:
 				{
-					const unsigned short netID = pByteStream->ReadShort();
+					const unsigned int netID = pByteStream->ReadNetID();
 					const LONG lReactionTime = pByteStream->ReadShort();
 					AActor *pActor = CLIENT_FindThingByNetID( netID );
 
@@ -1998,7 +1998,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 			// [Dusk]
 			case SVC2_SETFASTCHASESTRAFECOUNT:
 				{
-					const unsigned short netID = pByteStream->ReadShort();
+					const unsigned int netID = pByteStream->ReadNetID();
 					const LONG lStrafeCount = pByteStream->ReadByte(); 
 					AActor *pActor = CLIENT_FindThingByNetID( netID );
 
@@ -2093,7 +2093,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 
 			case SVC2_SETTHINGSPECIAL:
 				{
-					const unsigned short netID = pByteStream->ReadShort();
+					const unsigned int netID = pByteStream->ReadNetID();
 					const LONG lSpecial = pByteStream->ReadShort();
 					AActor *pActor = CLIENT_FindThingByNetID( netID );
 
@@ -2133,7 +2133,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 
 			case SVC2_SETTHINGHEALTH:
 				{
-					const unsigned short netID = pByteStream->ReadShort();
+					const unsigned int netID = pByteStream->ReadNetID();
 					const int health = pByteStream->ReadByte();
 					AActor* mo = CLIENT_FindThingByNetID( netID );
 
@@ -2203,7 +2203,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 
 			case SVC2_SETDEFAULTSKYBOX:
 				{
-					unsigned short mobjNetID = pByteStream->ReadShort();
+					unsigned int mobjNetID = pByteStream->ReadNetID();
 					if ( mobjNetID == 0  )
 						level.DefaultSkybox = NULL;
 					else
@@ -2217,7 +2217,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 
 			case SVC2_FLASHSTEALTHMONSTER:
 				{
-					AActor* mobj = CLIENT_FindThingByNetID( pByteStream->ReadShort());
+					AActor* mobj = CLIENT_FindThingByNetID( pByteStream->ReadNetID());
 					SBYTE direction = pByteStream->ReadByte();
 
 					if ( mobj && ( mobj->flags & MF_STEALTH ))
@@ -2230,7 +2230,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 
 			case SVC2_STOPALLSOUNDSONTHING:
 				{
-					AActor* actor = CLIENT_FindThingByNetID( pByteStream->ReadShort());
+					AActor* actor = CLIENT_FindThingByNetID( pByteStream->ReadNetID());
 
 					if ( actor )
 					{
@@ -2242,7 +2242,7 @@ void CLIENT_ProcessCommand( LONG lCommand, BYTESTREAM_s *pByteStream )
 			case SVC2_SHOOTDECAL:
 				{
 					FName decalName = NETWORK_ReadName( pByteStream );
-					AActor* actor = CLIENT_FindThingByNetID( pByteStream->ReadShort());
+					AActor* actor = CLIENT_FindThingByNetID( pByteStream->ReadNetID());
 					fixed_t z = pByteStream->ReadShort() << FRACBITS;
 					angle_t angle = pByteStream->ReadShort() << FRACBITS;
 					fixed_t tracedist = pByteStream->ReadLong();
@@ -2631,7 +2631,7 @@ void CLIENT_AuthenticateLevel( const char *pszMapName )
 
 //*****************************************************************************
 //
-AActor *CLIENT_SpawnThing( const PClass *pType, fixed_t X, fixed_t Y, fixed_t Z, unsigned short netID, BYTE spawnFlags )
+AActor *CLIENT_SpawnThing( const PClass *pType, fixed_t X, fixed_t Y, fixed_t Z, unsigned int netID, BYTE spawnFlags )
 {
 	AActor			*pActor;
 
@@ -2742,7 +2742,7 @@ AActor *CLIENT_SpawnThing( const PClass *pType, fixed_t X, fixed_t Y, fixed_t Z,
 
 //*****************************************************************************
 //
-void CLIENT_SpawnMissile( const PClass *pType, fixed_t X, fixed_t Y, fixed_t Z, fixed_t VelX, fixed_t VelY, fixed_t VelZ, unsigned short netID, unsigned short targetNetID )
+void CLIENT_SpawnMissile( const PClass *pType, fixed_t X, fixed_t Y, fixed_t Z, fixed_t VelX, fixed_t VelY, fixed_t VelZ, unsigned int netID, unsigned int targetNetID )
 {
 	AActor				*pActor;
 
@@ -2877,7 +2877,7 @@ bool CLIENT_GainingRCONAccess()
 
 //*****************************************************************************
 //
-AActor *CLIENT_FindThingByNetID( unsigned short netID )
+AActor *CLIENT_FindThingByNetID( unsigned int netID )
 {
     return ( g_ActorNetIDList.findPointerByID( netID ));
 }
@@ -3293,7 +3293,7 @@ void CLIENT_SetActorToLastDeathStateFrame ( AActor *pActor )
 //
 // 'actor' MUST be either NULL or an instance of the provided subclass!
 //
-bool CLIENT_ReadActorFromNetID( unsigned short netID, const PClass *subclass, bool allowNull, AActor *&actor,
+bool CLIENT_ReadActorFromNetID( unsigned int netID, const PClass *subclass, bool allowNull, AActor *&actor,
 								const char *commandName, const char *parameterName )
 {
 	actor = CLIENT_FindThingByNetID( netID );
@@ -5041,6 +5041,72 @@ void ServerCommands::LevelSpawnThingNoNetID::Execute()
 	CLIENT_SpawnThing( type, x, y, z, 0, SPAWNFLAG_LEVELTHING );
 }
 
+//*****************************************************************************
+//
+void ServerCommands::LevelSpawnThingsSnapshot::Execute()
+{
+	if (( snapshot.data == NULL ) || ( snapshot.size == 0 ))
+		return;
+
+	BYTESTREAM_s	ByteStream;
+	ByteStream.pbStream = snapshot.data;
+	ByteStream.pbStreamEnd = snapshot.data + snapshot.size;
+
+	// See SERVERCOMMANDS_LevelSpawnThingsSnapshot for the layout of the entries.
+	while ( ByteStream.pbStream < ByteStream.pbStreamEnd )
+	{
+		const unsigned int netID = ByteStream.ReadNetID( );
+		const PClass *pType = NETWORK_GetClassFromIdentification( ByteStream.ReadShort( ));
+		const fixed_t X = ByteStream.ReadShort( ) << FRACBITS;
+		const fixed_t Y = ByteStream.ReadShort( ) << FRACBITS;
+		const fixed_t Z = ByteStream.ReadShort( ) << FRACBITS;
+		const ULONG ulBits = ByteStream.ReadShort( ) & 0xFFFF;
+		const fixed_t LastX = ( ulBits & CM_LAST_X ) ? ByteStream.ReadLong( ) : X;
+		const fixed_t LastY = ( ulBits & CM_LAST_Y ) ? ByteStream.ReadLong( ) : Y;
+		const fixed_t LastZ = ( ulBits & CM_LAST_Z ) ? ByteStream.ReadLong( ) : Z;
+		const angle_t Angle = ( ulBits & CM_ANGLE ) ? ByteStream.ReadShort( ) << FRACBITS : 0;
+		const fixed_t VelX = ( ulBits & CM_VELX ) ? ByteStream.ReadLong( ) : 0;
+		const fixed_t VelY = ( ulBits & CM_VELY ) ? ByteStream.ReadLong( ) : 0;
+		const fixed_t VelZ = ( ulBits & CM_VELZ ) ? ByteStream.ReadLong( ) : 0;
+		const int Pitch = ( ulBits & CM_PITCH ) ? ByteStream.ReadLong( ) : 0;
+		const int Movedir = ( ulBits & CM_MOVEDIR ) ? ByteStream.ReadByte( ) : 0;
+
+		// The entry was cut short, so it can't be trusted.
+		if ( ByteStream.pbStream > ByteStream.pbStreamEnd )
+		{
+			CLIENT_PrintWarning( "LevelSpawnThingsSnapshot: Truncated entry for net ID %u\n", netID );
+			break;
+		}
+
+		if ( pType == NULL )
+		{
+			CLIENT_PrintWarning( "LevelSpawnThingsSnapshot: Unknown class for net ID %u\n", netID );
+			continue;
+		}
+
+		AActor *pActor = CLIENT_SpawnThing( pType, X, Y, Z, netID, SPAWNFLAG_LEVELTHING );
+		if ( pActor == NULL )
+			continue;
+
+		pActor->lastX = LastX;
+		pActor->lastY = LastY;
+		pActor->lastZ = LastZ;
+
+		if ( ulBits & CM_VELX )
+			pActor->velx = VelX;
+		if ( ulBits & CM_VELY )
+			pActor->vely = VelY;
+		if ( ulBits & CM_VELZ )
+			pActor->velz = VelZ;
+		if ( ulBits & CM_PITCH )
+			pActor->pitch = Pitch;
+		if ( ulBits & CM_MOVEDIR )
+			pActor->movedir = Movedir;
+		if ( ulBits & CM_ANGLE )
+			pActor->angle = Angle;
+	}
+}
+
 //*****************************************************************************
 //
 void ServerCommands::MoveThing::Execute()
@@ -9097,7 +9163,7 @@ static void client_EarthQuake( BYTESTREAM_s *pByteStream )
 	LONG	lTremorRadius;
 
 	// Read in the center's network ID.
-	unsigned short netID = pByteStream->ReadShort();
+	unsigned int netID = pByteStream->ReadNetID();
 
 	// Read in the intensity of the quake.
 	lIntensity = pByteStream->ReadByte();
@@ -9292,7 +9358,7 @@ static void client_SetCameraToTexture( BYTESTREAM_s *pByteStream )
 	FTextureID	picNum;
 
 	// Read in the ID of the camera.
-	unsigned short netID = pByteStream->ReadShort();
+	unsigned int netID = pByteStream->ReadNetID();
 
 	// Read in the name of the texture.
 	pszTexture = pByteStream->ReadString();
@@ -9401,7 +9467,7 @@ static void client_DoPusher( BYTESTREAM_s *pByteStream )
 	const int iLineNum = pByteStream->ReadShort();
 	const int iMagnitude = pByteStream->ReadLong();
 	const int iAngle = pByteStream->ReadLong();
-	const unsigned short sourceNetID = pByteStream->ReadShort();
+	const unsigned int sourceNetID = pByteStream->ReadNetID();
 	const int iAffectee = pByteStream->ReadShort();
 
 	line_t *pLine = ( iLineNum >= 0 && iLineNum < numlines ) ? &lines[iLineNum] : NULL;
@@ -9431,9 +9497,9 @@ void ServerCommands::ReplaceTextures::Execute()
 //
 void APathFollower::InitFromStream ( BYTESTREAM_s *pByteStream )
 {
-	APathFollower *pPathFollower = static_cast<APathFollower*> ( CLIENT_FindThingByNetID( static_cast<unsigned short>( pByteStream->ReadShort() ) ) );
-	const unsigned short currNodeId = static_cast<unsigned short>(pByteStream->ReadShort());
-	const unsigned short prevNodeId = static_cast<unsigned short>(pByteStream->ReadShort());
+	APathFollower *pPathFollower = static_cast<APathFollower*> ( CLIENT_FindThingByNetID( pByteStream->ReadNetID() ) );
+	const unsigned int currNodeId = pByteStream->ReadNetID();
+	const unsigned int prevNodeId = pByteStream->ReadNetID();
 	const float serverTime = pByteStream->ReadFloat();
 
 	if ( pPathFollower )
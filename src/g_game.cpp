@@ -113,6 +113,7 @@
 #include "a_lightning.h"
 #include "po_man.h"
 #include "voicechat.h"
+#include "unlagged.h"
 
 #include <zlib.h>
 
@@ -3628,6 +3629,7 @@ void GAME_ResetMap( bool bRunEnterScripts )
 */
 		if ( sectors[ulIdx].bCeilingHeightChange )
 		{
+			UNLAGGED_SectorMoved( &sectors[ulIdx] );
 			sectors[ulIdx].ceilingplane = sectors[ulIdx].SavedCeilingPlane;
 			sectors[ulIdx].SetPlaneTexZ(sector_t::ceiling, sectors[ulIdx].SavedCeilingTexZ);
 			sectors[ulIdx].bCeilingHeightChange = false;
@@ -3647,6 +3649,7 @@ void GAME_ResetMap( bool bRunEnterScripts )
 */
 		if ( sectors[ulIdx].bFloorHeightChange )
 		{
+			UNLAGGED_SectorMoved( &sectors[ulIdx] );
 			sectors[ulIdx].floorplane = sectors[ulIdx].SavedFloorPlane;
 			sectors[ulIdx].SetPlaneTexZ(sector_t::floor, sectors[ulIdx].SavedFloorTexZ);
 			sectors[ulIdx].bFloorHeightChange = false;
@@ -1869,7 +1869,7 @@ void G_FinishTravel ()
 	TThinkerIterator<APlayerPawn> it (STAT_TRAVELLING);
 	APlayerPawn *pawn, *pawndup, *oldpawn, *next;
 	AInventory *inv;
-	unsigned short savedNetID = 0; // [BC]
+	unsigned int savedNetID = 0; // [BC]
 	bool doSweep = false; // [RK] Do a GC sweep
 
 	next = it.Next ();
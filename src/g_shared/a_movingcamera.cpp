@@ -201,7 +201,20 @@ void APathFollower::Serialize (FArchive &arc)
 	Super::Serialize (arc);
 	arc << bActive << bJustStepped << PrevNode << CurrNode << Time << HoldTime;
 	// [BB] Zandronum specific stuff.
-	arc << bPostBeginPlayCalled << bActivateCalledBeforePostBeginPlay << ServerPrevNodeId << ServerCurrNodeId << fServerTime;
+	arc << bPostBeginPlayCalled << bActivateCalledBeforePostBeginPlay;
+	// NetIDs are 32 bits wide now.
+	if (SaveVersion >= 4507)
+	{
+		arc << ServerPrevNodeId << ServerCurrNodeId;
+	}
+	else
+	{
+		WORD prevNodeId, currNodeId;
+		arc << prevNodeId << currNodeId;
+		ServerPrevNodeId = prevNodeId;
+		ServerCurrNodeId = currNodeId;
+	}
+	arc << fServerTime;
 }
 
 // Interpolate between p2 and p3 along a Catmull-Rom spline
@@ -48,7 +48,7 @@ protected:
 	bool bPostBeginPlayCalled;
 	bool bActivateCalledBeforePostBeginPlay;
 
-	unsigned short ServerPrevNodeId, ServerCurrNodeId;
+	unsigned int ServerPrevNodeId, ServerCurrNodeId;
 	float fServerTime;
 public:
 	bool IsActive () const;
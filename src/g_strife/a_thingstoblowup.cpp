@@ -89,6 +89,7 @@ DEFINE_ACTION_FUNCTION(AActor, A_LightGoesOut)
 
 	sec->SetLightLevel(0);
 
+	UNLAGGED_SectorMoved( sec );
 	fixed_t oldtheight = sec->floorplane.Zat0();
 	newheight = sec->FindLowestFloorSurrounding(&spot);
 	sec->floorplane.d = sec->floorplane.PointToDist (spot, newheight);
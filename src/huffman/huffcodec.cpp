@@ -70,7 +70,7 @@ namespace skulltag {
 		root->code = 0;
 		root->value = -1;
 		// recursive Huffman tree builder.
-		buildTree( root, treeData, 0, dataLength, codeTable, 256 );
+		if ( buildTree( root, treeData, 0, dataLength, codeTable, 256 ) >= 0 ) buildLookupTables();
 		huffResourceOwner = true;
 	}
 	
@@ -88,6 +88,7 @@ namespace skulltag {
 		root = treeRootNode;
 		codeTable = leafCodeTable;
 		huffResourceOwner = false;
+		buildLookupTables();
 	}
 	
 	/** Checks the ownership state of this HuffmanCodec's resources.
@@ -103,6 +104,64 @@ namespace skulltag {
 		reverseBits = false;
 		expandable = true;
 		huffResourceOwner = false;
+		decodeTable = 0;
+		decodeBits = 0;
+		encodeTable = 0;
+		useTables = true;
+	}
+
+	/** Builds decodeTable and encodeTable from the Huffman tree. <br>
+	 * Leaves the tables NULL if the tree can't be represented by them. */
+	void HuffmanCodec::buildLookupTables(){
+		if ( (root == 0) || (root->branch == 0) || (codeTable == 0) ) return;
+
+		// Every byte needs a code that fits into the bits of an unsigned int.
+		for ( int i = 0; i < 256; i++ ){
+			if ( (codeTable[i] == 0) || (codeTable[i]->bitCount > 32) ) return;
+		}
+
+		encodeTable = new EncodeEntry[256];
+		for ( int i = 0; i < 256; i++ ){
+			// Reverse the code so its first bit is the least significant one.
+			unsigned int reversed = 0;
+			for ( int bit = 0; bit < codeTable[i]->bitCount; bit++ ){
+				reversed |= ((codeTable[i]->code >> (codeTable[i]->bitCount - 1 - bit)) & 1) << bit;
+			}
+			encodeTable[i].code = reversed;
+			encodeTable[i].bitCount = codeTable[i]->bitCount;
+		}
+
+		// Resolve as many bits per lookup as the longest code needs, up to 12 bits (4096 entries).
+		int longestCode = 0;
+		maxCodeLength( root, longestCode );
+		decodeBits = (longestCode < 12) ? longestCode : 12;
+		decodeTable = new DecodeEntry[1 << decodeBits];
+		fillDecodeTable( root, 0, 0 );
+	}
+
+	/** Recursively fills the decodeTable entries for a node of the Huffman tree.
+	 * @param node		in: The node to fill the entries for.
+	 * @param depth		in: The depth of the node in the tree.
+	 * @param prefix	in: The path to the node, first bit in the least significant position. */
+	void HuffmanCodec::fillDecodeTable( HuffmanNode const * const node, int depth, unsigned int prefix ){
+		if ( node->branch == 0 ){
+			// A leaf: every index that starts with this code decodes to its value.
+			for ( unsigned int i = 0; i < (1u << (decodeBits - depth)); i++ ){
+				DecodeEntry &entry = decodeTable[ prefix | (i << depth) ];
+				entry.node = 0;
+				entry.value = (unsigned char)(node->value & 0xff);
+				entry.bitCount = (unsigned char)depth;
+			}
+		} else if ( depth == decodeBits ){
+			// The code is longer than the table, the decoder continues at this node.
+			DecodeEntry &entry = decodeTable[ prefix ];
+			entry.node = node;
+			entry.value = 0;
+			entry.bitCount = 0;
+		} else {
+			fillDecodeTable( &(node->branch[0]), depth + 1, prefix );
+			fillDecodeTable( &(node->branch[1]), depth + 1, prefix | (1u << depth) );
+		}
 	}
 	
 	/** Increases a codeLength up to the longest Huffman code bit length found in the node or any of its children. <br>
@@ -213,6 +272,17 @@ namespace skulltag {
 		unsigned char * const output,		/**< out: pointer to an output buffer to store data. */
 		int const &inLength,				/**< in: number of bytes of input buffer to encoded. */
 		int const &outLength				/**< in: maximum length of data to output. */
+	) const {
+		if ( useTables && (encodeTable != 0) ) return tableEncode( input, output, inLength, outLength );
+		return treeEncode( input, output, inLength, outLength );
+	}
+
+	/** Encodes data by walking the Huffman tree codes through the BitWriter. */
+	int HuffmanCodec::treeEncode(
+		unsigned char const * const input,
+		unsigned char * const output,
+		int const &inLength,
+		int const &outLength
 	) const {
 		// setup the bit buffer to output. if not expandable Limit output to input length.
 		if ( expandable ) writer->outputBuffer( output, outLength );
@@ -238,7 +308,61 @@ namespace skulltag {
 		}
 
 		return bytesWritten;
-	} // end function encode
+	} // end function treeEncode
+
+	/** Encodes data with encodeTable. <br>
+	 * The codes are gathered least significant bit first, which is the bit order of the reversed bytes
+	 * mode, so the output is identical to treeEncode() without any per-byte work in that mode. */
+	int HuffmanCodec::tableEncode(
+		unsigned char const * const input,
+		unsigned char * const output,
+		int const &inLength,
+		int const &outLength
+	) const {
+		// if not expandable Limit output to input length.
+		int maxBytes = outLength;
+		if ( !expandable && ((inLength + 1) < outLength) ) maxBytes = inLength + 1;
+		// there must at least be room for the padding signal, unless there's nothing to encode.
+		if ( maxBytes < 1 ) return (inLength > 0) ? -1 : 0;
+
+		unsigned long long bits = 0;	// bits that still need to be written.
+		int bitCount = 0;				// number of bits in bits.
+		int wIndex = 1;					// write index of the output buffer, after the padding signal.
+
+		for ( int i = 0; i < inLength; i++ ){
+			EncodeEntry const &entry = encodeTable[ 0xff & input[i] ];
+			bits |= (unsigned long long)entry.code << bitCount;
+			bitCount += entry.bitCount;
+
+			// Write out 4 bytes at once whenever there are enough bits for them.
+			if ( bitCount >= 32 ){
+				if ( (wIndex + 4) > maxBytes ) return -1;
+				output[wIndex++] = (unsigned char)bits;
+				output[wIndex++] = (unsigned char)(bits >> 8);
+				output[wIndex++] = (unsigned char)(bits >> 16);
+				output[wIndex++] = (unsigned char)(bits >> 24);
+				bits >>= 32;
+				bitCount -= 32;
+			}
+		}
+
+		// Write the remaining bits, the unused bits of the last byte are zero.
+		int padding = (8 - (bitCount & 7)) & 7;
+		if ( (wIndex + ((bitCount + 7) >> 3)) > maxBytes ) return -1;
+		while ( bitCount > 0 ){
+			output[wIndex++] = (unsigned char)bits;
+			bits >>= 8;
+			bitCount -= 8;
+		}
+		output[0] = (unsigned char)padding;
+
+		// The tree encoder writes the most significant bit first, match it if the bytes aren't reversed.
+		if ( !reverseBits ) for ( int i = 1; i < wIndex; i++ ){
+			output[i] = reverseMap[ output[i] ];
+		}
+
+		return wIndex;
+	} // end function tableEncode
 
 	/** Decodes data read from an input buffer and stores the result in the output buffer.
 	 * @return number of bytes stored in the output buffer or -1 if an error occurs while decoding. */
@@ -248,6 +372,17 @@ namespace skulltag {
 		int const &inLength,				/**< in: number of bytes of input buffer to read. */
 		int const &outLength				/**< in: maximum length of data to output. */
 	){
+		if ( useTables && (decodeTable != 0) ) return tableDecode( input, output, inLength, outLength );
+		return treeDecode( input, output, inLength, outLength );
+	}
+
+	/** Decodes data by walking the Huffman tree one bit at a time. */
+	int HuffmanCodec::treeDecode(
+		unsigned char const * const input,
+		unsigned char * const output,
+		int const &inLength,
+		int const &outLength
+	) const {
 		if ( inLength < 1 ) return 0;
 		int bitsAvailable = ((inLength-1) << 3) - (0xff & input[0]);
 		int rIndex = 1;		// read index of input buffer.
@@ -285,7 +420,77 @@ namespace skulltag {
 		}
 
 		return wIndex;
-	} // end function decode
+	} // end function treeDecode
+
+	/** Decodes data with decodeTable. <br>
+	 * Input bits are consumed least significant bit first (the reversed bytes order), each lookup
+	 * resolves a whole code of up to decodeBits bits. Longer codes continue walking the tree. */
+	int HuffmanCodec::tableDecode(
+		unsigned char const * const input,
+		unsigned char * const output,
+		int const &inLength,
+		int const &outLength
+	) const {
+		if ( inLength < 1 ) return 0;
+		int bitsAvailable = ((inLength-1) << 3) - (0xff & input[0]);
+		int rIndex = 1;					// read index of input buffer.
+		int wIndex = 0;					// write index of output buffer.
+		unsigned long long bits = 0;	// bits read from the input but not consumed yet.
+		int bitCount = 0;				// number of bits in bits.
+		unsigned int const mask = (1u << decodeBits) - 1;
+
+		while ( bitsAvailable > 0 ){
+			// Top up the bit buffer. Once the input runs out the missing bits read as zero,
+			// which is harmless since no code longer than bitsAvailable is accepted.
+			while ( (bitCount <= 56) && (rIndex < inLength) ){
+				unsigned char byte = input[rIndex++];
+				if ( !reverseBits ) byte = reverseMap[ byte ];
+				bits |= (unsigned long long)byte << bitCount;
+				bitCount += 8;
+			}
+
+			DecodeEntry const &entry = decodeTable[ bits & mask ];
+
+			if ( entry.node == 0 ){
+				// The code ends past the last valid bit, there's nothing left to output.
+				if ( entry.bitCount > bitsAvailable ) break;
+				// buffer overflow prevention
+				if ( wIndex >= outLength ) return wIndex;
+				output[ wIndex++ ] = entry.value;
+				bits >>= entry.bitCount;
+				bitCount -= entry.bitCount;
+				bitsAvailable -= entry.bitCount;
+				continue;
+			}
+
+			// The code is longer than the table, walk the tree from where the table left off.
+			if ( decodeBits >= bitsAvailable ) break;
+			bits >>= decodeBits;
+			bitCount -= decodeBits;
+			bitsAvailable -= decodeBits;
+
+			HuffmanNode const * node = entry.node;
+			while ( node->branch != 0 ){
+				if ( bitsAvailable <= 0 ) return wIndex;
+				if ( (bitCount <= 0) && (rIndex < inLength) ){
+					unsigned char byte = input[rIndex++];
+					if ( !reverseBits ) byte = reverseMap[ byte ];
+					bits = byte;
+					bitCount = 8;
+				}
+				node = &(node->branch[ bits & 1 ]);
+				bits >>= 1;
+				bitCount--;
+				bitsAvailable--;
+			}
+
+			// buffer overflow prevention
+			if ( wIndex >= outLength ) return wIndex;
+			output[ wIndex++ ] = (unsigned char)(node->value & 0xff);
+		}
+
+		return wIndex;
+	} // end function tableDecode
 
 	/** Deletes all sub nodes of a HuffmanNode by traversing and deleting its child nodes.
 	 * @param treeNode pointer to a HuffmanNode whos children will be deleted. */
@@ -301,6 +506,9 @@ namespace skulltag {
 	/** Destructor - frees resources. */
 	HuffmanCodec::~HuffmanCodec() {
 		delete writer;
+		// the lookup tables always belong to this HuffmanCodec.
+		delete[] decodeTable;
+		delete[] encodeTable;
 		//check for resource ownership before deletion
 		if ( huffmanResourceOwner() ){
 			delete[] codeTable;
@@ -325,5 +533,13 @@ namespace skulltag {
 	 * @return	 true: data expansion is allowed.  false: data is not allowed to expand. */
 	bool HuffmanCodec::allowExpansion(){ return expandable; }
 
+	/** Enable or Disable the table driven encoder and decoder. Both produce the same output as walking the tree.
+	 * @param enabled	"true" uses the lookup tables if they could be built. "false" always walks the tree. */
+	void HuffmanCodec::lookupTables( bool enabled ){ useTables = enabled; }
+
+	/** Check if the table driven encoder and decoder are used.
+	 * @return	 true: lookup tables are used.  false: the tree is walked bit by bit. */
+	bool HuffmanCodec::lookupTables(){ return useTables && (decodeTable != 0) && (encodeTable != 0); }
+
 
 }; // end namespace skulltag
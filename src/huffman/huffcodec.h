@@ -67,6 +67,29 @@ namespace skulltag {
 		/** Number of bits the shortest huffman code in the tree has. */
 		int shortestCode;	
 
+		/** Entry of the table used to decode several bits of input at once. */
+		struct DecodeEntry {
+			HuffmanNode const * node;	/**< branch node reached after decodeBits bits if the code is longer, otherwise NULL. */
+			unsigned char value;		/**< the decoded value if node is NULL. */
+			unsigned char bitCount;		/**< number of bits the code of the value uses if node is NULL. */
+		};
+
+		/** Entry of the table used to encode a byte in one step. */
+		struct EncodeEntry {
+			unsigned int code;			/**< Huffman code with its bit order reversed, so it can be written least significant bit first. */
+			int bitCount;				/**< number of bits in the Huffman code. */
+		};
+
+		/** Decoding table indexed by the next decodeBits bits of input, or NULL if the tables are unavailable. */
+		DecodeEntry * decodeTable;
+		/** Number of input bits resolved by one decodeTable lookup. */
+		int decodeBits;
+		/** Encoding table indexed by byte value. */
+		EncodeEntry * encodeTable;
+		/** When true encode() and decode() use the lookup tables instead of walking the tree. <br>
+		 * Default value is "true". */
+		bool useTables;
+
 	public:	
 
 		/** Creates a new HuffmanCodec from the Huffman tree data.
@@ -120,6 +143,14 @@ namespace skulltag {
 		 * @return	 true: data expansion is allowed.  false: data is not allowed to expand. */
 		bool allowExpansion();
 
+		/** Enable or Disable the table driven encoder and decoder. Both produce the same output as walking the tree.
+		 * @param enabled	"true" uses the lookup tables if they could be built. "false" always walks the tree. */
+		void lookupTables( bool enabled );
+
+		/** Check if the table driven encoder and decoder are used.
+		 * @return	 true: lookup tables are used.  false: the tree is walked bit by bit. */
+		bool lookupTables();
+
 		/** Sets the ownership of this HuffmanCodec's resources.
 		* @param ownsResources	When false the tree will not be released upon destruction of this HuffmanCodec.
 		* 						When true deleting this HuffmanCodec will cause the Huffman tree to be released. */
@@ -176,6 +207,48 @@ namespace skulltag {
 		/** Perform initialization procedures common to all constructors. */
 		void init();
 
+		/** Builds decodeTable and encodeTable from the Huffman tree. <br>
+		 * Leaves the tables NULL if the tree can't be represented by them. */
+		void buildLookupTables();
+
+		/** Recursively fills the decodeTable entries for a node of the Huffman tree.
+		 * @param node		in: The node to fill the entries for.
+		 * @param depth		in: The depth of the node in the tree.
+		 * @param prefix	in: The path to the node, first bit in the least significant position. */
+		void fillDecodeTable( HuffmanNode const * const node, int depth, unsigned int prefix );
+
+		/** Encodes data by walking the Huffman tree codes through the BitWriter. */
+		int treeEncode(
+			unsigned char const * const input,
+			unsigned char * const output,
+			int const &inLength,
+			int const &outLength
+		) const;
+
+		/** Encodes data with encodeTable. */
+		int tableEncode(
+			unsigned char const * const input,
+			unsigned char * const output,
+			int const &inLength,
+			int const &outLength
+		) const;
+
+		/** Decodes data by walking the Huffman tree one bit at a time. */
+		int treeDecode(
+			unsigned char const * const input,
+			unsigned char * const output,
+			int const &inLength,
+			int const &outLength
+		) const;
+
+		/** Decodes data with decodeTable. */
+		int tableDecode(
+			unsigned char const * const input,
+			unsigned char * const output,
+			int const &inLength,
+			int const &outLength
+		) const;
+
 	}; // end class Huffman Codec.
 } // end namespace skulltag
 
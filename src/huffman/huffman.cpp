@@ -95,6 +95,11 @@ void HUFFMAN_Destruct(){
 	__codec = NULL;
 }
 
+/** Selects between the table driven and the tree walking encoder and decoder. */
+void HUFFMAN_UseLookupTables( bool const &enabled ){
+	if ( __codec != NULL ) __codec->lookupTables( enabled );
+}
+
 /** Applies Huffman encoding to a block of data. */
 void HUFFMAN_Encode(
 	/** in: Pointer to start of data that is to be encoded. */
@@ -36,6 +36,12 @@ void HUFFMAN_Construct();
 /** Releases resources allocated by the HuffmanCodec. */
 void HUFFMAN_Destruct();
 
+/** Selects between the table driven and the tree walking encoder and decoder. <br>
+ * Both produce identical output, the tree is only kept for comparison. */
+void HUFFMAN_UseLookupTables(
+	bool const &enabled							/**< in: "true" uses the lookup tables, "false" walks the tree. */
+);
+
 /** Applies Huffman encoding to a block of data. */
 void HUFFMAN_Encode(
 	unsigned char const * const inputBuffer,	/**< in: Pointer to start of data that is to be encoded. */
@@ -261,12 +261,14 @@ MD5Transform(DWORD buf[4], const DWORD in[16])
 #include <errno.h>
 
 // [BB]
-bool MD5SumOfFile ( const char *Filename, char *MD5Sum )
+bool MD5SumOfFile ( const char *Filename, char *MD5Sum, bool bPrintErrors )
 {
 	FILE *file = fopen(Filename, "rb");
 	if (file == NULL)
 	{
-		Printf("%s: %s\n", Filename, strerror(errno));
+		if (bPrintErrors)
+			Printf("%s: %s\n", Filename, strerror(errno));
+		*MD5Sum = 0;
 		return false;
 	}
 	else
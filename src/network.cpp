@@ -60,6 +60,18 @@
 #endif
 #endif
 
+// Linux is able to receive and send several datagrams with a single system call.
+#ifdef __linux__
+#define NETWORK_HAVE_RECVMMSG
+#define NETWORK_HAVE_SENDMMSG
+#define NETWORK_HAVE_EPOLL
+#endif
+
+#ifdef NETWORK_HAVE_EPOLL
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -69,6 +81,13 @@
 #include <set>
 #include <vector>
 #include <string>
+#include <thread>
+#include <atomic>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#endif
 #include "../GeoIP/GeoIP.h"
 
 #include "c_console.h"
@@ -92,6 +111,8 @@
 #include "d_netinf.h"
 
 #include "md5.h"
+#include "stats.h"
+#include "m_misc.h"
 #include "network/sv_auth.h"
 #include "doomerrors.h"
 
@@ -157,13 +178,56 @@ struct AUTHENTICATELUMP_s
 
 void SERVERCONSOLE_UpdateIP( NETADDRESS_s LocalAddress );
 
+//*****************************************************************************
+//	DEFINES
+
+enum
+{
+	// Maximum number of datagrams that are received with one system call.
+	NETWORK_MAX_RECEIVE_BATCH = 64,
+
+	// Maximum number of datagrams that are sent with one system call.
+	NETWORK_MAX_SEND_BATCH = 64,
+
+	// Maximum number of datagrams the outbound queue holds before it's flushed.
+	NETWORK_MAX_OUTBOUND_PACKETS = 512,
+};
+
 //*****************************************************************************
 //	VARIABLES
 
+// How many datagrams the server tries to receive with one system call. Values
+// of 1 or less fall back to one recvfrom call per datagram.
+CUSTOM_CVAR( Int, sv_receivebatchsize, 32, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+{
+	if ( self > NETWORK_MAX_RECEIVE_BATCH )
+		self = NETWORK_MAX_RECEIVE_BATCH;
+}
+
+// Should the server collect the packets of a tic and send them all at once?
+CVAR( Bool, sv_batchoutboundpackets, true, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
 static	TArray<NetworkPWAD>	g_PWADs;
 static	TArray<NetworkPWAD>	g_AuthenticatedWADs; // [SB] All authenticated WAD files, including IWAD and engine PK3
 static	FString		g_IWAD; // [RC/BB] Which IWAD are we using?
 
+// Checksums of all loaded (non-nested) files, indexed by their wad number.
+static	TArray<FString>	g_WadChecksums;
+
+// Checksums from earlier runs, stored in the cache directory so that unchanged files don't
+// have to be read again. Files are keyed by their full path, the map collection checksum
+// by a hash of the checksums of all loaded files and the names of all maps.
+struct CHECKSUMCACHEENTRY_s
+{
+	QWORD	qwSize;
+	QWORD	qwModificationTime;
+	FString	Checksum;
+};
+
+static	TMap<FString, CHECKSUMCACHEENTRY_s>	g_FileChecksumCache;
+static	TMap<FString, FString>	g_MapCollectionChecksumCache;
+static	bool				g_bChecksumCacheLoaded = false;
+
 FString g_lumpsAuthenticationChecksum;
 FString g_MapCollectionChecksum;
 
@@ -192,6 +256,46 @@ static	USHORT			g_usLocalPort;
 // Buffer for the Huffman encoding.
 static	UCHAR			g_ucHuffmanBuffer[131072];
 
+#ifdef NETWORK_HAVE_RECVMMSG
+// One datagram received by recvmmsg, along with the address it came from. The
+// slot is as big as the largest packet g_NetworkMessage is able to accept.
+struct RECEIVEBATCHSLOT_s
+{
+	UCHAR			aucData[(MAX_UDP_PACKET * 8) / 3 + 1];
+	sockaddr_in		From;
+};
+
+// Ring of datagrams received by the last recvmmsg call.
+static	RECEIVEBATCHSLOT_s	g_aReceiveBatch[NETWORK_MAX_RECEIVE_BATCH];
+static	mmsghdr				g_aReceiveBatchHeaders[NETWORK_MAX_RECEIVE_BATCH];
+static	iovec				g_aReceiveBatchVectors[NETWORK_MAX_RECEIVE_BATCH];
+
+// How many datagrams the batch holds and which one is processed next.
+static	ULONG				g_ulReceiveBatchCount = 0;
+static	ULONG				g_ulReceiveBatchPosition = 0;
+#endif
+
+// An encoded datagram waiting in the outbound queue.
+struct OUTBOUNDPACKET_s
+{
+	ULONG			ulOffset;
+	ULONG			ulSize;
+	NETADDRESS_s	Address;
+};
+
+// Encoded datagrams that are sent when the outbound batch is flushed.
+static	UCHAR				g_aucOutboundData[262144];
+static	ULONG				g_ulOutboundDataSize = 0;
+static	OUTBOUNDPACKET_s	g_aOutboundPackets[NETWORK_MAX_OUTBOUND_PACKETS];
+static	ULONG				g_ulNumOutboundPackets = 0;
+
+// Is NETWORK_LaunchPacket queueing packets instead of sending them right away?
+static	bool				g_bBatchOutboundPackets = false;
+
+// File that the decoded payload of every Huffman-encoded packet is written to,
+// so that it can be fed to huffmanbenchmark later.
+static	FILE				*g_PacketCaptureFile = NULL;
+
 // Our local address;
 NETADDRESS_s	g_LocalAddress;
 
@@ -244,6 +348,8 @@ static const std::vector<std::string> g_FreedoomDehackedHashes = {
 //	PROTOTYPES
 
 static	void			network_InitPWADList( void );
+static	void			network_LoadChecksumCache( void );
+static	void			network_SaveChecksumCache( void );
 static	void			network_Error( const char *pszError );
 static	SOCKET			network_AllocateSocket( void );
 static	bool			network_BindSocketToPort( SOCKET Socket, ULONG ulInAddr, USHORT usPort, bool bReUse );
@@ -743,12 +849,143 @@ void NETWORK_Destruct( void )
 	g_LumpNumsToAuthenticate.Clear();
 }
 
+//*****************************************************************************
+//
+// Appends a decoded packet to the capture file as a 16-bit little-endian length
+// followed by the data.
+static void network_CapturePacket( const BYTE *pData, ULONG ulSize )
+{
+	const BYTE abLength[2] = { static_cast<BYTE>( ulSize & 0xFF ), static_cast<BYTE>(( ulSize >> 8 ) & 0xFF ) };
+
+	if ( ulSize > 0xFFFF )
+		return;
+
+	fwrite( abLength, 1, sizeof( abLength ), g_PacketCaptureFile );
+	fwrite( pData, 1, ulSize, g_PacketCaptureFile );
+}
+
+//*****************************************************************************
+//
+// Fills g_NetworkMessage from a raw datagram that was just read from the network
+// socket. Returns the size of the decoded message or 0 if the packet is ignored.
+static int network_ProcessReceivedPacket( const UCHAR *pData, LONG lNumBytes, const sockaddr &SocketFrom )
+{
+	INT					iDecodedNumBytes = sizeof(g_ucHuffmanBuffer);
+
+	// No packets or an error, so don't process anything.
+	if ( lNumBytes <= 0 )
+		return ( 0 );
+
+	// Record this for our statistics window.
+	if ( NETWORK_GetState( ) == NETSTATE_SERVER )
+		SERVER_STATISTIC_AddToInboundDataTransfer( lNumBytes );
+
+	// If the number of bytes we're receiving exceeds our buffer size, ignore the packet.
+	if ( lNumBytes >= static_cast<LONG>(g_NetworkMessage.ulMaxSize) )
+		return ( 0 );
+
+	// Store the IP address of the sender.
+	g_AddressFrom.LoadFromSocketAddress( SocketFrom );
+
+	// Decode the huffman-encoded message we received.
+	// [BB] Communication with the auth server is not Huffman-encoded.
+	if ( g_AddressFrom.Compare( NETWORK_AUTH_GetCachedServerAddress() ) == false )
+	{
+		HUFFMAN_Decode( pData, (unsigned char *)g_NetworkMessage.pbData, lNumBytes, &iDecodedNumBytes );
+		g_NetworkMessage.ulCurrentSize = iDecodedNumBytes;
+
+		if ( g_PacketCaptureFile )
+			network_CapturePacket( g_NetworkMessage.pbData, g_NetworkMessage.ulCurrentSize );
+	}
+	else
+	{
+		// [BB] We don't need to decode, so we just copy the data.
+		// Not very efficient, but this keeps the changes at a minimum for now.
+		memcpy ( g_NetworkMessage.pbData, pData, lNumBytes );
+		g_NetworkMessage.ulCurrentSize = lNumBytes;
+	}
+	g_NetworkMessage.ByteStream.pbStream = g_NetworkMessage.pbData;
+	g_NetworkMessage.ByteStream.pbStreamEnd = g_NetworkMessage.ByteStream.pbStream + g_NetworkMessage.ulCurrentSize;
+	g_NetworkMessage.ByteStream.bitBuffer = NULL;
+	g_NetworkMessage.ByteStream.bitShift = -1;
+
+	return ( g_NetworkMessage.ulCurrentSize );
+}
+
+#ifdef NETWORK_HAVE_RECVMMSG
+//*****************************************************************************
+//
+// Pulls up to sv_receivebatchsize datagrams from the socket with a single
+// recvmmsg call. Returns the number of datagrams now waiting in the batch.
+static unsigned int network_FillReceiveBatch( void )
+{
+	const unsigned int batchSize = clamp<int>( sv_receivebatchsize, 1, NETWORK_MAX_RECEIVE_BATCH );
+
+	for ( unsigned int i = 0; i < batchSize; i++ )
+	{
+		g_aReceiveBatchVectors[i].iov_base = g_aReceiveBatch[i].aucData;
+		g_aReceiveBatchVectors[i].iov_len = sizeof( g_aReceiveBatch[i].aucData );
+
+		memset( &g_aReceiveBatchHeaders[i], 0, sizeof( g_aReceiveBatchHeaders[i] ));
+		g_aReceiveBatchHeaders[i].msg_hdr.msg_name = &g_aReceiveBatch[i].From;
+		g_aReceiveBatchHeaders[i].msg_hdr.msg_namelen = sizeof( g_aReceiveBatch[i].From );
+		g_aReceiveBatchHeaders[i].msg_hdr.msg_iov = &g_aReceiveBatchVectors[i];
+		g_aReceiveBatchHeaders[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	g_ulReceiveBatchPosition = 0;
+	g_ulReceiveBatchCount = 0;
+
+	const int result = recvmmsg( g_NetworkSocket, g_aReceiveBatchHeaders, batchSize, MSG_DONTWAIT, NULL );
+
+	if ( result == -1 )
+	{
+		SERVER_STATISTIC_AddToReceiveCalls( 0 );
+
+		if (( errno != EWOULDBLOCK ) && ( errno != EAGAIN ) && ( errno != ECONNREFUSED ))
+			Printf( "NETWORK_GetPackets: WARNING!: Error #%d: %s\n", errno, strerror( errno ));
+
+		return ( 0 );
+	}
+
+	g_ulReceiveBatchCount = result;
+	SERVER_STATISTIC_AddToReceiveCalls( g_ulReceiveBatchCount );
+	return ( g_ulReceiveBatchCount );
+}
+
+//*****************************************************************************
+//
+// Hands out the next datagram of the current batch, refilling the batch from
+// the socket once all of its datagrams have been processed.
+static int network_GetBatchedPacket( void )
+{
+	while (( g_ulReceiveBatchPosition < g_ulReceiveBatchCount ) || ( network_FillReceiveBatch( ) > 0 ))
+	{
+		const ULONG ulSlot = g_ulReceiveBatchPosition++;
+		const mmsghdr &header = g_aReceiveBatchHeaders[ulSlot];
+
+		// The datagram didn't fit into the slot, so it's oversized anyway. Drop it
+		// without a message, anyone can send these.
+		if ( header.msg_hdr.msg_flags & MSG_TRUNC )
+			continue;
+
+		const int size = network_ProcessReceivedPacket( g_aReceiveBatch[ulSlot].aucData, header.msg_len,
+			reinterpret_cast<const sockaddr&>( g_aReceiveBatch[ulSlot].From ));
+
+		// Skip packets that were ignored, but keep going through the batch.
+		if ( size > 0 )
+			return ( size );
+	}
+
+	return ( 0 );
+}
+#endif
+
 //*****************************************************************************
 //
 int NETWORK_GetPackets( void )
 {
 	LONG				lNumBytes;
-	INT					iDecodedNumBytes = sizeof(g_ucHuffmanBuffer);
 	sockaddr			SocketFrom;
 	INT					iSocketFromLength;
 
@@ -758,6 +995,13 @@ int NETWORK_GetPackets( void )
 	if ( g_NetworkSocket == INVALID_SOCKET )
 		return ( 0 );
 
+#ifdef NETWORK_HAVE_RECVMMSG
+	// The server pulls several datagrams per system call, since it receives
+	// packets from every client each tic.
+	if (( NETWORK_GetState( ) == NETSTATE_SERVER ) && ( sv_receivebatchsize > 1 ))
+		return ( network_GetBatchedPacket( ));
+#endif
+
 #ifdef	WIN32
 	lNumBytes = recvfrom( g_NetworkSocket, (char *)g_ucHuffmanBuffer, sizeof( g_ucHuffmanBuffer ), 0, &SocketFrom, &iSocketFromLength );
 #else
@@ -767,6 +1011,9 @@ int NETWORK_GetPackets( void )
 	// If the number of bytes returned is -1, an error has occured.
 	if ( lNumBytes == -1 ) 
 	{ 
+		if ( NETWORK_GetState( ) == NETSTATE_SERVER )
+			SERVER_STATISTIC_AddToReceiveCalls( 0 );
+
 #ifdef __WIN32__
 		errno = WSAGetLastError( );
 
@@ -797,41 +1044,10 @@ int NETWORK_GetPackets( void )
 #endif
 	}
 
-	// No packets or an error, so don't process anything.
-	if ( lNumBytes <= 0 )
-		return ( 0 );
-
-	// Record this for our statistics window.
 	if ( NETWORK_GetState( ) == NETSTATE_SERVER )
-		SERVER_STATISTIC_AddToInboundDataTransfer( lNumBytes );
+		SERVER_STATISTIC_AddToReceiveCalls( lNumBytes > 0 ? 1 : 0 );
 
-	// If the number of bytes we're receiving exceeds our buffer size, ignore the packet.
-	if ( lNumBytes >= static_cast<LONG>(g_NetworkMessage.ulMaxSize) )
-		return ( 0 );
-
-	// Store the IP address of the sender.
-	g_AddressFrom.LoadFromSocketAddress( SocketFrom );
-
-	// Decode the huffman-encoded message we received.
-	// [BB] Communication with the auth server is not Huffman-encoded.
-	if ( g_AddressFrom.Compare( NETWORK_AUTH_GetCachedServerAddress() ) == false )
-	{
-		HUFFMAN_Decode( g_ucHuffmanBuffer, (unsigned char *)g_NetworkMessage.pbData, lNumBytes, &iDecodedNumBytes );
-		g_NetworkMessage.ulCurrentSize = iDecodedNumBytes;
-	}
-	else
-	{
-		// [BB] We don't need to decode, so we just copy the data.
-		// Not very efficient, but this keeps the changes at a minimum for now.
-		memcpy ( g_NetworkMessage.pbData, g_ucHuffmanBuffer, lNumBytes );
-		g_NetworkMessage.ulCurrentSize = lNumBytes;
-	}
-	g_NetworkMessage.ByteStream.pbStream = g_NetworkMessage.pbData;
-	g_NetworkMessage.ByteStream.pbStreamEnd = g_NetworkMessage.ByteStream.pbStream + g_NetworkMessage.ulCurrentSize;
-	g_NetworkMessage.ByteStream.bitBuffer = NULL;
-	g_NetworkMessage.ByteStream.bitShift = -1;
-
-	return ( g_NetworkMessage.ulCurrentSize );
+	return ( network_ProcessReceivedPacket( g_ucHuffmanBuffer, lNumBytes, SocketFrom ));
 }
 
 //*****************************************************************************
@@ -932,83 +1148,220 @@ NETADDRESS_s NETWORK_GetFromAddress( void )
 
 //*****************************************************************************
 //
-void NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address )
+// Huffman-encodes the packet into pOutput, unless it goes to the auth server.
+// pOutput must be able to hold at least one byte more than the packet itself.
+static int network_EncodePacket( NETBUFFER_s *pBuffer, const NETADDRESS_s &Address, UCHAR *pOutput, int iOutputSize )
 {
-	LONG				lNumBytes;
-	INT					iNumBytesOut = sizeof(g_ucHuffmanBuffer);
-
-	pBuffer->ulCurrentSize = pBuffer->CalcSize();
-
-	// Nothing to do.
-	if ( pBuffer->ulCurrentSize == 0 )
-		return;
-
-	// Convert the IP address to a socket address.
-	struct sockaddr_in SocketAddress;
-	Address.ToSocketAddress( reinterpret_cast<sockaddr&>(SocketAddress) );
+	INT					iNumBytesOut = iOutputSize;
 
 	// [BB] Communication with the auth server is not Huffman-encoded.
 	if ( Address.Compare( NETWORK_AUTH_GetCachedServerAddress() ) == false )
-		HUFFMAN_Encode( (unsigned char *)pBuffer->pbData, g_ucHuffmanBuffer, pBuffer->ulCurrentSize, &iNumBytesOut );
+	{
+		HUFFMAN_Encode( (unsigned char *)pBuffer->pbData, pOutput, pBuffer->ulCurrentSize, &iNumBytesOut );
+
+		if ( g_PacketCaptureFile )
+			network_CapturePacket( pBuffer->pbData, pBuffer->ulCurrentSize );
+	}
 	else
 	{
 		// [BB] We don't need to encode, so we just copy the data.
 		// Not very efficient, but this keeps the changes at a minimum for now.
-		memcpy ( g_ucHuffmanBuffer, pBuffer->pbData, pBuffer->ulCurrentSize );
+		memcpy ( pOutput, pBuffer->pbData, pBuffer->ulCurrentSize );
 		iNumBytesOut = pBuffer->ulCurrentSize;
 	}
 
-	lNumBytes = sendto( g_NetworkSocket, (const char*)g_ucHuffmanBuffer, iNumBytesOut, 0, reinterpret_cast<sockaddr*>(&SocketAddress), sizeof( SocketAddress ));
+	return ( iNumBytesOut );
+}
 
-	// If sendto returns -1, there was an error.
-	if ( lNumBytes == -1 )
-	{
+//*****************************************************************************
+//
+// Reports why sending a datagram to Address failed. Returns false if the
+// failure is silent and the caller should just move on.
+static bool network_HandleSendError( const NETADDRESS_s &Address )
+{
 #ifdef __WIN32__
-		INT	iError = WSAGetLastError( );
+	INT	iError = WSAGetLastError( );
 
-		// Wouldblock is silent.
-		if ( iError == WSAEWOULDBLOCK )
-			return;
+	// Wouldblock is silent.
+	if ( iError == WSAEWOULDBLOCK )
+		return ( false );
 
-		switch ( iError )
-		{
-		case WSAEACCES:
+	switch ( iError )
+	{
+	case WSAEACCES:
 
-			Printf( "NETWORK_LaunchPacket: Error #%d, WSAEACCES: Permission denied for address: %s\n", iError, Address.ToString() );
-			return;
-		case WSAEAFNOSUPPORT:
+		Printf( "NETWORK_LaunchPacket: Error #%d, WSAEACCES: Permission denied for address: %s\n", iError, Address.ToString() );
+		return ( false );
+	case WSAEAFNOSUPPORT:
 
-			Printf( "NETWORK_LaunchPacket: Error #%d, WSAEAFNOSUPPORT: Address %s incompatible with the requested protocol\n", iError, Address.ToString() );
-			return;
-		case WSAEADDRNOTAVAIL:
+		Printf( "NETWORK_LaunchPacket: Error #%d, WSAEAFNOSUPPORT: Address %s incompatible with the requested protocol\n", iError, Address.ToString() );
+		return ( false );
+	case WSAEADDRNOTAVAIL:
 
-			Printf( "NETWORK_LaunchPacket: Error #%d, WSAEADDRENOTAVAIL: Address %s not available\n", iError, Address.ToString() );
-			return;
-		case WSAEHOSTUNREACH:
+		Printf( "NETWORK_LaunchPacket: Error #%d, WSAEADDRENOTAVAIL: Address %s not available\n", iError, Address.ToString() );
+		return ( false );
+	case WSAEHOSTUNREACH:
 
-			Printf( "NETWORK_LaunchPacket: Error #%d, WSAEHOSTUNREACH: Address %s unreachable\n", iError, Address.ToString() );
-			return;				
-		default:
+		Printf( "NETWORK_LaunchPacket: Error #%d, WSAEHOSTUNREACH: Address %s unreachable\n", iError, Address.ToString() );
+		return ( false );
+	default:
 
-			Printf( "NETWORK_LaunchPacket: Error #%d\n", iError );
-			return;
-		}
+		Printf( "NETWORK_LaunchPacket: Error #%d\n", iError );
+		return ( false );
+	}
 #else
 	if ( errno == EWOULDBLOCK )
-return;
-
-          if ( errno == ECONNREFUSED )
-              return;
+		return ( false );
 
-		Printf( "NETWORK_LaunchPacket: %s\n", strerror( errno ));
-		Printf( "NETWORK_LaunchPacket: Address %s\n", Address.ToString() );
+	if ( errno == ECONNREFUSED )
+		return ( false );
 
+	Printf( "NETWORK_LaunchPacket: %s\n", strerror( errno ));
+	Printf( "NETWORK_LaunchPacket: Address %s\n", Address.ToString() );
+	return ( true );
 #endif
-	}
+}
+
+//*****************************************************************************
+//
+static void network_SendDatagram( const UCHAR *pData, int iSize, const NETADDRESS_s &Address )
+{
+	LONG				lNumBytes;
+
+	// Convert the IP address to a socket address.
+	struct sockaddr_in SocketAddress;
+	Address.ToSocketAddress( reinterpret_cast<sockaddr&>(SocketAddress) );
+
+	lNumBytes = sendto( g_NetworkSocket, (const char*)pData, iSize, 0, reinterpret_cast<sockaddr*>(&SocketAddress), sizeof( SocketAddress ));
+
+	// If sendto returns -1, there was an error.
+	if (( lNumBytes == -1 ) && ( network_HandleSendError( Address ) == false ))
+		return;
 
 	// Record this for our statistics window.
 	if ( NETWORK_GetState( ) == NETSTATE_SERVER )
+	{
+		SERVER_STATISTIC_AddToSendCalls( 1 );
 		SERVER_STATISTIC_AddToOutboundDataTransfer( lNumBytes );
+	}
+}
+
+//*****************************************************************************
+//
+void NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address )
+{
+	pBuffer->ulCurrentSize = pBuffer->CalcSize();
+
+	// Nothing to do.
+	if ( pBuffer->ulCurrentSize == 0 )
+		return;
+
+	// While an outbound batch is open, encode the packet straight into the
+	// outbound queue. The encoded packet is at most one byte larger than the input.
+	if ( g_bBatchOutboundPackets && ( pBuffer->ulCurrentSize + 1 <= sizeof( g_aucOutboundData )))
+	{
+		if (( g_ulNumOutboundPackets == NETWORK_MAX_OUTBOUND_PACKETS )
+			|| ( g_ulOutboundDataSize + pBuffer->ulCurrentSize + 1 > sizeof( g_aucOutboundData )))
+		{
+			NETWORK_FlushOutboundBatch( );
+		}
+
+		OUTBOUNDPACKET_s &packet = g_aOutboundPackets[g_ulNumOutboundPackets++];
+		packet.ulOffset = g_ulOutboundDataSize;
+		packet.ulSize = network_EncodePacket( pBuffer, Address, g_aucOutboundData + g_ulOutboundDataSize, sizeof( g_aucOutboundData ) - g_ulOutboundDataSize );
+		packet.Address = Address;
+		g_ulOutboundDataSize += packet.ulSize;
+		return;
+	}
+
+	// Don't let this packet overtake the ones that are still queued.
+	if ( g_ulNumOutboundPackets > 0 )
+		NETWORK_FlushOutboundBatch( );
+
+	const int iNumBytesOut = network_EncodePacket( pBuffer, Address, g_ucHuffmanBuffer, sizeof( g_ucHuffmanBuffer ));
+	network_SendDatagram( g_ucHuffmanBuffer, iNumBytesOut, Address );
+}
+
+//*****************************************************************************
+//
+// From now on, NETWORK_LaunchPacket only queues the encoded packets until
+// NETWORK_FlushOutboundBatch is called.
+void NETWORK_BeginOutboundBatch( void )
+{
+	g_bBatchOutboundPackets = sv_batchoutboundpackets;
+}
+
+//*****************************************************************************
+//
+// Sends all queued packets and closes the outbound batch.
+void NETWORK_EndOutboundBatch( void )
+{
+	NETWORK_FlushOutboundBatch( );
+	g_bBatchOutboundPackets = false;
+}
+
+//*****************************************************************************
+//
+// Sends all queued packets, with as few system calls as the platform allows.
+void NETWORK_FlushOutboundBatch( void )
+{
+#ifdef NETWORK_HAVE_SENDMMSG
+	sockaddr_in	aSocketAddresses[NETWORK_MAX_SEND_BATCH];
+	iovec		aVectors[NETWORK_MAX_SEND_BATCH];
+	mmsghdr		aHeaders[NETWORK_MAX_SEND_BATCH];
+	ULONG		ulFirst = 0;
+
+	while ( ulFirst < g_ulNumOutboundPackets )
+	{
+		const ULONG ulCount = MIN<ULONG>( g_ulNumOutboundPackets - ulFirst, NETWORK_MAX_SEND_BATCH );
+
+		for ( ULONG i = 0; i < ulCount; i++ )
+		{
+			const OUTBOUNDPACKET_s &packet = g_aOutboundPackets[ulFirst + i];
+
+			packet.Address.ToSocketAddress( reinterpret_cast<sockaddr&>( aSocketAddresses[i] ));
+			aVectors[i].iov_base = g_aucOutboundData + packet.ulOffset;
+			aVectors[i].iov_len = packet.ulSize;
+
+			memset( &aHeaders[i], 0, sizeof( aHeaders[i] ));
+			aHeaders[i].msg_hdr.msg_name = &aSocketAddresses[i];
+			aHeaders[i].msg_hdr.msg_namelen = sizeof( aSocketAddresses[i] );
+			aHeaders[i].msg_hdr.msg_iov = &aVectors[i];
+			aHeaders[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		const int result = sendmmsg( g_NetworkSocket, aHeaders, ulCount, 0 );
+
+		// sendmmsg only fails if the very first datagram couldn't be sent. Report
+		// it like sendto would have and carry on with the rest.
+		if ( result <= 0 )
+		{
+			network_HandleSendError( g_aOutboundPackets[ulFirst].Address );
+			ulFirst++;
+			continue;
+		}
+
+		// Record this for our statistics window.
+		if ( NETWORK_GetState( ) == NETSTATE_SERVER )
+		{
+			SERVER_STATISTIC_AddToSendCalls( result );
+
+			for ( int i = 0; i < result; i++ )
+				SERVER_STATISTIC_AddToOutboundDataTransfer( aHeaders[i].msg_len );
+		}
+
+		ulFirst += result;
+	}
+#else
+	for ( ULONG i = 0; i < g_ulNumOutboundPackets; i++ )
+	{
+		const OUTBOUNDPACKET_s &packet = g_aOutboundPackets[i];
+		network_SendDatagram( g_aucOutboundData + packet.ulOffset, packet.ulSize, packet.Address );
+	}
+#endif
+
+	g_ulNumOutboundPackets = 0;
+	g_ulOutboundDataSize = 0;
 }
 
 //*****************************************************************************
@@ -1402,6 +1755,35 @@ void network_ParseLumpAuthenticationMode( FScanner &sc, LumpAuthenticationMode &
 FString NETWORK_MapCollectionChecksum( )
 {
 	FString longSum, fullSum;
+	FString cacheKey;
+	cycle_t checksumTime;
+
+	checksumTime.Reset( );
+	checksumTime.Clock( );
+
+	// The checksum only depends on the maps in the loaded files, so if all of them are
+	// unchanged, we can reuse the checksum we computed the last time.
+	if ( g_WadChecksums.Size( ) > 0 )
+	{
+		FString longKey;
+
+		for ( unsigned i = 0; i < g_WadChecksums.Size( ); i++ )
+			longKey.AppendFormat( "%u:%s;", i, g_WadChecksums[i].GetChars( ));
+		for ( unsigned i = 0; i < wadlevelinfos.Size( ); i++ )
+			longKey.AppendFormat( "%s;", wadlevelinfos[i].mapname );
+
+		CMD5Checksum::GetMD5( reinterpret_cast<const BYTE *>( longKey.GetChars( )), longKey.Len( ), cacheKey );
+
+		network_LoadChecksumCache( );
+		const FString *cachedSum = g_MapCollectionChecksumCache.CheckKey( cacheKey );
+		if ( cachedSum != NULL )
+		{
+			checksumTime.Unclock( );
+			DPrintf( "Map collection checksum taken from the cache (%.1f ms).\n", checksumTime.TimeMS( ));
+			return *cachedSum;
+		}
+	}
+
 	for( unsigned i = 0; i < wadlevelinfos.Size( ); i++ )
 	{
 		char* mname = wadlevelinfos[i].mapname;
@@ -1426,6 +1808,15 @@ FString NETWORK_MapCollectionChecksum( )
 
 	CMD5Checksum::GetMD5( reinterpret_cast<const BYTE *>( longSum.GetChars( ) ),
 		longSum.Len( ), fullSum );
+
+	if ( cacheKey.IsNotEmpty( ))
+	{
+		g_MapCollectionChecksumCache[cacheKey] = fullSum;
+		network_SaveChecksumCache( );
+	}
+
+	checksumTime.Unclock( );
+	DPrintf( "Map collection checksum computed in %.1f ms.\n", checksumTime.TimeMS( ));
 	return fullSum;
 }
 
@@ -1753,6 +2144,238 @@ void NETWORK_SetState( LONG lState )
 //*****************************************************************************
 //*****************************************************************************
 //
+//*****************************************************************************
+//
+static bool network_GetFileSizeAndTime( const char *pszFileName, QWORD &qwSize, QWORD &qwModificationTime )
+{
+#ifdef _WIN32
+	struct _stati64 fileInfo;
+	if ( _stati64( pszFileName, &fileInfo ) != 0 )
+		return false;
+#else
+	struct stat fileInfo;
+	if ( stat( pszFileName, &fileInfo ) != 0 )
+		return false;
+#endif
+
+	qwSize = static_cast<QWORD>( fileInfo.st_size );
+	qwModificationTime = static_cast<QWORD>( fileInfo.st_mtime );
+	return true;
+}
+
+//*****************************************************************************
+//
+static FString network_GetChecksumCacheFileName( bool bCreate )
+{
+	FString path = M_GetCachePath( bCreate );
+	if ( bCreate )
+		CreatePath( path );
+
+	path += "/checksums.txt";
+	return path;
+}
+
+//*****************************************************************************
+//
+// Reads the checksum cache. Every line is either
+//   file <size> <modification time> <checksum> <full path>
+// or
+//   maps <key> <checksum>
+static void network_LoadChecksumCache( void )
+{
+	if ( g_bChecksumCacheLoaded )
+		return;
+
+	g_bChecksumCacheLoaded = true;
+
+	FILE *pFile = fopen( network_GetChecksumCacheFileName( false ), "r" );
+	if ( pFile == NULL )
+		return;
+
+	char szLine[1024];
+	while ( fgets( szLine, sizeof( szLine ), pFile ) != NULL )
+	{
+		unsigned long long size, modificationTime;
+		char szChecksum[33], szKey[33];
+		int pathStart = 0;
+
+		// Get rid of the line break.
+		szLine[strcspn( szLine, "\r\n" )] = 0;
+
+		if (( sscanf( szLine, "file %llu %llu %32s %n", &size, &modificationTime, szChecksum, &pathStart ) == 3 ) && ( pathStart > 0 ))
+		{
+			CHECKSUMCACHEENTRY_s entry;
+			entry.qwSize = size;
+			entry.qwModificationTime = modificationTime;
+			entry.Checksum = szChecksum;
+			g_FileChecksumCache[szLine + pathStart] = entry;
+		}
+		else if ( sscanf( szLine, "maps %32s %32s", szKey, szChecksum ) == 2 )
+		{
+			g_MapCollectionChecksumCache[szKey] = szChecksum;
+		}
+	}
+
+	fclose( pFile );
+}
+
+//*****************************************************************************
+//
+// Writes the cache to a temporary file first, so that another instance reading it, or a crash
+// while writing, never sees a half-written cache.
+static void network_SaveChecksumCache( void )
+{
+	const FString path = network_GetChecksumCacheFileName( true );
+	FString temppath;
+	temppath.Format( "%s.%d.tmp", path.GetChars( ), static_cast<int>( getpid( )));
+
+	FILE *pFile = fopen( temppath, "w" );
+	if ( pFile == NULL )
+		return;
+
+	fprintf( pFile, "# " GAMENAME " checksum cache. Safe to delete.\n" );
+
+	TMap<FString, CHECKSUMCACHEENTRY_s>::Iterator fileIt( g_FileChecksumCache );
+	TMap<FString, CHECKSUMCACHEENTRY_s>::Pair *filePair;
+	while ( fileIt.NextPair( filePair ))
+	{
+		fprintf( pFile, "file %llu %llu %s %s\n", static_cast<unsigned long long>( filePair->Value.qwSize ),
+			static_cast<unsigned long long>( filePair->Value.qwModificationTime ), filePair->Value.Checksum.GetChars( ), filePair->Key.GetChars( ));
+	}
+
+	TMap<FString, FString>::Iterator mapIt( g_MapCollectionChecksumCache );
+	TMap<FString, FString>::Pair *mapPair;
+	while ( mapIt.NextPair( mapPair ))
+		fprintf( pFile, "maps %s %s\n", mapPair->Key.GetChars( ), mapPair->Value.GetChars( ));
+
+	const bool bWritten = ( ferror( pFile ) == 0 );
+	if (( fclose( pFile ) != 0 ) || ( bWritten == false ))
+	{
+		remove( temppath );
+		return;
+	}
+
+#ifdef _WIN32
+	remove( path );
+#endif
+	if ( rename( temppath, path ) != 0 )
+		remove( temppath );
+}
+
+//*****************************************************************************
+//
+// Fills g_WadChecksums with the MD5 sums of all loaded files. Files that didn't change since
+// their checksum was cached are not read at all, the others are hashed by several threads.
+static void network_ComputeWadChecksums( void )
+{
+	struct ChecksumJob
+	{
+		ULONG		ulWad;
+		const char	*pszFileName;
+		QWORD		qwSize;
+		QWORD		qwModificationTime;
+		bool		bHaveFileInfo;
+		bool		bSuccess;
+		char		szChecksum[33];
+	};
+
+	cycle_t totalTime, hashTime;
+	std::vector<ChecksumJob> jobs;
+	unsigned int numCached = 0;
+
+	totalTime.Reset( );
+	hashTime.Reset( );
+	totalTime.Clock( );
+
+	network_LoadChecksumCache( );
+	g_WadChecksums.Clear( );
+
+	for ( ULONG ulIdx = 0; Wads.GetWadName( ulIdx ) != NULL; ulIdx++ )
+	{
+		g_WadChecksums.Push( FString( ));
+
+		// Nested files are part of their parent's checksum.
+		if ( Wads.GetParentWad( ulIdx ) != static_cast<int>( ulIdx ))
+			continue;
+
+		ChecksumJob job;
+		job.ulWad = ulIdx;
+		job.pszFileName = Wads.GetWadFullName( ulIdx );
+		job.bHaveFileInfo = network_GetFileSizeAndTime( job.pszFileName, job.qwSize, job.qwModificationTime );
+		job.bSuccess = false;
+		job.szChecksum[0] = 0;
+
+		if ( job.bHaveFileInfo )
+		{
+			const CHECKSUMCACHEENTRY_s *entry = g_FileChecksumCache.CheckKey( job.pszFileName );
+			if (( entry != NULL ) && ( entry->qwSize == job.qwSize ) && ( entry->qwModificationTime == job.qwModificationTime ))
+			{
+				g_WadChecksums[ulIdx] = entry->Checksum;
+				numCached++;
+				continue;
+			}
+		}
+
+		jobs.push_back( job );
+	}
+
+	// The workers must not touch anything but their jobs, so all the console output
+	// and cache updates are done here afterwards.
+	const unsigned int numThreads = MIN<unsigned int>( MAX<unsigned int>( std::thread::hardware_concurrency( ), 1 ), static_cast<unsigned int>( jobs.size( )));
+
+	if ( jobs.size( ) > 0 )
+	{
+		std::atomic<unsigned int> nextJob( 0 );
+		auto worker = [&jobs, &nextJob]( )
+		{
+			for ( unsigned int i = nextJob++; i < jobs.size( ); i = nextJob++ )
+				jobs[i].bSuccess = MD5SumOfFile( jobs[i].pszFileName, jobs[i].szChecksum, false );
+		};
+
+		hashTime.Clock( );
+		std::vector<std::thread> threads;
+		for ( unsigned int i = 1; i < numThreads; i++ )
+			threads.push_back( std::thread( worker ));
+		worker( );
+		for ( unsigned int i = 0; i < threads.size( ); i++ )
+			threads[i].join( );
+		hashTime.Unclock( );
+	}
+
+	for ( unsigned int i = 0; i < jobs.size( ); i++ )
+	{
+		if ( jobs[i].bSuccess == false )
+		{
+			Printf( "%s: Couldn't read the file to compute its checksum.\n", jobs[i].pszFileName );
+			continue;
+		}
+
+		g_WadChecksums[jobs[i].ulWad] = jobs[i].szChecksum;
+
+		if ( jobs[i].bHaveFileInfo )
+		{
+			CHECKSUMCACHEENTRY_s entry;
+			entry.qwSize = jobs[i].qwSize;
+			entry.qwModificationTime = jobs[i].qwModificationTime;
+			entry.Checksum = jobs[i].szChecksum;
+			g_FileChecksumCache[jobs[i].pszFileName] = entry;
+		}
+	}
+
+	if ( jobs.size( ) > 0 )
+		network_SaveChecksumCache( );
+
+	totalTime.Unclock( );
+
+	// Servers restart often enough that it's worth showing where the startup time goes.
+	const char *pszFormat = "Checksummed %u files in %.1f ms: %u from the cache, %u hashed by %u thread%s in %.1f ms.\n";
+	const unsigned int numHashed = static_cast<unsigned int>( jobs.size( ));
+	if ( NETWORK_GetState( ) == NETSTATE_SERVER )
+		Printf( pszFormat, numCached + numHashed, totalTime.TimeMS( ), numCached, numHashed, numThreads, ( numThreads == 1 ) ? "" : "s", hashTime.TimeMS( ));
+	else
+		DPrintf( pszFormat, numCached + numHashed, totalTime.TimeMS( ), numCached, numHashed, numThreads, ( numThreads == 1 ) ? "" : "s", hashTime.TimeMS( ));
+}
+
 //*****************************************************************************
 // [RC]
 static void network_InitPWADList( void )
@@ -1777,6 +2400,8 @@ static void network_InitPWADList( void )
 
 	g_IWAD = Wads.GetWadName( ulRealIWADIdx );
 
+	network_ComputeWadChecksums( );
+
 	// Collect all the PWADs into a list.
 	for ( ULONG ulIdx = 0; Wads.GetWadName( ulIdx ) != NULL; ulIdx++ )
 	{
@@ -1789,12 +2414,9 @@ static void network_InitPWADList( void )
 		const bool bIsIwad = ( ulIdx == ulRealIWADIdx );
 		const bool bIsBaseWad = ( stricmp( Wads.GetWadName( ulIdx ), BASEWAD ) == 0 ); // [SB] Corrected to use BASEWAD instead of GAMENAMELOWERCASE ".pk3"
 
-		char MD5Sum[33];
-		MD5SumOfFile ( Wads.GetWadFullName( ulIdx ), MD5Sum );
-
 		NetworkPWAD pwad;
 		pwad.name = Wads.GetWadName( ulIdx );
-		pwad.checksum = MD5Sum;
+		pwad.checksum = g_WadChecksums[ulIdx];
 		pwad.wadnum = ulIdx;
 
 		// Skip the IWAD, zandronum.pk3, files that were automatically loaded from subdirectories (such as skin files), and WADs loaded automatically within pk3 files.
@@ -1867,9 +2489,154 @@ extern int	stdin_ready;
 extern int	do_stdin;
 #endif
 
+#ifdef NETWORK_HAVE_EPOLL
+
+// The epoll instance the server waits on between tics. It watches the network
+// socket, standard input and a timer that expires at the start of the next tic.
+static	int		g_EpollFD = -1;
+static	int		g_TimerFD = -1;
+static	bool	g_bEventLoopFailed = false;
+static	bool	g_bWatchingStdin = false;
+
+//*****************************************************************************
+//
+static bool network_InitEventLoop( void )
+{
+	if ( g_EpollFD != -1 )
+		return ( true );
+
+	if ( g_bEventLoopFailed )
+		return ( false );
+
+	struct epoll_event	event;
+
+	g_EpollFD = epoll_create1( EPOLL_CLOEXEC );
+	g_TimerFD = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+
+	if (( g_EpollFD != -1 ) && ( g_TimerFD != -1 ))
+	{
+		memset( &event, 0, sizeof( event ));
+		event.events = EPOLLIN;
+		event.data.fd = g_NetworkSocket;
+
+		if ( epoll_ctl( g_EpollFD, EPOLL_CTL_ADD, g_NetworkSocket, &event ) == 0 )
+		{
+			event.data.fd = g_TimerFD;
+			if ( epoll_ctl( g_EpollFD, EPOLL_CTL_ADD, g_TimerFD, &event ) == 0 )
+				return ( true );
+		}
+	}
+
+	Printf( "I_WaitForEvents: Couldn't set up epoll (%s), falling back to polling.\n", strerror( errno ));
+
+	if ( g_EpollFD != -1 )
+		close( g_EpollFD );
+	if ( g_TimerFD != -1 )
+		close( g_TimerFD );
+
+	g_EpollFD = g_TimerFD = -1;
+	g_bEventLoopFailed = true;
+	return ( false );
+}
+
+//*****************************************************************************
+//
+static void network_WaitForEpollEvents( double dTimeoutMS )
+{
+	struct epoll_event	events[3];
+	struct epoll_event	event;
+
+	// Only watch stdin until it becomes readable. The input is read once per
+	// tic, and it would otherwise wake us up over and over again until then.
+	if ( do_stdin && ( stdin_ready == 0 ) && ( g_bWatchingStdin == false ))
+	{
+		memset( &event, 0, sizeof( event ));
+		event.events = EPOLLIN;
+		event.data.fd = 0;
+
+		if ( epoll_ctl( g_EpollFD, EPOLL_CTL_ADD, 0, &event ) == 0 )
+			g_bWatchingStdin = true;
+		// Regular files can't be watched by epoll, but they're always readable.
+		else if ( errno == EPERM )
+			stdin_ready = 1;
+	}
+
+	int timeout = 0;
+	if ( dTimeoutMS > 0 )
+	{
+		struct itimerspec	timer;
+		const SQWORD		nanoseconds = static_cast<SQWORD>( dTimeoutMS * 1000000.0 );
+
+		memset( &timer, 0, sizeof( timer ));
+		timer.it_value.tv_sec = static_cast<time_t>( nanoseconds / 1000000000 );
+		timer.it_value.tv_nsec = static_cast<long>( nanoseconds % 1000000000 );
+
+		// Wait for the timer instead of passing a timeout to epoll_wait, which
+		// only has millisecond resolution.
+		if ( timerfd_settime( g_TimerFD, 0, &timer, NULL ) == 0 )
+			timeout = -1;
+		else
+			timeout = static_cast<int>( ceil( dTimeoutMS ));
+	}
+
+	const int numEvents = epoll_wait( g_EpollFD, events, countof( events ), timeout );
+
+	for ( int i = 0; i < numEvents; i++ )
+	{
+		if ( events[i].data.fd == 0 )
+		{
+			stdin_ready = 1;
+			epoll_ctl( g_EpollFD, EPOLL_CTL_DEL, 0, NULL );
+			g_bWatchingStdin = false;
+		}
+		else if ( events[i].data.fd == g_TimerFD )
+		{
+			QWORD expirations;
+			if ( read( g_TimerFD, &expirations, sizeof( expirations )) < 0 )
+				continue;
+		}
+	}
+}
+
+#endif
+
+//*****************************************************************************
+//
+// Blocks until a packet arrives, there is console input, or dTimeoutMS
+// milliseconds have passed. Returns how many milliseconds were spent waiting.
+double I_WaitForEvents( double dTimeoutMS )
+{
+	cycle_t	waitTime;
+
+	waitTime.Reset( );
+	waitTime.Clock( );
+
+#ifdef NETWORK_HAVE_EPOLL
+	if ( network_InitEventLoop( ))
+		network_WaitForEpollEvents( dTimeoutMS );
+	else
+#endif
+	if ( dTimeoutMS > 0 )
+		I_Sleep( 1 );
+
+	waitTime.Unclock( );
+	return ( waitTime.TimeMS( ));
+}
+
+//*****************************************************************************
+//
 // [BB] We only need this for the server console input under Linux.
 void I_DoSelect (void)
 {
+#ifdef NETWORK_HAVE_EPOLL
+	// Just check for console input, I_WaitForEvents does the waiting.
+	if ( network_InitEventLoop( ))
+	{
+		network_WaitForEpollEvents( 0 );
+		return;
+	}
+#endif
+
 #ifdef		WIN32
 /*
     struct timeval   timeout;
@@ -2025,6 +2792,165 @@ CCMD( dumpnetclassids )
 }
 #endif
 
+//*****************************************************************************
+//
+CCMD( capturepackets )
+{
+	if ( g_PacketCaptureFile )
+	{
+		fclose( g_PacketCaptureFile );
+		g_PacketCaptureFile = NULL;
+		Printf( "Packet capture stopped.\n" );
+	}
+
+	if ( argv.argc( ) < 2 )
+	{
+		Printf( "Usage: capturepackets <filename>\nCalling it again without a filename stops the capture.\n" );
+		return;
+	}
+
+	g_PacketCaptureFile = fopen( argv[1], "wb" );
+
+	if ( g_PacketCaptureFile == NULL )
+		Printf( "Couldn't open %s for writing.\n", argv[1] );
+	else
+		Printf( "Capturing packets to %s.\n", argv[1] );
+}
+
+//*****************************************************************************
+//
+// Measures the throughput of the tree walking and the table driven Huffman codec
+// on packets captured with capturepackets, and verifies that both agree.
+CCMD( huffmanbenchmark )
+{
+	if ( argv.argc( ) < 2 )
+	{
+		Printf( "Usage: huffmanbenchmark <capture file> [iterations]\n" );
+		return;
+	}
+
+	FILE *pFile = fopen( argv[1], "rb" );
+	if ( pFile == NULL )
+	{
+		Printf( "Couldn't open %s.\n", argv[1] );
+		return;
+	}
+
+	TArray<BYTE> data;
+	TArray<ULONG> sizes;
+	BYTE abLength[2];
+
+	while ( fread( abLength, 1, sizeof( abLength ), pFile ) == sizeof( abLength ))
+	{
+		const ULONG ulSize = abLength[0] | ( abLength[1] << 8 );
+		const ULONG ulOffset = data.Reserve( ulSize );
+
+		if (( ulSize > MAX_UDP_PACKET ) || ( fread( &data[ulOffset], 1, ulSize, pFile ) != ulSize ))
+		{
+			data.Resize( ulOffset );
+			break;
+		}
+
+		sizes.Push( ulSize );
+	}
+	fclose( pFile );
+
+	if ( sizes.Size( ) == 0 )
+	{
+		Printf( "%s doesn't contain any packets.\n", argv[1] );
+		return;
+	}
+
+	const int iterations = ( argv.argc( ) > 2 ) ? MAX( atoi( argv[2] ), 1 ) : 100;
+	const double megabytes = static_cast<double>( data.Size( )) * iterations / ( 1024.0 * 1024.0 );
+	TArray<BYTE> encoded[2];
+	UCHAR abDecoded[MAX_UDP_PACKET];
+
+	Printf( "%u packets, %u bytes, %d iterations\n", sizes.Size( ), data.Size( ), iterations );
+
+	for ( int mode = 0; mode < 2; mode++ )
+	{
+		const bool bUseTables = ( mode == 1 );
+		cycle_t encodeTime, decodeTime;
+		encodeTime.Reset( );
+		decodeTime.Reset( );
+
+		HUFFMAN_UseLookupTables( bUseTables );
+		encoded[mode].Resize( data.Size( ) + sizes.Size( ) * 3 );
+
+		for ( int i = 0; i < iterations; i++ )
+		{
+			ULONG ulInput = 0;
+			ULONG ulOutput = 0;
+
+			encodeTime.Clock( );
+			for ( unsigned int packet = 0; packet < sizes.Size( ); packet++ )
+			{
+				// Each encoded packet is stored behind a 16-bit length, like in the capture file.
+				INT iNumBytesOut = sizes[packet] + 1;
+				HUFFMAN_Encode( &data[ulInput], &encoded[mode][ulOutput + 2], sizes[packet], &iNumBytesOut );
+				encoded[mode][ulOutput] = iNumBytesOut & 0xFF;
+				encoded[mode][ulOutput + 1] = ( iNumBytesOut >> 8 ) & 0xFF;
+				ulInput += sizes[packet];
+				ulOutput += iNumBytesOut + 2;
+			}
+			encodeTime.Unclock( );
+
+			ulOutput = 0;
+
+			decodeTime.Clock( );
+			for ( unsigned int packet = 0; packet < sizes.Size( ); packet++ )
+			{
+				const INT iNumBytesIn = encoded[mode][ulOutput] | ( encoded[mode][ulOutput + 1] << 8 );
+				INT iDecodedNumBytes = sizeof( abDecoded );
+				HUFFMAN_Decode( &encoded[mode][ulOutput + 2], abDecoded, iNumBytesIn, &iDecodedNumBytes );
+				ulOutput += iNumBytesIn + 2;
+			}
+			decodeTime.Unclock( );
+		}
+
+		Printf( "%s: encode %.1f MB/s, decode %.1f MB/s\n", bUseTables ? "Lookup tables" : "Tree",
+			megabytes * 1000.0 / MAX( encodeTime.TimeMS( ), 0.001 ), megabytes * 1000.0 / MAX( decodeTime.TimeMS( ), 0.001 ));
+	}
+
+	// Make sure the table codec really is wire-compatible with the tree: both must
+	// produce the same bytes, and decoding must give back the captured packets.
+	ULONG ulInput = 0;
+	ULONG ulOutput = 0;
+	unsigned int mismatches = 0;
+
+	for ( unsigned int packet = 0; packet < sizes.Size( ); packet++ )
+	{
+		INT iNumBytes[2];
+
+		for ( int mode = 0; mode < 2; mode++ )
+		{
+			iNumBytes[mode] = sizes[packet] + 1;
+			HUFFMAN_UseLookupTables( mode == 1 );
+			HUFFMAN_Encode( &data[ulInput], &encoded[mode][ulOutput], sizes[packet], &iNumBytes[mode] );
+		}
+
+		INT iDecodedNumBytes = sizeof( abDecoded );
+		HUFFMAN_Decode( &encoded[1][ulOutput], abDecoded, iNumBytes[1], &iDecodedNumBytes );
+
+		if (( iNumBytes[0] != iNumBytes[1] ) || ( memcmp( &encoded[0][ulOutput], &encoded[1][ulOutput], iNumBytes[0] ) != 0 )
+			|| ( iDecodedNumBytes != static_cast<INT>( sizes[packet] )) || ( memcmp( abDecoded, &data[ulInput], iDecodedNumBytes ) != 0 ))
+		{
+			mismatches++;
+		}
+
+		ulInput += sizes[packet];
+		ulOutput += sizes[packet] + 1;
+	}
+
+	HUFFMAN_UseLookupTables( true );
+
+	if ( mismatches > 0 )
+		Printf( TEXTCOLOR_RED "%u packets were encoded or decoded differently!\n", mismatches );
+	else
+		Printf( "Both codecs produced identical output.\n" );
+}
+
 #ifdef	_DEBUG
 // DEBUG FUNCTION!
 void NETWORK_FillBufferWithShit( BYTESTREAM_s *pByteStream, ULONG ulSize )
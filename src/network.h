@@ -338,6 +338,9 @@ int				NETWORK_GetPackets( void );
 int				NETWORK_GetLANPackets( void );
 NETADDRESS_s	NETWORK_GetFromAddress( void );
 void			NETWORK_LaunchPacket( NETBUFFER_s *pBuffer, NETADDRESS_s Address );
+void			NETWORK_BeginOutboundBatch( void );
+void			NETWORK_EndOutboundBatch( void );
+void			NETWORK_FlushOutboundBatch( void );
 NETADDRESS_s	NETWORK_GetLocalAddress( void );
 NETADDRESS_s	NETWORK_GetCachedLocalAddress( void );
 NETBUFFER_s		*NETWORK_GetNetworkMessageBuffer( void );
@@ -403,6 +406,7 @@ LONG			NETWORK_GetState( void );
 void			NETWORK_SetState( LONG lState );
 
 void			I_DoSelect( void );
+double			I_WaitForEvents( double dTimeoutMS );
 
 // DEBUG FUNCTION!
 #ifdef	_DEBUG
@@ -48,6 +48,49 @@
 
 #include "netcommand.h"
 
+//*****************************************************************************
+//	VARIABLES
+
+// [BB] Every NetCommand needs a MAX_UDP_PACKET sized scratch buffer, but only
+// lives for the duration of a single SERVERCOMMANDS_* call. Recycle the buffers
+// instead of allocating a new one for every command that is sent.
+enum
+{
+	NETCOMMAND_MAX_POOLED_BUFFERS = 32,
+};
+
+static	BYTE	*g_pNetCommandBufferPool[NETCOMMAND_MAX_POOLED_BUFFERS];
+static	ULONG	g_ulNumPooledNetCommandBuffers = 0;
+
+//*****************************************************************************
+//
+static void netcommand_AcquireBuffer( NETBUFFER_s &Buffer )
+{
+	if ( g_ulNumPooledNetCommandBuffers == 0 )
+	{
+		Buffer.Init( MAX_UDP_PACKET, BUFFERTYPE_WRITE );
+		return;
+	}
+
+	Buffer.pbData = g_pNetCommandBufferPool[--g_ulNumPooledNetCommandBuffers];
+	Buffer.ulMaxSize = MAX_UDP_PACKET;
+	Buffer.BufferType = BUFFERTYPE_WRITE;
+	Buffer.Clear();
+}
+
+//*****************************************************************************
+//
+static void netcommand_ReleaseBuffer( NETBUFFER_s &Buffer )
+{
+	if (( Buffer.pbData != NULL ) && ( Buffer.ulMaxSize == MAX_UDP_PACKET ) && ( g_ulNumPooledNetCommandBuffers < NETCOMMAND_MAX_POOLED_BUFFERS ))
+	{
+		g_pNetCommandBufferPool[g_ulNumPooledNetCommandBuffers++] = Buffer.pbData;
+		Buffer.pbData = NULL;
+	}
+
+	Buffer.Free();
+}
+
 //*****************************************************************************
 //
 ClientIterator::ClientIterator ( const ULONG ulPlayerExtra, const ServerCommandFlags flags )
@@ -106,27 +149,60 @@ ULONG ClientIterator::operator++ ( ) {
 //*****************************************************************************
 //
 NetCommand::NetCommand ( const SVC Header ) :
-	_unreliable( false )
+	_unreliable( false ),
+	_sharedCommand( NULL ),
+	_numClientsSentTo( 0 )
 {
-	_buffer.Init( MAX_UDP_PACKET, BUFFERTYPE_WRITE );
+	netcommand_AcquireBuffer( _buffer );
 	addByte( Header );
 }
 
 //*****************************************************************************
 //
 NetCommand::NetCommand ( const SVC2 Header2 ) :
-	_unreliable( false )
+	_unreliable( false ),
+	_sharedCommand( NULL ),
+	_numClientsSentTo( 0 )
 {
-	_buffer.Init( MAX_UDP_PACKET, BUFFERTYPE_WRITE );
+	netcommand_AcquireBuffer( _buffer );
 	addByte( SVC_EXTENDEDCOMMAND );
 	addByte( Header2 );
 }
 
+//*****************************************************************************
+//
+NetCommand::NetCommand ( const NetCommand &Command ) :
+	_unreliable( Command._unreliable ),
+	_sharedCommand( NULL ),
+	_numClientsSentTo( 0 )
+{
+	netcommand_AcquireBuffer( _buffer );
+	memcpy( _buffer.pbData, Command._buffer.pbData, Command._buffer.CalcSize() );
+	_buffer.ByteStream.pbStream = _buffer.pbData + Command._buffer.CalcSize();
+	_buffer.ulCurrentSize = _buffer.CalcSize();
+	_buffer.ByteStream.bitShift = Command._buffer.ByteStream.bitShift;
+	if ( Command._buffer.ByteStream.bitBuffer != NULL )
+		_buffer.ByteStream.bitBuffer = _buffer.pbData + ( Command._buffer.ByteStream.bitBuffer - Command._buffer.pbData );
+}
+
 //*****************************************************************************
 //
 NetCommand::~NetCommand ( )
 {
-	_buffer.Free();
+	if ( _sharedCommand != NULL )
+		_sharedCommand->Release();
+
+	netcommand_ReleaseBuffer( _buffer );
+}
+
+//*****************************************************************************
+//
+// Frees the recycled scratch buffers, e.g. when the server shuts down.
+//
+void NetCommand::freeBufferPool ( )
+{
+	while ( g_ulNumPooledNetCommandBuffers > 0 )
+		delete[] g_pNetCommandBufferPool[--g_ulNumPooledNetCommandBuffers];
 }
 
 //*****************************************************************************
@@ -216,6 +292,14 @@ void NetCommand::addShortByte ( int value, int bits )
 	_buffer.ulCurrentSize = _buffer.CalcSize();
 }
 
+//*****************************************************************************
+//
+void NetCommand::addNetID ( const unsigned int netID )
+{
+	_buffer.ByteStream.WriteNetID( netID );
+	_buffer.ulCurrentSize = _buffer.CalcSize();
+}
+
 //*****************************************************************************
 //
 void NetCommand::addString ( const char *pszString )
@@ -287,6 +371,16 @@ NETBUFFER_s& NetCommand::getBufferForClient( ULONG i ) const
 	return SERVER_GetClient( i )->PacketBuffer;
 }
 
+//*****************************************************************************
+//
+SharedCommandQueue& NetCommand::getSharedCommandsForClient( ULONG i ) const
+{
+	if ( _unreliable )
+		return SERVER_GetClient( i )->UnreliableSharedCommands;
+
+	return SERVER_GetClient( i )->SharedCommands;
+}
+
 //*****************************************************************************
 // [TP]
 //
@@ -318,18 +412,39 @@ void NetCommand::sendCommandToOneClient( ULONG i )
 	SERVER_CheckClientBuffer( i, _buffer.ulCurrentSize, _unreliable == false );
 
 	// [BB] 5 = 1 + 4 (SVC_HEADER + packet number)
-	const unsigned int estimateSize = getBufferForClient( i ).CalcSize() + _buffer.ulCurrentSize + 5;
+	const unsigned int estimateSize = SERVER_CalcClientPacketSize( i, _unreliable == false ) + _buffer.ulCurrentSize + 5;
 	if ( estimateSize >= SERVER_GetMaxPacketSize( ) )
 	{
 		// [BB] This should never happen.
-		if ( getBufferForClient( i ).CalcSize() > 0 )
+		if ( SERVER_CalcClientPacketSize( i, _unreliable == false ) > 0 )
 			SERVER_PrintWarning ( "NetCommand %s didn't create a new packet to client %lu even though the command doesn't fit within the current packet!\n", getHeaderAsString(), i );
 		// [BB] This happens if the current command alone is already too big for one packet.
 		else
 			SERVER_PrintWarning ( "NetCommand %s created a packet to client %lu exceeding sv_maxpacketsize (%d >= %lu)!\n", getHeaderAsString(), i, estimateSize, SERVER_GetMaxPacketSize( ));
 	}
 
-	writeCommandToStream( getBytestreamForClient( i ));
+	// [BB] The first client gets a plain copy of the command, that's all we
+	// need if the command is only meant for one client. Every further client
+	// shares one copy of the command that is gathered into the client's packet
+	// when the packet is sent.
+	if ( _numClientsSentTo++ == 0 )
+	{
+		writeCommandToStream( getBytestreamForClient( i ));
+		return;
+	}
+
+	// [BB] The command can only grow after it has been sent, so a size change
+	// means the shared copy is outdated.
+	if (( _sharedCommand != NULL ) && ( _sharedCommand->GetSize() != _buffer.ulCurrentSize ))
+	{
+		_sharedCommand->Release();
+		_sharedCommand = NULL;
+	}
+
+	if ( _sharedCommand == NULL )
+		_sharedCommand = SharedCommand::Create( _buffer.pbData, _buffer.ulCurrentSize );
+
+	getSharedCommandsForClient( i ).Push( getBufferForClient( i ), _sharedCommand );
 }
 
 //*****************************************************************************
@@ -49,6 +49,7 @@
 #pragma once
 #include "network_enums.h"
 #include "sv_commands.h"
+#include "packetarchive.h"
 
 /**
  * \brief Iterate over all clients, possibly skipping one or all but one.
@@ -85,11 +86,21 @@ class NetCommand {
 	NETBUFFER_s	_buffer;
 	bool		_unreliable;
 
+	// The command bytes shared by all clients that receive this command, created
+	// when the command is sent to its second client.
+	SharedCommand	*_sharedCommand;
+	ULONG		_numClientsSentTo;
+
+	NetCommand &operator= ( const NetCommand & );
+
 public:
 	NetCommand ( const SVC Header );
 	NetCommand ( const SVC2 Header2 );
+	NetCommand ( const NetCommand &Command );
 	~NetCommand ( );
 
+	static void freeBufferPool ( );
+
 	const char *getHeaderAsString() const;
 
 	void addInteger( const int IntValue, const int Size );
@@ -102,9 +113,11 @@ public:
 	void addBit ( const bool value );
 	void addVariable ( const int value );
 	void addShortByte ( int value, int bits );
+	void addNetID ( const unsigned int netID );
 	void addBuffer( const void *pvBuffer, const unsigned int length );
 	void writeCommandToStream ( BYTESTREAM_s &ByteStream ) const;
 	NETBUFFER_s& getBufferForClient( ULONG i ) const;
+	SharedCommandQueue& getSharedCommandsForClient( ULONG i ) const;
 	BYTESTREAM_s& getBytestreamForClient( ULONG i ) const;
 	void sendCommandToClients ( ULONG ulPlayerExtra = MAXPLAYERS, ServerCommandFlags flags = 0 );
 	void sendCommandToOneClient( ULONG i );
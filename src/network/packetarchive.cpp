@@ -53,6 +53,100 @@
 #include "../network_enums.h" 
 #include "packetarchive.h"
 
+//*****************************************************************************
+//
+SharedCommand *SharedCommand::Create( const BYTE *data, unsigned int size )
+{
+	SharedCommand *command = static_cast<SharedCommand *>( M_Malloc( sizeof( SharedCommand ) + size ));
+	command->_refCount = 1;
+	command->_size = size;
+	memcpy( command + 1, data, size );
+	return command;
+}
+
+//*****************************************************************************
+//
+void SharedCommand::Release( )
+{
+	if ( --_refCount == 0 )
+		M_Free( this );
+}
+
+//*****************************************************************************
+//
+SharedCommandQueue::SharedCommandQueue ( ) :
+	_size ( 0 )
+{
+}
+
+//*****************************************************************************
+//
+SharedCommandQueue::~SharedCommandQueue ( )
+{
+	Clear();
+}
+
+//*****************************************************************************
+//
+void SharedCommandQueue::Push( const NETBUFFER_s &buffer, SharedCommand *command )
+{
+	Entry entry;
+	entry.position = buffer.CalcSize();
+	entry.command = command;
+	command->AddRef();
+	_entries.Push( entry );
+	_size += command->GetSize();
+
+	// [BB] The command is part of the client's packet now, so it has to be
+	// counted just like a command that was written into the buffer.
+	NETWORK_CountOutboundTraffic( command->GetSize() );
+}
+
+//*****************************************************************************
+//
+void SharedCommandQueue::Clear( )
+{
+	for ( unsigned int i = 0; i < _entries.Size(); ++i )
+		_entries[i].command->Release();
+
+	_entries.Clear();
+	_size = 0;
+}
+
+//*****************************************************************************
+//
+LONG SharedCommandQueue::CalcPacketSize( const NETBUFFER_s &buffer ) const
+{
+	return buffer.CalcSize() + _size;
+}
+
+//*****************************************************************************
+//
+// Assembles the packet out of the buffer and the shared commands.
+//
+LONG SharedCommandQueue::WritePacketTo( const NETBUFFER_s &buffer, BYTESTREAM_s &ByteStream ) const
+{
+	const LONG bufferSize = buffer.CalcSize();
+	LONG position = 0;
+
+	for ( unsigned int i = 0; i < _entries.Size(); ++i )
+	{
+		const LONG end = MIN( _entries[i].position, bufferSize );
+		if ( end > position )
+		{
+			ByteStream.WriteBuffer( buffer.pbData + position, end - position );
+			position = end;
+		}
+
+		ByteStream.WriteBuffer( _entries[i].command->GetData(), _entries[i].command->GetSize() );
+	}
+
+	if ( bufferSize > position )
+		ByteStream.WriteBuffer( buffer.pbData + position, bufferSize - position );
+
+	return bufferSize + _size;
+}
+
 //*****************************************************************************
 //
 PacketArchive::PacketArchive() :
@@ -93,15 +187,16 @@ void PacketArchive::Free()
 
 //*****************************************************************************
 //
-unsigned int PacketArchive::StorePacket( const NETBUFFER_s& packet )
+unsigned int PacketArchive::StorePacket( const NETBUFFER_s& packet, const SharedCommandQueue *sharedCommands )
 {
 	if ( _initialized == false )
 		return 0;
 
 	_packetData.ulCurrentSize = _packetData.CalcSize();
+	const LONG packetSize = ( sharedCommands != NULL ) ? sharedCommands->CalcPacketSize( packet ) : packet.CalcSize();
 
 	// If we've reached the end of our reliable packets buffer, start writing at the beginning.
-	if (( _packetData.ulCurrentSize + packet.CalcSize() ) >= _packetData.ulMaxSize )
+	if (( _packetData.ulCurrentSize + packetSize ) >= _packetData.ulMaxSize )
 	{
 		_packetData.ByteStream.pbStream = _packetData.pbData;
 		_packetData.ulCurrentSize = 0;
@@ -114,8 +209,12 @@ unsigned int PacketArchive::StorePacket( const NETBUFFER_s& packet )
 	_records[i].sequenceNumber = _sequenceNumber;
 
 	// Write what we want to send out to our reliable packets buffer, so that it can be
-	// retransmitted later if necessary. Also save the size.
-	_records[i].size = packet.WriteTo( _packetData.ByteStream );
+	// retransmitted later if necessary. Also save the size. The shared commands
+	// are gathered straight into the archive, so this is the only copy we make.
+	if ( sharedCommands != NULL )
+		_records[i].size = sharedCommands->WritePacketTo( packet, _packetData.ByteStream );
+	else
+		_records[i].size = packet.WriteTo( _packetData.ByteStream );
 
 	return _sequenceNumber++;
 }
@@ -195,18 +294,26 @@ void OutgoingPacketBuffer::SetClientIndex ( const unsigned int ClientIdx )
 
 //*****************************************************************************
 //
-void OutgoingPacketBuffer::ScheduleUnsentPacket ( const NETBUFFER_s &Packet )
+void OutgoingPacketBuffer::ScheduleUnsentPacket ( const NETBUFFER_s &Packet, const SharedCommandQueue *SharedCommands )
 {
 	if ( ( _unsentPackets.Size () == 0 ) && ( _packetsSentThisTick < static_cast<unsigned int> ( sv_maxpacketspertick ) ) )
 	{
 		++_packetsSentThisTick;
-		const int packetNumber = this->StorePacket ( Packet );
+		const int packetNumber = this->StorePacket ( Packet, SharedCommands );
 		SendPacket( packetNumber, SERVER_GetClient ( _clientIdx )->Address );
 	}
-	else
+	else if (( SharedCommands == NULL ) || SharedCommands->IsEmpty() )
 	{
 		_unsentPackets.Push ( Packet );
 	}
+	else
+	{
+		// [BB] The packet has to wait, so assemble it now. The client's buffers
+		// are reused as soon as we return.
+		NETBUFFER_s &unsentPacket = _unsentPackets[_unsentPackets.Reserve( 1 )];
+		unsentPacket.Init( MAX_UDP_PACKET, BUFFERTYPE_WRITE );
+		SharedCommands->WritePacketTo( Packet, unsentPacket.ByteStream );
+	}
 }
 
 //*****************************************************************************
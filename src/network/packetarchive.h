@@ -50,6 +50,71 @@
 
 #pragma once
 #include "../networkshared.h"
+#include "../tarray.h"
+
+//==========================================================================
+//
+// SharedCommand
+//
+// A serialized server command that is sent to several clients. Its bytes
+// are stored only once, every client packet that contains the command just
+// holds a reference to them until the packet is assembled.
+//
+//==========================================================================
+class SharedCommand
+{
+	unsigned int _refCount;
+	unsigned int _size;
+
+	SharedCommand ( ) { }
+
+public:
+	static SharedCommand *Create( const BYTE *data, unsigned int size );
+
+	void AddRef( ) { ++_refCount; }
+	void Release( );
+
+	// The command bytes are stored right behind the header.
+	const BYTE *GetData( ) const { return reinterpret_cast<const BYTE *>( this + 1 ); }
+	unsigned int GetSize( ) const { return _size; }
+};
+
+//==========================================================================
+//
+// SharedCommandQueue
+//
+// The shared commands that belong into one of the packet buffers of a
+// client. Each command remembers where in the buffer it was sent, so that
+// it ends up at the right place between the commands that were written into
+// the buffer directly when the packet is assembled.
+//
+//==========================================================================
+class SharedCommandQueue
+{
+	struct Entry
+	{
+		LONG position; // The size of the client's buffer when the command was queued.
+		SharedCommand *command;
+	};
+
+	TArray<Entry> _entries;
+
+	// Sum of the sizes of all queued commands.
+	LONG _size;
+
+	SharedCommandQueue ( const SharedCommandQueue & );
+	SharedCommandQueue &operator= ( const SharedCommandQueue & );
+
+public:
+	SharedCommandQueue ( );
+	~SharedCommandQueue ( );
+
+	void Push( const NETBUFFER_s &buffer, SharedCommand *command );
+	void Clear( );
+	bool IsEmpty( ) const { return _entries.Size() == 0; }
+	LONG CalcPacketSize( const NETBUFFER_s &buffer ) const;
+	LONG WritePacketTo( const NETBUFFER_s &buffer, BYTESTREAM_s &ByteStream ) const;
+};
 
 class PacketArchive
 {
@@ -60,7 +125,7 @@ public:
 	void Initialize( size_t maxPacketSize );
 	void Free();
 	void Clear();
-	unsigned int StorePacket( const NETBUFFER_s& packet );
+	unsigned int StorePacket( const NETBUFFER_s& packet, const SharedCommandQueue *sharedCommands = NULL );
 	bool FindPacket( unsigned int packetNumber, const BYTE*& data, size_t& size ) const;
 
 private:
@@ -102,7 +167,7 @@ private:
 public:
 	OutgoingPacketBuffer ( );
 	void SetClientIndex ( const unsigned int ClientIdx );
-	void ScheduleUnsentPacket ( const NETBUFFER_s &Packet );
+	void ScheduleUnsentPacket ( const NETBUFFER_s &Packet, const SharedCommandQueue *SharedCommands = NULL );
 	bool SchedulePacket( unsigned int packetNumber );
 	void ClearScheduling();
 	void ForceSendAll();
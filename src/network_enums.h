@@ -395,6 +395,8 @@ BEGIN_ENUM( SVC2 )
 	ENUM_ELEMENT ( SVC2_RCONACCESS ),
 	// [TRSR] Command for syncing Domination point state.
 	ENUM_ELEMENT ( SVC2_SETDOMINATIONPOINTSTATE ),
+	// Spawns several level things at once during a full update.
+	ENUM_ELEMENT ( SVC2_LEVELSPAWNTHINGSSNAPSHOT ),
 
 	ENUM_ELEMENT ( NUM_SVC2_COMMANDS ),
 }
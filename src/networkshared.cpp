@@ -180,6 +180,17 @@ int NETWORK_StopTrafficMeasurement ( )
 	return g_OutboundBytesMeasured;
 }
 
+//*****************************************************************************
+//
+// [BB] For data that becomes part of the outbound traffic without being
+// written through NETWORK_Write*, e.g. shared server commands.
+//
+void NETWORK_CountOutboundTraffic ( const int NumBytes )
+{
+	if ( g_MeasuringOutboundTraffic )
+		g_OutboundBytesMeasured += NumBytes;
+}
+
 //================================================================================
 // IO read functions
 //================================================================================
@@ -348,6 +359,28 @@ int BYTESTREAM_s::ReadVariable()
 	}
 }
 
+//*****************************************************************************
+//
+// Network IDs below 32768 are sent as a short, like they used to be. Larger
+// IDs set the top bit of that short, which then holds the lowest 15 bits of
+// the ID, and the rest of the ID follows in another short.
+//
+unsigned int BYTESTREAM_s::ReadNetID()
+{
+	const unsigned int Low = this->ReadShort() & 0xFFFF;
+
+	if (( Low & 0x8000 ) == 0 )
+		return Low;
+
+	const unsigned int High = this->ReadShort() & 0xFFFF;
+
+	// Reading past the end gives 0xFFFF shorts, don't make an ID out of them.
+	if ( this->pbStream > this->pbStreamEnd )
+		return 0;
+
+	return ( Low & 0x7FFF ) | ( High << 15 );
+}
+
 //*****************************************************************************
 //
 int BYTESTREAM_s::ReadShortByte ( int bits )
@@ -545,6 +578,22 @@ void BYTESTREAM_s::WriteVariable( int value )
 	}
 }
 
+//*****************************************************************************
+//
+// See ReadNetID for the encoding.
+//
+void BYTESTREAM_s::WriteNetID( unsigned int netID )
+{
+	if ( netID < 0x8000 )
+	{
+		this->WriteShort( netID );
+		return;
+	}
+
+	this->WriteShort(( netID & 0x7FFF ) | 0x8000 );
+	this->WriteShort( netID >> 15 );
+}
+
 //*****************************************************************************
 //
 void BYTESTREAM_s::WriteShortByte( int value, int bits )
@@ -1098,6 +1147,7 @@ bool IPList::clearAndLoadFromFile( const char *Filename )
 	if ( !success )
 		_error = parser.getErrorMessage();
 
+	_trieOutdated = true;
 	return success;
 }
 
@@ -1144,10 +1194,141 @@ void IPList::removeExpiredEntries( void )
 	}
 }
 
+//*****************************************************************************
+//
+// Parses an octet written the way IPStringArray::SetFrom writes it, i.e. a
+// decimal number without leading zeroes.
+static bool iplist_ParseOctet( const char *pszOctet, BYTE &bValue )
+{
+	int value = 0;
+	int numDigits = 0;
+
+	for ( ; isdigit( static_cast<unsigned char>( *pszOctet )); pszOctet++ )
+	{
+		// Only "0" itself may start with a zero.
+		if (( numDigits == 1 ) && ( value == 0 ))
+			return false;
+
+		value = value * 10 + ( *pszOctet - '0' );
+		numDigits++;
+	}
+
+	if (( *pszOctet != 0 ) || ( numDigits == 0 ) || ( value > 255 ))
+		return false;
+
+	bValue = static_cast<BYTE>( value );
+	return true;
+}
+
+//*****************************************************************************
+//
+// Inserts every entry that only has wildcards at its end (e.g. 1.2.*.*) into
+// a binary trie over the address bits, so that all the entries matching an
+// address lie on the path of that address through the trie.
+void IPList::rebuildTrie () const
+{
+	const TrieNode root = { { 0, 0 }, ULONG_MAX };
+
+	_trie.clear( );
+	_trie.push_back( root );
+	_entriesNotInTrie.clear( );
+
+	for ( ULONG ulIdx = 0; ulIdx < _ipVector.size( ); ulIdx++ )
+	{
+		const IPStringArray &IP = _ipVector[ulIdx].szIP;
+		BYTE abIP[4];
+		int numOctets = 0;
+		bool canBeInserted = true;
+
+		while (( numOctets < 4 ) && ( IP[numOctets][0] != '*' ))
+		{
+			if ( iplist_ParseOctet( IP[numOctets], abIP[numOctets] ) == false )
+			{
+				canBeInserted = false;
+				break;
+			}
+			numOctets++;
+		}
+
+		for ( int i = numOctets; canBeInserted && ( i < 4 ); i++ )
+		{
+			if ( IP[i][0] != '*' )
+				canBeInserted = false;
+		}
+
+		if ( canBeInserted == false )
+		{
+			_entriesNotInTrie.push_back( ulIdx );
+			continue;
+		}
+
+		ULONG ulNode = 0;
+		for ( int bit = 0; bit < numOctets * 8; bit++ )
+		{
+			const int side = ( abIP[bit / 8] >> ( 7 - bit % 8 )) & 1;
+
+			if ( _trie[ulNode].children[side] == 0 )
+			{
+				_trie[ulNode].children[side] = static_cast<ULONG>( _trie.size( ));
+				_trie.push_back( root );
+			}
+			ulNode = _trie[ulNode].children[side];
+		}
+
+		// The entries are inserted in order, so the first one to get here is the one to keep.
+		if ( _trie[ulNode].firstEntry == ULONG_MAX )
+			_trie[ulNode].firstEntry = ulIdx;
+	}
+
+	_trieOutdated = false;
+}
+
+//*****************************************************************************
+//
+ULONG IPList::findInTrie( const BYTE *abIP ) const
+{
+	if ( _trieOutdated )
+		rebuildTrie( );
+
+	ULONG ulFirstEntry = size( );
+	ULONG ulNode = 0;
+
+	for ( int bit = 0; ; bit++ )
+	{
+		if ( _trie[ulNode].firstEntry < ulFirstEntry )
+			ulFirstEntry = _trie[ulNode].firstEntry;
+
+		if ( bit == 32 )
+			break;
+
+		ulNode = _trie[ulNode].children[( abIP[bit / 8] >> ( 7 - bit % 8 )) & 1];
+		if ( ulNode == 0 )
+			break;
+	}
+
+	return ( ulFirstEntry );
+}
+
 //*****************************************************************************
 //
 ULONG IPList::getFirstMatchingEntryIndex( const IPStringArray &szAddress ) const
 {
+	NETADDRESS_s Address;
+	bool isPlainAddress = true;
+
+	for ( int i = 0; i < 4; ++i )
+	{
+		if ( iplist_ParseOctet( szAddress[i], Address.abIP[i] ) == false )
+		{
+			isPlainAddress = false;
+			break;
+		}
+	}
+
+	if ( isPlainAddress )
+		return getFirstMatchingEntryIndex( Address );
+
+	// The trie can't handle anything but plain addresses.
 	for ( ULONG ulIdx = 0; ulIdx < _ipVector.size(); ulIdx++ )
 	{
 		if ( szAddress.Matches ( _ipVector[ulIdx].szIP ) )
@@ -1163,9 +1344,28 @@ ULONG IPList::getFirstMatchingEntryIndex( const IPStringArray &szAddress ) const
 //
 ULONG IPList::getFirstMatchingEntryIndex( const NETADDRESS_s &Address ) const
 {
-	IPStringArray szAddress;
-	szAddress.SetFrom ( Address );
-	return getFirstMatchingEntryIndex( szAddress );
+	ULONG ulFirstEntry = findInTrie( Address.abIP );
+
+	// Entries that aren't in the trie still have to be checked, but only the
+	// ones that come before the best match found so far.
+	if ( _entriesNotInTrie.empty( ) == false )
+	{
+		IPStringArray szAddress;
+		szAddress.SetFrom ( Address );
+
+		for ( ULONG i = 0; i < _entriesNotInTrie.size( ); i++ )
+		{
+			const ULONG ulIdx = _entriesNotInTrie[i];
+
+			if ( ulIdx >= ulFirstEntry )
+				break;
+
+			if ( szAddress.Matches ( _ipVector[ulIdx].szIP ) )
+				return ( ulIdx );
+		}
+	}
+
+	return ( ulFirstEntry );
 }
 
 //*****************************************************************************
@@ -1333,6 +1533,7 @@ void IPList::addEntry( const IPStringArray &szAddress, const char *pszPlayerName
 	newIPEntry.szComment[127] = 0;
 	newIPEntry.tExpirationDate = tExpiration;
 	_ipVector.push_back( newIPEntry );
+	_trieOutdated = true;
 
 	// Finally, append the IP to the file.
 	if ( (pFile = fopen( _filename.c_str(), "a" )) )
@@ -1402,6 +1603,7 @@ void IPList::removeEntry( ULONG ulEntryIdx )
 			_ipVector[ulIdx] = _ipVector[ulIdx+1];
 
 	_ipVector.pop_back();
+	_trieOutdated = true;
 	rewriteListToFile ();
 }
 
@@ -1488,6 +1690,7 @@ struct ASCENDINGIPSORT_S
 void IPList::sort()
 {
 	std::sort( _ipVector.begin(), _ipVector.end(), ASCENDINGIPSORT_S() );
+	_trieOutdated = true;
 }
 
 //=============================================================================
@@ -1505,7 +1708,38 @@ void IPList::sort()
 void QueryIPQueue::adjustHead( const unsigned long currentTime )
 {
 	while (( _queueHead != _queueTail ) && ( currentTime >= _IPQueue[_queueHead].nextAllowedTime ))
-		_queueHead = ( _queueHead + 1 ) % MAX_QUERY_IPS;
+		removeHead( );
+}
+
+//=============================================================================
+//
+// addressKey
+//
+// Packs the IP of the given address (without the port) into a single integer.
+//
+//=============================================================================
+
+unsigned int QueryIPQueue::addressKey( const NETADDRESS_s &Address )
+{
+	return ( Address.abIP[0] << 24 ) | ( Address.abIP[1] << 16 ) | ( Address.abIP[2] << 8 ) | Address.abIP[3];
+}
+
+//=============================================================================
+//
+// removeHead
+//
+// Removes the oldest entry from the queue.
+//
+//=============================================================================
+
+void QueryIPQueue::removeHead( )
+{
+	std::unordered_map<unsigned int, unsigned int>::iterator it = _addressCounts.find( addressKey( _IPQueue[_queueHead].Address ));
+
+	if (( it != _addressCounts.end( )) && ( --it->second == 0 ))
+		_addressCounts.erase( it );
+
+	_queueHead = ( _queueHead + 1 ) % MAX_QUERY_IPS;
 }
 
 //=============================================================================
@@ -1518,15 +1752,7 @@ void QueryIPQueue::adjustHead( const unsigned long currentTime )
 
 bool QueryIPQueue::addressInQueue( const NETADDRESS_s AddressFrom ) const
 {
-	// Search through the queue.
-	for ( unsigned int i = _queueHead; i != _queueTail; i = ( i + 1 ) % MAX_QUERY_IPS )
-	{
-		if ( AddressFrom.CompareNoPort( _IPQueue[i].Address ))
-			return true;
-	}
-
-	// Not found, or the queue is empty.
-	return false;
+	return ( _addressCounts.find( addressKey( AddressFrom )) != _addressCounts.end( ));
 }
 
 //=============================================================================
@@ -1557,6 +1783,7 @@ void QueryIPQueue::addAddress( const NETADDRESS_s AddressFrom, const unsigned lo
 	_IPQueue[_queueTail].Address = AddressFrom;
 	_IPQueue[_queueTail].nextAllowedTime = currentTime + _entryLength;
 	_queueTail = ( _queueTail + 1 ) % MAX_QUERY_IPS;
+	_addressCounts[addressKey( AddressFrom )]++;
 
 	// Is the queue full?
 	if ( _queueTail == _queueHead )
@@ -1564,6 +1791,6 @@ void QueryIPQueue::addAddress( const NETADDRESS_s AddressFrom, const unsigned lo
 		if ( errorOut )
 			*errorOut << "WARNING! The IP flood queue is full.\n";
 
-		_queueHead = ( _queueHead + 1 ) % MAX_QUERY_IPS; // [RC] Start removing older entries.
+		removeHead( ); // [RC] Start removing older entries.
 	}
 }
@@ -57,6 +57,7 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <unordered_map>
 #include <time.h>
 #include <ctype.h>
 #include <math.h>
@@ -335,6 +336,7 @@ struct BYTESTREAM_s
 	bool ReadBit();
 	int ReadVariable();
 	int ReadShortByte( int bits );
+	unsigned int ReadNetID();
 	void ReadBuffer( void* buffer, size_t length );
 
 	void WriteByte( int Byte );
@@ -345,6 +347,7 @@ struct BYTESTREAM_s
 	void WriteBit( bool bit );
 	void WriteVariable( int value );
 	void WriteShortByte( int value, int bits );
+	void WriteNetID( unsigned int netID );
 	void WriteBuffer( const void *pvBuffer, int nLength );
 
 	void WriteHeader( int Byte );
@@ -405,6 +408,7 @@ struct NETBUFFER_s
 
 void			NETWORK_StartTrafficMeasurement ( );
 int				NETWORK_StopTrafficMeasurement ( );
+void			NETWORK_CountOutboundTraffic ( const int NumBytes );
 
 //--------------------------------------------------------------------------------------------------------------------------------------------------
 //-- CLASSES ---------------------------------------------------------------------------------------------------------------------------------------
@@ -460,14 +464,32 @@ private:
 // Stores a list of IPs. Supports wildcards.
 // @author Benjamin Berkels
 //
+// Lookups go through a binary trie over the 32 address bits that is built
+// from the entries the first time the list is searched after a change.
+// Entries whose wildcards don't form a suffix (e.g. 1.*.3.4) are kept out of
+// the trie and are checked one by one.
+//
 //==========================================================================
 
 class IPList
 {
+	struct TrieNode
+	{
+		// Indices into _trie, 0 means there is no child.
+		ULONG	children[2];
+
+		// The first entry whose prefix ends at this node.
+		ULONG	firstEntry;
+	};
+
 	std::vector<IPADDRESSBAN_s>		_ipVector;
 	std::string						_filename;
 	std::string						_error;
 
+	mutable std::vector<TrieNode>	_trie;
+	mutable std::vector<ULONG>		_entriesNotInTrie;
+	mutable bool					_trieOutdated = true;
+
 //*************************************************************************
 public:
 	bool			clearAndLoadFromFile( const char *Filename );
@@ -491,16 +513,19 @@ public:
 	void			removeExpiredEntries( void ); // [RC]
 
 	unsigned int	size() const { return static_cast<unsigned int>( _ipVector.size( )); }
-	void			clear() { _ipVector.clear(); }
-	void			push_back ( IPADDRESSBAN_s &IP ) { _ipVector.push_back(IP); }
+	void			clear() { _ipVector.clear(); _trieOutdated = true; }
+	void			push_back ( IPADDRESSBAN_s &IP ) { _ipVector.push_back(IP); _trieOutdated = true; }
 	const char		*getErrorMessage() const { return _error.c_str(); }
 	const char		*getFilename() const { return _filename.c_str(); } // [AK]
 
+	// The addresses of the entries must not be changed through this, the trie wouldn't notice.
 	std::vector<IPADDRESSBAN_s>&	getVector() { return _ipVector; }
 
 //*************************************************************************
 private:
 	bool rewriteListToFile ();
+	void rebuildTrie () const;
+	ULONG findInTrie ( const BYTE *abIP ) const;
 };
 
 //==========================================================================
@@ -538,6 +563,13 @@ class QueryIPQueue
 	// How long entries will last (seconds).
 	unsigned int				_entryLength;
 
+	// How often each IP (ignoring the port) is in the queue, so that addressInQueue
+	// doesn't have to search the whole queue.
+	std::unordered_map<unsigned int, unsigned int>	_addressCounts;
+
+	static unsigned int	addressKey( const NETADDRESS_s &Address );
+	void				removeHead( );
+
 //*************************************************************************
 public:
 	QueryIPQueue( int entryLength ) : _queueHead( 0 ), _queueTail( 0 ), _entryLength( entryLength )
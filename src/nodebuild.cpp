@@ -43,6 +43,9 @@
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #include "doomdata.h"
 #include "nodebuild.h"
@@ -51,11 +54,34 @@
 #include "m_bbox.h"
 #include "c_console.h"
 #include "r_state.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "doomstat.h"
+#include "stats.h"
 
 const int MaxSegs = 64;
 const int SplitCost = 8;
 const int AAPreference = 16;
 
+// Number of threads that score splitters (0 = one per core, up to 8,
+// 1 = don't use any extra threads).
+CUSTOM_CVAR (Int, nodebuildthreads, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+{
+	if (self < 0)
+	{
+		self = 0;
+	}
+	else if (self > 64)
+	{
+		self = 64;
+	}
+}
+
+// A set's splitters are only scored in parallel if that takes at least
+// this many line classifications. That's only true near the top of the tree
+// of a big map, and there it's where nearly all of the time goes.
+const double ParallelScoreWork = 262144;
+
 #if 0
 #define D(x) x
 #else
@@ -459,6 +485,7 @@ int FNodeBuilder::SelectSplitter (DWORD set, node_t &node, DWORD &splitseg, int
 	DWORD bestseg;
 	DWORD seg;
 	bool nosplitters = false;
+	unsigned int segsInSet = 0;
 
 	bestvalue = 0;
 	bestseg = DWORD_MAX;
@@ -467,9 +494,12 @@ int FNodeBuilder::SelectSplitter (DWORD set, node_t &node, DWORD &splitseg, int
 	stepleft = 0;
 
 	memset (&PlaneChecked[0], 0, PlaneChecked.Size());
+	SplitterCandidates.Clear ();
 
 	D(Printf (PRINT_LOG, "Processing set %d\n", set));
 
+	// Find the candidates first, so that ScoreSplitters can score them
+	// on several threads.
 	while (seg != DWORD_MAX)
 	{
 		FPrivSeg *pseg = &Segs[seg];
@@ -487,28 +517,33 @@ int FNodeBuilder::SelectSplitter (DWORD set, node_t &node, DWORD &splitseg, int
 				}
 
 				stepleft = step;
-				SetNodeFromSeg (node, pseg);
-
-				int value = Heuristic (node, set, nosplit);
-
-				D(Printf (PRINT_LOG, "Seg %5d, ld %d (%5d,%5d)-(%5d,%5d) scores %d\n", seg, Segs[seg].linedef, node.x>>16, node.y>>16,
-					(node.x+node.dx)>>16, (node.y+node.dy)>>16, value));
-
-				if (value > bestvalue)
-				{
-					bestvalue = value;
-					bestseg = seg;
-				}
-				else if (value < 0)
-				{
-					nosplitters = true;
-				}
+				SplitterCandidates.Push (seg);
 			}
 		}
 
+		segsInSet++;
 		seg = pseg->next;
 	}
 
+	ScoreSplitters (set, nosplit, segsInSet);
+
+	for (unsigned int i = 0; i < SplitterCandidates.Size(); ++i)
+	{
+		int value = SplitterScores[i];
+
+		D(Printf (PRINT_LOG, "Seg %5d, ld %d scores %d\n", SplitterCandidates[i], Segs[SplitterCandidates[i]].linedef, value));
+
+		if (value > bestvalue)
+		{
+			bestvalue = value;
+			bestseg = SplitterCandidates[i];
+		}
+		else if (value < 0)
+		{
+			nosplitters = true;
+		}
+	}
+
 	if (bestseg == DWORD_MAX)
 	{ // No lines split any others into two sets, so this is a convex region.
 	D(Printf (PRINT_LOG, "set %d, step %d, nosplit %d has no good splitter (%d)\n", set, step, nosplit, nosplitters));
@@ -522,13 +557,69 @@ int FNodeBuilder::SelectSplitter (DWORD set, node_t &node, DWORD &splitseg, int
 	return 1;
 }
 
+// Scores each of the SplitterCandidates into SplitterScores. Big sets
+// are scored on several threads, each taking the next candidate that is left.
+// Every score is still computed by the same code from the same segs, and
+// SelectSplitter compares them in the original order, so the splitter it
+// picks does not depend on the number of threads.
+
+void FNodeBuilder::ScoreSplitters (DWORD set, bool nosplit, unsigned int segsInSet)
+{
+	const unsigned int numcandidates = SplitterCandidates.Size();
+	unsigned int numthreads = 1;
+
+	SplitterScores.Resize (numcandidates);
+
+#ifndef BACKPATCH	// ClassifyLineBackpatch patches its caller, which isn't thread safe.
+	if (double(numcandidates) * segsInSet >= ParallelScoreWork)
+	{
+		numthreads = nodebuildthreads > 0 ? nodebuildthreads : clamp<int> (std::thread::hardware_concurrency(), 1, 8);
+		numthreads = MIN (numthreads, numcandidates);
+	}
+#endif
+
+	std::atomic<unsigned int> nextcandidate (0);
+	auto worker = [&](TArray<int> &touched, TArray<int> &colinear)
+	{
+		node_t node;
+		unsigned int i;
+
+		while ((i = nextcandidate++) < numcandidates)
+		{
+			SetNodeFromSeg (node, &Segs[SplitterCandidates[i]]);
+			SplitterScores[i] = Heuristic (node, set, nosplit, touched, colinear);
+		}
+	};
+
+	if (numthreads <= 1)
+	{
+		worker (Touched, Colinear);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < numthreads; ++i)
+	{
+		threads.push_back (std::thread ([&]()
+		{
+			TArray<int> touched, colinear;
+			worker (touched, colinear);
+		}));
+	}
+	worker (Touched, Colinear);
+	for (unsigned int i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join ();
+	}
+}
+
 // Given a splitter (node), returns a score based on how "good" the resulting
 // split in a set of segs is. Higher scores are better. -1 means this splitter
 // splits something it shouldn't and will only be returned if honorNoSplit is
 // true. A score of 0 means that the splitter does not split any of the segs
 // in the set.
 
-int FNodeBuilder::Heuristic (node_t &node, DWORD set, bool honorNoSplit)
+int FNodeBuilder::Heuristic (node_t &node, DWORD set, bool honorNoSplit, TArray<int> &touched, TArray<int> &colinear)
 {
 	// Set the initial score above 0 so that near vertex anti-weighting is less likely to produce a negative score.
 	int score = 1000000;
@@ -543,8 +634,8 @@ int FNodeBuilder::Heuristic (node_t &node, DWORD set, bool honorNoSplit)
 	unsigned int max, m2, p, q;
 	double frac;
 
-	Touched.Clear ();
-	Colinear.Clear ();
+	touched.Clear ();
+	colinear.Clear ();
 
 	while (i != DWORD_MAX)
 	{
@@ -570,32 +661,32 @@ int FNodeBuilder::Heuristic (node_t &node, DWORD set, bool honorNoSplit)
 			{
 				if ((sidev[0] | sidev[1]) != 0)
 				{
-					max = Touched.Size();
+					max = touched.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Touched[p] == test->loopnum)
+						if (touched[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Touched.Push (test->loopnum);
+						touched.Push (test->loopnum);
 					}
 				}
 				else
 				{
-					max = Colinear.Size();
+					max = colinear.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Colinear[p] == test->loopnum)
+						if (colinear[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Colinear.Push (test->loopnum);
+						colinear.Push (test->loopnum);
 					}
 				}
 			}
@@ -712,8 +803,8 @@ int FNodeBuilder::Heuristic (node_t &node, DWORD set, bool honorNoSplit)
 	// seg of that sector must be crossing the container's corner and does not
 	// actually split the container.
 
-	max = Touched.Size ();
-	m2 = Colinear.Size ();
+	max = touched.Size ();
+	m2 = colinear.Size ();
 
 	// If honorNoSplit is false, then both these lists will be empty.
 
@@ -726,10 +817,10 @@ int FNodeBuilder::Heuristic (node_t &node, DWORD set, bool honorNoSplit)
 
 	for (p = 0; p < max; ++p)
 	{
-		int look = Touched[p];
+		int look = touched[p];
 		for (q = 0; q < m2; ++q)
 		{
-			if (look == Colinear[q])
+			if (look == colinear[q])
 			{
 				break;
 			}
@@ -1078,6 +1169,139 @@ void FNodeBuilder::PrintSet (int l, DWORD set)
 	Printf (PRINT_LOG, "*\n");
 }
 
+//==========================================================================
+//
+// nodebench
+//
+// Builds GL nodes for the current level once without and once with extra
+// threads, and prints how long each build took and whether the results are
+// identical.
+//
+//==========================================================================
+
+struct FBenchNodes
+{
+	node_t *Nodes;				int NumNodes;
+	seg_t *Segs;				int NumSegs;
+	glsegextra_t *GLSegExtras;
+	subsector_t *Subsectors;	int NumSubsectors;
+	vertex_t *Vertices;			int NumVertices;
+	line_t *Lines;
+	double Time;
+};
+
+static ptrdiff_t NodeBench_ChildIndex (const FBenchNodes &built, void *child)
+{
+	if ((size_t)child & 1)
+	{
+		return -1 - ((subsector_t *)((BYTE *)child - 1) - built.Subsectors);
+	}
+	return (node_t *)child - built.Nodes;
+}
+
+static bool NodeBench_Compare (const FBenchNodes &a, const FBenchNodes &b)
+{
+	int i;
+
+	if (a.NumNodes != b.NumNodes || a.NumSegs != b.NumSegs ||
+		a.NumSubsectors != b.NumSubsectors || a.NumVertices != b.NumVertices)
+	{
+		return false;
+	}
+	for (i = 0; i < a.NumVertices; ++i)
+	{
+		if (a.Vertices[i].x != b.Vertices[i].x || a.Vertices[i].y != b.Vertices[i].y)
+			return false;
+	}
+	for (i = 0; i < a.NumNodes; ++i)
+	{
+		const node_t &x = a.Nodes[i], &y = b.Nodes[i];
+		if (x.x != y.x || x.y != y.y || x.dx != y.dx || x.dy != y.dy ||
+			memcmp (x.bbox, y.bbox, sizeof(x.bbox)) != 0 ||
+			NodeBench_ChildIndex (a, x.children[0]) != NodeBench_ChildIndex (b, y.children[0]) ||
+			NodeBench_ChildIndex (a, x.children[1]) != NodeBench_ChildIndex (b, y.children[1]))
+			return false;
+	}
+	for (i = 0; i < a.NumSegs; ++i)
+	{
+		const seg_t &x = a.Segs[i], &y = b.Segs[i];
+		if (x.v1 - a.Vertices != y.v1 - b.Vertices || x.v2 - a.Vertices != y.v2 - b.Vertices ||
+			x.sidedef != y.sidedef || x.linedef - a.Lines != y.linedef - b.Lines ||
+			x.frontsector != y.frontsector || x.backsector != y.backsector ||
+			a.GLSegExtras[i].PartnerSeg != b.GLSegExtras[i].PartnerSeg ||
+			a.GLSegExtras[i].Subsector - a.Subsectors != b.GLSegExtras[i].Subsector - b.Subsectors)
+			return false;
+	}
+	for (i = 0; i < a.NumSubsectors; ++i)
+	{
+		if (a.Subsectors[i].firstline - a.Segs != b.Subsectors[i].firstline - b.Segs ||
+			a.Subsectors[i].numlines != b.Subsectors[i].numlines)
+			return false;
+	}
+	return true;
+}
+
+CCMD (nodebench)
+{
+	if (gamestate != GS_LEVEL)
+	{
+		Printf ("You must be in a level to use this command.\n");
+		return;
+	}
+
+	FBenchNodes built[2];
+	TArray<line_t> linecopies[2];
+	const int oldthreads = nodebuildthreads;
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		// The node builder changes the vertices of the lines it is given.
+		for (int i = 0; i < numlines; ++i)
+		{
+			linecopies[pass].Push (lines[i]);
+		}
+		built[pass].Lines = &linecopies[pass][0];
+
+		TArray<FNodeBuilder::FPolyStart> polyspots, anchors;
+		FNodeBuilder::FLevel leveldata =
+		{
+			vertexes, numvertexes,
+			sides, numsides,
+			built[pass].Lines, numlines,
+			0, 0, 0, 0
+		};
+		cycle_t time;
+
+		leveldata.FindMapBounds ();
+		nodebuildthreads = pass == 0 ? 1 : oldthreads;
+		time.Reset ();
+		time.Clock ();
+		{
+			FNodeBuilder builder (leveldata, polyspots, anchors, true);
+			builder.Extract (built[pass].Nodes, built[pass].NumNodes,
+				built[pass].Segs, built[pass].GLSegExtras, built[pass].NumSegs,
+				built[pass].Subsectors, built[pass].NumSubsectors,
+				built[pass].Vertices, built[pass].NumVertices);
+		}
+		time.Unclock ();
+		built[pass].Time = time.TimeMS ();
+	}
+	nodebuildthreads = oldthreads;
+
+	Printf ("%d nodes, %d segs, %d subsectors\n", built[0].NumNodes, built[0].NumSegs, built[0].NumSubsectors);
+	Printf ("Serial build %.1f ms, threaded build %.1f ms, results are %s\n", built[0].Time, built[1].Time,
+		NodeBench_Compare (built[0], built[1]) ? "identical" : "DIFFERENT");
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		delete[] built[pass].Nodes;
+		delete[] built[pass].Segs;
+		delete[] built[pass].GLSegExtras;
+		delete[] built[pass].Subsectors;
+		delete[] built[pass].Vertices;
+	}
+}
+
 
 
 #ifdef BACKPATCH
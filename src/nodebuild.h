@@ -249,6 +249,9 @@ private:
 
 	TArray<FSplitSharer> SplitSharers;	// Segs colinear with the current splitter
 
+	TArray<DWORD> SplitterCandidates;	// Segs SelectSplitter tries as splitters
+	TArray<int> SplitterScores;			// And the Heuristic score of each
+
 	DWORD HackSeg;			// Seg to force to back of splitter
 	DWORD HackMate;			// Seg to use in front of hack seg
 	FLevel &Level;
@@ -275,7 +278,12 @@ private:
 	bool ShoveSegBehind (DWORD set, node_t &node, DWORD seg, DWORD mate);	int SelectSplitter (DWORD set, node_t &node, DWORD &splitseg, int step, bool nosplit);
 	void SplitSegs (DWORD set, node_t &node, DWORD splitseg, DWORD &outset0, DWORD &outset1, unsigned int &count0, unsigned int &count1);
 	DWORD SplitSeg (DWORD segnum, int splitvert, int v1InFront);
-	int Heuristic (node_t &node, DWORD set, bool honorNoSplit);
+	void ScoreSplitters (DWORD set, bool nosplit, unsigned int segsInSet);
+	int Heuristic (node_t &node, DWORD set, bool honorNoSplit)
+	{
+		return Heuristic (node, set, honorNoSplit, Touched, Colinear);
+	}
+	int Heuristic (node_t &node, DWORD set, bool honorNoSplit, TArray<int> &touched, TArray<int> &colinear);
 
 	// Returns:
 	//	0 = seg is in front
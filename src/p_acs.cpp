@@ -2781,6 +2781,11 @@ FBehavior::FBehavior (int lumpnum, FileReader * fr, int len)
 		}
 	}
 
+	if (Format != ACS_Unknown)
+	{
+		TranslateCode ();
+	}
+
 	DPrintf ("Loaded %d scripts, %d functions\n", NumScripts, NumFunctions);
 }
 
@@ -2826,6 +2831,404 @@ FBehavior::~FBehavior ()
 	}
 }
 
+//============================================================================
+//
+// FBehavior :: TranslateCode
+//
+// Translates the module's p-code into a stream that RunScript can run
+// without caring about the module's format: Every p-code and every operand
+// takes exactly one little endian word, and jump targets, jump points and
+// script and function addresses are byte offsets into that stream.
+//
+// Code and data can't be told apart in a module, so only the p-code that is
+// reachable from a script, a function or a jump point is translated.
+//
+//============================================================================
+
+struct FBehavior::TranslatedPCode
+{
+	DWORD FileOfs;			// Where the p-code starts in the module
+	DWORD FileEnd;			// Where the p-code after it starts in the module
+	int PCode;
+	unsigned int FirstArg;	// Index of the first operand in args
+	unsigned int NumArgs;
+	bool FallsThrough;		// Can execution continue at FileEnd?
+	DWORD CodeOfs;			// Where the p-code starts in the translated code
+};
+
+// Reads the operands of a p-code from a module, making sure it doesn't read
+// past the end of it.
+class FACSCodeReader
+{
+public:
+	FACSCodeReader (const BYTE *data, DWORD size, DWORD pos)
+		: Pos(pos), Overrun(false), Data(data), Size(size)
+	{
+	}
+
+	int ReadByte ()
+	{
+		if (!Check (1)) return 0;
+		return Data[Pos++];
+	}
+
+	int ReadShort ()
+	{
+		if (!Check (2)) return 0;
+		SWORD res = SWORD(Data[Pos] | (Data[Pos+1] << 8));
+		Pos += 2;
+		return res;
+	}
+
+	int ReadWord ()
+	{
+		if (!Check (4)) return 0;
+		int res = Data[Pos] | (Data[Pos+1] << 8) | (Data[Pos+2] << 16) | (Data[Pos+3] << 24);
+		Pos += 4;
+		return res;
+	}
+
+	void Align ()
+	{
+		Pos = (Pos + 3) & ~3;
+	}
+
+	DWORD Pos;
+	bool Overrun;
+
+private:
+	bool Check (DWORD len)
+	{
+		if (Overrun || Pos + len > Size || Pos + len < Pos)
+		{
+			Overrun = true;
+			return false;
+		}
+		return true;
+	}
+
+	const BYTE *Data;
+	DWORD Size;
+};
+
+int STACK_ARGS FBehavior::SortTranslatedPCodes (const void *a, const void *b)
+{
+	const TranslatedPCode *ptr1 = (const TranslatedPCode *)a;
+	const TranslatedPCode *ptr2 = (const TranslatedPCode *)b;
+	return ptr1->FileOfs < ptr2->FileOfs ? -1 : ptr1->FileOfs > ptr2->FileOfs ? 1 : 0;
+}
+
+void FBehavior::TranslateCode ()
+{
+	TArray<TranslatedPCode> pcodes;
+	TArray<int> args;
+	TArray<bool> argIsJump;
+	TArray<DWORD> pending;
+	TMap<DWORD, bool> visited;
+	DWORD ofs;
+	unsigned int i, j;
+	int k;
+
+	// Find all the code that can be reached.
+	for (k = 0; k < NumScripts; ++k)
+	{
+		pending.Push (Scripts[k].Address);
+	}
+	for (k = 0; k < NumFunctions; ++k)
+	{
+		if (Functions[k].ImportNum == 0 && Functions[k].Address != 0)
+		{
+			pending.Push (Functions[k].Address);
+		}
+	}
+	for (i = 0; i < JumpPoints.Size(); ++i)
+	{
+		pending.Push (JumpPoints[i]);
+	}
+
+	while (pending.Pop (ofs))
+	{
+		if (visited.CheckKey (ofs) != NULL)
+		{
+			continue;
+		}
+		visited[ofs] = true;
+
+		FACSCodeReader reader (Data, DataSize, ofs);
+		TranslatedPCode pcode;
+		const char *operands;
+
+		pcode.FileOfs = ofs;
+		pcode.FirstArg = args.Size();
+		pcode.FallsThrough = true;
+
+		if (Format == ACS_LittleEnhanced)
+		{
+			pcode.PCode = reader.ReadByte ();
+			if (pcode.PCode >= 256-16)
+			{
+				pcode.PCode = (256-16) + ((pcode.PCode - (256-16)) << 8) + reader.ReadByte ();
+			}
+		}
+		else
+		{
+			pcode.PCode = reader.ReadWord ();
+		}
+
+		if (pcode.PCode < 0 || pcode.PCode >= DLevelScript::PCODE_COMMAND_COUNT)
+		{
+			// RunScript terminates the script when it gets here.
+			operands = "";
+			pcode.FallsThrough = false;
+		}
+		else
+		{
+			operands = DLevelScript::GetPCodeOperands (pcode.PCode);
+		}
+
+		for (; *operands != 0 && !reader.Overrun; ++operands)
+		{
+			int count;
+
+			switch (*operands)
+			{
+			case 'B':
+				args.Push (Format == ACS_LittleEnhanced ? reader.ReadByte () : reader.ReadWord ());
+				argIsJump.Push (false);
+				break;
+
+			case 'S':
+				args.Push (Format == ACS_LittleEnhanced ? reader.ReadShort () : reader.ReadWord ());
+				argIsJump.Push (false);
+				break;
+
+			case 'W':
+				args.Push (reader.ReadWord ());
+				argIsJump.Push (false);
+				break;
+
+			case 'J':
+				args.Push (reader.ReadWord ());
+				argIsJump.Push (true);
+				pending.Push (args.Last());
+				break;
+
+			case 'b':
+				args.Push (reader.ReadByte ());
+				argIsJump.Push (false);
+				break;
+
+			case 'C':
+				count = reader.ReadByte ();
+				args.Push (count);
+				argIsJump.Push (false);
+				while (count-- > 0)
+				{
+					args.Push (reader.ReadByte ());
+					argIsJump.Push (false);
+				}
+				break;
+
+			case 'T':
+				reader.Align ();
+				count = reader.ReadWord ();
+				if (count < 0 || DWORD(count) > (DataSize - reader.Pos) / 8)
+				{
+					reader.Overrun = true;
+					break;
+				}
+				args.Push (count);
+				argIsJump.Push (false);
+				while (count-- > 0)
+				{
+					args.Push (reader.ReadWord ());
+					argIsJump.Push (false);
+					args.Push (reader.ReadWord ());
+					argIsJump.Push (true);
+					pending.Push (args.Last());
+				}
+				break;
+			}
+		}
+
+		switch (pcode.PCode)
+		{
+		case DLevelScript::PCD_TERMINATE:
+		case DLevelScript::PCD_RESTART:
+		case DLevelScript::PCD_GOTO:
+		case DLevelScript::PCD_GOTOSTACK:
+		case DLevelScript::PCD_RETURNVOID:
+		case DLevelScript::PCD_RETURNVAL:
+			pcode.FallsThrough = false;
+			break;
+		}
+
+		// A p-code that doesn't fit into the module ends the script.
+		if (reader.Overrun)
+		{
+			pcode.PCode = DLevelScript::PCD_TERMINATE;
+			pcode.FallsThrough = false;
+			args.Resize (pcode.FirstArg);
+			argIsJump.Resize (pcode.FirstArg);
+		}
+
+		pcode.NumArgs = args.Size() - pcode.FirstArg;
+		pcode.FileEnd = reader.Pos;
+		pcodes.Push (pcode);
+
+		if (pcode.FallsThrough)
+		{
+			pending.Push (pcode.FileEnd);
+		}
+	}
+
+	// Lay the p-codes out in the same order as in the module. The code starts
+	// with a PCD_TERMINATE, so that no p-code is at offset 0, which marks
+	// functions that aren't defined in this module.
+	if (pcodes.Size() > 0)
+	{
+		qsort (&pcodes[0], pcodes.Size(), sizeof(TranslatedPCode), SortTranslatedPCodes);
+	}
+
+	TMap<DWORD, DWORD> fileToCode;
+	DWORD size = 1;
+
+	for (i = 0; i < pcodes.Size(); ++i)
+	{
+		pcodes[i].CodeOfs = size * 4;
+		fileToCode[pcodes[i].FileOfs] = pcodes[i].CodeOfs;
+		size += 1 + pcodes[i].NumArgs;
+
+		// If the next p-code doesn't follow this one, jump to it.
+		if (pcodes[i].FallsThrough && (i + 1 == pcodes.Size() || pcodes[i+1].FileOfs != pcodes[i].FileEnd))
+		{
+			size += 2;
+		}
+	}
+
+	Code.Resize (size);
+	CodeMap.Clear ();
+	Code[0] = LittleLong(DLevelScript::PCD_TERMINATE);
+
+	for (i = 0; i < pcodes.Size(); ++i)
+	{
+		const TranslatedPCode &pcode = pcodes[i];
+		int *pc = Ofs2PC (pcode.CodeOfs);
+		CodeMapEntry entry = { pcode.FileOfs, pcode.CodeOfs };
+
+		CodeMap.Push (entry);
+		*pc++ = LittleLong(pcode.PCode);
+		for (j = 0; j < pcode.NumArgs; ++j)
+		{
+			int arg = args[pcode.FirstArg + j];
+			if (argIsJump[pcode.FirstArg + j])
+			{
+				arg = *fileToCode.CheckKey (arg);
+			}
+			*pc++ = LittleLong(arg);
+		}
+
+		if (pcode.FallsThrough && (i + 1 == pcodes.Size() || pcodes[i+1].FileOfs != pcode.FileEnd))
+		{
+			CodeMapEntry jump = { pcode.FileEnd, PC2Ofs (pc) };
+			CodeMap.Push (jump);
+			*pc++ = LittleLong(DLevelScript::PCD_GOTO);
+			*pc++ = LittleLong(*fileToCode.CheckKey (pcode.FileEnd));
+		}
+	}
+
+	// Make everything that pointed into the module point into the translated code.
+	for (k = 0; k < NumScripts; ++k)
+	{
+		Scripts[k].Address = *fileToCode.CheckKey (Scripts[k].Address);
+	}
+	for (k = 0; k < NumFunctions; ++k)
+	{
+		if (Functions[k].ImportNum == 0 && Functions[k].Address != 0)
+		{
+			Functions[k].Address = *fileToCode.CheckKey (Functions[k].Address);
+		}
+	}
+	for (i = 0; i < JumpPoints.Size(); ++i)
+	{
+		JumpPoints[i] = *fileToCode.CheckKey (JumpPoints[i]);
+	}
+}
+
+//============================================================================
+//
+// FBehavior :: PC2FileOfs
+//
+// Returns where the p-code at pc is in the module. Savegames store these, so
+// that they don't depend on how the module was translated.
+//
+//============================================================================
+
+DWORD FBehavior::PC2FileOfs (int *pc) const
+{
+	const DWORD ofs = PC2Ofs (pc);
+	unsigned int min = 0, max = CodeMap.Size();
+
+	// The map is sorted by CodeOfs.
+	while (min < max)
+	{
+		unsigned int mid = (min + max) / 2;
+		if (CodeMap[mid].CodeOfs == ofs)
+		{
+			return CodeMap[mid].FileOfs;
+		}
+		else if (CodeMap[mid].CodeOfs < ofs)
+		{
+			min = mid + 1;
+		}
+		else
+		{
+			max = mid;
+		}
+	}
+	return 0;
+}
+
+//============================================================================
+//
+// FBehavior :: FileOfs2PC
+//
+//============================================================================
+
+int *FBehavior::FileOfs2PC (DWORD ofs) const
+{
+	unsigned int min = 0, max = CodeMap.Size();
+
+	// The map is sorted by FileOfs unless the module jumps into the middle of
+	// a p-code, which compilers don't do.
+	while (min < max)
+	{
+		unsigned int mid = (min + max) / 2;
+		if (CodeMap[mid].FileOfs == ofs)
+		{
+			return Ofs2PC (CodeMap[mid].CodeOfs);
+		}
+		else if (CodeMap[mid].FileOfs < ofs)
+		{
+			min = mid + 1;
+		}
+		else
+		{
+			max = mid;
+		}
+	}
+	for (unsigned int i = 0; i < CodeMap.Size(); ++i)
+	{
+		if (CodeMap[i].FileOfs == ofs)
+		{
+			return Ofs2PC (CodeMap[i].CodeOfs);
+		}
+	}
+
+	// Not a p-code of this module, so just end the script.
+	return Ofs2PC (0);
+}
+
 void FBehavior::LoadScriptsDirectory ()
 {
 	union
@@ -3738,7 +4141,7 @@ void DLevelScript::Serialize (FArchive &arc)
 	{
 		WORD lib = activeBehavior->GetLibraryID() >> LIBRARYID_SHIFT;
 		arc << lib;
-		i = activeBehavior->PC2Ofs (pc);
+		i = activeBehavior->PC2FileOfs (pc);
 		arc << i;
 	}
 	else
@@ -3746,7 +4149,7 @@ void DLevelScript::Serialize (FArchive &arc)
 		WORD lib;
 		arc << lib << i;
 		activeBehavior = FBehavior::StaticGetModule (lib);
-		pc = activeBehavior->Ofs2PC (i);
+		pc = activeBehavior->FileOfs2PC (i);
 	}
 
 	// [BC] The server doesn't have an active font.
@@ -5709,9 +6112,48 @@ static int GetUserCVar(int playernum, const char *cvarname, bool is_string)
 	return DoGetCVar(cvar, is_string);
 }
 
-static int GetCVar(AActor *activator, const char *cvarname, bool is_string)
+//*****************************************************************************
+//
+// Cvars resolved by GetCVar, keyed by the ACS string id of their name. Scripts
+// tend to poll the same few cvars every tic, so this saves hashing the name
+// each time. The whole cache is dropped once any cvar is created or destroyed.
+static TMap<DWORD, FBaseCVar *> ACSCVarCache;
+static unsigned int ACSCVarCacheGeneration;
+
+static FBaseCVar *FindACSCVar(DWORD strid, const char *cvarname)
 {
+	if (cvarname == NULL)
+	{
+		return NULL;
+	}
+
+	// Dynamic strings get new ids all the time, don't let the cache grow forever.
+	if (ACSCVarCacheGeneration != C_GetCVarGeneration() || ACSCVarCache.CountUsed() > 1024)
+	{
+		ACSCVarCache.Clear();
+		ACSCVarCacheGeneration = C_GetCVarGeneration();
+	}
+
+	// The id of a dynamic string can be reused for a different string once
+	// the old one is freed, so the name still has to be checked.
+	FBaseCVar **cached = ACSCVarCache.CheckKey(strid);
+	if (cached != NULL && stricmp((*cached)->GetName(), cvarname) == 0)
+	{
+		return *cached;
+	}
+
 	FBaseCVar *cvar = FindCVar(cvarname, NULL);
+	if (cvar != NULL)
+	{
+		ACSCVarCache[strid] = cvar;
+	}
+	return cvar;
+}
+
+static int GetCVar(AActor *activator, DWORD strid, bool is_string)
+{
+	const char *cvarname = FBehavior::StaticLookupString(strid);
+	FBaseCVar *cvar = FindACSCVar(strid, cvarname);
 	// Either the cvar doesn't exist, or it's for a mod that isn't loaded, so return 0.
 	if (cvar == NULL || (cvar->GetFlags() & CVAR_IGNORE))
 	{
@@ -6364,7 +6806,7 @@ int DLevelScript::CallFunction(int argCount, int funcIndex, SDWORD *args, struct
 		case ACSF_GetCVarString:
 			if (argCount == 1)
 			{
-				return GetCVar(activator, FBehavior::StaticLookupString(args[0]), true);
+				return GetCVar(activator, args[0], true);
 			}
 			break;
 
@@ -8886,28 +9328,26 @@ enum
 };
 
 
+// Every p-code and operand takes a word once the module has been translated,
+// see FBehavior::TranslateCode.
 #define NEXTWORD	(LittleLong(*pc++))
-#define NEXTBYTE	(fmt==ACS_LittleEnhanced?getbyte(pc):NEXTWORD)
-#define NEXTSHORT	(fmt==ACS_LittleEnhanced?getshort(pc):NEXTWORD)
+#define NEXTBYTE	NEXTWORD
+#define NEXTSHORT	NEXTWORD
+
+// With GCC and Clang, the most common p-codes are dispatched through a label
+// table instead of the switch. All other p-codes still go through the switch.
+#if defined(__GNUC__)
+#define ACS_COMPUTED_GOTO
+#define PCODE_CASE(a)	case a: pcode_##a
+#define PCODE_LABEL(a)	pcodeLabels[a] = &&pcode_##a
+#else
+#define PCODE_CASE(a)	case a
+#endif
 #define STACK(a)	(Stack[sp - (a)])
 #define PushToStack(a)	(Stack[sp++] = (a))
 // Direct instructions that take strings need to have the tag applied.
 #define TAGSTR(a)	(a|activeBehavior->GetLibraryID())
 
-inline int getbyte (int *&pc)
-{
-	int res = *(BYTE *)pc;
-	pc = (int *)((BYTE *)pc+1);
-	return res;
-}
-
-inline int getshort (int *&pc)
-{
-	int res = LittleShort( *(SWORD *)pc);
-	pc = (int *)((BYTE *)pc+2);
-	return res;
-}
-
 static bool CharArrayParms(int &capacity, int &offset, int &a, FACSStackMemory& Stack, int &sp, bool ranged)
 {
 	if (ranged)
@@ -8932,6 +9372,241 @@ static bool CharArrayParms(int &capacity, int &offset, int &a, FACSStackMemory&
 	return true;
 }
 
+//============================================================================
+//
+// DLevelScript :: GetPCodeOperands
+//
+// Describes the operands that follow a p-code in a module, one character
+// per operand:
+//   B: a byte in ACS_LittleEnhanced modules, a word otherwise
+//   S: a short in ACS_LittleEnhanced modules, a word otherwise
+//   W: a word
+//   J: a word with the offset to jump to
+//   b: a byte
+//   C: a byte with a count, followed by that many bytes
+//   T: a word aligned word with a count, followed by that many pairs of
+//      a value and an offset to jump to
+//
+//============================================================================
+
+const char *DLevelScript::GetPCodeOperands (int pcd)
+{
+	switch (pcd)
+	{
+	case PCD_LSPEC1:
+	case PCD_LSPEC2:
+	case PCD_LSPEC3:
+	case PCD_LSPEC4:
+	case PCD_LSPEC5:
+	case PCD_LSPEC5RESULT:
+	case PCD_PUSHFUNCTION:
+	case PCD_CALL:
+	case PCD_CALLDISCARD:
+	case PCD_ASSIGNSCRIPTVAR:
+	case PCD_ASSIGNSCRIPTARRAY:
+	case PCD_ASSIGNMAPVAR:
+	case PCD_ASSIGNMAPARRAY:
+	case PCD_ASSIGNWORLDVAR:
+	case PCD_ASSIGNWORLDARRAY:
+	case PCD_ASSIGNGLOBALVAR:
+	case PCD_ASSIGNGLOBALARRAY:
+	case PCD_PUSHSCRIPTVAR:
+	case PCD_PUSHSCRIPTARRAY:
+	case PCD_PUSHMAPVAR:
+	case PCD_PUSHMAPARRAY:
+	case PCD_PUSHWORLDVAR:
+	case PCD_PUSHWORLDARRAY:
+	case PCD_PUSHGLOBALVAR:
+	case PCD_PUSHGLOBALARRAY:
+	case PCD_ADDSCRIPTVAR:
+	case PCD_ADDSCRIPTARRAY:
+	case PCD_ADDMAPVAR:
+	case PCD_ADDMAPARRAY:
+	case PCD_ADDWORLDVAR:
+	case PCD_ADDWORLDARRAY:
+	case PCD_ADDGLOBALVAR:
+	case PCD_ADDGLOBALARRAY:
+	case PCD_SUBSCRIPTVAR:
+	case PCD_SUBSCRIPTARRAY:
+	case PCD_SUBMAPVAR:
+	case PCD_SUBMAPARRAY:
+	case PCD_SUBWORLDVAR:
+	case PCD_SUBWORLDARRAY:
+	case PCD_SUBGLOBALVAR:
+	case PCD_SUBGLOBALARRAY:
+	case PCD_MULSCRIPTVAR:
+	case PCD_MULSCRIPTARRAY:
+	case PCD_MULMAPVAR:
+	case PCD_MULMAPARRAY:
+	case PCD_MULWORLDVAR:
+	case PCD_MULWORLDARRAY:
+	case PCD_MULGLOBALVAR:
+	case PCD_MULGLOBALARRAY:
+	case PCD_DIVSCRIPTVAR:
+	case PCD_DIVSCRIPTARRAY:
+	case PCD_DIVMAPVAR:
+	case PCD_DIVMAPARRAY:
+	case PCD_DIVWORLDVAR:
+	case PCD_DIVWORLDARRAY:
+	case PCD_DIVGLOBALVAR:
+	case PCD_DIVGLOBALARRAY:
+	case PCD_MODSCRIPTVAR:
+	case PCD_MODSCRIPTARRAY:
+	case PCD_MODMAPVAR:
+	case PCD_MODMAPARRAY:
+	case PCD_MODWORLDVAR:
+	case PCD_MODWORLDARRAY:
+	case PCD_MODGLOBALVAR:
+	case PCD_MODGLOBALARRAY:
+	case PCD_ANDSCRIPTVAR:
+	case PCD_ANDSCRIPTARRAY:
+	case PCD_ANDMAPVAR:
+	case PCD_ANDMAPARRAY:
+	case PCD_ANDWORLDVAR:
+	case PCD_ANDWORLDARRAY:
+	case PCD_ANDGLOBALVAR:
+	case PCD_ANDGLOBALARRAY:
+	case PCD_EORSCRIPTVAR:
+	case PCD_EORSCRIPTARRAY:
+	case PCD_EORMAPVAR:
+	case PCD_EORMAPARRAY:
+	case PCD_EORWORLDVAR:
+	case PCD_EORWORLDARRAY:
+	case PCD_EORGLOBALVAR:
+	case PCD_EORGLOBALARRAY:
+	case PCD_ORSCRIPTVAR:
+	case PCD_ORSCRIPTARRAY:
+	case PCD_ORMAPVAR:
+	case PCD_ORMAPARRAY:
+	case PCD_ORWORLDVAR:
+	case PCD_ORWORLDARRAY:
+	case PCD_ORGLOBALVAR:
+	case PCD_ORGLOBALARRAY:
+	case PCD_LSSCRIPTVAR:
+	case PCD_LSSCRIPTARRAY:
+	case PCD_LSMAPVAR:
+	case PCD_LSMAPARRAY:
+	case PCD_LSWORLDVAR:
+	case PCD_LSWORLDARRAY:
+	case PCD_LSGLOBALVAR:
+	case PCD_LSGLOBALARRAY:
+	case PCD_RSSCRIPTVAR:
+	case PCD_RSSCRIPTARRAY:
+	case PCD_RSMAPVAR:
+	case PCD_RSMAPARRAY:
+	case PCD_RSWORLDVAR:
+	case PCD_RSWORLDARRAY:
+	case PCD_RSGLOBALVAR:
+	case PCD_RSGLOBALARRAY:
+	case PCD_INCSCRIPTVAR:
+	case PCD_INCSCRIPTARRAY:
+	case PCD_INCMAPVAR:
+	case PCD_INCMAPARRAY:
+	case PCD_INCWORLDVAR:
+	case PCD_INCWORLDARRAY:
+	case PCD_INCGLOBALVAR:
+	case PCD_INCGLOBALARRAY:
+	case PCD_DECSCRIPTVAR:
+	case PCD_DECSCRIPTARRAY:
+	case PCD_DECMAPVAR:
+	case PCD_DECMAPARRAY:
+	case PCD_DECWORLDVAR:
+	case PCD_DECWORLDARRAY:
+	case PCD_DECGLOBALVAR:
+	case PCD_DECGLOBALARRAY:
+		return "B";
+
+	case PCD_CALLFUNC:
+		return "BS";
+
+	case PCD_LSPEC1DIRECT:
+		return "BW";
+
+	case PCD_LSPEC2DIRECT:
+		return "BWW";
+
+	case PCD_LSPEC3DIRECT:
+		return "BWWW";
+
+	case PCD_LSPEC4DIRECT:
+		return "BWWWW";
+
+	case PCD_LSPEC5DIRECT:
+		return "BWWWWW";
+
+	case PCD_PUSHNUMBER:
+	case PCD_DELAYDIRECT:
+	case PCD_TAGWAITDIRECT:
+	case PCD_POLYWAITDIRECT:
+	case PCD_SCRIPTWAITDIRECT:
+	case PCD_SETFONTDIRECT:
+	case PCD_SETGRAVITYDIRECT:
+	case PCD_SETAIRCONTROLDIRECT:
+	case PCD_CHECKINVENTORYDIRECT:
+		return "W";
+
+	case PCD_RANDOMDIRECT:
+	case PCD_THINGCOUNTDIRECT:
+	case PCD_CHANGEFLOORDIRECT:
+	case PCD_CHANGECEILINGDIRECT:
+	case PCD_GIVEINVENTORYDIRECT:
+	case PCD_TAKEINVENTORYDIRECT:
+		return "WW";
+
+	case PCD_CONSOLECOMMANDDIRECT:
+	case PCD_SETMUSICDIRECT:
+	case PCD_LOCALSETMUSICDIRECT:
+		return "WWW";
+
+	case PCD_SPAWNSPOTDIRECT:
+		return "WWWW";
+
+	case PCD_SPAWNDIRECT:
+		return "WWWWWW";
+
+	case PCD_PUSHBYTE:
+	case PCD_DELAYDIRECTB:
+		return "b";
+
+	case PCD_PUSH2BYTES:
+	case PCD_RANDOMDIRECTB:
+	case PCD_LSPEC1DIRECTB:
+		return "bb";
+
+	case PCD_PUSH3BYTES:
+	case PCD_LSPEC2DIRECTB:
+		return "bbb";
+
+	case PCD_PUSH4BYTES:
+	case PCD_LSPEC3DIRECTB:
+		return "bbbb";
+
+	case PCD_PUSH5BYTES:
+	case PCD_LSPEC4DIRECTB:
+		return "bbbbb";
+
+	case PCD_LSPEC5DIRECTB:
+		return "bbbbbb";
+
+	case PCD_PUSHBYTES:
+		return "C";
+
+	case PCD_GOTO:
+	case PCD_IFGOTO:
+	case PCD_IFNOTGOTO:
+		return "J";
+
+	case PCD_CASEGOTO:
+		return "WJ";
+
+	case PCD_CASEGOTOSORTED:
+		return "T";
+
+	default:
+		return "";
+	}
+}
+
 int DLevelScript::RunScript ()
 {
 	DACSThinker *controller = DACSThinker::ActiveThinker;
@@ -9037,6 +9712,84 @@ int DLevelScript::RunScript ()
 	// [AK] Any action or line specials activated at this point are done from ACS so indicate that.
 	g_pCurrentScript = this;
 
+#ifdef ACS_COMPUTED_GOTO
+	static void *pcodeLabels[PCODE_COMMAND_COUNT];
+	static bool pcodeLabelsInitialized = false;
+
+	if (!pcodeLabelsInitialized)
+	{
+		for (int i = 0; i < PCODE_COMMAND_COUNT; ++i)
+		{
+			pcodeLabels[i] = &&pcode_switch;
+		}
+		PCODE_LABEL(PCD_PUSHNUMBER);
+		PCODE_LABEL(PCD_PUSHBYTE);
+		PCODE_LABEL(PCD_PUSH2BYTES);
+		PCODE_LABEL(PCD_PUSH3BYTES);
+		PCODE_LABEL(PCD_PUSH4BYTES);
+		PCODE_LABEL(PCD_PUSH5BYTES);
+		PCODE_LABEL(PCD_PUSHBYTES);
+		PCODE_LABEL(PCD_LSPEC1);
+		PCODE_LABEL(PCD_LSPEC2);
+		PCODE_LABEL(PCD_LSPEC3);
+		PCODE_LABEL(PCD_LSPEC4);
+		PCODE_LABEL(PCD_LSPEC5);
+		PCODE_LABEL(PCD_LSPEC5RESULT);
+		PCODE_LABEL(PCD_CALLFUNC);
+		PCODE_LABEL(PCD_CALL);
+		PCODE_LABEL(PCD_CALLDISCARD);
+		PCODE_LABEL(PCD_RETURNVOID);
+		PCODE_LABEL(PCD_RETURNVAL);
+		PCODE_LABEL(PCD_ASSIGNSCRIPTVAR);
+		PCODE_LABEL(PCD_ASSIGNMAPVAR);
+		PCODE_LABEL(PCD_ASSIGNWORLDVAR);
+		PCODE_LABEL(PCD_ASSIGNGLOBALVAR);
+		PCODE_LABEL(PCD_ASSIGNSCRIPTARRAY);
+		PCODE_LABEL(PCD_ASSIGNMAPARRAY);
+		PCODE_LABEL(PCD_PUSHSCRIPTVAR);
+		PCODE_LABEL(PCD_PUSHMAPVAR);
+		PCODE_LABEL(PCD_PUSHWORLDVAR);
+		PCODE_LABEL(PCD_PUSHGLOBALVAR);
+		PCODE_LABEL(PCD_PUSHSCRIPTARRAY);
+		PCODE_LABEL(PCD_PUSHMAPARRAY);
+		PCODE_LABEL(PCD_ADDSCRIPTVAR);
+		PCODE_LABEL(PCD_SUBSCRIPTVAR);
+		PCODE_LABEL(PCD_INCSCRIPTVAR);
+		PCODE_LABEL(PCD_DECSCRIPTVAR);
+		PCODE_LABEL(PCD_ADD);
+		PCODE_LABEL(PCD_SUBTRACT);
+		PCODE_LABEL(PCD_MULTIPLY);
+		PCODE_LABEL(PCD_DIVIDE);
+		PCODE_LABEL(PCD_MODULUS);
+		PCODE_LABEL(PCD_EQ);
+		PCODE_LABEL(PCD_NE);
+		PCODE_LABEL(PCD_LT);
+		PCODE_LABEL(PCD_GT);
+		PCODE_LABEL(PCD_LE);
+		PCODE_LABEL(PCD_GE);
+		PCODE_LABEL(PCD_ANDLOGICAL);
+		PCODE_LABEL(PCD_ORLOGICAL);
+		PCODE_LABEL(PCD_ANDBITWISE);
+		PCODE_LABEL(PCD_ORBITWISE);
+		PCODE_LABEL(PCD_NEGATELOGICAL);
+		PCODE_LABEL(PCD_GOTO);
+		PCODE_LABEL(PCD_IFGOTO);
+		PCODE_LABEL(PCD_IFNOTGOTO);
+		PCODE_LABEL(PCD_CASEGOTO);
+		PCODE_LABEL(PCD_CASEGOTOSORTED);
+		PCODE_LABEL(PCD_DROP);
+		PCODE_LABEL(PCD_DUP);
+		PCODE_LABEL(PCD_SWAP);
+		PCODE_LABEL(PCD_DELAY);
+		PCODE_LABEL(PCD_DELAYDIRECT);
+		PCODE_LABEL(PCD_DELAYDIRECTB);
+		PCODE_LABEL(PCD_TAGSTRING);
+		PCODE_LABEL(PCD_FIXEDMUL);
+		PCODE_LABEL(PCD_FIXEDDIV);
+		pcodeLabelsInitialized = true;
+	}
+#endif
+
 	while (state == SCRIPT_Running)
 	{
 		if (++runaway > 2000000)
@@ -9046,19 +9799,15 @@ int DLevelScript::RunScript ()
 			break;
 		}
 
-		if (fmt == ACS_LittleEnhanced)
-		{
-			pcd = getbyte(pc);
-			if (pcd >= 256-16)
-			{
-				pcd = (256-16) + ((pcd - (256-16)) << 8) + getbyte(pc);
-			}
-		}
-		else
+		pcd = NEXTWORD;
+
+#ifdef ACS_COMPUTED_GOTO
+		if ((unsigned int)pcd < PCODE_COMMAND_COUNT)
 		{
-			pcd = NEXTWORD;
+			goto *pcodeLabels[pcd];
 		}
-
+pcode_switch:
+#endif
 		switch (pcd)
 		{
 		default:
@@ -9077,87 +9826,86 @@ int DLevelScript::RunScript ()
 			state = SCRIPT_Suspended;
 			break;
 
-		case PCD_TAGSTRING:
+		PCODE_CASE(PCD_TAGSTRING):
 			//Stack[sp-1] |= activeBehavior->GetLibraryID();
 			Stack[sp-1] = GlobalACSStrings.AddString(activeBehavior->LookupString(Stack[sp-1]));
 			break;
 
-		case PCD_PUSHNUMBER:
+		PCODE_CASE(PCD_PUSHNUMBER):
 			PushToStack (uallong(pc[0]));
 			pc++;
 			break;
 
-		case PCD_PUSHBYTE:
-			PushToStack (*(BYTE *)pc);
-			pc = (int *)((BYTE *)pc + 1);
+		PCODE_CASE(PCD_PUSHBYTE):
+			PushToStack (uallong(pc[0]));
+			pc++;
 			break;
 
-		case PCD_PUSH2BYTES:
-			Stack[sp] = ((BYTE *)pc)[0];
-			Stack[sp+1] = ((BYTE *)pc)[1];
+		PCODE_CASE(PCD_PUSH2BYTES):
+			Stack[sp] = uallong(pc[0]);
+			Stack[sp+1] = uallong(pc[1]);
 			sp += 2;
-			pc = (int *)((BYTE *)pc + 2);
+			pc += 2;
 			break;
 
-		case PCD_PUSH3BYTES:
-			Stack[sp] = ((BYTE *)pc)[0];
-			Stack[sp+1] = ((BYTE *)pc)[1];
-			Stack[sp+2] = ((BYTE *)pc)[2];
+		PCODE_CASE(PCD_PUSH3BYTES):
+			Stack[sp] = uallong(pc[0]);
+			Stack[sp+1] = uallong(pc[1]);
+			Stack[sp+2] = uallong(pc[2]);
 			sp += 3;
-			pc = (int *)((BYTE *)pc + 3);
+			pc += 3;
 			break;
 
-		case PCD_PUSH4BYTES:
-			Stack[sp] = ((BYTE *)pc)[0];
-			Stack[sp+1] = ((BYTE *)pc)[1];
-			Stack[sp+2] = ((BYTE *)pc)[2];
-			Stack[sp+3] = ((BYTE *)pc)[3];
+		PCODE_CASE(PCD_PUSH4BYTES):
+			Stack[sp] = uallong(pc[0]);
+			Stack[sp+1] = uallong(pc[1]);
+			Stack[sp+2] = uallong(pc[2]);
+			Stack[sp+3] = uallong(pc[3]);
 			sp += 4;
-			pc = (int *)((BYTE *)pc + 4);
+			pc += 4;
 			break;
 
-		case PCD_PUSH5BYTES:
-			Stack[sp] = ((BYTE *)pc)[0];
-			Stack[sp+1] = ((BYTE *)pc)[1];
-			Stack[sp+2] = ((BYTE *)pc)[2];
-			Stack[sp+3] = ((BYTE *)pc)[3];
-			Stack[sp+4] = ((BYTE *)pc)[4];
+		PCODE_CASE(PCD_PUSH5BYTES):
+			Stack[sp] = uallong(pc[0]);
+			Stack[sp+1] = uallong(pc[1]);
+			Stack[sp+2] = uallong(pc[2]);
+			Stack[sp+3] = uallong(pc[3]);
+			Stack[sp+4] = uallong(pc[4]);
 			sp += 5;
-			pc = (int *)((BYTE *)pc + 5);
+			pc += 5;
 			break;
 
-		case PCD_PUSHBYTES:
-			temp = *(BYTE *)pc;
-			pc = (int *)((BYTE *)pc + temp + 1);
-			for (temp = -temp; temp; temp++)
+		PCODE_CASE(PCD_PUSHBYTES):
+			temp = NEXTWORD;
+			for (; temp > 0; temp--)
 			{
-				PushToStack (*((BYTE *)pc + temp));
+				PushToStack (NEXTWORD);
 			}
 			break;
 
-		case PCD_DUP:
+		PCODE_CASE(PCD_DUP):
 			Stack[sp] = Stack[sp-1];
 			sp++;
 			break;
 
-		case PCD_SWAP:
+		PCODE_CASE(PCD_SWAP):
 			swapvalues(Stack[sp-2], Stack[sp-1]);
 			break;
 
-		case PCD_LSPEC1:
+		PCODE_CASE(PCD_LSPEC1):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(1) & specialargmask, 0, 0, 0, 0);
 			sp -= 1;
 			break;
 
-		case PCD_LSPEC2:
+		PCODE_CASE(PCD_LSPEC2):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask, 0, 0, 0);
 			sp -= 2;
 			break;
 
-		case PCD_LSPEC3:
+		PCODE_CASE(PCD_LSPEC3):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(3) & specialargmask,
 									STACK(2) & specialargmask,
@@ -9165,7 +9913,7 @@ int DLevelScript::RunScript ()
 			sp -= 3;
 			break;
 
-		case PCD_LSPEC4:
+		PCODE_CASE(PCD_LSPEC4):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(4) & specialargmask,
 									STACK(3) & specialargmask,
@@ -9174,7 +9922,7 @@ int DLevelScript::RunScript ()
 			sp -= 4;
 			break;
 
-		case PCD_LSPEC5:
+		PCODE_CASE(PCD_LSPEC5):
 			P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -9184,7 +9932,7 @@ int DLevelScript::RunScript ()
 			sp -= 5;
 			break;
 
-		case PCD_LSPEC5RESULT:
+		PCODE_CASE(PCD_LSPEC5RESULT):
 			STACK(5) = P_ExecuteSpecial(NEXTBYTE, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -9241,38 +9989,38 @@ int DLevelScript::RunScript ()
 
 		// Parameters for PCD_LSPEC?DIRECTB are by definition bytes so never need and-ing.
 		case PCD_LSPEC1DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], 0, 0, 0, 0);
-			pc = (int *)((BYTE *)pc + 2);
+			P_ExecuteSpecial(uallong(pc[0]), activationline, activator, backSide,
+				uallong(pc[1]), 0, 0, 0, 0);
+			pc += 2;
 			break;
 
 		case PCD_LSPEC2DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], 0, 0, 0);
-			pc = (int *)((BYTE *)pc + 3);
+			P_ExecuteSpecial(uallong(pc[0]), activationline, activator, backSide,
+				uallong(pc[1]), uallong(pc[2]), 0, 0, 0);
+			pc += 3;
 			break;
 
 		case PCD_LSPEC3DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3], 0, 0);
-			pc = (int *)((BYTE *)pc + 4);
+			P_ExecuteSpecial(uallong(pc[0]), activationline, activator, backSide,
+				uallong(pc[1]), uallong(pc[2]), uallong(pc[3]), 0, 0);
+			pc += 4;
 			break;
 
 		case PCD_LSPEC4DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3],
-				((BYTE *)pc)[4], 0);
-			pc = (int *)((BYTE *)pc + 5);
+			P_ExecuteSpecial(uallong(pc[0]), activationline, activator, backSide,
+				uallong(pc[1]), uallong(pc[2]), uallong(pc[3]),
+				uallong(pc[4]), 0);
+			pc += 5;
 			break;
 
 		case PCD_LSPEC5DIRECTB:
-			P_ExecuteSpecial(((BYTE *)pc)[0], activationline, activator, backSide,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3],
-				((BYTE *)pc)[4], ((BYTE *)pc)[5]);
-			pc = (int *)((BYTE *)pc + 6);
+			P_ExecuteSpecial(uallong(pc[0]), activationline, activator, backSide,
+				uallong(pc[1]), uallong(pc[2]), uallong(pc[3]),
+				uallong(pc[4]), uallong(pc[5]));
+			pc += 6;
 			break;
 
-		case PCD_CALLFUNC:
+		PCODE_CASE(PCD_CALLFUNC):
 			{
 				int argCount = NEXTBYTE;
 				int funcIndex = NEXTSHORT;
@@ -9293,8 +10041,8 @@ int DLevelScript::RunScript ()
 			PushToStack(TAGSTR(funcnum));
 			break;
 		}
-		case PCD_CALL:
-		case PCD_CALLDISCARD:
+		PCODE_CASE(PCD_CALL):
+		PCODE_CASE(PCD_CALLDISCARD):
 		case PCD_CALLSTACK:
 			{
 				int funcnum;
@@ -9349,8 +10097,8 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_RETURNVOID:
-		case PCD_RETURNVAL:
+		PCODE_CASE(PCD_RETURNVOID):
+		PCODE_CASE(PCD_RETURNVAL):
 			{
 				int value;
 				union
@@ -9385,22 +10133,22 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ADD:
+		PCODE_CASE(PCD_ADD):
 			STACK(2) = STACK(2) + STACK(1);
 			sp--;
 			break;
 
-		case PCD_SUBTRACT:
+		PCODE_CASE(PCD_SUBTRACT):
 			STACK(2) = STACK(2) - STACK(1);
 			sp--;
 			break;
 
-		case PCD_MULTIPLY:
+		PCODE_CASE(PCD_MULTIPLY):
 			STACK(2) = STACK(2) * STACK(1);
 			sp--;
 			break;
 
-		case PCD_DIVIDE:
+		PCODE_CASE(PCD_DIVIDE):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -9412,7 +10160,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_MODULUS:
+		PCODE_CASE(PCD_MODULUS):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -9424,63 +10172,63 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_EQ:
+		PCODE_CASE(PCD_EQ):
 			STACK(2) = (STACK(2) == STACK(1));
 			sp--;
 			break;
 
-		case PCD_NE:
+		PCODE_CASE(PCD_NE):
 			STACK(2) = (STACK(2) != STACK(1));
 			sp--;
 			break;
 
-		case PCD_LT:
+		PCODE_CASE(PCD_LT):
 			STACK(2) = (STACK(2) < STACK(1));
 			sp--;
 			break;
 
-		case PCD_GT:
+		PCODE_CASE(PCD_GT):
 			STACK(2) = (STACK(2) > STACK(1));
 			sp--;
 			break;
 
-		case PCD_LE:
+		PCODE_CASE(PCD_LE):
 			STACK(2) = (STACK(2) <= STACK(1));
 			sp--;
 			break;
 
-		case PCD_GE:
+		PCODE_CASE(PCD_GE):
 			STACK(2) = (STACK(2) >= STACK(1));
 			sp--;
 			break;
 
-		case PCD_ASSIGNSCRIPTVAR:
+		PCODE_CASE(PCD_ASSIGNSCRIPTVAR):
 			locals[NEXTBYTE] = STACK(1);
 			sp--;
 			break;
 
 
-		case PCD_ASSIGNMAPVAR:
+		PCODE_CASE(PCD_ASSIGNMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) = STACK(1);
 			sp--;
 			break;
 
-		case PCD_ASSIGNWORLDVAR:
+		PCODE_CASE(PCD_ASSIGNWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] = STACK(1);
 			sp--;
 			break;
 
-		case PCD_ASSIGNGLOBALVAR:
+		PCODE_CASE(PCD_ASSIGNGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] = STACK(1);
 			sp--;
 			break;
 
-		case PCD_ASSIGNSCRIPTARRAY:
+		PCODE_CASE(PCD_ASSIGNSCRIPTARRAY):
 			localarrays->Set(locals, NEXTBYTE, STACK(2), STACK(1));
 			sp -= 2;
 			break;
 
-		case PCD_ASSIGNMAPARRAY:
+		PCODE_CASE(PCD_ASSIGNMAPARRAY):
 			activeBehavior->SetArrayVal (*(activeBehavior->MapVars[NEXTBYTE]), STACK(2), STACK(1));
 			sp -= 2;
 			break;
@@ -9495,27 +10243,27 @@ int DLevelScript::RunScript ()
 			sp -= 2;
 			break;
 
-		case PCD_PUSHSCRIPTVAR:
+		PCODE_CASE(PCD_PUSHSCRIPTVAR):
 			PushToStack (locals[NEXTBYTE]);
 			break;
 
-		case PCD_PUSHMAPVAR:
+		PCODE_CASE(PCD_PUSHMAPVAR):
 			PushToStack (*(activeBehavior->MapVars[NEXTBYTE]));
 			break;
 
-		case PCD_PUSHWORLDVAR:
+		PCODE_CASE(PCD_PUSHWORLDVAR):
 			PushToStack (ACS_WorldVars[NEXTBYTE]);
 			break;
 
-		case PCD_PUSHGLOBALVAR:
+		PCODE_CASE(PCD_PUSHGLOBALVAR):
 			PushToStack (ACS_GlobalVars[NEXTBYTE]);
 			break;
 
-		case PCD_PUSHSCRIPTARRAY:
+		PCODE_CASE(PCD_PUSHSCRIPTARRAY):
 			STACK(1) = localarrays->Get(locals, NEXTBYTE, STACK(1));
 			break;
 
-		case PCD_PUSHMAPARRAY:
+		PCODE_CASE(PCD_PUSHMAPARRAY):
 			STACK(1) = activeBehavior->GetArrayVal (*(activeBehavior->MapVars[NEXTBYTE]), STACK(1));
 			break;
 
@@ -9527,7 +10275,7 @@ int DLevelScript::RunScript ()
 			STACK(1) = ACS_GlobalArrays[NEXTBYTE][STACK(1)];
 			break;
 
-		case PCD_ADDSCRIPTVAR:
+		PCODE_CASE(PCD_ADDSCRIPTVAR):
 			locals[NEXTBYTE] += STACK(1);
 			sp--;
 			break;
@@ -9580,7 +10328,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_SUBSCRIPTVAR:
+		PCODE_CASE(PCD_SUBSCRIPTVAR):
 			locals[NEXTBYTE] -= STACK(1);
 			sp--;
 			break;
@@ -10156,7 +10904,7 @@ int DLevelScript::RunScript ()
 			break;
 		//[MW] end
 
-		case PCD_INCSCRIPTVAR:
+		PCODE_CASE(PCD_INCSCRIPTVAR):
 			++locals[NEXTBYTE];
 			break;
 
@@ -10205,7 +10953,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DECSCRIPTVAR:
+		PCODE_CASE(PCD_DECSCRIPTVAR):
 			--locals[NEXTBYTE];
 			break;
 
@@ -10255,7 +11003,7 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_GOTO:
+		PCODE_CASE(PCD_GOTO):
 			pc = activeBehavior->Ofs2PC (LittleLong(*pc));
 			break;
 
@@ -10264,7 +11012,7 @@ int DLevelScript::RunScript ()
 			sp--;
 			break;
 
-		case PCD_IFGOTO:
+		PCODE_CASE(PCD_IFGOTO):
 			if (STACK(1))
 				pc = activeBehavior->Ofs2PC (LittleLong(*pc));
 			else
@@ -10281,11 +11029,11 @@ int DLevelScript::RunScript ()
 			if (( bIsFirstTic ) && ( ACS_IsEventScript( script )) && ( resultValue != GAMEMODE_GetEventResult( )))
 				GAMEMODE_SetEventResult( resultValue );
 
-		case PCD_DROP: //fall through.
+		PCODE_CASE(PCD_DROP): //fall through.
 			sp--;
 			break;
 
-		case PCD_DELAY:
+		PCODE_CASE(PCD_DELAY):
 			statedata = STACK(1) + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
 			if (statedata > 0)
 			{
@@ -10294,7 +11042,7 @@ int DLevelScript::RunScript ()
 			sp--;
 			break;
 
-		case PCD_DELAYDIRECT:
+		PCODE_CASE(PCD_DELAYDIRECT):
 			statedata = uallong(pc[0]) + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
 			pc++;
 			if (statedata > 0)
@@ -10303,13 +11051,13 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_DELAYDIRECTB:
-			statedata = *(BYTE *)pc + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
+		PCODE_CASE(PCD_DELAYDIRECTB):
+			statedata = uallong(pc[0]) + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
 			if (statedata > 0)
 			{
 				state = SCRIPT_Delayed;
 			}
-			pc = (int *)((BYTE *)pc + 1);
+			pc++;
 			break;
 
 		case PCD_RANDOM:
@@ -10323,8 +11071,8 @@ int DLevelScript::RunScript ()
 			break;
 
 		case PCD_RANDOMDIRECTB:
-			PushToStack (Random (((BYTE *)pc)[0], ((BYTE *)pc)[1]));
-			pc = (int *)((BYTE *)pc + 2);
+			PushToStack (Random (uallong(pc[0]), uallong(pc[1])));
+			pc += 2;
 			break;
 
 		case PCD_THINGCOUNT:
@@ -10405,22 +11153,22 @@ int DLevelScript::RunScript ()
 			}
 			break;
 
-		case PCD_ANDLOGICAL:
+		PCODE_CASE(PCD_ANDLOGICAL):
 			STACK(2) = (STACK(2) && STACK(1));
 			sp--;
 			break;
 
-		case PCD_ORLOGICAL:
+		PCODE_CASE(PCD_ORLOGICAL):
 			STACK(2) = (STACK(2) || STACK(1));
 			sp--;
 			break;
 
-		case PCD_ANDBITWISE:
+		PCODE_CASE(PCD_ANDBITWISE):
 			STACK(2) = (STACK(2) & STACK(1));
 			sp--;
 			break;
 
-		case PCD_ORBITWISE:
+		PCODE_CASE(PCD_ORBITWISE):
 			STACK(2) = (STACK(2) | STACK(1));
 			sp--;
 			break;
@@ -10430,7 +11178,7 @@ int DLevelScript::RunScript ()
 			sp--;
 			break;
 
-		case PCD_NEGATELOGICAL:
+		PCODE_CASE(PCD_NEGATELOGICAL):
 			STACK(1) = !STACK(1);
 			break;
 
@@ -10455,7 +11203,7 @@ int DLevelScript::RunScript ()
 			STACK(1) = -STACK(1);
 			break;
 
-		case PCD_IFNOTGOTO:
+		PCODE_CASE(PCD_IFNOTGOTO):
 			if (!STACK(1))
 				pc = activeBehavior->Ofs2PC (LittleLong(*pc));
 			else
@@ -10496,7 +11244,7 @@ scriptwait:
 			}
 			break;
 
-		case PCD_CASEGOTO:
+		PCODE_CASE(PCD_CASEGOTO):
 			if (STACK(1) == uallong(pc[0]))
 			{
 				pc = activeBehavior->Ofs2PC (uallong(pc[1]));
@@ -10508,16 +11256,14 @@ scriptwait:
 			}
 			break;
 
-		case PCD_CASEGOTOSORTED:
-			// The count and jump table are 4-byte aligned
-			pc = (int *)(((size_t)pc + 3) & ~3);
+		PCODE_CASE(PCD_CASEGOTOSORTED):
 			{
 				int numcases = uallong(pc[0]); pc++;
 				int min = 0, max = numcases-1;
 				while (min <= max)
 				{
 					int mid = (min + max) / 2;
-					SDWORD caseval = pc[mid*2];
+					SDWORD caseval = LittleLong(pc[mid*2]);
 					if (caseval == STACK(1))
 					{
 						pc = activeBehavior->Ofs2PC (LittleLong(pc[mid*2+1]));
@@ -11411,12 +12157,12 @@ scriptwait:
 			sp -= 3;
 			break;
 
-		case PCD_FIXEDMUL:
+		PCODE_CASE(PCD_FIXEDMUL):
 			STACK(2) = FixedMul (STACK(2), STACK(1));
 			sp--;
 			break;
 
-		case PCD_FIXEDDIV:
+		PCODE_CASE(PCD_FIXEDDIV):
 			STACK(2) = FixedDiv (STACK(2), STACK(1));
 			sp--;
 			break;
@@ -12311,7 +13057,7 @@ scriptwait:
 			break;
 
 		case PCD_GETCVAR:
-			STACK(1) = GetCVar(activator, FBehavior::StaticLookupString(STACK(1)), false);
+			STACK(1) = GetCVar(activator, STACK(1), false);
 			break;
 
 		case PCD_SETHUDSIZE:
@@ -460,8 +460,11 @@ public:
 	const ScriptPtr *FindScript (int number) const;
 	void StartTypedScripts (WORD type, AActor *activator, bool always, int arg1, bool runNow, bool onlyClientSideScripts=false, int arg2=0, int arg3=0); // [BB] Added arg2+arg3
 	int CountTypedScripts( WORD type );
-	DWORD PC2Ofs (int *pc) const { return (DWORD)((BYTE *)pc - Data); }
-	int *Ofs2PC (DWORD ofs) const {	return (int *)(Data + ofs); }
+	// pc and offsets refer to the translated code, see TranslateCode.
+	DWORD PC2Ofs (int *pc) const { return (DWORD)((BYTE *)pc - (BYTE *)&Code[0]); }
+	int *Ofs2PC (DWORD ofs) const {	return (int *)((BYTE *)&Code[0] + ofs); }
+	DWORD PC2FileOfs (int *pc) const;
+	int *FileOfs2PC (DWORD ofs) const;
 	int *Jump2PC (DWORD jumpPoint) const { return Ofs2PC(JumpPoints[jumpPoint]); }
 	ACSFormat GetFormat() const { return Format; }
 	ScriptFunction *GetFunction (int funcnum, FBehavior *&module) const;
@@ -474,7 +477,7 @@ public:
 	int FindMapVarName (const char *varname) const;
 	int FindMapArray (const char *arrayname) const;
 	int GetLibraryID () const { return LibraryID; }
-	int *GetScriptAddress (const ScriptPtr *ptr) const { return (int *)(ptr->Address + Data); }
+	int *GetScriptAddress (const ScriptPtr *ptr) const { return Ofs2PC(ptr->Address); }
 	int GetScriptIndex (const ScriptPtr *ptr) const { ptrdiff_t index = ptr - Scripts; return index >= NumScripts ? -1 : (int)index; }
 	ScriptPtr *GetScriptPtr(int index) const { return index >= 0 && index < NumScripts ? &Scripts[index] : NULL; }
 	int GetLumpNum() const { return LumpNum; }
@@ -507,6 +510,14 @@ public:
 
 private:
 	struct ArrayInfo;
+	struct TranslatedPCode;
+
+	// Where a p-code of the module ended up in the translated code.
+	struct CodeMapEntry
+	{
+		DWORD FileOfs;
+		DWORD CodeOfs;
+	};
 
 	ACSFormat Format;
 
@@ -529,10 +540,14 @@ private:
 	DWORD LibraryID;
 	char ModuleName[9];
 	TArray<int> JumpPoints;
+	TArray<int> Code;
+	TArray<CodeMapEntry> CodeMap;
 
 	static TArray<FBehavior *> StaticModules;
 
 	void LoadScriptsDirectory ();
+	void TranslateCode ();
+	static int STACK_ARGS SortTranslatedPCodes (const void *a, const void *b);
 
 	static int STACK_ARGS SortScripts (const void *a, const void *b);
 	void UnencryptStrings ();
@@ -950,6 +965,8 @@ public:
 /*381*/	PCODE_COMMAND_COUNT
 	};
 
+	static const char *GetPCodeOperands (int pcd);
+
 	// Some constants used by ACS scripts
 	enum {
 		LINE_FRONT =			0,
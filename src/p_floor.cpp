@@ -36,6 +36,7 @@
 #include "cl_demo.h"
 #include "network.h"
 #include "sv_commands.h"
+#include "unlagged.h"
 
 //==========================================================================
 //
@@ -1727,6 +1728,9 @@ void DWaggleBase::DoWaggle (bool ceiling)
 		m_Sector->bFloorHeightChange = true;
 	}
 
+	// Unlagged needs to record the sector while it's waggling.
+	UNLAGGED_SectorMoved( m_Sector );
+
 	switch (m_State)
 	{
 	case WGLSTATE_EXPAND:
@@ -40,8 +40,10 @@
 
 #else
 #include <direct.h>
+#include <process.h>
 
 #define rmdir _rmdir
+#define getpid _getpid
 
 #endif
 
@@ -1008,12 +1010,91 @@ bool P_CheckNodes(MapData * map, bool rebuilt, int buildtime)
 		}
 	}
 
+	P_SaveCachedNodes(map, buildtime);
+
+	if (!gamenodes)
+	{
+		gamenodes = nodes;
+		numgamenodes = numnodes;
+		gamesubsectors = subsectors;
+		numgamesubsectors = numsubsectors;
+	}
+	return ret;
+}
+
+//==========================================================================
+//
+// P_LoadCachedNodes
+//
+// For maps whose nodes have to be built at load time: loads the GL nodes
+// from the node cache instead, if it has them. oldvertextable receives
+// the same table the node builder would have returned.
+//
+//==========================================================================
+
+bool P_LoadCachedNodes(MapData *map, const int *&oldvertextable)
+{
+	// Loading the nodes replaces the vertices, so keep the original ones
+	// around in case the cache turns out to be unusable.
+	TArray<vertex_t> oldvertexes(numvertexes);
+	TArray<int> oldlinevertexes(numlines * 2);
+
+	oldvertexes.Resize(numvertexes);
+	memcpy(&oldvertexes[0], vertexes, numvertexes * sizeof(vertex_t));
+	for (int i = 0; i < numlines; i++)
+	{
+		oldlinevertexes.Push(int(lines[i].v1 - vertexes));
+		oldlinevertexes.Push(int(lines[i].v2 - vertexes));
+	}
+
+	subsectors = NULL;
+	segs = NULL;
+	nodes = NULL;
+	if (!CheckCachedNodes(map))
+	{
+		if (numvertexes != (int)oldvertexes.Size())
+		{
+			delete[] vertexes;
+			numvertexes = oldvertexes.Size();
+			vertexes = new vertex_t[numvertexes];
+		}
+		memcpy(vertexes, &oldvertexes[0], numvertexes * sizeof(vertex_t));
+		for (int i = 0; i < numlines; i++)
+		{
+			lines[i].v1 = &vertexes[oldlinevertexes[i*2]];
+			lines[i].v2 = &vertexes[oldlinevertexes[i*2+1]];
+		}
+		return false;
+	}
+
+	// Vertices that aren't used by any line are dropped, just like the
+	// node builder does.
+	int *table = new int[oldvertexes.Size()];
+	memset(table, -1, oldvertexes.Size() * sizeof(int));
+	for (int i = 0; i < numlines; i++)
+	{
+		table[oldlinevertexes[i*2]] = int(lines[i].v1 - vertexes);
+		table[oldlinevertexes[i*2+1]] = int(lines[i].v2 - vertexes);
+	}
+	oldvertextable = table;
+	return true;
+}
+
+//==========================================================================
+//
+// P_SaveCachedNodes
+//
+// Caches the current GL nodes if building them took long enough.
+//
+//==========================================================================
+
+void P_SaveCachedNodes(MapData *map, int buildtime)
+{
 #ifdef DEBUG
 	// Building nodes in debug is much slower so let's cache them only if cachetime is 0
 	buildtime = 0;
 #endif
-	// [BB] Reportedly, the server can crash in case "gl_cachenodes true".
-	if ( ( NETWORK_GetState( ) != NETSTATE_SERVER ) && gl_cachenodes && buildtime/1000.f >= gl_cachetime)
+	if (gl_cachenodes && buildtime/1000.f >= gl_cachetime)
 	{
 		DPrintf("Caching nodes\n");
 		CreateCachedNodes(map);
@@ -1022,16 +1103,6 @@ bool P_CheckNodes(MapData * map, bool rebuilt, int buildtime)
 	{
 		DPrintf("Not caching nodes (time = %f)\n", buildtime/1000.f);
 	}
-
-
-	if (!gamenodes)
-	{
-		gamenodes = nodes;
-		numgamenodes = numnodes;
-		gamesubsectors = subsectors;
-		numgamesubsectors = numsubsectors;
-	}
-	return ret;
 }
 
 //==========================================================================
@@ -1042,6 +1113,9 @@ bool P_CheckNodes(MapData * map, bool rebuilt, int buildtime)
 
 typedef TArray<BYTE> MemFile;
 
+// Magic, number of lines, MD5 of the map and MD5 of the rest of the file.
+enum { NODECACHE_HEADER_SIZE = 4 + 4 + 16 + 16 };
+
 
 static FString CreateCacheName(MapData *map, bool create)
 {
@@ -1142,77 +1216,127 @@ static void CreateCachedNodes(MapData *map)
 		}
 	}
 
-	uLongf outlen = ZNodes.Size();
-	BYTE *compressed;
-	int offset = numlines * 8 + 12 + 16;
-	int r;
-	do
+	// The cache file starts with a header that identifies the map, followed by the
+	// payload: the vertices of all lines and the compressed nodes. The header also
+	// contains a checksum of the payload, so that a file that wasn't completely
+	// written can never be loaded.
+	uLongf outlen = compressBound(ZNodes.Size());
+	const int payloadStart = NODECACHE_HEADER_SIZE;
+	const int offset = payloadStart + numlines * 8 + 4;
+	BYTE *compressed = new Bytef[outlen + offset];
+
+	if (compress (compressed + offset, &outlen, &ZNodes[0], ZNodes.Size()) != Z_OK)
 	{
-		compressed = new Bytef[outlen + offset];
-		r = compress (compressed + offset, &outlen, &ZNodes[0], ZNodes.Size());
-		if (r == Z_BUF_ERROR)
-		{
-			delete[] compressed;
-			outlen += 1024;
-		}
-	} 
-	while (r == Z_BUF_ERROR);
+		delete[] compressed;
+		return;
+	}
 
-	memcpy(compressed, "CACH", 4);
+	memcpy(compressed, "CAC2", 4);
 	DWORD len = LittleLong(numlines);
 	memcpy(compressed+4, &len, 4);
 	map->GetChecksum(compressed+8);
 	for(int i=0;i<numlines;i++)
 	{
 		DWORD ndx[2] = {LittleLong(DWORD(lines[i].v1 - vertexes)), LittleLong(DWORD(lines[i].v2 - vertexes)) };
-		memcpy(compressed+8+16+8*i, ndx, 8);
+		memcpy(compressed+payloadStart+8*i, ndx, 8);
 	}
 	memcpy(compressed + offset - 4, "ZGL2", 4);
 
+	MD5Context md5;
+	md5.Update(compressed + payloadStart, outlen + offset - payloadStart);
+	md5.Final(compressed + 24);
+
+	// Several servers may share the cache and a crash may happen at any time, so write
+	// to a file of our own first and only then put it in place.
 	FString path = CreateCacheName(map, true);
-	FILE *f = fopen(path, "wb");
-	fwrite(compressed, 1, outlen+offset, f);
-	fclose(f);
+	FString temppath;
+	temppath.Format("%s.%d.tmp", path.GetChars(), int(getpid()));
+
+	FILE *f = fopen(temppath, "wb");
+	if (f == NULL)
+	{
+		DPrintf("Can't write node cache %s\n", temppath.GetChars());
+		delete [] compressed;
+		return;
+	}
+
+	const bool written = (fwrite(compressed, 1, outlen+offset, f) == outlen+offset);
 	delete [] compressed;
+
+	if (fclose(f) != 0 || !written)
+	{
+		remove(temppath);
+		return;
+	}
+
+#ifdef _WIN32
+	// Windows' rename doesn't replace existing files.
+	remove(path);
+#endif
+	if (rename(temppath, path) != 0)
+	{
+		remove(temppath);
+	}
 }
 
 
 static bool CheckCachedNodes(MapData *map)
 {
-	char magic[4] = {0,0,0,0};
-	BYTE md5[16];
 	BYTE md5map[16];
+	BYTE md5payload[16];
 	DWORD numlin;
-	DWORD *verts = NULL;
 
 	FString path = CreateCacheName(map, false);
 	FILE *f = fopen(path, "rb");
 	if (f == NULL) return false;
 
-	if (fread(magic, 1, 4, f) != 4) goto errorout;
-	if (memcmp(magic, "CACH", 4))  goto errorout;
+	// Read the whole file at once, the payload has to be verified before anything
+	// in it can be trusted anyway.
+	TArray<BYTE> data;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size > 0)
+	{
+		data.Resize(size);
+		if (fread(&data[0], 1, size, f) != (size_t)size) size = -1;
+	}
+	fclose(f);
+
+	if (size < NODECACHE_HEADER_SIZE + 4) return false;
+	if (memcmp(&data[0], "CAC2", 4)) return false;
 
-	if (fread(&numlin, 4, 1, f) != 1) goto errorout; 
+	memcpy(&numlin, &data[4], 4);
 	numlin = LittleLong(numlin);
-	if ((int)numlin != numlines) goto errorout;
+	if ((int)numlin != numlines) return false;
+	if (size < NODECACHE_HEADER_SIZE + (long)numlin * 8 + 4) return false;
 
-	if (fread(md5, 1, 16, f) != 16) goto errorout;
 	map->GetChecksum(md5map);
-	if (memcmp(md5, md5map, 16)) goto errorout;
+	if (memcmp(&data[8], md5map, 16)) return false;
 
-	verts = new DWORD[numlin * 8];
-	if (fread(verts, 8, numlin, f) != numlin) goto errorout;
-
-	if (fread(magic, 1, 4, f) != 4) goto errorout;
-	if (memcmp(magic, "ZGL2", 4))  goto errorout;
+	MD5Context md5;
+	md5.Update(&data[NODECACHE_HEADER_SIZE], size - NODECACHE_HEADER_SIZE);
+	md5.Final(md5payload);
+	if (memcmp(&data[24], md5payload, 16)) return false;
 
+	const BYTE *verts = &data[NODECACHE_HEADER_SIZE];
+	const long nodesStart = NODECACHE_HEADER_SIZE + numlin * 8;
+	if (memcmp(&data[nodesStart], "ZGL2", 4)) return false;
 
 	try
 	{
-		long pos = ftell(f);
-		FileReader fr(f);
-		fr.Seek(pos, SEEK_SET);
+		MemoryReader fr((const char *)&data[nodesStart + 4], size - nodesStart - 4);
 		P_LoadZNodes (fr, MAKE_ID('Z','G','L','2'));
+
+		for(int i=0;i<numlines;i++)
+		{
+			DWORD ndx[2];
+			memcpy(ndx, verts + 8*i, 8);
+			if (LittleLong(ndx[0]) >= (DWORD)numvertexes || LittleLong(ndx[1]) >= (DWORD)numvertexes)
+			{
+				throw CRecoverableError("Invalid vertex in node cache");
+			}
+		}
 	}
 	catch (CRecoverableError &error)
 	{
@@ -1233,26 +1357,17 @@ static bool CheckCachedNodes(MapData *map)
 			delete[] nodes;
 			nodes = NULL;
 		}
-		goto errorout;
+		return false;
 	}
 
 	for(int i=0;i<numlines;i++)
 	{
-		lines[i].v1 = &vertexes[LittleLong(verts[i*2])];
-		lines[i].v2 = &vertexes[LittleLong(verts[i*2+1])];
+		DWORD ndx[2];
+		memcpy(ndx, verts + 8*i, 8);
+		lines[i].v1 = &vertexes[LittleLong(ndx[0])];
+		lines[i].v2 = &vertexes[LittleLong(ndx[1])];
 	}
-	delete [] verts;
-
-	fclose(f);
 	return true;
-
-errorout:
-	if (verts != NULL)
-	{
-		delete[] verts;
-	}
-	fclose(f);
-	return false;
 }
 
 UNSAFE_CCMD(clearnodecache)
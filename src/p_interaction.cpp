@@ -2284,6 +2284,9 @@ void PLAYER_SetTeam( player_t *pPlayer, ULONG ulTeam, bool bNoBroadcast )
 {
 	bool	bBroadcastChange = false;
 
+	if ( NETWORK_GetState( ) == NETSTATE_SERVER )
+		SERVER_MASTER_InvalidateLauncherResponses( );
+
 	if (
 		// Player was removed from a team.
 		( pPlayer->bOnTeam && ulTeam == teams.Size( ) ) || 
@@ -2417,6 +2420,9 @@ void PLAYER_SetSpectator( player_t *pPlayer, bool bBroadcast, bool bDeadSpectato
 {
 	AActor	*pOldBody;
 
+	if ( NETWORK_GetState( ) == NETSTATE_SERVER )
+		SERVER_MASTER_InvalidateLauncherResponses( );
+
 	// Already a spectator. Check if their spectating state is changing.
 	if ( pPlayer->bSpectating == true )
 	{
@@ -36,6 +36,7 @@
 #include "templates.h"
 #include "p_local.h"
 #include "p_lnspec.h"
+#include "unlagged.h"
 
 enum
 {
@@ -94,6 +95,7 @@ bool sector_t::IsLinked(sector_t *other, bool ceiling) const
 
 static bool MoveCeiling(sector_t *sector, int crush, fixed_t move)
 {
+	UNLAGGED_SectorMoved( sector );
 	sector->ceilingplane.ChangeHeight (move);
 	sector->ChangePlaneTexZ(sector_t::ceiling, move);
 
@@ -112,6 +114,7 @@ static bool MoveCeiling(sector_t *sector, int crush, fixed_t move)
 
 static bool MoveFloor(sector_t *sector, int crush, fixed_t move)
 {
+	UNLAGGED_SectorMoved( sector );
 	sector->floorplane.ChangeHeight (move);
 	sector->ChangePlaneTexZ(sector_t::floor, move);
 
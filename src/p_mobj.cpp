@@ -4756,10 +4756,76 @@ bool AActor::UpdateWaterLevel (fixed_t oldz, bool dosplash)
 template <typename T>
 void IDList<T>::clear( void )
 {
-	for ( unsigned int i = 0; i <= ( std::numeric_limits<unsigned short>::max )( ); i++ )
-		freeID ( i );
+	// Start over with the initial size, so that the IDs of a new level
+	// are as short on the wire as possible. ID 0 is never free.
+	_entries.Clear ( );
+	_entries.Reserve ( 1 );
+	_entries[0].bFree = false;
+	_entries[0].pActor = NULL;
+	_entries[0].prevFree = 0;
+	_entries[0].nextFree = 0;
 
-	_firstFreeID = 1;
+	_firstFreeID = 0;
+	_lastFreeID = 0;
+	grow ( NETID_INITIALSIZE );
+}
+
+//*****************************************************************************
+//
+// Adds free nodes to the table until it has the given size. The new IDs
+// are appended to the free list in ascending order.
+//
+template <typename T>
+void IDList<T>::grow( const unsigned int size )
+{
+	const unsigned int first = _entries.Size( );
+
+	if ( size <= first )
+		return;
+
+	_entries.Reserve ( size - first );
+
+	for ( unsigned int i = first; i < size; i++ )
+	{
+		_entries[i].bFree = true;
+		_entries[i].pActor = NULL;
+		_entries[i].prevFree = i - 1;
+		_entries[i].nextFree = i + 1;
+	}
+
+	_entries[first].prevFree = _lastFreeID;
+	_entries[size - 1].nextFree = 0;
+
+	if ( _lastFreeID != 0 )
+		_entries[_lastFreeID].nextFree = first;
+	else
+		_firstFreeID = first;
+
+	_lastFreeID = size - 1;
+}
+
+//*****************************************************************************
+//
+// Takes a free node out of the free list and marks it as used.
+//
+template <typename T>
+void IDList<T>::unlinkFreeID( const unsigned int netID )
+{
+	IDNODE_t &node = _entries[netID];
+
+	if ( node.prevFree != 0 )
+		_entries[node.prevFree].nextFree = node.nextFree;
+	else
+		_firstFreeID = node.nextFree;
+
+	if ( node.nextFree != 0 )
+		_entries[node.nextFree].prevFree = node.prevFree;
+	else
+		_lastFreeID = node.prevFree;
+
+	node.bFree = false;
+	node.prevFree = 0;
+	node.nextFree = 0;
 }
 
 //*****************************************************************************
@@ -4775,7 +4841,7 @@ void IDList<T>::rebuild( void )
 
 	while ( (pActor = it.Next()) )
 	{
-		if ( isIndexValid ( pActor->NetID ))
+		if ( pActor->NetID != 0 )
 			useID ( pActor->NetID, pActor );
 	}
 }
@@ -4783,16 +4849,44 @@ void IDList<T>::rebuild( void )
 //*****************************************************************************
 //
 template <typename T>
-void IDList<T>::useID ( const unsigned short netID, T *actor )
+void IDList<T>::useID ( const unsigned int netID, T *actor )
 {
-	if ( isIndexValid ( netID ) )
-	{
-		if ( ( _entries[netID].bFree == false ) && ( _entries[netID].pActor != actor ) )
-			SERVER_PrintWarning ( "IDList<T>::useID is using an already used ID.\n" );
+	if (( netID == 0 ) || ( netID >= NETID_MAXSIZE ))
+		return;
 
-		_entries[netID].bFree = false;
-		_entries[netID].pActor = actor;
-	}
+	// The server may have handed out IDs beyond our table (and when
+	// rebuilding, so may we).
+	if ( netID >= _entries.Size( ))
+		grow ( netID + 1 );
+
+	if ( _entries[netID].bFree )
+		unlinkFreeID ( netID );
+	else if (( _entries[netID].pActor != NULL ) && ( _entries[netID].pActor != actor ))
+		SERVER_PrintWarning ( "IDList<T>::useID is using an already used ID.\n" );
+
+	_entries[netID].pActor = actor;
+}
+
+//*****************************************************************************
+//
+template <typename T>
+void IDList<T>::freeID ( const unsigned int netID )
+{
+	if (( isIndexValid ( netID ) == false ) || _entries[netID].bFree )
+		return;
+
+	IDNODE_t &node = _entries[netID];
+	node.bFree = true;
+	node.pActor = NULL;
+	node.prevFree = _lastFreeID;
+	node.nextFree = 0;
+
+	if ( _lastFreeID != 0 )
+		_entries[_lastFreeID].nextFree = netID;
+	else
+		_firstFreeID = netID;
+
+	_lastFreeID = netID;
 }
 
 //*****************************************************************************
@@ -4800,39 +4894,164 @@ void IDList<T>::useID ( const unsigned short netID, T *actor )
 void CountActors ( ); // [BB]
 
 template <typename T>
-unsigned short IDList<T>::getNewID( void )
+unsigned int IDList<T>::getNewID( void )
 {
-	// Actor's network ID is the first availible net ID.
-	unsigned short id = _firstFreeID;
-
-	do
+	if ( _firstFreeID == 0 )
 	{
-		if ( _firstFreeID == ( std::numeric_limits<unsigned short>::max )( ))
-			_firstFreeID = 1;
-		else
-			_firstFreeID++;
-
-		if ( _firstFreeID == id )
+		if ( _entries.Size( ) >= NETID_MAXSIZE )
 		{
 			// [BB] In case there is no free netID, the server has to abort the current game.
 			if ( NETWORK_GetState( ) == NETSTATE_SERVER )
 			{
-				// [BB] We can only spawn (MAX_NETID-2) actors with netID, because ID zero is reserved and
-				// we already check that a new ID for the next actor is available when assign a net ID.
-				Printf( "ACTOR_GetNewNetID: Network ID limit reached (>=%u actors)\n", ( std::numeric_limits<unsigned short>::max )( ));
+				// [BB] ID zero is reserved, so we can only spawn (NETID_MAXSIZE-1) actors with netID.
+				Printf( "ACTOR_GetNewNetID: Network ID limit reached (>=%u actors)\n", NETID_MAXSIZE - 1 );
 				CountActors ( );
-				I_Error ("Network ID limit reached (>=%u actors)!\n", ( std::numeric_limits<unsigned short>::max )( ));
+				I_Error ("Network ID limit reached (>=%u actors)!\n", NETID_MAXSIZE - 1 );
 			}
 
 			return ( 0 );
 		}
-	} while ( _entries[_firstFreeID].bFree == false );
 
+		// All IDs are in use, so double the table.
+		grow ( MIN<unsigned int>( _entries.Size( ) * 2, NETID_MAXSIZE ));
+	}
+
+	// Actor's network ID is the first available net ID.
+	const unsigned int id = _firstFreeID;
+	unlinkFreeID ( id );
 	return ( id );
 }
 
 template class IDList<AActor>;
 
+//*****************************************************************************
+//
+// netidbench [count]
+//
+// Allocates count network IDs (four million by default) from a list of its
+// own, keeping twice as many in use as fit in the initial table and freeing
+// them in random order, and prints how long getNewID and freeID took. In a
+// level (but not as a client), it then spawns and destroys count MapSpots
+// the same way and checks that their IDs can be looked up.
+//
+static FRandom pr_netidbench;
+
+// Moves n randomly chosen ones of the first size entries to the front.
+template<class T>
+static void netidbench_Shuffle( TArray<T> &entries, unsigned int n, unsigned int size )
+{
+	for ( unsigned int i = 0; i < n; i++ )
+	{
+		const unsigned int j = i + pr_netidbench( size - i );
+		swapvalues( entries[i], entries[j] );
+	}
+}
+
+CCMD( netidbench )
+{
+	int count = ( argv.argc( ) > 1 ) ? atoi( argv[1] ) : 4000000;
+	if ( count <= 0 )
+		count = 1;
+
+	const unsigned int live = IDList<AActor>::NETID_INITIALSIZE * 2;
+	const unsigned int batch = live / 4;
+	IDList<AActor> *list = new IDList<AActor>;
+	TArray<unsigned int> ids;
+	TArray<unsigned int> order;
+	cycle_t gettime, freetime;
+	unsigned int numGets = 0, numFrees = 0;
+
+	ids.Resize( live );
+	order.Resize( live );
+	for ( unsigned int i = 0; i < live; i++ )
+		order[i] = i;
+
+	gettime.Reset( );
+	freetime.Reset( );
+
+	gettime.Clock( );
+	for ( unsigned int i = 0; i < live; i++ )
+	{
+		ids[i] = list->getNewID( );
+		list->useID( ids[i], NULL );
+	}
+	gettime.Unclock( );
+	numGets = live;
+
+	while ( numGets < static_cast<unsigned int>( count ))
+	{
+		const unsigned int n = MIN( batch, count - numGets );
+		netidbench_Shuffle( order, n, live );
+
+		freetime.Clock( );
+		for ( unsigned int i = 0; i < n; i++ )
+			list->freeID( ids[order[i]] );
+		freetime.Unclock( );
+
+		gettime.Clock( );
+		for ( unsigned int i = 0; i < n; i++ )
+		{
+			ids[order[i]] = list->getNewID( );
+			list->useID( ids[order[i]], NULL );
+		}
+		gettime.Unclock( );
+
+		numGets += n;
+		numFrees += n;
+	}
+
+	Printf( "%u IDs allocated in %.2f ms (%.1f ns each)\n", numGets, gettime.TimeMS( ), gettime.TimeMS( ) * 1e6 / numGets );
+	if ( numFrees > 0 )
+		Printf( "%u IDs freed in %.2f ms (%.1f ns each)\n", numFrees, freetime.TimeMS( ), freetime.TimeMS( ) * 1e6 / numFrees );
+	Printf( "%u IDs in use, table size %u\n", live, list->size( ));
+	delete list;
+
+	if (( gamestate != GS_LEVEL ) || NETWORK_InClientMode( ))
+		return;
+
+	const PClass *type = PClass::FindClass( "MapSpot" );
+	if ( type == NULL )
+		return;
+
+	TArray<AActor *> actors;
+	cycle_t spawntime, destroytime;
+	unsigned int maxNetID = 0, numBad = 0;
+
+	actors.Resize( live );
+	spawntime.Reset( );
+	destroytime.Reset( );
+
+	for ( unsigned int done = 0; done < static_cast<unsigned int>( count ); )
+	{
+		const unsigned int n = MIN( live, count - done );
+
+		spawntime.Clock( );
+		for ( unsigned int i = 0; i < n; i++ )
+			actors[i] = Spawn( type, 0, 0, 0, NO_REPLACE );
+		spawntime.Unclock( );
+
+		for ( unsigned int i = 0; i < n; i++ )
+		{
+			if (( actors[i]->NetID == 0 ) || ( g_ActorNetIDList.findPointerByID( actors[i]->NetID ) != actors[i] ))
+				numBad++;
+			maxNetID = MAX( maxNetID, actors[i]->NetID );
+		}
+
+		// Destroy them in random order, so that the free list gets shuffled.
+		netidbench_Shuffle( actors, n, n );
+		destroytime.Clock( );
+		for ( unsigned int i = 0; i < n; i++ )
+			actors[i]->Destroy( );
+		destroytime.Unclock( );
+
+		GC::FullGC( );
+		done += n;
+	}
+
+	Printf( "%d actors spawned in %.2f ms and destroyed in %.2f ms\n", count, spawntime.TimeMS( ), destroytime.TimeMS( ));
+	Printf( "Highest net ID %u, table size %u, %u lookups failed\n", maxNetID, g_ActorNetIDList.size( ), numBad );
+}
+
 // [BB] AActor::FreeNetID
 //
 //==========================================================================
@@ -0,0 +1,817 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Filename: p_reject.cpp
+//
+// Description: Builds a REJECT table for maps that don't have a usable one.
+//
+// The table is computed with a 2D portal flow over the two-sided lines of the
+// map: starting at every sector, it follows each chain of two-sided lines that
+// a single straight line can pass through, in order. Heights (doors, lifts, 3D
+// floors), one-sided lines inside sectors and line flags are ignored, which
+// only makes the result more permissive.
+//
+// The flow assumes that a line of sight can only leave a sector through one
+// of its two-sided lines, i.e. that the sectors are closed and don't overlap.
+// Sectors whose sides don't form closed loops are detected, and every flow
+// that reaches one of them falls back to marking everything that's connected
+// to its source as visible. Closed sectors that overlap each other are not
+// detected, so such maps may get sectors rejected that can see each other.
+//
+//-----------------------------------------------------------------------------
+
+#include <math.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#define getpid _getpid
+#endif
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "doomtype.h"
+#include "i_system.h"
+#include "m_misc.h"
+#include "m_swap.h"
+#include "md5.h"
+#include "network.h"
+#include "p_local.h"
+#include "p_setup.h"
+#include "po_man.h"
+#include "r_state.h"
+#include "templates.h"
+
+//*****************************************************************************
+//	DEFINES
+
+// Tolerance of all side checks, in map units. Since a larger value can only
+// make more sectors visible, it errs on the generous side.
+#define	REJECT_EPSILON				( 1.0 / 64 )
+
+// When a portal is reached again with a state that isn't covered by the one it
+// was explored with before, the merged state is widened by this many map units,
+// so that every portal is only explored a limited number of times.
+#define	REJECT_GROW					1.0
+
+// How many portal steps the flow from a single sector may take, and how long a
+// chain of portals may get. Sectors that exceed this (huge open areas) simply
+// see everything that's connected to them.
+#define	REJECT_MAX_STEPS			( 1 << 16 )
+#define	REJECT_MAX_DEPTH			256
+
+// The table has numsectors^2 bits, beyond this it's not worth the memory.
+#define	REJECT_MAX_SECTORS			16384
+
+// Magic, number of sectors, MD5 of the map and MD5 of the table.
+#define	REJECT_CACHE_HEADER_SIZE	( 4 + 4 + 16 + 16 )
+
+//*****************************************************************************
+//	VARIABLES
+
+struct REJECTSEG_s
+{
+	double		x1, y1, x2, y2;
+};
+
+// One direction of a two-sided line. Points beyond the portal, i.e. in the
+// sector it leads to, have a positive distance to its plane.
+struct REJECTPORTAL_s
+{
+	REJECTSEG_s	Seg;
+	double		nx, ny, d;
+	double		fLength;
+	int			lLine;
+	int			lToSector;
+};
+
+// The widest state a portal has been explored with during the flow through one
+// first portal: the part of the first portal (the source) and the part of this
+// portal (the target), as fractions along the portals.
+struct REJECTSTATE_s
+{
+	double		fSource1, fSource2;
+	double		fTarget1, fTarget2;
+	bool		bExplored;
+};
+
+static	TArray<REJECTPORTAL_s>		g_Portals;
+
+// Indices into g_Portals of the portals leaving each sector.
+static	TArray<int>					g_SectorPortalStart;
+static	TArray<int>					g_SectorPortalList;
+
+// Sectors whose sides don't form closed loops, see reject_FindUnclosedSectors.
+static	TArray<bool>				g_UnclosedSectors;
+
+// Per-thread state of the flow from one source sector.
+struct REJECTFLOW_s
+{
+	BYTE					*pbVisible;
+	REJECTSTATE_s			*pStates;
+	TArray<int>				*pExploredPortals;
+	const REJECTPORTAL_s	*pFirst;
+	int						lSteps;
+	int						lDepth;
+};
+
+//*****************************************************************************
+//	CONSOLE VARIABLES
+
+CVAR( Bool, sv_buildreject, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG )
+
+//*****************************************************************************
+//	FUNCTIONS
+
+//*****************************************************************************
+//
+// Keeps the part of the segment for which fA * x + fB * y - fC >= -REJECT_EPSILON.
+// Returns false if nothing is left.
+//
+static bool reject_ClipSeg( REJECTSEG_s &Seg, double fA, double fB, double fC )
+{
+	const double fDist1 = fA * Seg.x1 + fB * Seg.y1 - fC + REJECT_EPSILON;
+	const double fDist2 = fA * Seg.x2 + fB * Seg.y2 - fC + REJECT_EPSILON;
+
+	if (( fDist1 >= 0 ) && ( fDist2 >= 0 ))
+		return ( true );
+	if (( fDist1 < 0 ) && ( fDist2 < 0 ))
+		return ( false );
+
+	const double fFrac = fDist1 / ( fDist1 - fDist2 );
+	const double x = Seg.x1 + ( Seg.x2 - Seg.x1 ) * fFrac;
+	const double y = Seg.y1 + ( Seg.y2 - Seg.y1 ) * fFrac;
+
+	if ( fDist1 < 0 )
+	{
+		Seg.x1 = x;
+		Seg.y1 = y;
+	}
+	else
+	{
+		Seg.x2 = x;
+		Seg.y2 = y;
+	}
+	return ( true );
+}
+
+//*****************************************************************************
+//
+// Clips Target to the area that can be seen from Source through Pass. That area
+// is bounded by the lines through an end of Source and an end of Pass that have
+// Source and Pass on opposite sides.
+//
+static bool reject_ClipToSeparators( const REJECTSEG_s &Source, const REJECTSEG_s &Pass, REJECTSEG_s &Target )
+{
+	const double afSource[2][2] = { { Source.x1, Source.y1 }, { Source.x2, Source.y2 } };
+	const double afPass[2][2] = { { Pass.x1, Pass.y1 }, { Pass.x2, Pass.y2 } };
+
+	for ( int i = 0; i < 2; i++ )
+	{
+		for ( int j = 0; j < 2; j++ )
+		{
+			const double fDX = afPass[j][0] - afSource[i][0];
+			const double fDY = afPass[j][1] - afSource[i][1];
+			const double fLength = sqrt( fDX * fDX + fDY * fDY );
+
+			if ( fLength < REJECT_EPSILON )
+				continue;
+
+			const double fA = -fDY / fLength;
+			const double fB = fDX / fLength;
+			const double fC = fA * afSource[i][0] + fB * afSource[i][1];
+			const double fSourceSide = fA * afSource[1-i][0] + fB * afSource[1-i][1] - fC;
+			const double fPassSide = fA * afPass[1-j][0] + fB * afPass[1-j][1] - fC;
+
+			// The visible area is on the side of Pass. If Pass is collinear with the
+			// line, it's the side opposite of Source.
+			int lKeep;
+			if ( fabs( fPassSide ) > REJECT_EPSILON )
+				lKeep = ( fPassSide > 0 ) ? 1 : -1;
+			else if ( fabs( fSourceSide ) > REJECT_EPSILON )
+				lKeep = ( fSourceSide > 0 ) ? -1 : 1;
+			else
+				continue;
+
+			// Not a separator if Source is on the same side.
+			if ( fSourceSide * lKeep > REJECT_EPSILON )
+				continue;
+
+			if ( reject_ClipSeg( Target, fA * lKeep, fB * lKeep, fC * lKeep ) == false )
+				return ( false );
+		}
+	}
+
+	return ( true );
+}
+
+//*****************************************************************************
+//
+// Converts between a part of a portal and the fractions of its ends along it.
+//
+static void reject_SegToFractions( const REJECTPORTAL_s &Portal, const REJECTSEG_s &Seg, double &fFrac1, double &fFrac2 )
+{
+	const double fDX = Portal.Seg.x2 - Portal.Seg.x1;
+	const double fDY = Portal.Seg.y2 - Portal.Seg.y1;
+	const double fLengthSquared = Portal.fLength * Portal.fLength;
+
+	fFrac1 = (( Seg.x1 - Portal.Seg.x1 ) * fDX + ( Seg.y1 - Portal.Seg.y1 ) * fDY ) / fLengthSquared;
+	fFrac2 = (( Seg.x2 - Portal.Seg.x1 ) * fDX + ( Seg.y2 - Portal.Seg.y1 ) * fDY ) / fLengthSquared;
+	if ( fFrac1 > fFrac2 )
+		swapvalues( fFrac1, fFrac2 );
+}
+
+static REJECTSEG_s reject_FractionsToSeg( const REJECTPORTAL_s &Portal, double fFrac1, double fFrac2 )
+{
+	REJECTSEG_s Seg;
+	const double fDX = Portal.Seg.x2 - Portal.Seg.x1;
+	const double fDY = Portal.Seg.y2 - Portal.Seg.y1;
+
+	Seg.x1 = Portal.Seg.x1 + fDX * fFrac1;
+	Seg.y1 = Portal.Seg.y1 + fDY * fFrac1;
+	Seg.x2 = Portal.Seg.x1 + fDX * fFrac2;
+	Seg.y2 = Portal.Seg.y1 + fDY * fFrac2;
+	return ( Seg );
+}
+
+//*****************************************************************************
+//
+// Checks whether a portal has to be explored with the given source and target.
+// If it was explored before with a state that covers this one, it doesn't. If
+// not, both states are merged and widened, and Source and Target are replaced
+// by the merged state. Since the flow only ever gets wider with a wider state,
+// that can only make more sectors visible.
+//
+static bool reject_UpdateState( REJECTFLOW_s &Flow, int lPortal, REJECTSEG_s &Source, REJECTSEG_s &Target )
+{
+	const REJECTPORTAL_s &First = *Flow.pFirst;
+	const REJECTPORTAL_s &Portal = g_Portals[lPortal];
+	REJECTSTATE_s &State = Flow.pStates[lPortal];
+	double fSource1, fSource2, fTarget1, fTarget2;
+
+	reject_SegToFractions( First, Source, fSource1, fSource2 );
+	reject_SegToFractions( Portal, Target, fTarget1, fTarget2 );
+
+	if ( State.bExplored == false )
+	{
+		State.bExplored = true;
+		Flow.pExploredPortals->Push( lPortal );
+	}
+	else
+	{
+		const double fSourceTolerance = REJECT_EPSILON / First.fLength;
+		const double fTargetTolerance = REJECT_EPSILON / Portal.fLength;
+
+		if (( fSource1 >= State.fSource1 - fSourceTolerance ) && ( fSource2 <= State.fSource2 + fSourceTolerance ) &&
+			( fTarget1 >= State.fTarget1 - fTargetTolerance ) && ( fTarget2 <= State.fTarget2 + fTargetTolerance ))
+		{
+			return ( false );
+		}
+
+		const double fSourceGrow = REJECT_GROW / First.fLength;
+		const double fTargetGrow = REJECT_GROW / Portal.fLength;
+
+		fSource1 = MAX( 0.0, MIN( fSource1, State.fSource1 ) - fSourceGrow );
+		fSource2 = MIN( 1.0, MAX( fSource2, State.fSource2 ) + fSourceGrow );
+		fTarget1 = MAX( 0.0, MIN( fTarget1, State.fTarget1 ) - fTargetGrow );
+		fTarget2 = MIN( 1.0, MAX( fTarget2, State.fTarget2 ) + fTargetGrow );
+
+		Source = reject_FractionsToSeg( First, fSource1, fSource2 );
+		Target = reject_FractionsToSeg( Portal, fTarget1, fTarget2 );
+	}
+
+	State.fSource1 = fSource1;
+	State.fSource2 = fSource2;
+	State.fTarget1 = fTarget1;
+	State.fTarget2 = fTarget2;
+	return ( true );
+}
+
+//*****************************************************************************
+//
+static inline void reject_MarkVisible( REJECTFLOW_s &Flow, int lSector )
+{
+	Flow.pbVisible[lSector >> 3] |= ( 1 << ( lSector & 7 ));
+}
+
+//*****************************************************************************
+//
+// Source is the part of the first portal that can still see through all
+// portals up to Pass, which is the part of PassPortal that can be seen from
+// Source. Returns false if the flow got too expensive.
+//
+static bool reject_Flow( REJECTFLOW_s &Flow, const REJECTSEG_s &Source, const REJECTPORTAL_s &PassPortal, const REJECTSEG_s &Pass )
+{
+	const int lSector = PassPortal.lToSector;
+
+	if ( ++Flow.lDepth > REJECT_MAX_DEPTH )
+		return ( false );
+
+	for ( int i = g_SectorPortalStart[lSector]; i < g_SectorPortalStart[lSector + 1]; i++ )
+	{
+		const int lPortal = g_SectorPortalList[i];
+		const REJECTPORTAL_s &Portal = g_Portals[lPortal];
+
+		// A straight line can't cross the same line twice.
+		if (( Portal.lLine == PassPortal.lLine ) || ( Portal.lLine == Flow.pFirst->lLine ))
+			continue;
+
+		if ( ++Flow.lSteps > REJECT_MAX_STEPS )
+			return ( false );
+
+		REJECTSEG_s Target = Portal.Seg;
+		if ( reject_ClipSeg( Target, PassPortal.nx, PassPortal.ny, PassPortal.d ) == false )
+			continue;
+		if ( reject_ClipToSeparators( Source, Pass, Target ) == false )
+			continue;
+
+		// Sight can leave an unclosed sector anywhere.
+		if ( g_UnclosedSectors[Portal.lToSector] )
+			return ( false );
+
+		reject_MarkVisible( Flow, Portal.lToSector );
+
+		// Only the part of the source that is in front of the new portal and can see
+		// through both portals matters from here on. If clipping fails for numerical
+		// reasons, keep the old source, which is just less strict.
+		REJECTSEG_s NewSource = Source;
+		if (( reject_ClipSeg( NewSource, -Portal.nx, -Portal.ny, -Portal.d ) == false ) ||
+			( reject_ClipToSeparators( Target, Pass, NewSource ) == false ))
+		{
+			NewSource = Source;
+		}
+
+		if ( reject_UpdateState( Flow, lPortal, NewSource, Target ) == false )
+			continue;
+
+		if ( reject_Flow( Flow, NewSource, Portal, Target ) == false )
+			return ( false );
+	}
+
+	Flow.lDepth--;
+	return ( true );
+}
+
+//*****************************************************************************
+//
+// Marks every sector that's connected to lSector through two-sided lines.
+//
+static void reject_FloodConnected( REJECTFLOW_s &Flow, int lSector )
+{
+	TArray<int> Queue;
+	TArray<bool> Reached( numsectors );
+
+	for ( int i = 0; i < numsectors; i++ )
+		Reached.Push( false );
+
+	Reached[lSector] = true;
+	Queue.Push( lSector );
+	for ( unsigned int ulIdx = 0; ulIdx < Queue.Size( ); ulIdx++ )
+	{
+		const int lCurrent = Queue[ulIdx];
+		reject_MarkVisible( Flow, lCurrent );
+
+		for ( int i = g_SectorPortalStart[lCurrent]; i < g_SectorPortalStart[lCurrent + 1]; i++ )
+		{
+			const int lTo = g_Portals[g_SectorPortalList[i]].lToSector;
+			if ( Reached[lTo] == false )
+			{
+				Reached[lTo] = true;
+				Queue.Push( lTo );
+			}
+		}
+	}
+}
+
+//*****************************************************************************
+//
+static void reject_FlowFromSector( REJECTFLOW_s &Flow, int lSector )
+{
+	Flow.lSteps = 0;
+	reject_MarkVisible( Flow, lSector );
+
+	for ( int i = g_SectorPortalStart[lSector]; i < g_SectorPortalStart[lSector + 1]; i++ )
+	{
+		const REJECTPORTAL_s &First = g_Portals[g_SectorPortalList[i]];
+		const int lNext = First.lToSector;
+		bool bResult = ( g_UnclosedSectors[lSector] == false ) && ( g_UnclosedSectors[lNext] == false );
+
+		reject_MarkVisible( Flow, lNext );
+		Flow.pFirst = &First;
+
+		for ( int j = g_SectorPortalStart[lNext]; ( j < g_SectorPortalStart[lNext + 1] ) && bResult; j++ )
+		{
+			const REJECTPORTAL_s &Second = g_Portals[g_SectorPortalList[j]];
+			if ( Second.lLine == First.lLine )
+				continue;
+
+			REJECTSEG_s Pass = Second.Seg;
+			if ( reject_ClipSeg( Pass, First.nx, First.ny, First.d ) == false )
+				continue;
+
+			REJECTSEG_s Source = First.Seg;
+			if ( reject_ClipSeg( Source, -Second.nx, -Second.ny, -Second.d ) == false )
+				Source = First.Seg;
+
+			if ( g_UnclosedSectors[Second.lToSector] )
+			{
+				bResult = false;
+				break;
+			}
+
+			reject_MarkVisible( Flow, Second.lToSector );
+
+			Flow.lDepth = 0;
+			bResult = reject_Flow( Flow, Source, Second, Pass );
+		}
+
+		// The explored states only apply to this first portal.
+		for ( unsigned int j = 0; j < Flow.pExploredPortals->Size( ); j++ )
+			Flow.pStates[( *Flow.pExploredPortals )[j]].bExplored = false;
+		Flow.pExploredPortals->Clear( );
+
+		if ( bResult == false )
+		{
+			reject_FloodConnected( Flow, lSector );
+			Flow.lSteps = REJECT_MAX_STEPS + 1;
+			return;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+static void reject_AddPortal( const line_t &Line, const sector_t *pFrom, const sector_t *pTo, bool bIntoBack )
+{
+	REJECTPORTAL_s Portal;
+	const double fX1 = FIXED2DBL( Line.v1->x );
+	const double fY1 = FIXED2DBL( Line.v1->y );
+	const double fX2 = FIXED2DBL( Line.v2->x );
+	const double fY2 = FIXED2DBL( Line.v2->y );
+	const double fLength = sqrt(( fX2 - fX1 ) * ( fX2 - fX1 ) + ( fY2 - fY1 ) * ( fY2 - fY1 ));
+
+	if ( fLength == 0 )
+		return;
+
+	Portal.fLength = fLength;
+	Portal.Seg.x1 = fX1;
+	Portal.Seg.y1 = fY1;
+	Portal.Seg.x2 = fX2;
+	Portal.Seg.y2 = fY2;
+
+	// The front side of a line is on its right.
+	Portal.nx = ( fY2 - fY1 ) / fLength;
+	Portal.ny = ( fX1 - fX2 ) / fLength;
+	if ( bIntoBack )
+	{
+		Portal.nx = -Portal.nx;
+		Portal.ny = -Portal.ny;
+	}
+	Portal.d = Portal.nx * fX1 + Portal.ny * fY1;
+	Portal.lLine = static_cast<int>( &Line - lines );
+	Portal.lToSector = static_cast<int>( pTo - sectors );
+
+	g_Portals.Push( Portal );
+	g_SectorPortalList.Push( static_cast<int>( pFrom - sectors ));
+}
+
+//*****************************************************************************
+//
+static void reject_BuildPortals( void )
+{
+	TArray<int> PortalSectors;
+
+	g_Portals.Clear( );
+	g_SectorPortalList.Clear( );
+
+	for ( int i = 0; i < numlines; i++ )
+	{
+		if (( lines[i].frontsector == NULL ) || ( lines[i].backsector == NULL ))
+			continue;
+
+		reject_AddPortal( lines[i], lines[i].frontsector, lines[i].backsector, true );
+		reject_AddPortal( lines[i], lines[i].backsector, lines[i].frontsector, false );
+	}
+
+	// Sort the portals by the sector they leave. g_SectorPortalList holds that
+	// sector for now.
+	PortalSectors = g_SectorPortalList;
+	g_SectorPortalStart.Resize( numsectors + 1 );
+	for ( int i = 0; i <= numsectors; i++ )
+		g_SectorPortalStart[i] = 0;
+	for ( unsigned int i = 0; i < PortalSectors.Size( ); i++ )
+		g_SectorPortalStart[PortalSectors[i] + 1]++;
+	for ( int i = 0; i < numsectors; i++ )
+		g_SectorPortalStart[i + 1] += g_SectorPortalStart[i];
+
+	TArray<int> Fill( numsectors );
+	for ( int i = 0; i < numsectors; i++ )
+		Fill.Push( g_SectorPortalStart[i] );
+	for ( unsigned int i = 0; i < PortalSectors.Size( ); i++ )
+		g_SectorPortalList[Fill[PortalSectors[i]]++] = i;
+}
+
+//*****************************************************************************
+//
+// Finds the sectors whose sides don't form closed loops. Going around a sector
+// with the sector on the right, every vertex has to be left as often as it's
+// reached.
+//
+static void reject_FindUnclosedSectors( void )
+{
+	TArray<int> Balance( numvertexes );
+
+	for ( int i = 0; i < numvertexes; i++ )
+		Balance.Push( 0 );
+
+	g_UnclosedSectors.Clear( );
+	for ( int i = 0; i < numsectors; i++ )
+	{
+		const sector_t *pSector = &sectors[i];
+		bool bClosed = true;
+
+		for ( int j = 0; j < pSector->linecount; j++ )
+		{
+			const line_t *pLine = pSector->lines[j];
+			const int lV1 = static_cast<int>( pLine->v1 - vertexes );
+			const int lV2 = static_cast<int>( pLine->v2 - vertexes );
+
+			if ( pLine->frontsector == pSector )
+			{
+				Balance[lV1]++;
+				Balance[lV2]--;
+			}
+			if ( pLine->backsector == pSector )
+			{
+				Balance[lV2]++;
+				Balance[lV1]--;
+			}
+		}
+
+		// Check and reset the balance of every vertex in the sector.
+		for ( int j = 0; j < pSector->linecount; j++ )
+		{
+			const line_t *pLine = pSector->lines[j];
+			int &lBalance1 = Balance[static_cast<int>( pLine->v1 - vertexes )];
+			int &lBalance2 = Balance[static_cast<int>( pLine->v2 - vertexes )];
+
+			if (( lBalance1 != 0 ) || ( lBalance2 != 0 ))
+				bClosed = false;
+			lBalance1 = 0;
+			lBalance2 = 0;
+		}
+
+		g_UnclosedSectors.Push( bClosed == false );
+	}
+}
+
+//*****************************************************************************
+//
+static FString reject_CacheName( const BYTE abChecksum[16], bool bCreate )
+{
+	FString path = M_GetCachePath( bCreate );
+	path += "/reject";
+	if ( bCreate )
+		CreatePath( path );
+
+	path += '/';
+	for ( int i = 0; i < 16; i++ )
+		path.AppendFormat( "%02x", abChecksum[i] );
+	path += ".rej";
+	return path;
+}
+
+//*****************************************************************************
+//
+static bool reject_LoadCache( const BYTE abChecksum[16], BYTE *pbReject, int lSize )
+{
+	FString path = reject_CacheName( abChecksum, false );
+	FILE *pFile = fopen( path, "rb" );
+	if ( pFile == NULL )
+		return ( false );
+
+	BYTE abHeader[REJECT_CACHE_HEADER_SIZE];
+	const bool bRead = ( fread( abHeader, 1, REJECT_CACHE_HEADER_SIZE, pFile ) == REJECT_CACHE_HEADER_SIZE )
+		&& ( fread( pbReject, 1, lSize, pFile ) == static_cast<size_t>( lSize ));
+	fclose( pFile );
+
+	if (( bRead == false ) || memcmp( abHeader, "REJ2", 4 ))
+		return ( false );
+
+	DWORD dwNumSectors;
+	memcpy( &dwNumSectors, abHeader + 4, 4 );
+	if (( static_cast<int>( LittleLong( dwNumSectors )) != numsectors ) || memcmp( abHeader + 8, abChecksum, 16 ))
+		return ( false );
+
+	BYTE abTableChecksum[16];
+	MD5Context md5;
+	md5.Update( pbReject, lSize );
+	md5.Final( abTableChecksum );
+	return ( memcmp( abHeader + 24, abTableChecksum, 16 ) == 0 );
+}
+
+//*****************************************************************************
+//
+// Like the node cache, the file is written under a temporary name and then
+// renamed, so that an incomplete file is never picked up.
+//
+static void reject_SaveCache( const BYTE abChecksum[16], const BYTE *pbReject, int lSize )
+{
+	BYTE abHeader[REJECT_CACHE_HEADER_SIZE];
+	const DWORD dwNumSectors = LittleLong( static_cast<DWORD>( numsectors ));
+
+	memcpy( abHeader, "REJ2", 4 );
+	memcpy( abHeader + 4, &dwNumSectors, 4 );
+	memcpy( abHeader + 8, abChecksum, 16 );
+
+	MD5Context md5;
+	md5.Update( pbReject, lSize );
+	md5.Final( abHeader + 24 );
+
+	FString path = reject_CacheName( abChecksum, true );
+	FString temppath;
+	temppath.Format( "%s.%d.tmp", path.GetChars( ), static_cast<int>( getpid( )));
+
+	FILE *pFile = fopen( temppath, "wb" );
+	if ( pFile == NULL )
+		return;
+
+	const bool bWritten = ( fwrite( abHeader, 1, REJECT_CACHE_HEADER_SIZE, pFile ) == REJECT_CACHE_HEADER_SIZE )
+		&& ( fwrite( pbReject, 1, lSize, pFile ) == static_cast<size_t>( lSize ));
+
+	if (( fclose( pFile ) != 0 ) || ( bWritten == false ))
+	{
+		remove( temppath );
+		return;
+	}
+
+#ifdef _WIN32
+	remove( path );
+#endif
+	if ( rename( temppath, path ) != 0 )
+		remove( temppath );
+}
+
+//*****************************************************************************
+//
+// Fills rejectmatrix for a map that doesn't have a usable REJECT lump. Must be
+// called after the polyobjects have been spawned.
+//
+void P_BuildReject( const BYTE abChecksum[16] )
+{
+	if (( rejectmatrix != NULL ) || ( sv_buildreject == false ) || ( NETWORK_GetState( ) == NETSTATE_CLIENT ))
+		return;
+	if (( numsectors <= 0 ) || ( numsectors > REJECT_MAX_SECTORS ))
+		return;
+
+	const unsigned int ulStartTime = I_MSTime( );
+	const int lRejectSize = ( numsectors * numsectors + 7 ) >> 3;
+	BYTE *pbReject = new BYTE[lRejectSize];
+
+	if ( reject_LoadCache( abChecksum, pbReject, lRejectSize ))
+	{
+		rejectmatrix = pbReject;
+		DPrintf( "Loaded reject table from the cache in %u ms\n", I_MSTime( ) - ulStartTime );
+		return;
+	}
+
+	reject_BuildPortals( );
+	reject_FindUnclosedSectors( );
+
+	// One row of visibility bits per source sector. Each row is padded to whole
+	// bytes, so that the threads never write to the same byte.
+	const int lRowBytes = ( numsectors + 7 ) >> 3;
+	BYTE *pbVisible = new BYTE[lRowBytes * numsectors];
+	memset( pbVisible, 0, lRowBytes * numsectors );
+
+	// Polyobjects move, so the sectors on either side of a two-sided polyobject
+	// line can't be rejected from anywhere.
+	TArray<bool> OpenSectors( numsectors );
+	for ( int i = 0; i < numsectors; i++ )
+		OpenSectors.Push( false );
+	for ( int i = 0; i < po_NumPolyobjs; i++ )
+	{
+		for ( unsigned int j = 0; j < polyobjs[i].Linedefs.Size( ); j++ )
+		{
+			const line_t *pLine = polyobjs[i].Linedefs[j];
+			if (( pLine->frontsector != NULL ) && ( pLine->backsector != NULL ))
+			{
+				OpenSectors[static_cast<int>( pLine->frontsector - sectors )] = true;
+				OpenSectors[static_cast<int>( pLine->backsector - sectors )] = true;
+			}
+		}
+	}
+
+	std::atomic<int> nextSector( 0 );
+	std::atomic<int> numFallbacks( 0 );
+	auto worker = [&]( )
+	{
+		TArray<REJECTSTATE_s> States( g_Portals.Size( ) + 1 );
+		TArray<int> ExploredPortals;
+		REJECTSTATE_s Unexplored = { 0, 0, 0, 0, false };
+		for ( unsigned int i = 0; i <= g_Portals.Size( ); i++ )
+			States.Push( Unexplored );
+
+		REJECTFLOW_s Flow;
+		Flow.pStates = &States[0];
+		Flow.pExploredPortals = &ExploredPortals;
+
+		int lSector;
+		while (( lSector = nextSector++ ) < numsectors )
+		{
+			Flow.pbVisible = pbVisible + lSector * lRowBytes;
+			if ( OpenSectors[lSector] )
+			{
+				memset( Flow.pbVisible, 0xFF, lRowBytes );
+				continue;
+			}
+
+			reject_FlowFromSector( Flow, lSector );
+			if ( Flow.lSteps > REJECT_MAX_STEPS )
+				numFallbacks++;
+		}
+	};
+
+	const unsigned int ulNumThreads = MIN<unsigned int>( MAX<unsigned int>( std::thread::hardware_concurrency( ), 1 ), static_cast<unsigned int>( numsectors ));
+	if (( ulNumThreads <= 1 ) || ( numlines == 0 ))
+	{
+		worker( );
+	}
+	else
+	{
+		std::vector<std::thread> threads;
+		for ( unsigned int i = 0; i < ulNumThreads; i++ )
+			threads.push_back( std::thread( worker ));
+		for ( unsigned int i = 0; i < threads.size( ); i++ )
+			threads[i].join( );
+	}
+
+	// Sight works both ways, so a pair is only rejected if neither sector can see
+	// the other.
+	memset( pbReject, 0, lRejectSize );
+	for ( int lFrom = 0; lFrom < numsectors; lFrom++ )
+	{
+		const BYTE *pbRow = pbVisible + lFrom * lRowBytes;
+		for ( int lTo = 0; lTo < numsectors; lTo++ )
+		{
+			if ( pbRow[lTo >> 3] & ( 1 << ( lTo & 7 )))
+				continue;
+			if ( pbVisible[lTo * lRowBytes + ( lFrom >> 3 )] & ( 1 << ( lFrom & 7 )))
+				continue;
+
+			const int lBit = lFrom * numsectors + lTo;
+			pbReject[lBit >> 3] |= ( 1 << ( lBit & 7 ));
+		}
+	}
+
+	delete[] pbVisible;
+	g_Portals.Clear( );
+	g_SectorPortalStart.Clear( );
+	g_SectorPortalList.Clear( );
+	g_UnclosedSectors.Clear( );
+
+	rejectmatrix = pbReject;
+	reject_SaveCache( abChecksum, pbReject, lRejectSize );
+
+	DPrintf( "Built reject table for %d sectors in %u ms with %u thread%s (%d sectors without a full flow)\n",
+		numsectors, I_MSTime( ) - ulStartTime, ulNumThreads, ( ulNumThreads == 1 ) ? "" : "s", static_cast<int>( numFallbacks ));
+}
@@ -87,6 +87,7 @@
 #include "joinqueue.h"
 #include "cl_demo.h"
 #include "domination.h"
+#include "unlagged.h"
 
 // [BB] New #includes..
 #include "gl/dynlights/gl_dynlight.h"
@@ -3191,15 +3192,6 @@ void P_LoadBlockMap (MapData * map)
 	memset (blocklinks, 0, count*sizeof(*blocklinks));
 	blockmap = blockmaplump+4;
 
-	// [BC] Also, build the node list for the bot pathing module.
-	// [K6/BB] This is handled in CSkullBot(), unless we already have bots in game (from the previous map).
-	if (( NETWORK_InClientMode() == false ) &&
-		(( level.flagsZA & LEVEL_ZA_NOBOTNODES ) == false ) &&
-		( BOTS_CountBots( ) > 0 ))
-	{
-		ASTAR_BuildNodes( );
-	}
-
 	if ( level.flagsZA & LEVEL_ZA_NOBOTNODES || level.flagsZA & LEVEL_ZA_ISLOBBY )
 		BOTS_RemoveAllBots( false );
 }
@@ -3749,6 +3741,12 @@ void P_FreeLevelData ()
 	Renderer->CleanLevelData();
 	FPolyObj::ClearAllSubsectorLinks(); // can't be done as part of the polyobj deletion process.
 	SN_StopAllSequences ();
+
+	// [BC] Clear the bots' nodes. This also destroys the path visualizations,
+	// so it has to happen while they still exist.
+	if ( ASTAR_IsInitialized( ))
+		ASTAR_ClearNodes( );
+
 	DThinker::DestroyAllThinkers ();
 	level.total_monsters = level.total_items = level.total_secrets =
 		level.killed_monsters = level.found_items = level.found_secrets =
@@ -3886,10 +3884,6 @@ void P_FreeLevelData ()
 		level.Scrolls = NULL;
 	}
 	P_ClearUDMFKeys();
-
-	// [BC] Clear the bots' nodes.
-	if ( ASTAR_IsInitialized( ))
-		ASTAR_ClearNodes( );
 }
 
 extern msecnode_t *headsecnode;
@@ -4275,28 +4269,44 @@ void P_SetupLevel (char *lumpname, int position)
 		BuildGLNodes = RequireGLNodes || ( NETWORK_GetState( ) != NETSTATE_SINGLE ) || demoplayback || demorecording || genglnodes;
 
 		startTime = I_FPSTime ();
-		TArray<FNodeBuilder::FPolyStart> polyspots, anchors;
-		P_GetPolySpots (map, polyspots, anchors);
-		FNodeBuilder::FLevel leveldata =
-		{
-			vertexes, numvertexes,
-			sides, numsides,
-			lines, numlines,
-			0, 0, 0, 0
-		};
-		leveldata.FindMapBounds ();
-		// We need GL nodes if am_textured is on.
-		// In case a sync critical game mode is started, also build GL nodes to avoid problems
-		// if the different machines' am_textured setting differs.
-		FNodeBuilder builder (leveldata, polyspots, anchors, BuildGLNodes);
-		delete[] vertexes;
-		builder.Extract (nodes, numnodes,
-			segs, glsegextras, numsegs,
-			subsectors, numsubsectors,
-			vertexes, numvertexes);
-		endTime = I_FPSTime ();
-		DPrintf ("BSP generation took %.3f sec (%d segs)\n", (endTime - startTime) * 0.001, numsegs);
-		oldvertextable = builder.GetOldVertexTable();
+		// The node cache only holds GL nodes. This is the only place where servers
+		// use it, since they never get to P_CheckNodes.
+		if (BuildGLNodes && !buildmap && P_LoadCachedNodes(map, oldvertextable))
+		{
+			endTime = I_FPSTime ();
+			DPrintf ("Loaded cached nodes in %.3f sec (%d segs)\n", (endTime - startTime) * 0.001, numsegs);
+		}
+		else
+		{
+			TArray<FNodeBuilder::FPolyStart> polyspots, anchors;
+			P_GetPolySpots (map, polyspots, anchors);
+			FNodeBuilder::FLevel leveldata =
+			{
+				vertexes, numvertexes,
+				sides, numsides,
+				lines, numlines,
+				0, 0, 0, 0
+			};
+			leveldata.FindMapBounds ();
+			// We need GL nodes if am_textured is on.
+			// In case a sync critical game mode is started, also build GL nodes to avoid problems
+			// if the different machines' am_textured setting differs.
+			FNodeBuilder builder (leveldata, polyspots, anchors, BuildGLNodes);
+			delete[] vertexes;
+			builder.Extract (nodes, numnodes,
+				segs, glsegextras, numsegs,
+				subsectors, numsubsectors,
+				vertexes, numvertexes);
+			endTime = I_FPSTime ();
+			DPrintf ("BSP generation took %.3f sec (%d segs)\n", (endTime - startTime) * 0.001, numsegs);
+			oldvertextable = builder.GetOldVertexTable();
+
+			// With RequireGLNodes, P_CheckNodes below caches them.
+			if (BuildGLNodes && !buildmap && !RequireGLNodes)
+			{
+				P_SaveCachedNodes(map, endTime - startTime);
+			}
+		}
 		reloop = true;
 	}
 	else
@@ -4452,6 +4462,14 @@ void P_SetupLevel (char *lumpname, int position)
 		}
 		delete[] buildthings;
 	}
+	// Without a usable REJECT lump, one is built after the polyobjects have
+	// been spawned. It's cached by the map's checksum, which needs the map data.
+	BYTE mapchecksum[16];
+	const bool buildreject = !buildmap && rejectmatrix == NULL;
+	if (buildreject)
+	{
+		map->GetChecksum(mapchecksum);
+	}
 	delete map;
 	if (oldvertextable != NULL)
 	{
@@ -4464,6 +4482,9 @@ void P_SetupLevel (char *lumpname, int position)
 	// set up world state
 	P_SpawnSpecials ();
 
+	// All sectors are at their initial positions now, so that's what unlagged records.
+	UNLAGGED_ResetSectors( );
+
 	// This must be done BEFORE the PolyObj Spawn!!!
 	// [BB] The server may not execute this
 	if ( NETWORK_GetState( ) != NETSTATE_SERVER )
@@ -4489,6 +4510,23 @@ void P_SetupLevel (char *lumpname, int position)
 	PO_Init ();	// Initialize the polyobjs
 	times[16].Unclock();
 
+	if (buildreject)
+	{
+		times[18].Clock();
+		P_BuildReject (mapchecksum);
+		times[18].Unclock();
+	}
+
+	// [BC] Also, build the node list for the bot pathing module.
+	// [K6/BB] This is handled in CSkullBot(), unless we already have bots in game (from the previous map).
+	// The graph leaves out polyobject lines, so this has to wait until they're set up.
+	if (( NETWORK_InClientMode() == false ) &&
+		(( level.flagsZA & LEVEL_ZA_NOBOTNODES ) == false ) &&
+		( BOTS_CountBots( ) > 0 ))
+	{
+		ASTAR_BuildNodes( );
+	}
+
 	assert(sidetemp != NULL);
 	delete[] sidetemp;
 	sidetemp = NULL;
@@ -4664,7 +4702,7 @@ void P_SetupLevel (char *lumpname, int position)
 	if (showloadtimes)
 	{
 		Printf ("---Total load times---\n");
-		for (i = 0; i < 18; ++i)
+		for (i = 0; i < 19; ++i)
 		{
 			static const char *timenames[] =
 			{
@@ -4685,7 +4723,8 @@ void P_SetupLevel (char *lumpname, int position)
 				"load things",
 				"translate teleports",
 				"init polys",
-				"precache"
+				"precache",
+				"build reject"
 			};
 			Printf ("Time%3d:%9.4f ms (%s)\n", i, times[i].TimeMS(), timenames[i]);
 		}
@@ -125,9 +125,14 @@ fixed_t GetUDMFFixed(int type, int index, const char *key);
 
 bool P_LoadGLNodes(MapData * map);
 bool P_CheckNodes(MapData * map, bool rebuilt, int buildtime);
+bool P_LoadCachedNodes(MapData *map, const int *&oldvertextable);
+void P_SaveCachedNodes(MapData *map, int buildtime);
 bool P_CheckForGLNodes();
 void P_SetRenderSector();
 
+// p_reject.cpp
+void P_BuildReject (const BYTE mapchecksum[16]);
+
 
 struct sidei_t	// [RH] Only keep BOOM sidedef init stuff around for init
 {
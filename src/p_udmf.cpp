@@ -33,6 +33,13 @@
 **
 */
 
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#define getpid _getpid
+#endif
+
 #include "doomstat.h"
 #include "p_setup.h"
 #include "p_lnspec.h"
@@ -46,6 +53,11 @@
 #include "r_state.h"
 #include "r_data/colormaps.h"
 #include "w_wad.h"
+#include "cmdlib.h"
+#include "m_misc.h"
+#include "m_swap.h"
+#include "md5.h"
+#include "stats.h"
 // [BB] New #includes.
 #include "g_game.h"
 
@@ -376,6 +388,494 @@ fixed_t GetUDMFFixed(int type, int index, const char *key)
 }
 
 
+//===========================================================================
+//
+// Compiled map cache
+//
+// Most of the time it takes to load a big TEXTMAP goes into running it
+// through the scanner. After a map has been parsed, the keys of its blocks
+// are saved with their values already converted, and later loads of the
+// same TEXTMAP replay them instead. What the keys mean is still worked out
+// by the parser every time, so the result only depends on the TEXTMAP,
+// whose checksum the cache is looked up by. Only syntax warnings from the
+// scanner aren't repeated when a map is replayed.
+//
+// Change the magic whenever the format or what gets recorded changes.
+//
+//===========================================================================
+
+CVAR(Bool, udmf_cachemaps, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+CVAR(Float, udmf_cachetime, 0.05f, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+EXTERN_CVAR(Bool, showloadtimes)
+
+enum
+{
+	UDMFBLOCK_End,
+	UDMFBLOCK_Thing,
+	UDMFBLOCK_Linedef,
+	UDMFBLOCK_Sidedef,
+	UDMFBLOCK_Sector,
+	UDMFBLOCK_Vertex,
+
+	NUM_UDMFBLOCKS
+};
+
+// Magic, size of the TEXTMAP, MD5 of the TEXTMAP and MD5 of the rest of the file.
+enum { UDMFCACHE_HEADER_SIZE = 4 + 4 + 16 + 16 };
+
+// Stands in for a key at the end of a block, and for a missing namespace.
+static const DWORD UDMFCACHE_NONE = 0xffffffffu;
+
+struct FCompiledKey
+{
+	FName Key;
+	int Line;
+	int TokenType;
+	int Number;
+	double Float;
+	const char *String;
+};
+
+class FCompiledTextMap
+{
+public:
+	FCompiledTextMap()
+		: Namespace(UDMFCACHE_NONE), Pos(0), Failed(false)
+	{
+	}
+
+	// Recording
+	void SetNamespace(const char *name);
+	void BeginBlock(int type);
+	void AddKey(FName key, int line, int token, int number, double value, const char *string);
+	void EndBlock();
+	void Save(const BYTE checksum[16], DWORD textsize);
+
+	// Replaying
+	bool Load(const BYTE checksum[16], DWORD textsize);
+	const char *GetNamespace() const;
+	int NextBlock();
+	bool AtBlockEnd();
+	const FCompiledKey &NextKey();
+
+private:
+	DWORD GetLong();
+	double GetDouble();
+	DWORD AddString(const char *string);
+	bool ReadStrings(TArray<const char *> &strings);
+	bool VerifyBlocks();
+	bool ReadCache(const BYTE checksum[16], DWORD textsize);
+	void Reset();
+
+	// While recording, Data only holds the blocks. When replaying, it holds the
+	// whole file and Pos is where the next block or key starts.
+	TArray<BYTE> Data;
+	TArray<FName> Names;
+	TMap<int, DWORD> NameIndex;
+	TArray<FString> Strings;
+	TMap<FString, DWORD> StringIndex;
+	TArray<const char *> LoadedStrings;
+	DWORD Namespace;
+	unsigned int Pos;
+	bool Failed;
+	FCompiledKey Current;
+};
+
+static FString UDMF_CacheName(const BYTE checksum[16], bool create)
+{
+	FString path = M_GetCachePath(create);
+	path += "/udmf";
+	if (create) CreatePath(path);
+
+	path += '/';
+	for (int i = 0; i < 16; i++)
+	{
+		path.AppendFormat("%02x", checksum[i]);
+	}
+	path += ".udc";
+	return path;
+}
+
+static bool IsPositiveZero(double v)
+{
+	QWORD bits;
+	memcpy(&bits, &v, 8);
+	return bits == 0;
+}
+
+static void WriteLong(TArray<BYTE> &f, DWORD v)
+{
+	unsigned int p = f.Reserve(4);
+	f[p] = BYTE(v);
+	f[p+1] = BYTE(v >> 8);
+	f[p+2] = BYTE(v >> 16);
+	f[p+3] = BYTE(v >> 24);
+}
+
+static void WriteDouble(TArray<BYTE> &f, double v)
+{
+	QWORD bits;
+	memcpy(&bits, &v, 8);
+	WriteLong(f, DWORD(bits));
+	WriteLong(f, DWORD(bits >> 32));
+}
+
+static void WriteString(TArray<BYTE> &f, const char *string)
+{
+	const size_t len = strlen(string) + 1;
+	memcpy(&f[f.Reserve(len)], string, len);
+}
+
+DWORD FCompiledTextMap::GetLong()
+{
+	DWORD v;
+	memcpy(&v, &Data[Pos], 4);
+	Pos += 4;
+	return LittleLong(v);
+}
+
+double FCompiledTextMap::GetDouble()
+{
+	QWORD bits = GetLong();
+	bits |= QWORD(GetLong()) << 32;
+	double v;
+	memcpy(&v, &bits, 8);
+	return v;
+}
+
+DWORD FCompiledTextMap::AddString(const char *string)
+{
+	FString str = string;
+	DWORD *index = StringIndex.CheckKey(str);
+	if (index != NULL) return *index;
+	return StringIndex[str] = Strings.Push(str);
+}
+
+void FCompiledTextMap::SetNamespace(const char *name)
+{
+	Namespace = AddString(name);
+}
+
+void FCompiledTextMap::BeginBlock(int type)
+{
+	Data.Push(BYTE(type));
+}
+
+void FCompiledTextMap::EndBlock()
+{
+	WriteLong(Data, UDMFCACHE_NONE);
+}
+
+//===========================================================================
+//
+// Records the key that has just been parsed. The scanner only sets Number
+// and Float as the replay restores them, but if that's ever not the case,
+// the map just isn't cached.
+//
+//===========================================================================
+
+void FCompiledTextMap::AddKey(FName key, int line, int token, int number, double value, const char *string)
+{
+	DWORD *nameindex = NameIndex.CheckKey(int(key));
+	DWORD name = (nameindex != NULL) ? *nameindex : (NameIndex[int(key)] = Names.Push(key));
+
+	WriteLong(Data, name);
+	WriteLong(Data, line);
+	WriteLong(Data, token);
+	switch (token)
+	{
+	case TK_IntConst:
+		if (value != double(number)) Failed = true;
+		WriteLong(Data, number);
+		break;
+
+	case TK_FloatConst:
+		if (number != 0) Failed = true;
+		WriteDouble(Data, value);
+		break;
+
+	case TK_StringConst:
+		WriteLong(Data, AddString(string));
+		// fall through
+	default:
+		if (number != 0 || !IsPositiveZero(value)) Failed = true;
+		break;
+	}
+}
+
+//===========================================================================
+//
+// Like the node cache, the file is written under a temporary name and then
+// renamed, so that an incomplete file is never picked up.
+//
+//===========================================================================
+
+void FCompiledTextMap::Save(const BYTE checksum[16], DWORD textsize)
+{
+	if (Failed) return;
+
+	// The names and strings go in front of the blocks.
+	TArray<BYTE> tables;
+	WriteLong(tables, Names.Size());
+	for (unsigned i = 0; i < Names.Size(); i++)
+	{
+		WriteString(tables, Names[i].GetChars());
+	}
+	WriteLong(tables, Strings.Size());
+	for (unsigned i = 0; i < Strings.Size(); i++)
+	{
+		WriteString(tables, Strings[i]);
+	}
+	WriteLong(tables, Namespace);
+	Data.Push(UDMFBLOCK_End);
+
+	BYTE header[UDMFCACHE_HEADER_SIZE];
+	const DWORD len = LittleLong(textsize);
+	memcpy(header, "UDC1", 4);
+	memcpy(header + 4, &len, 4);
+	memcpy(header + 8, checksum, 16);
+
+	MD5Context md5;
+	md5.Update(&tables[0], tables.Size());
+	md5.Update(&Data[0], Data.Size());
+	md5.Final(header + 24);
+
+	FString path = UDMF_CacheName(checksum, true);
+	FString temppath;
+	temppath.Format("%s.%d.tmp", path.GetChars(), int(getpid()));
+
+	FILE *f = fopen(temppath, "wb");
+	if (f == NULL)
+	{
+		DPrintf("Can't write compiled map %s\n", temppath.GetChars());
+		return;
+	}
+
+	const bool written = fwrite(header, 1, UDMFCACHE_HEADER_SIZE, f) == UDMFCACHE_HEADER_SIZE &&
+		fwrite(&tables[0], 1, tables.Size(), f) == tables.Size() &&
+		fwrite(&Data[0], 1, Data.Size(), f) == Data.Size();
+
+	if (fclose(f) != 0 || !written)
+	{
+		remove(temppath);
+		return;
+	}
+
+#ifdef _WIN32
+	remove(path);
+#endif
+	if (rename(temppath, path) != 0)
+	{
+		remove(temppath);
+	}
+}
+
+//===========================================================================
+//
+// Reads a table of zero terminated strings
+//
+//===========================================================================
+
+bool FCompiledTextMap::ReadStrings(TArray<const char *> &strings)
+{
+	if (Data.Size() - Pos < 4) return false;
+	DWORD count = GetLong();
+
+	// Every string takes at least one byte.
+	if (count > Data.Size() - Pos) return false;
+	strings.Resize(count);
+	for (DWORD i = 0; i < count; i++)
+	{
+		if (Pos >= Data.Size()) return false;
+		const BYTE *start = &Data[Pos];
+		const BYTE *end = (const BYTE *)memchr(start, 0, Data.Size() - Pos);
+		if (end == NULL) return false;
+		strings[i] = (const char *)start;
+		Pos += unsigned(end - start) + 1;
+	}
+	return true;
+}
+
+//===========================================================================
+//
+// Checks that all blocks are complete and only refer to names and strings
+// that exist, so that replaying them can't fail halfway through the map.
+//
+//===========================================================================
+
+bool FCompiledTextMap::VerifyBlocks()
+{
+	const unsigned int start = Pos;
+
+	for (;;)
+	{
+		if (Pos >= Data.Size()) return false;
+		const BYTE type = Data[Pos++];
+		if (type == UDMFBLOCK_End) break;
+		if (type >= NUM_UDMFBLOCKS) return false;
+
+		for (;;)
+		{
+			if (Data.Size() - Pos < 4) return false;
+			const DWORD name = GetLong();
+			if (name == UDMFCACHE_NONE) break;
+			if (name >= Names.Size() || Data.Size() - Pos < 8) return false;
+
+			Pos += 4;
+			const DWORD token = GetLong();
+			const unsigned int size = (token == TK_FloatConst) ? 8 : (token == TK_IntConst || token == TK_StringConst) ? 4 : 0;
+			if (Data.Size() - Pos < size) return false;
+			if (token == TK_StringConst)
+			{
+				if (GetLong() >= LoadedStrings.Size()) return false;
+			}
+			else
+			{
+				Pos += size;
+			}
+		}
+	}
+	if (Pos != Data.Size()) return false;
+
+	Pos = start;
+	return true;
+}
+
+//===========================================================================
+//
+// Reads and verifies the cache file for a TEXTMAP.
+//
+//===========================================================================
+
+bool FCompiledTextMap::ReadCache(const BYTE checksum[16], DWORD textsize)
+{
+	BYTE md5payload[16];
+	DWORD len;
+
+	FString path = UDMF_CacheName(checksum, false);
+	FILE *f = fopen(path, "rb");
+	if (f == NULL) return false;
+
+	// Read the whole file at once, the payload has to be verified before anything
+	// in it can be trusted anyway.
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size > UDMFCACHE_HEADER_SIZE)
+	{
+		Data.Resize(size);
+		if (fread(&Data[0], 1, size, f) != (size_t)size) size = -1;
+	}
+	fclose(f);
+
+	if (size <= UDMFCACHE_HEADER_SIZE) return false;
+	if (memcmp(&Data[0], "UDC1", 4)) return false;
+
+	memcpy(&len, &Data[4], 4);
+	if (LittleLong(len) != textsize) return false;
+	if (memcmp(&Data[8], checksum, 16)) return false;
+
+	MD5Context md5;
+	md5.Update(&Data[UDMFCACHE_HEADER_SIZE], size - UDMFCACHE_HEADER_SIZE);
+	md5.Final(md5payload);
+	if (memcmp(&Data[24], md5payload, 16)) return false;
+
+	TArray<const char *> names;
+	Pos = UDMFCACHE_HEADER_SIZE;
+	if (!ReadStrings(names) || !ReadStrings(LoadedStrings)) return false;
+	if (Data.Size() - Pos < 4) return false;
+
+	Namespace = GetLong();
+	if (Namespace != UDMFCACHE_NONE && Namespace >= LoadedStrings.Size()) return false;
+
+	for (unsigned i = 0; i < names.Size(); i++)
+	{
+		Names.Push(names[i]);
+	}
+	return VerifyBlocks();
+}
+
+//===========================================================================
+//
+// Forgets everything a rejected cache file left behind, so that the map
+// can be recorded from scratch.
+//
+//===========================================================================
+
+void FCompiledTextMap::Reset()
+{
+	Data.Clear();
+	Names.Clear();
+	NameIndex.Clear();
+	Strings.Clear();
+	StringIndex.Clear();
+	LoadedStrings.Clear();
+	Namespace = UDMFCACHE_NONE;
+	Pos = 0;
+	Failed = false;
+}
+
+//===========================================================================
+//
+// Loads the compiled map for a TEXTMAP, if there is a valid one.
+//
+//===========================================================================
+
+bool FCompiledTextMap::Load(const BYTE checksum[16], DWORD textsize)
+{
+	if (!ReadCache(checksum, textsize))
+	{
+		Reset();
+		return false;
+	}
+	return true;
+}
+
+const char *FCompiledTextMap::GetNamespace() const
+{
+	return (Namespace != UDMFCACHE_NONE) ? LoadedStrings[Namespace] : NULL;
+}
+
+int FCompiledTextMap::NextBlock()
+{
+	return Data[Pos++];
+}
+
+bool FCompiledTextMap::AtBlockEnd()
+{
+	DWORD v;
+	memcpy(&v, &Data[Pos], 4);
+	if (LittleLong(v) != UDMFCACHE_NONE) return false;
+	Pos += 4;
+	return true;
+}
+
+const FCompiledKey &FCompiledTextMap::NextKey()
+{
+	Current.Key = Names[GetLong()];
+	Current.Line = GetLong();
+	Current.TokenType = GetLong();
+	Current.Number = 0;
+	Current.Float = 0;
+	Current.String = NULL;
+	switch (Current.TokenType)
+	{
+	case TK_IntConst:
+		Current.Number = GetLong();
+		Current.Float = Current.Number;
+		break;
+
+	case TK_FloatConst:
+		Current.Float = GetDouble();
+		break;
+
+	case TK_StringConst:
+		Current.String = LoadedStrings[GetLong()];
+		break;
+	}
+	return Current;
+}
+
 //===========================================================================
 //
 // UDMF parser
@@ -398,12 +898,121 @@ class UDMFParser : public UDMFParserBase
 	FDynamicColormap	*fogMap, *normMap;
 	FMissingTextureTracker &missingTex;
 
+	// Compiled map cache
+	FCompiledTextMap Compiled;
+	bool Recording, Replaying;
+
 public:
 	UDMFParser(FMissingTextureTracker &missing)
 		: missingTex(missing)
 	{
 		linemap.Clear();
 		fogMap = normMap = NULL;
+		Recording = Replaying = false;
+	}
+
+	//===========================================================================
+	//
+	// Reads the blocks and keys either from the scanner or from the
+	// compiled map.
+	//
+	//===========================================================================
+
+	int NextBlock()
+	{
+		if (Replaying)
+		{
+			return Compiled.NextBlock();
+		}
+
+		while (sc.GetString())
+		{
+			int type;
+
+			if (sc.Compare("thing")) type = UDMFBLOCK_Thing;
+			else if (sc.Compare("linedef")) type = UDMFBLOCK_Linedef;
+			else if (sc.Compare("sidedef")) type = UDMFBLOCK_Sidedef;
+			else if (sc.Compare("sector")) type = UDMFBLOCK_Sector;
+			else if (sc.Compare("vertex")) type = UDMFBLOCK_Vertex;
+			else
+			{
+				Skip();
+				continue;
+			}
+			if (Recording) Compiled.BeginBlock(type);
+			return type;
+		}
+		return UDMFBLOCK_End;
+	}
+
+	void OpenBlock()
+	{
+		if (!Replaying) sc.MustGetToken('{');
+	}
+
+	bool CloseBlock()
+	{
+		if (Replaying)
+		{
+			return Compiled.AtBlockEnd();
+		}
+		if (!sc.CheckToken('}'))
+		{
+			return false;
+		}
+		if (Recording) Compiled.EndBlock();
+		return true;
+	}
+
+	FName NextKey()
+	{
+		if (Replaying)
+		{
+			const FCompiledKey &key = Compiled.NextKey();
+			sc.Line = key.Line;
+			sc.TokenType = key.TokenType;
+			sc.Number = key.Number;
+			sc.Float = key.Float;
+			if (key.TokenType == TK_StringConst)
+			{
+				parsedString = key.String;
+			}
+			return key.Key;
+		}
+
+		FName key = ParseKey();
+		if (Recording) Compiled.AddKey(key, sc.GetMessageLine(), sc.TokenType, sc.Number, sc.Float, parsedString);
+		return key;
+	}
+
+	// Vertices are read differently, their values are always converted with strtod.
+	bool NextVertexKey(FName &key, double &value)
+	{
+		if (Replaying)
+		{
+			if (Compiled.AtBlockEnd())
+			{
+				return false;
+			}
+			const FCompiledKey &ckey = Compiled.NextKey();
+			key = ckey.Key;
+			value = ckey.Float;
+			return true;
+		}
+
+		if (sc.CheckString("}"))
+		{
+			if (Recording) Compiled.EndBlock();
+			return false;
+		}
+		sc.MustGetString();
+		key = sc.String;
+		sc.MustGetStringName("=");
+		sc.MustGetString();
+		value = strtod(sc.String, NULL);
+		sc.MustGetStringName(";");
+		if (Recording) Compiled.AddKey(key, sc.GetMessageLine(), TK_FloatConst, 0, value, NULL);
+		return true;
 	}
 
 	void AddUserKey(FName key, int kind, int index)
@@ -475,10 +1084,10 @@ public:
 		th->RenderStyle = STYLE_Count;
 		th->alpha = -1;
 		th->health = 1;
-		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		OpenBlock();
+		while (!CloseBlock())
 		{
-			FName key = ParseKey();
+			FName key = NextKey();
 			switch(key)
 			{
 			case NAME_Id:
@@ -781,10 +1390,10 @@ public:
 		if (level.flags2 & LEVEL2_WRAPMIDTEX) ld->flags |= ML_WRAP_MIDTEX;
 		if (level.flags2 & LEVEL2_CHECKSWITCHRANGE) ld->flags |= ML_CHECKSWITCHRANGE;
 
-		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		OpenBlock();
+		while (!CloseBlock())
 		{
-			FName key = ParseKey();
+			FName key = NextKey();
 
 			// This switch contains all keys of the UDMF base spec
 			switch(key)
@@ -1101,10 +1710,10 @@ public:
 		sd->SetTextureYScale(FRACUNIT);
 		sd->Index = index;
 
-		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		OpenBlock();
+		while (!CloseBlock())
 		{
-			FName key = ParseKey();
+			FName key = NextKey();
 			switch(key)
 			{
 			case NAME_Offsetx:
@@ -1272,10 +1881,10 @@ public:
 		sec->friction = ORIG_FRICTION;
 		sec->movefactor = ORIG_FRICTION_FACTOR;
 
-		sc.MustGetToken('{');
-		while (!sc.CheckToken('}'))
+		OpenBlock();
+		while (!CloseBlock())
 		{
-			FName key = ParseKey();
+			FName key = NextKey();
 			switch(key)
 			{
 			case NAME_Heightfloor:
@@ -1508,32 +2117,29 @@ public:
 	{
 		vt->x = vt->y = 0;
 		vd->zCeiling = vd->zFloor = vd->flags = 0;
-		sc.MustGetStringName("{");
-		while (!sc.CheckString("}"))
+		if (!Replaying) sc.MustGetStringName("{");
+
+		FName key;
+		double value;
+		while (NextVertexKey(key, value))
 		{
-			sc.MustGetString();
-			FName key = sc.String;
-			sc.MustGetStringName("=");
-			sc.MustGetString();
-			FString value = sc.String;
-			sc.MustGetStringName(";");
 			switch(key)
 			{
 			case NAME_X:
-				vt->x = FLOAT2FIXED(strtod(value, NULL));
+				vt->x = FLOAT2FIXED(value);
 				break;
 
 			case NAME_Y:
-				vt->y = FLOAT2FIXED(strtod(value, NULL));
+				vt->y = FLOAT2FIXED(value);
 				break;
 
 			case NAME_ZCeiling:
-				vd->zCeiling = FLOAT2FIXED(strtod(value, NULL));
+				vd->zCeiling = FLOAT2FIXED(value);
 				vd->flags |= VERTEXFLAG_ZCeilingEnabled;
 				break;
 
 			case NAME_ZFloor:
-				vd->zFloor = FLOAT2FIXED(strtod(value, NULL));
+				vd->zFloor = FLOAT2FIXED(value);
 				vd->flags |= VERTEXFLAG_ZFloorEnabled;
 				break;
 
@@ -1638,21 +2244,64 @@ public:
 
 	void ParseTextMap(MapData *map)
 	{
-		char *buffer = new char[map->Size(ML_TEXTMAP)];
+		const DWORD textsize = map->Size(ML_TEXTMAP);
+		char *buffer = new char[textsize];
+		const char *nsname = NULL;
+		BYTE checksum[16];
+		cycle_t readtime, cachetime, parsetime;
 
 		isTranslated = true;
 		isExtended = false;
 		floordrop = false;
 
+		readtime.Reset();
+		cachetime.Reset();
+		parsetime.Reset();
+
+		readtime.Clock();
 		map->Read(ML_TEXTMAP, buffer);
-		sc.OpenMem(Wads.GetLumpFullName(map->lumpnum), buffer, map->Size(ML_TEXTMAP));
+		readtime.Unclock();
+
+		// Replay the compiled map if this TEXTMAP has been parsed before,
+		// otherwise record one while parsing it.
+		if (udmf_cachemaps)
+		{
+			cachetime.Clock();
+			MD5Context md5;
+			md5.Update((BYTE *)buffer, textsize);
+			md5.Final(checksum);
+			Replaying = Compiled.Load(checksum, textsize);
+			Recording = !Replaying;
+			cachetime.Unclock();
+		}
+
+		parsetime.Clock();
+		if (Replaying)
+		{
+			// The scanner is only needed for the script name and line numbers of
+			// the messages about bad values.
+			sc.OpenMem(Wads.GetLumpFullName(map->lumpnum), "", 0);
+			nsname = Compiled.GetNamespace();
+		}
+		else
+		{
+			sc.OpenMem(Wads.GetLumpFullName(map->lumpnum), buffer, textsize);
+		}
 		delete [] buffer;
-		sc.SetCMode(true);
-		if (sc.CheckString("namespace"))
+		if (!Replaying)
 		{
-			sc.MustGetStringName("=");
-			sc.MustGetString();
-			namespc = sc.String;
+			sc.SetCMode(true);
+			if (sc.CheckString("namespace"))
+			{
+				sc.MustGetStringName("=");
+				sc.MustGetString();
+				nsname = sc.String;
+				if (Recording) Compiled.SetNamespace(nsname);
+			}
+		}
+		if (nsname != NULL)
+		{
+			namespc = nsname;
 			switch(namespc)
 			{
 			case NAME_ZDoom:
@@ -1690,7 +2339,7 @@ public:
 				floordrop = true;
 				break;
 			default:
-				Printf("Unknown namespace %s. Using defaults for %s\n", sc.String, GameTypeName());
+				Printf("Unknown namespace %s. Using defaults for %s\n", nsname, GameTypeName());
 				switch (gameinfo.gametype)
 				{
 				default:			// Shh, GCC
@@ -1713,16 +2362,17 @@ public:
 					break;
 				}
 			}
-			sc.MustGetStringName(";");
+			if (!Replaying) sc.MustGetStringName(";");
 		}
 		else
 		{
 			Printf("Map does not define a namespace.\n");
 		}
 
-		while (sc.GetString())
+		int type;
+		while ((type = NextBlock()) != UDMFBLOCK_End)
 		{
-			if (sc.Compare("thing"))
+			if (type == UDMFBLOCK_Thing)
 			{
 				FMapThing th;
 				unsigned userdatastart = MapThingsUserData.Size();
@@ -1738,7 +2388,7 @@ public:
 					MapThingsUserData.Push(ud);
 				}
 			}
-			else if (sc.Compare("linedef"))
+			else if (type == UDMFBLOCK_Linedef)
 			{
 				line_t li;
 				ParseLinedef(&li, ParsedLines.Size());
@@ -1749,7 +2399,7 @@ public:
 
 				ParsedLines.Push(li);
 			}
-			else if (sc.Compare("sidedef"))
+			else if (type == UDMFBLOCK_Sidedef)
 			{
 				side_t si;
 				mapsidedef_t st;
@@ -1761,13 +2411,13 @@ public:
 				ParsedSides.Push(si);
 				ParsedSideTextures.Push(st);
 			}
-			else if (sc.Compare("sector"))
+			else if (type == UDMFBLOCK_Sector)
 			{
 				sector_t sec;
 				ParseSector(&sec, ParsedSectors.Size());
 				ParsedSectors.Push(sec);
 			}
-			else if (sc.Compare("vertex"))
+			else if (type == UDMFBLOCK_Vertex)
 			{
 				vertex_t vt;
 				vertexdata_t vd;
@@ -1775,10 +2425,6 @@ public:
 				ParsedVertices.Push(vt);
 				ParsedVertexDatas.Push(vd);
 			}
-			else
-			{
-				Skip();
-			}
 		}
 
 		// Catch bogus maps here rather than during nodebuilding
@@ -1813,6 +2459,23 @@ public:
 
 		// Create the real linedefs and decompress the sidedefs
 		ProcessLineDefs();
+		parsetime.Unclock();
+
+		// Small maps parse fast enough as they are.
+		if (Recording && parsetime.TimeMS() >= udmf_cachetime * 1000.)
+		{
+			cachetime.Clock();
+			Compiled.Save(checksum, textsize);
+			cachetime.Unclock();
+		}
+
+		if (showloadtimes)
+		{
+			Printf ("---TEXTMAP load times (%s)---\n", Replaying ? "warm, compiled map" : "cold, parsed");
+			Printf (" read TEXTMAP:%9.4f ms\n", readtime.TimeMS());
+			Printf (" compiled map:%9.4f ms\n", cachetime.TimeMS());
+			Printf ("%13s:%9.4f ms\n", Replaying ? "replay" : "parse", parsetime.TimeMS());
+		}
 	}
 };
 
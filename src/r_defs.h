@@ -817,6 +817,12 @@ struct sector_t
 	// [BC] Has the height changed during the course of the level?
 	bool		bCeilingHeightChange;
 	bool		bFloorHeightChange;
+
+	// Last tic the floor or ceiling of this sector moved, and whether unlagged
+	// is still recording its planes because of that.
+	int			unlaggedMoveTic;
+	bool		bUnlaggedMoving;
+
 	secplane_t	SavedCeilingPlane;
 	secplane_t	SavedFloorPlane;
 	fixed_t		SavedCeilingTexZ;
@@ -46,6 +46,7 @@
 #include "gi.h"
 #include "stats.h"
 #include "x86.h"
+#include "r_thread.h"
 
 #undef RANGECHECK
 
@@ -85,6 +86,18 @@ void (*R_DrawSpanMaskedTranslucent)(void);
 void (*R_DrawSpanAddClamp)(void);
 void (*R_DrawSpanMaskedAddClamp)(void);
 void (STACK_ARGS *rt_map4cols)(int,int,int);
+#ifndef X86_ASM
+void (STACK_ARGS *rt_shaded4cols)(int,int,int);
+void (STACK_ARGS *rt_add4cols)(int,int,int);
+void (STACK_ARGS *rt_addclamp4cols)(int,int,int);
+void (STACK_ARGS *rt_subclamp4cols)(int,int,int);
+void (STACK_ARGS *rt_revsubclamp4cols)(int,int,int);
+void (STACK_ARGS *rt_tlate4cols)(int,int,int);
+void (STACK_ARGS *rt_tlateadd4cols)(int,int,int);
+void (STACK_ARGS *rt_tlateaddclamp4cols)(int,int,int);
+void (STACK_ARGS *rt_tlatesubclamp4cols)(int,int,int);
+void (STACK_ARGS *rt_tlaterevsubclamp4cols)(int,int,int);
+#endif
 
 //
 // R_DrawColumn
@@ -1060,39 +1073,38 @@ void R_SetupSpanBits(FTexture *tex)
 
 //
 // Draws the actual span.
-#ifndef X86_ASM
-void R_DrawSpanP_C (void)
+void R_DrawSpanP_C (const FSpanState &ds)
 {
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
 	dsfixed_t			ystep;
 	BYTE*				dest;
-	const BYTE*			source = ds_source;
-	const BYTE*			colormap = ds_colormap;
+	const BYTE*			source = ds.source;
+	const BYTE*			colormap = ds.colormap;
 	int 				count;
 	int 				spot;
 
 #ifdef RANGECHECK 
-	if (ds_x2 < ds_x1 || ds_x1 < 0
-		|| ds_x2 >= screen->width || ds_y > screen->height)
+	if (ds.x2 < ds.x1 || ds.x1 < 0
+		|| ds.x2 >= screen->width || ds.y > screen->height)
 	{
-		I_Error ("R_DrawSpan: %i to %i at %i", ds_x1, ds_x2, ds_y);
+		I_Error ("R_DrawSpan: %i to %i at %i", ds.x1, ds.x2, ds.y);
 	}
 //		dscount++;
 #endif
 
-	xfrac = ds_xfrac;
-	yfrac = ds_yfrac;
+	xfrac = ds.xfrac;
+	yfrac = ds.yfrac;
 
-	dest = ylookup[ds_y] + ds_x1 + dc_destorg;
+	dest = ylookup[ds.y] + ds.x1 + ds.destorg;
 
-	count = ds_x2 - ds_x1 + 1;
+	count = ds.x2 - ds.x1 + 1;
 
-	xstep = ds_xstep;
-	ystep = ds_ystep;
+	xstep = ds.xstep;
+	ystep = ds.ystep;
 
-	if (ds_xbits == 6 && ds_ybits == 6)
+	if (ds.xbits == 6 && ds.ybits == 6)
 	{
 		// 64x64 is the most common case by far, so special case it.
 		do
@@ -1111,9 +1123,9 @@ void R_DrawSpanP_C (void)
 	}
 	else
 	{
-		BYTE yshift = 32 - ds_ybits;
-		BYTE xshift = yshift - ds_xbits;
-		int xmask = ((1 << ds_xbits) - 1) << ds_ybits;
+		BYTE yshift = 32 - ds.ybits;
+		BYTE xshift = yshift - ds.xbits;
+		int xmask = ((1 << ds.xbits) - 1) << ds.ybits;
 
 		do
 		{
@@ -1132,29 +1144,29 @@ void R_DrawSpanP_C (void)
 }
 
 // [RH] Draw a span with holes
-void R_DrawSpanMaskedP_C (void)
+void R_DrawSpanMaskedP_C (const FSpanState &ds)
 {
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
 	dsfixed_t			ystep;
 	BYTE*				dest;
-	const BYTE*			source = ds_source;
-	const BYTE*			colormap = ds_colormap;
+	const BYTE*			source = ds.source;
+	const BYTE*			colormap = ds.colormap;
 	int 				count;
 	int 				spot;
 
-	xfrac = ds_xfrac;
-	yfrac = ds_yfrac;
+	xfrac = ds.xfrac;
+	yfrac = ds.yfrac;
 
-	dest = ylookup[ds_y] + ds_x1 + dc_destorg;
+	dest = ylookup[ds.y] + ds.x1 + ds.destorg;
 
-	count = ds_x2 - ds_x1 + 1;
+	count = ds.x2 - ds.x1 + 1;
 
-	xstep = ds_xstep;
-	ystep = ds_ystep;
+	xstep = ds.xstep;
+	ystep = ds.ystep;
 
-	if (ds_xbits == 6 && ds_ybits == 6)
+	if (ds.xbits == 6 && ds.ybits == 6)
 	{
 		// 64x64 is the most common case by far, so special case it.
 		do
@@ -1174,9 +1186,9 @@ void R_DrawSpanMaskedP_C (void)
 	}
 	else
 	{
-		BYTE yshift = 32 - ds_ybits;
-		BYTE xshift = yshift - ds_xbits;
-		int xmask = ((1 << ds_xbits) - 1) << ds_ybits;
+		BYTE yshift = 32 - ds.ybits;
+		BYTE xshift = yshift - ds.xbits;
+		int xmask = ((1 << ds.xbits) - 1) << ds.ybits;
 		do
 		{
 			BYTE texdata;
@@ -1193,33 +1205,32 @@ void R_DrawSpanMaskedP_C (void)
 		} while (--count);
 	}
 }
-#endif
 
-void R_DrawSpanTranslucentP_C (void)
+void R_DrawSpanTranslucentP_C (const FSpanState &ds)
 {
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
 	dsfixed_t			ystep;
 	BYTE*				dest;
-	const BYTE*			source = ds_source;
-	const BYTE*			colormap = ds_colormap;
+	const BYTE*			source = ds.source;
+	const BYTE*			colormap = ds.colormap;
 	int 				count;
 	int 				spot;
-	DWORD *fg2rgb = dc_srcblend;
-	DWORD *bg2rgb = dc_destblend;
+	DWORD *fg2rgb = ds.srcblend;
+	DWORD *bg2rgb = ds.destblend;
 
-	xfrac = ds_xfrac;
-	yfrac = ds_yfrac;
+	xfrac = ds.xfrac;
+	yfrac = ds.yfrac;
 
-	dest = ylookup[ds_y] + ds_x1 + dc_destorg;
+	dest = ylookup[ds.y] + ds.x1 + ds.destorg;
 
-	count = ds_x2 - ds_x1 + 1;
+	count = ds.x2 - ds.x1 + 1;
 
-	xstep = ds_xstep;
-	ystep = ds_ystep;
+	xstep = ds.xstep;
+	ystep = ds.ystep;
 
-	if (ds_xbits == 6 && ds_ybits == 6)
+	if (ds.xbits == 6 && ds.ybits == 6)
 	{
 		// 64x64 is the most common case by far, so special case it.
 		do
@@ -1237,9 +1248,9 @@ void R_DrawSpanTranslucentP_C (void)
 	}
 	else
 	{
-		BYTE yshift = 32 - ds_ybits;
-		BYTE xshift = yshift - ds_xbits;
-		int xmask = ((1 << ds_xbits) - 1) << ds_ybits;
+		BYTE yshift = 32 - ds.ybits;
+		BYTE xshift = yshift - ds.xbits;
+		int xmask = ((1 << ds.xbits) - 1) << ds.ybits;
 		do
 		{
 			spot = ((xfrac >> xshift) & xmask) + (yfrac >> yshift);
@@ -1255,31 +1266,31 @@ void R_DrawSpanTranslucentP_C (void)
 	}
 }
 
-void R_DrawSpanMaskedTranslucentP_C (void)
+void R_DrawSpanMaskedTranslucentP_C (const FSpanState &ds)
 {
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
 	dsfixed_t			ystep;
 	BYTE*				dest;
-	const BYTE*			source = ds_source;
-	const BYTE*			colormap = ds_colormap;
+	const BYTE*			source = ds.source;
+	const BYTE*			colormap = ds.colormap;
 	int 				count;
 	int 				spot;
-	DWORD *fg2rgb = dc_srcblend;
-	DWORD *bg2rgb = dc_destblend;
+	DWORD *fg2rgb = ds.srcblend;
+	DWORD *bg2rgb = ds.destblend;
 
-	xfrac = ds_xfrac;
-	yfrac = ds_yfrac;
+	xfrac = ds.xfrac;
+	yfrac = ds.yfrac;
 
-	dest = ylookup[ds_y] + ds_x1 + dc_destorg;
+	dest = ylookup[ds.y] + ds.x1 + ds.destorg;
 
-	count = ds_x2 - ds_x1 + 1;
+	count = ds.x2 - ds.x1 + 1;
 
-	xstep = ds_xstep;
-	ystep = ds_ystep;
+	xstep = ds.xstep;
+	ystep = ds.ystep;
 
-	if (ds_xbits == 6 && ds_ybits == 6)
+	if (ds.xbits == 6 && ds.ybits == 6)
 	{
 		// 64x64 is the most common case by far, so special case it.
 		do
@@ -1304,9 +1315,9 @@ void R_DrawSpanMaskedTranslucentP_C (void)
 	}
 	else
 	{
-		BYTE yshift = 32 - ds_ybits;
-		BYTE xshift = yshift - ds_xbits;
-		int xmask = ((1 << ds_xbits) - 1) << ds_ybits;
+		BYTE yshift = 32 - ds.ybits;
+		BYTE xshift = yshift - ds.xbits;
+		int xmask = ((1 << ds.xbits) - 1) << ds.ybits;
 		do
 		{
 			BYTE texdata;
@@ -1329,31 +1340,31 @@ void R_DrawSpanMaskedTranslucentP_C (void)
 	}
 }
 
-void R_DrawSpanAddClampP_C (void)
+void R_DrawSpanAddClampP_C (const FSpanState &ds)
 {
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
 	dsfixed_t			ystep;
 	BYTE*				dest;
-	const BYTE*			source = ds_source;
-	const BYTE*			colormap = ds_colormap;
+	const BYTE*			source = ds.source;
+	const BYTE*			colormap = ds.colormap;
 	int 				count;
 	int 				spot;
-	DWORD *fg2rgb = dc_srcblend;
-	DWORD *bg2rgb = dc_destblend;
+	DWORD *fg2rgb = ds.srcblend;
+	DWORD *bg2rgb = ds.destblend;
 
-	xfrac = ds_xfrac;
-	yfrac = ds_yfrac;
+	xfrac = ds.xfrac;
+	yfrac = ds.yfrac;
 
-	dest = ylookup[ds_y] + ds_x1 + dc_destorg;
+	dest = ylookup[ds.y] + ds.x1 + ds.destorg;
 
-	count = ds_x2 - ds_x1 + 1;
+	count = ds.x2 - ds.x1 + 1;
 
-	xstep = ds_xstep;
-	ystep = ds_ystep;
+	xstep = ds.xstep;
+	ystep = ds.ystep;
 
-	if (ds_xbits == 6 && ds_ybits == 6)
+	if (ds.xbits == 6 && ds.ybits == 6)
 	{
 		// 64x64 is the most common case by far, so special case it.
 		do
@@ -1374,9 +1385,9 @@ void R_DrawSpanAddClampP_C (void)
 	}
 	else
 	{
-		BYTE yshift = 32 - ds_ybits;
-		BYTE xshift = yshift - ds_xbits;
-		int xmask = ((1 << ds_xbits) - 1) << ds_ybits;
+		BYTE yshift = 32 - ds.ybits;
+		BYTE xshift = yshift - ds.xbits;
+		int xmask = ((1 << ds.xbits) - 1) << ds.ybits;
 		do
 		{
 			spot = ((xfrac >> xshift) & xmask) + (yfrac >> yshift);
@@ -1395,31 +1406,31 @@ void R_DrawSpanAddClampP_C (void)
 	}
 }
 
-void R_DrawSpanMaskedAddClampP_C (void)
+void R_DrawSpanMaskedAddClampP_C (const FSpanState &ds)
 {
 	dsfixed_t			xfrac;
 	dsfixed_t			yfrac;
 	dsfixed_t			xstep;
 	dsfixed_t			ystep;
 	BYTE*				dest;
-	const BYTE*			source = ds_source;
-	const BYTE*			colormap = ds_colormap;
+	const BYTE*			source = ds.source;
+	const BYTE*			colormap = ds.colormap;
 	int 				count;
 	int 				spot;
-	DWORD *fg2rgb = dc_srcblend;
-	DWORD *bg2rgb = dc_destblend;
+	DWORD *fg2rgb = ds.srcblend;
+	DWORD *bg2rgb = ds.destblend;
 
-	xfrac = ds_xfrac;
-	yfrac = ds_yfrac;
+	xfrac = ds.xfrac;
+	yfrac = ds.yfrac;
 
-	dest = ylookup[ds_y] + ds_x1 + dc_destorg;
+	dest = ylookup[ds.y] + ds.x1 + ds.destorg;
 
-	count = ds_x2 - ds_x1 + 1;
+	count = ds.x2 - ds.x1 + 1;
 
-	xstep = ds_xstep;
-	ystep = ds_ystep;
+	xstep = ds.xstep;
+	ystep = ds.ystep;
 
-	if (ds_xbits == 6 && ds_ybits == 6)
+	if (ds.xbits == 6 && ds.ybits == 6)
 	{
 		// 64x64 is the most common case by far, so special case it.
 		do
@@ -1447,9 +1458,9 @@ void R_DrawSpanMaskedAddClampP_C (void)
 	}
 	else
 	{
-		BYTE yshift = 32 - ds_ybits;
-		BYTE xshift = yshift - ds_xbits;
-		int xmask = ((1 << ds_xbits) - 1) << ds_ybits;
+		BYTE yshift = 32 - ds.ybits;
+		BYTE xshift = yshift - ds.xbits;
+		int xmask = ((1 << ds.xbits) - 1) << ds.ybits;
 		do
 		{
 			BYTE texdata;
@@ -1476,9 +1487,69 @@ void R_DrawSpanMaskedAddClampP_C (void)
 }
 
 // [RH] Just fill a span with a color
+void R_FillSpanP_C (const FSpanState &ds)
+{
+	memset (ylookup[ds.y] + ds.x1 + ds.destorg, ds.color, ds.x2 - ds.x1 + 1);
+}
+
+// The span drawers above read their state from an FSpanState, so that
+// the drawer queue can run them on other threads. These draw with the
+// current ds_* globals.
+
+FSpanState::FSpanState ()
+{
+	y = ds_y;
+	x1 = ds_x1;
+	x2 = ds_x2;
+	colormap = ds_colormap;
+	source = ds_source;
+	xfrac = ds_xfrac;
+	yfrac = ds_yfrac;
+	xstep = ds_xstep;
+	ystep = ds_ystep;
+	xbits = ds_xbits;
+	ybits = ds_ybits;
+	color = ds_color;
+	srcblend = dc_srcblend;
+	destblend = dc_destblend;
+	destorg = dc_destorg;
+}
+
+#ifndef X86_ASM
+void R_DrawSpanP_C (void)
+{
+	R_DrawSpanP_C (FSpanState());
+}
+
+void R_DrawSpanMaskedP_C (void)
+{
+	R_DrawSpanMaskedP_C (FSpanState());
+}
+#endif
+
+void R_DrawSpanTranslucentP_C (void)
+{
+	R_DrawSpanTranslucentP_C (FSpanState());
+}
+
+void R_DrawSpanMaskedTranslucentP_C (void)
+{
+	R_DrawSpanMaskedTranslucentP_C (FSpanState());
+}
+
+void R_DrawSpanAddClampP_C (void)
+{
+	R_DrawSpanAddClampP_C (FSpanState());
+}
+
+void R_DrawSpanMaskedAddClampP_C (void)
+{
+	R_DrawSpanMaskedAddClampP_C (FSpanState());
+}
+
 void R_FillSpan (void)
 {
-	memset (ylookup[ds_y] + ds_x1 + dc_destorg, ds_color, ds_x2 - ds_x1 + 1);
+	R_FillSpanP_C (FSpanState());
 }
 
 // Draw a voxel slab
@@ -1586,8 +1657,8 @@ DWORD (STACK_ARGS *doprevline1)() = vlinec1;
 
 #ifdef X64_ASM
 extern "C" void vlinetallasm4();
-#define dovline4 vlinetallasm4
 extern "C" void setupvlinetallasm (int);
+void (STACK_ARGS *dovline4)() = vlinetallasm4;
 #else
 static void STACK_ARGS vlinec4 ();
 void (STACK_ARGS *dovline4)() = vlinec4;
@@ -1629,6 +1700,14 @@ void (STACK_ARGS *domvline4)() = mvlineasm4;
 
 void setupvline (int fracbits)
 {
+	// Record the columns if the drawer queue is open. Otherwise all the
+	// pointers have to be set, since the queue replaces them.
+	if (DrawersQueued)
+	{
+		R_SetupQueuedVLine (fracbits);
+		return;
+	}
+
 #ifdef X86_ASM
 	if (CPU.Family <= 5)
 	{
@@ -1650,6 +1729,9 @@ void setupvline (int fracbits)
 	else
 	{
 		setupvlinetallasm (fracbits);
+		dovline1 = vlinetallasm1;
+		doprevline1 = prevlinetallasm1;
+		dovline4 = vlinetallasm4;
 		if (CPU.bIsAMD && CPU.AMDFamily >= 7)
 		{
 			dovline4 = vlinetallasmathlon4;
@@ -1657,8 +1739,13 @@ void setupvline (int fracbits)
 	}
 #else
 	vlinebits = fracbits;
+	dovline1 = vlinec1;
+	doprevline1 = vlinec1;
 #ifdef X64_ASM
 	setupvlinetallasm(fracbits);
+	dovline4 = vlinetallasm4;
+#else
+	dovline4 = vlinec4;
 #endif
 #endif
 }
@@ -1705,6 +1792,12 @@ void STACK_ARGS vlinec4 ()
 
 void setupmvline (int fracbits)
 {
+	// Masked walls aren't queued.
+	if (DrawersQueued)
+	{
+		R_WaitForDrawerCommands ();
+	}
+
 #if defined(X86_ASM)
 	setupmvlineasm (fracbits);
 	domvline1 = mvlineasm1;
@@ -1886,6 +1979,11 @@ int tmvlinebits;
 
 void setuptmvline (int bits)
 {
+	if (DrawersQueued)
+	{
+		R_WaitForDrawerCommands ();
+	}
+
 	tmvlinebits = bits;
 }
 
@@ -2168,6 +2266,83 @@ const BYTE *R_GetColumn (FTexture *tex, int col)
 }
 
 
+#ifndef X86_ASM
+// Which versions of the translucent four column drawers to use:
+// 0 = C, 1 = SSE2, 2 = AVX2. Where the CPU does not have the instruction
+// set, the next lower one is used.
+CUSTOM_CVAR (Int, r_simddrawers, 1, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+{
+	if (self < 0)
+	{
+		self = 0;
+	}
+	else if (self > 2)
+	{
+		self = 2;
+	}
+	else
+	{
+		R_InitColumnDrawers ();
+	}
+}
+
+//==========================================================================
+//
+// R_InitRT4colDrawers
+//
+// Sets the translucent four column drawers for the given r_simddrawers
+// value and returns the one that was actually used.
+//
+//==========================================================================
+
+int R_InitRT4colDrawers (int simd)
+{
+#ifdef RT_SIMD_DRAWERS
+#ifdef RT_AVX2_DRAWERS
+	if (simd >= 2 && CPU.bAVX2)
+	{
+		rt_shaded4cols				= rt_shaded4cols_avx2;
+		rt_add4cols					= rt_add4cols_avx2;
+		rt_addclamp4cols			= rt_addclamp4cols_avx2;
+		rt_subclamp4cols			= rt_subclamp4cols_avx2;
+		rt_revsubclamp4cols			= rt_revsubclamp4cols_avx2;
+		rt_tlate4cols				= rt_tlate4cols_sse2;
+		rt_tlateadd4cols			= rt_tlateadd4cols_avx2;
+		rt_tlateaddclamp4cols		= rt_tlateaddclamp4cols_avx2;
+		rt_tlatesubclamp4cols		= rt_tlatesubclamp4cols_avx2;
+		rt_tlaterevsubclamp4cols	= rt_tlaterevsubclamp4cols_avx2;
+		return 2;
+	}
+#endif
+	if (simd >= 1 && CPU.bSSE2)
+	{
+		rt_shaded4cols				= rt_shaded4cols_sse2;
+		rt_add4cols					= rt_add4cols_sse2;
+		rt_addclamp4cols			= rt_addclamp4cols_sse2;
+		rt_subclamp4cols			= rt_subclamp4cols_sse2;
+		rt_revsubclamp4cols			= rt_revsubclamp4cols_sse2;
+		rt_tlate4cols				= rt_tlate4cols_sse2;
+		rt_tlateadd4cols			= rt_tlateadd4cols_sse2;
+		rt_tlateaddclamp4cols		= rt_tlateaddclamp4cols_sse2;
+		rt_tlatesubclamp4cols		= rt_tlatesubclamp4cols_sse2;
+		rt_tlaterevsubclamp4cols	= rt_tlaterevsubclamp4cols_sse2;
+		return 1;
+	}
+#endif
+	rt_shaded4cols					= rt_shaded4cols_c;
+	rt_add4cols						= rt_add4cols_c;
+	rt_addclamp4cols				= rt_addclamp4cols_c;
+	rt_subclamp4cols				= rt_subclamp4cols_c;
+	rt_revsubclamp4cols				= rt_revsubclamp4cols_c;
+	rt_tlate4cols					= rt_tlate4cols_c;
+	rt_tlateadd4cols				= rt_tlateadd4cols_c;
+	rt_tlateaddclamp4cols			= rt_tlateaddclamp4cols_c;
+	rt_tlatesubclamp4cols			= rt_tlatesubclamp4cols_c;
+	rt_tlaterevsubclamp4cols		= rt_tlaterevsubclamp4cols_c;
+	return 0;
+}
+#endif
+
 // [RH] Initialize the column drawer pointers
 void R_InitColumnDrawers ()
 {
@@ -2196,6 +2371,7 @@ void R_InitColumnDrawers ()
 	R_DrawSpan					= R_DrawSpanP_C;
 	R_DrawSpanMasked			= R_DrawSpanMaskedP_C;
 	rt_map4cols					= rt_map4cols_c;
+	R_InitRT4colDrawers (r_simddrawers);
 #endif
 	R_DrawSpanTranslucent		= R_DrawSpanTranslucentP_C;
 	R_DrawSpanMaskedTranslucent = R_DrawSpanMaskedTranslucentP_C;
@@ -2358,6 +2534,13 @@ ESPSResult R_SetPatchStyle (FRenderStyle style, fixed_t alpha, int translation,
 {
 	fixed_t fglevel, bglevel;
 
+	// Whatever is drawn with this isn't queued, so it has to go on top
+	// of what has been recorded so far (decals do this during the opaque pass).
+	if (DrawersQueued)
+	{
+		R_WaitForDrawerCommands ();
+	}
+
 	style.CheckFuzz();
 
 	if (style.BlendOp == STYLEOP_Shadow)
@@ -67,12 +67,7 @@ extern void (*R_DrawColumn)(void);
 
 extern DWORD (STACK_ARGS *dovline1) ();
 extern DWORD (STACK_ARGS *doprevline1) ();
-#ifdef X64_ASM
-#define dovline4 vlinetallasm4
-extern "C" void vlinetallasm4();
-#else
 extern void (STACK_ARGS *dovline4) ();
-#endif
 extern void setupvline (int);
 
 extern DWORD (STACK_ARGS *domvline1) ();
@@ -119,6 +114,11 @@ void R_DrawMaskedColumnHoriz (const BYTE *column, const FTexture::Span *spans);
 // [RH] Initialize the above pointers
 void R_InitColumnDrawers ();
 
+#ifndef X86_ASM
+// Chooses the versions of the rt_*4cols drawers
+int R_InitRT4colDrawers (int simd);
+#endif
+
 // [RH] Moves data from the temporary buffer to the screen.
 extern "C"
 {
@@ -144,14 +144,14 @@ void rt_tlaterevsubclamp1col (int hx, int sx, int yl, int yh);
 void STACK_ARGS rt_map4cols_c (int sx, int yl, int yh);
 void STACK_ARGS rt_add4cols_c (int sx, int yl, int yh);
 void STACK_ARGS rt_addclamp4cols_c (int sx, int yl, int yh);
-void STACK_ARGS rt_subclamp4cols (int sx, int yl, int yh);
-void STACK_ARGS rt_revsubclamp4cols (int sx, int yl, int yh);
+void STACK_ARGS rt_subclamp4cols_c (int sx, int yl, int yh);
+void STACK_ARGS rt_revsubclamp4cols_c (int sx, int yl, int yh);
 
-void STACK_ARGS rt_tlate4cols (int sx, int yl, int yh);
-void STACK_ARGS rt_tlateadd4cols (int sx, int yl, int yh);
-void STACK_ARGS rt_tlateaddclamp4cols (int sx, int yl, int yh);
-void STACK_ARGS rt_tlatesubclamp4cols (int sx, int yl, int yh);
-void STACK_ARGS rt_tlaterevsubclamp4cols (int sx, int yl, int yh);
+void STACK_ARGS rt_tlate4cols_c (int sx, int yl, int yh);
+void STACK_ARGS rt_tlateadd4cols_c (int sx, int yl, int yh);
+void STACK_ARGS rt_tlateaddclamp4cols_c (int sx, int yl, int yh);
+void STACK_ARGS rt_tlatesubclamp4cols_c (int sx, int yl, int yh);
+void STACK_ARGS rt_tlaterevsubclamp4cols_c (int sx, int yl, int yh);
 
 void rt_copy1col_asm (int hx, int sx, int yl, int yh);
 void rt_map1col_asm (int hx, int sx, int yl, int yh);
@@ -165,6 +165,38 @@ void STACK_ARGS rt_addclamp4cols_asm (int sx, int yl, int yh);
 
 extern void (STACK_ARGS *rt_map4cols)(int sx, int yl, int yh);
 
+// SSE2 and AVX2 versions of the translucent four column drawers. The
+// AVX2 ones are only used if CPU.bAVX2 is set.
+#if !defined(X86_ASM) && (defined(__amd64__) || defined(_M_X64))
+#define RT_SIMD_DRAWERS
+
+void STACK_ARGS rt_tlate4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_shaded4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_add4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_tlateadd4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_addclamp4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_tlateaddclamp4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_subclamp4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_tlatesubclamp4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_revsubclamp4cols_sse2 (int sx, int yl, int yh);
+void STACK_ARGS rt_tlaterevsubclamp4cols_sse2 (int sx, int yl, int yh);
+
+// Defined when the compiler can't build r_drawt_avx2.cpp.
+#ifndef NO_AVX2
+#define RT_AVX2_DRAWERS
+
+void STACK_ARGS rt_shaded4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_add4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_tlateadd4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_addclamp4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_tlateaddclamp4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_subclamp4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_tlatesubclamp4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_revsubclamp4cols_avx2 (int sx, int yl, int yh);
+void STACK_ARGS rt_tlaterevsubclamp4cols_avx2 (int sx, int yl, int yh);
+#endif
+#endif
+
 #ifdef X86_ASM
 #define rt_copy1col			rt_copy1col_asm
 #define rt_copy4cols		rt_copy4cols_asm
@@ -172,13 +204,29 @@ extern void (STACK_ARGS *rt_map4cols)(int sx, int yl, int yh);
 #define rt_shaded4cols		rt_shaded4cols_asm
 #define rt_add4cols			rt_add4cols_asm
 #define rt_addclamp4cols	rt_addclamp4cols_asm
+#define rt_subclamp4cols	rt_subclamp4cols_c
+#define rt_revsubclamp4cols	rt_revsubclamp4cols_c
+#define rt_tlate4cols		rt_tlate4cols_c
+#define rt_tlateadd4cols	rt_tlateadd4cols_c
+#define rt_tlateaddclamp4cols	rt_tlateaddclamp4cols_c
+#define rt_tlatesubclamp4cols	rt_tlatesubclamp4cols_c
+#define rt_tlaterevsubclamp4cols	rt_tlaterevsubclamp4cols_c
 #else
 #define rt_copy1col			rt_copy1col_c
 #define rt_copy4cols		rt_copy4cols_c
 #define rt_map1col			rt_map1col_c
-#define rt_shaded4cols		rt_shaded4cols_c
-#define rt_add4cols			rt_add4cols_c
-#define rt_addclamp4cols	rt_addclamp4cols_c
+
+// Set by R_InitColumnDrawers
+extern void (STACK_ARGS *rt_shaded4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_add4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_addclamp4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_subclamp4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_revsubclamp4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_tlate4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_tlateadd4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_tlateaddclamp4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_tlatesubclamp4cols)(int sx, int yl, int yh);
+extern void (STACK_ARGS *rt_tlaterevsubclamp4cols)(int sx, int yl, int yh);
 #endif
 
 void rt_draw4cols (int sx);
@@ -252,6 +300,36 @@ extern "C" const BYTE*		ds_source;
 
 extern "C" int				ds_color;		// [RH] For flat color (no texturing)
 
+// Everything a span drawer reads, captured from the globals above.
+struct FSpanState
+{
+	FSpanState ();
+
+	int				y;
+	int				x1;
+	int				x2;
+	const BYTE*		colormap;
+	const BYTE*		source;
+	dsfixed_t		xfrac;
+	dsfixed_t		yfrac;
+	dsfixed_t		xstep;
+	dsfixed_t		ystep;
+	int				xbits;
+	int				ybits;
+	int				color;
+	DWORD			*srcblend;
+	DWORD			*destblend;
+	BYTE			*destorg;
+};
+
+void	R_DrawSpanP_C (const FSpanState &ds);
+void	R_DrawSpanMaskedP_C (const FSpanState &ds);
+void	R_DrawSpanTranslucentP_C (const FSpanState &ds);
+void	R_DrawSpanMaskedTranslucentP_C (const FSpanState &ds);
+void	R_DrawSpanAddClampP_C (const FSpanState &ds);
+void	R_DrawSpanMaskedAddClampP_C (const FSpanState &ds);
+void	R_FillSpanP_C (const FSpanState &ds);
+
 extern BYTE shadetables[/*NUMCOLORMAPS*16*256*/];
 extern FDynamicColormap ShadeFakeColormap[16];
 extern BYTE identitymap[256];
@@ -46,6 +46,11 @@
 #include "r_main.h"
 #include "r_things.h"
 #include "v_video.h"
+#include "c_dispatch.h"
+#include "m_random.h"
+#include "stats.h"
+#include "v_text.h"
+#include "x86.h"
 
 // I should have commented this stuff better.
 //
@@ -320,7 +325,7 @@ void rt_tlate1col (int hx, int sx, int yl, int yh)
 }
 
 // Translates all four spans to the screen starting at sx.
-void STACK_ARGS rt_tlate4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_tlate4cols_c (int sx, int yl, int yh)
 {
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_map4cols(sx, yl, yh);
@@ -424,7 +429,7 @@ void rt_tlateadd1col (int hx, int sx, int yl, int yh)
 }
 
 // Translates and adds all four spans to the screen starting at sx without clamping.
-void STACK_ARGS rt_tlateadd4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_tlateadd4cols_c (int sx, int yl, int yh)
 {
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_add4cols(sx, yl, yh);
@@ -614,7 +619,7 @@ void rt_tlateaddclamp1col (int hx, int sx, int yl, int yh)
 }
 
 // Translates and adds all four spans to the screen starting at sx with clamping.
-void STACK_ARGS rt_tlateaddclamp4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_tlateaddclamp4cols_c (int sx, int yl, int yh)
 {
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_addclamp4cols(sx, yl, yh);
@@ -656,7 +661,7 @@ void rt_subclamp1col (int hx, int sx, int yl, int yh)
 }
 
 // Subtracts all four spans to the screen starting at sx with clamping.
-void STACK_ARGS rt_subclamp4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_subclamp4cols_c (int sx, int yl, int yh)
 {
 	BYTE *colormap;
 	BYTE *source;
@@ -723,7 +728,7 @@ void rt_tlatesubclamp1col (int hx, int sx, int yl, int yh)
 }
 
 // Translates and subtracts all four spans to the screen starting at sx with clamping.
-void STACK_ARGS rt_tlatesubclamp4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_tlatesubclamp4cols_c (int sx, int yl, int yh)
 {
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_subclamp4cols(sx, yl, yh);
@@ -765,7 +770,7 @@ void rt_revsubclamp1col (int hx, int sx, int yl, int yh)
 }
 
 // Subtracts all four spans from the screen starting at sx with clamping.
-void STACK_ARGS rt_revsubclamp4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_revsubclamp4cols_c (int sx, int yl, int yh)
 {
 	BYTE *colormap;
 	BYTE *source;
@@ -832,7 +837,7 @@ void rt_tlaterevsubclamp1col (int hx, int sx, int yl, int yh)
 }
 
 // Translates and subtracts all four spans from the screen starting at sx with clamping.
-void STACK_ARGS rt_tlaterevsubclamp4cols (int sx, int yl, int yh)
+void STACK_ARGS rt_tlaterevsubclamp4cols_c (int sx, int yl, int yh)
 {
 	rt_Translate4cols(dc_translation, yl, yh);
 	rt_revsubclamp4cols(sx, yl, yh);
@@ -1200,3 +1205,194 @@ nextpost:
 		}
 	}
 }
+
+#ifdef RT_SIMD_DRAWERS
+//==========================================================================
+//
+// drawerbench
+//
+// Checks that the SSE2 and AVX2 versions of the translucent four column
+// drawers write exactly the same pixels as the C versions for random
+// input, and times all of them.
+//
+//==========================================================================
+
+#define BENCH_HEIGHT	400
+#define BENCH_PITCH		16
+
+struct FRT4colTest
+{
+	const char *Name;
+	void (STACK_ARGS *Drawer[3])(int sx, int yl, int yh);	// C, SSE2, AVX2
+	bool Translate;		// The C drawer needs dc_temp translated first
+	bool Shaded;		// dc_colormap maps to alpha values
+	bool Additive;		// The blend tables need to add up to 64
+};
+
+// The AVX2 drawers aren't built when the compiler doesn't support them.
+#ifdef RT_AVX2_DRAWERS
+#define AVX2_DRAWER(a)	a
+#else
+#define AVX2_DRAWER(a)	NULL
+#endif
+
+static const FRT4colTest RT4colTests[] =
+{
+	{ "tlate",				{ rt_map4cols_c, rt_tlate4cols_sse2, NULL }, true, false, false },
+	{ "shaded",				{ rt_shaded4cols_c, rt_shaded4cols_sse2, AVX2_DRAWER(rt_shaded4cols_avx2) }, false, true, false },
+	{ "add",				{ rt_add4cols_c, rt_add4cols_sse2, AVX2_DRAWER(rt_add4cols_avx2) }, false, false, true },
+	{ "tlateadd",			{ rt_add4cols_c, rt_tlateadd4cols_sse2, AVX2_DRAWER(rt_tlateadd4cols_avx2) }, true, false, true },
+	{ "addclamp",			{ rt_addclamp4cols_c, rt_addclamp4cols_sse2, AVX2_DRAWER(rt_addclamp4cols_avx2) }, false, false, false },
+	{ "tlateaddclamp",		{ rt_addclamp4cols_c, rt_tlateaddclamp4cols_sse2, AVX2_DRAWER(rt_tlateaddclamp4cols_avx2) }, true, false, false },
+	{ "subclamp",			{ rt_subclamp4cols_c, rt_subclamp4cols_sse2, AVX2_DRAWER(rt_subclamp4cols_avx2) }, false, false, false },
+	{ "tlatesubclamp",		{ rt_subclamp4cols_c, rt_tlatesubclamp4cols_sse2, AVX2_DRAWER(rt_tlatesubclamp4cols_avx2) }, true, false, false },
+	{ "revsubclamp",		{ rt_revsubclamp4cols_c, rt_revsubclamp4cols_sse2, AVX2_DRAWER(rt_revsubclamp4cols_avx2) }, false, false, false },
+	{ "tlaterevsubclamp",	{ rt_revsubclamp4cols_c, rt_tlaterevsubclamp4cols_sse2, AVX2_DRAWER(rt_tlaterevsubclamp4cols_avx2) }, true, false, false },
+};
+
+static FRandom pr_drawerbench;
+
+static void R_RunRT4colTest (const FRT4colTest &test, int level, BYTE *screen, BYTE *temp, int sx, int yl, int yh)
+{
+	dc_destorg = screen;
+	dc_temp = temp;
+	if (level == 0 && test.Translate)
+	{
+		rt_Translate4cols (dc_translation, yl, yh);
+	}
+	test.Drawer[level] (sx, yl, yh);
+}
+
+CCMD (drawerbench)
+{
+	static BYTE screens[3][BENCH_HEIGHT*BENCH_PITCH];
+	static BYTE temps[3][BENCH_HEIGHT*4];
+	BYTE colormap[256], translation[256];
+
+	int iterations = argv.argc() > 1 ? atoi(argv[1]) : 1000;
+#ifdef RT_AVX2_DRAWERS
+	int levels = CPU.bAVX2 ? 3 : 2;
+#else
+	int levels = 2;
+#endif
+	iterations = MAX (iterations, 1);
+
+	// Save everything the drawers use.
+	int savedlookup[BENCH_HEIGHT];
+	int savedpitch = dc_pitch;
+	BYTE *saveddestorg = dc_destorg;
+	BYTE *savedtemp = dc_temp;
+	lighttable_t *savedcolormap = dc_colormap;
+	BYTE *savedtranslation = dc_translation;
+	DWORD *savedsrcblend = dc_srcblend;
+	DWORD *saveddestblend = dc_destblend;
+	int savedcolor = dc_color;
+
+	memcpy (savedlookup, ylookup, sizeof(savedlookup));
+	for (int i = 0; i < BENCH_HEIGHT; ++i)
+	{
+		ylookup[i] = i * BENCH_PITCH;
+	}
+	dc_pitch = BENCH_PITCH;
+	dc_colormap = colormap;
+	dc_translation = translation;
+
+	for (unsigned int t = 0; t < countof(RT4colTests); ++t)
+	{
+		const FRT4colTest &test = RT4colTests[t];
+		unsigned int mismatches = 0;
+		cycle_t times[3];
+		int i, j, k;
+
+		// Compare the output for random input.
+		for (i = 0; i < iterations; ++i)
+		{
+			int fglevel = pr_drawerbench(65);
+			int bglevel = test.Additive ? 64 - fglevel : pr_drawerbench(65);
+
+			for (j = 0; j < 256; ++j)
+			{
+				colormap[j] = test.Shaded ? pr_drawerbench(65) : pr_drawerbench();
+				translation[j] = pr_drawerbench();
+			}
+			dc_srcblend = Col2RGB8[fglevel];
+			dc_destblend = Col2RGB8[bglevel];
+			dc_color = pr_drawerbench();
+
+			for (j = 0; j < BENCH_HEIGHT*BENCH_PITCH; ++j)
+			{
+				screens[0][j] = pr_drawerbench();
+			}
+			for (j = 0; j < BENCH_HEIGHT*4; ++j)
+			{
+				temps[0][j] = pr_drawerbench();
+			}
+			for (k = 1; k < levels; ++k)
+			{
+				memcpy (screens[k], screens[0], sizeof(screens[0]));
+				memcpy (temps[k], temps[0], sizeof(temps[0]));
+			}
+
+			int sx = pr_drawerbench(BENCH_PITCH / 4) * 4;
+			int yl = pr_drawerbench(BENCH_HEIGHT);
+			int yh = yl + pr_drawerbench(BENCH_HEIGHT - yl);
+
+			for (k = 0; k < levels; ++k)
+			{
+				if (test.Drawer[k] != NULL)
+				{
+					R_RunRT4colTest (test, k, screens[k], temps[k], sx, yl, yh);
+					if (k > 0 && memcmp (screens[0], screens[k], sizeof(screens[0])) != 0)
+					{
+						mismatches++;
+					}
+				}
+			}
+		}
+
+		// Time them on full columns.
+		for (k = 0; k < levels; ++k)
+		{
+			times[k].Reset();
+			if (test.Drawer[k] == NULL)
+			{
+				continue;
+			}
+			times[k].Clock();
+			for (i = 0; i < iterations; ++i)
+			{
+				for (int sx = 0; sx < BENCH_PITCH; sx += 4)
+				{
+					R_RunRT4colTest (test, k, screens[k], temps[k], sx, 0, BENCH_HEIGHT - 1);
+				}
+			}
+			times[k].Unclock();
+		}
+
+		FString out;
+		out.Format ("%-18s C %.2f ms", test.Name, times[0].TimeMS());
+		for (k = 1; k < levels; ++k)
+		{
+			if (test.Drawer[k] != NULL)
+			{
+				out.AppendFormat (", %s %.2f ms", k == 1 ? "SSE2" : "AVX2", times[k].TimeMS());
+			}
+		}
+		if (mismatches > 0)
+		{
+			out.AppendFormat (" - " TEXTCOLOR_RED "%u mismatches", mismatches);
+		}
+		Printf ("%s\n", out.GetChars());
+	}
+
+	memcpy (ylookup, savedlookup, sizeof(savedlookup));
+	dc_pitch = savedpitch;
+	dc_destorg = saveddestorg;
+	dc_temp = savedtemp;
+	dc_colormap = savedcolormap;
+	dc_translation = savedtranslation;
+	dc_srcblend = savedsrcblend;
+	dc_destblend = saveddestblend;
+	dc_color = savedcolor;
+}
+#endif
@@ -0,0 +1,333 @@
+/*
+** r_drawt_avx2.cpp
+** AVX2 versions of the translucent four column drawers
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 Zandronum Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+** 4. When not used as part of ZDoom or a ZDoom derivative, this code will be
+**    covered by the terms of the GNU General Public License as published by
+**    the Free Software Foundation; either version 2 of the License, or (at
+**    your option) any later version.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Same as r_drawt_sse2.cpp, but two rows at a time, with the lookups into
+** the blend tables gathered. The colormap, translation and RGB32k lookups
+** are bytes and are still done one pixel at a time: a dword gather would
+** read past the end of those tables.
+**
+** This file is compiled with AVX2 enabled, and only called when CPUID says
+** it is safe to. It therefore includes as little as possible, so that no
+** inline function from the headers ends up in the executable as AVX2 code.
+*/
+
+#include <immintrin.h>
+
+#include "doomtype.h"
+
+#if (defined(__amd64__) || defined(_M_X64)) && !defined(X86_ASM) && !defined(NO_AVX2)
+
+extern "C" int			ylookup[];
+extern "C" int			dc_pitch;
+extern "C" BYTE			*dc_colormap;
+extern "C" int			dc_color;
+extern "C" DWORD		*dc_srcblend;
+extern "C" DWORD		*dc_destblend;
+extern "C" BYTE			*dc_destorg;
+extern "C" BYTE			*dc_temp;
+extern BYTE				*dc_translation;
+
+extern "C" BYTE RGB32k[32][32][32];
+extern "C" DWORD Col2RGB8[65][256];
+
+// Internal linkage, so the linker can never pick these AVX2 versions for
+// the SSE2 blends of the same names.
+namespace
+{
+
+// Each blend takes the fg2rgb and bg2rgb values of eight pixels, or four
+// for an odd row, and returns their RGB32k indices.
+
+struct FBlendAdd
+{
+	static inline __m256i Blend (__m256i fg, __m256i bg)
+	{
+		__m256i a = _mm256_or_si256 (_mm256_add_epi32 (fg, bg), _mm256_set1_epi32 (0x1f07c1f));
+		return _mm256_and_si256 (a, _mm256_srli_epi32 (a, 15));
+	}
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		__m128i a = _mm_or_si128 (_mm_add_epi32 (fg, bg), _mm_set1_epi32 (0x1f07c1f));
+		return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+	}
+};
+
+struct FBlendAddClamp
+{
+	static inline __m256i Blend (__m256i fg, __m256i bg)
+	{
+		__m256i a = _mm256_add_epi32 (fg, bg);
+		__m256i b = _mm256_and_si256 (a, _mm256_set1_epi32 (0x40100400));
+		a = _mm256_or_si256 (a, _mm256_set1_epi32 (0x01f07c1f));
+		a = _mm256_and_si256 (a, _mm256_set1_epi32 (0x3fffffff));
+		b = _mm256_sub_epi32 (b, _mm256_srli_epi32 (b, 5));
+		a = _mm256_or_si256 (a, b);
+		return _mm256_and_si256 (a, _mm256_srli_epi32 (a, 15));
+	}
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		__m128i a = _mm_add_epi32 (fg, bg);
+		__m128i b = _mm_and_si128 (a, _mm_set1_epi32 (0x40100400));
+		a = _mm_or_si128 (a, _mm_set1_epi32 (0x01f07c1f));
+		a = _mm_and_si128 (a, _mm_set1_epi32 (0x3fffffff));
+		b = _mm_sub_epi32 (b, _mm_srli_epi32 (b, 5));
+		a = _mm_or_si128 (a, b);
+		return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+	}
+};
+
+static inline __m256i R_SubClamp (__m256i a)
+{
+	__m256i b = _mm256_and_si256 (a, _mm256_set1_epi32 (0x40100400));
+	b = _mm256_sub_epi32 (b, _mm256_srli_epi32 (b, 5));
+	a = _mm256_and_si256 (a, b);
+	a = _mm256_or_si256 (a, _mm256_set1_epi32 (0x01f07c1f));
+	return _mm256_and_si256 (a, _mm256_srli_epi32 (a, 15));
+}
+
+static inline __m128i R_SubClamp (__m128i a)
+{
+	__m128i b = _mm_and_si128 (a, _mm_set1_epi32 (0x40100400));
+	b = _mm_sub_epi32 (b, _mm_srli_epi32 (b, 5));
+	a = _mm_and_si128 (a, b);
+	a = _mm_or_si128 (a, _mm_set1_epi32 (0x01f07c1f));
+	return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+}
+
+struct FBlendSubClamp
+{
+	static inline __m256i Blend (__m256i fg, __m256i bg)
+	{
+		return R_SubClamp (_mm256_sub_epi32 (_mm256_or_si256 (fg, _mm256_set1_epi32 (0x40100400)), bg));
+	}
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		return R_SubClamp (_mm_sub_epi32 (_mm_or_si128 (fg, _mm_set1_epi32 (0x40100400)), bg));
+	}
+};
+
+struct FBlendRevSubClamp
+{
+	static inline __m256i Blend (__m256i fg, __m256i bg)
+	{
+		return R_SubClamp (_mm256_sub_epi32 (_mm256_or_si256 (bg, _mm256_set1_epi32 (0x40100400)), fg));
+	}
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		return R_SubClamp (_mm_sub_epi32 (_mm_or_si128 (bg, _mm_set1_epi32 (0x40100400)), fg));
+	}
+};
+
+} // namespace
+
+// Looks up count bytes of source in colormap, and in translation first if
+// translate is set, and returns them packed into a qword.
+template<bool translate>
+static inline QWORD R_MapBytes (const BYTE *source, const BYTE *translation, const BYTE *colormap, int count)
+{
+	QWORD mapped = 0;
+
+	for (int i = 0; i < count; ++i)
+	{
+		BYTE c = source[i];
+		if (translate)
+		{
+			c = translation[c];
+		}
+		mapped |= (QWORD)colormap[c] << (i * 8);
+	}
+	return mapped;
+}
+
+// Writes the pixels for count RGB32k indices to dest, four per row.
+static inline void R_WriteRows (BYTE *dest, int pitch, const DWORD *index, int count)
+{
+	for (int i = 0; i < count; i += 4)
+	{
+		dest[0] = RGB32k[0][0][index[i+0]];
+		dest[1] = RGB32k[0][0][index[i+1]];
+		dest[2] = RGB32k[0][0][index[i+2]];
+		dest[3] = RGB32k[0][0][index[i+3]];
+		dest += pitch;
+	}
+}
+
+template<class Op, bool translate>
+static void rt_Blend4cols_AVX2 (int sx, int yl, int yh)
+{
+	union
+	{
+		__m256i v;
+		__m128i h;
+		DWORD d[8];
+	} index;
+	const BYTE *colormap;
+	const BYTE *translation;
+	const BYTE *source;
+	BYTE *dest;
+	int count;
+	int pitch;
+
+	count = yh-yl;
+	if (count < 0)
+		return;
+	count++;
+
+	const int *fg2rgb = (const int *)dc_srcblend;
+	const int *bg2rgb = (const int *)dc_destblend;
+	dest = ylookup[yl] + sx + dc_destorg;
+	source = &dc_temp[yl*4];
+	pitch = dc_pitch;
+	colormap = dc_colormap;
+	translation = dc_translation;
+
+	if (count & 1)
+	{
+		__m128i fgi = _mm_cvtepu8_epi32 (_mm_cvtsi32_si128 ((int)R_MapBytes<translate> (source, translation, colormap, 4)));
+		__m128i bgi = _mm_cvtepu8_epi32 (_mm_cvtsi32_si128 (*(int *)dest));
+
+		index.h = Op::Blend (_mm_i32gather_epi32 (fg2rgb, fgi, 4), _mm_i32gather_epi32 (bg2rgb, bgi, 4));
+		R_WriteRows (dest, pitch, index.d, 4);
+		source += 4;
+		dest += pitch;
+	}
+	for (count >>= 1; count; --count)
+	{
+		__m256i fgi = _mm256_cvtepu8_epi32 (_mm_cvtsi64_si128 ((long long)R_MapBytes<translate> (source, translation, colormap, 8)));
+		__m256i bgi = _mm256_cvtepu8_epi32 (_mm_unpacklo_epi32 (_mm_cvtsi32_si128 (*(int *)dest), _mm_cvtsi32_si128 (*(int *)(dest + pitch))));
+
+		index.v = Op::Blend (_mm256_i32gather_epi32 (fg2rgb, fgi, 4), _mm256_i32gather_epi32 (bg2rgb, bgi, 4));
+		R_WriteRows (dest, pitch, index.d, 8);
+		source += 8;
+		dest += pitch*2;
+	}
+}
+
+void STACK_ARGS rt_add4cols_avx2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_AVX2<FBlendAdd, false> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_tlateadd4cols_avx2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_AVX2<FBlendAdd, true> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_addclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_AVX2<FBlendAddClamp, false> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_tlateaddclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_AVX2<FBlendAddClamp, true> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_subclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_AVX2<FBlendSubClamp, false> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_tlatesubclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_AVX2<FBlendSubClamp, true> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_revsubclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_AVX2<FBlendRevSubClamp, false> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_tlaterevsubclamp4cols_avx2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_AVX2<FBlendRevSubClamp, true> (sx, yl, yh);
+}
+
+// Shades all four spans to the screen starting at sx. Col2RGB8[64-val][bg]
+// and Col2RGB8[val][color] are both gathered from the start of Col2RGB8.
+void STACK_ARGS rt_shaded4cols_avx2 (int sx, int yl, int yh)
+{
+	union
+	{
+		__m256i v;
+		__m128i h;
+		DWORD d[8];
+	} index;
+	const int *col2rgb;
+	const BYTE *colormap;
+	const BYTE *source;
+	BYTE *dest;
+	int count;
+	int pitch;
+
+	count = yh-yl;
+	if (count < 0)
+		return;
+	count++;
+
+	col2rgb = (const int *)&Col2RGB8[0][0];
+	colormap = dc_colormap;
+	dest = ylookup[yl] + sx + dc_destorg;
+	source = &dc_temp[yl*4];
+	pitch = dc_pitch;
+
+	if (count & 1)
+	{
+		__m128i val = _mm_cvtepu8_epi32 (_mm_cvtsi32_si128 ((int)R_MapBytes<false> (source, NULL, colormap, 4)));
+		__m128i bg = _mm_cvtepu8_epi32 (_mm_cvtsi32_si128 (*(int *)dest));
+		__m128i fgi = _mm_add_epi32 (_mm_slli_epi32 (val, 8), _mm_set1_epi32 (dc_color));
+		__m128i bgi = _mm_add_epi32 (_mm_slli_epi32 (_mm_sub_epi32 (_mm_set1_epi32 (64), val), 8), bg);
+
+		index.h = FBlendAdd::Blend (_mm_i32gather_epi32 (col2rgb, fgi, 4), _mm_i32gather_epi32 (col2rgb, bgi, 4));
+		R_WriteRows (dest, pitch, index.d, 4);
+		source += 4;
+		dest += pitch;
+	}
+	for (count >>= 1; count; --count)
+	{
+		__m256i val = _mm256_cvtepu8_epi32 (_mm_cvtsi64_si128 ((long long)R_MapBytes<false> (source, NULL, colormap, 8)));
+		__m256i bg = _mm256_cvtepu8_epi32 (_mm_unpacklo_epi32 (_mm_cvtsi32_si128 (*(int *)dest), _mm_cvtsi32_si128 (*(int *)(dest + pitch))));
+		__m256i fgi = _mm256_add_epi32 (_mm256_slli_epi32 (val, 8), _mm256_set1_epi32 (dc_color));
+		__m256i bgi = _mm256_add_epi32 (_mm256_slli_epi32 (_mm256_sub_epi32 (_mm256_set1_epi32 (64), val), 8), bg);
+
+		index.v = FBlendAdd::Blend (_mm256_i32gather_epi32 (col2rgb, fgi, 4), _mm256_i32gather_epi32 (col2rgb, bgi, 4));
+		R_WriteRows (dest, pitch, index.d, 8);
+		source += 8;
+		dest += pitch*2;
+	}
+}
+
+#endif
@@ -0,0 +1,282 @@
+/*
+** r_drawt_sse2.cpp
+** SSE2 versions of the translucent four column drawers
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 Zandronum Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+** 4. When not used as part of ZDoom or a ZDoom derivative, this code will be
+**    covered by the terms of the GNU General Public License as published by
+**    the Free Software Foundation; either version 2 of the License, or (at
+**    your option) any later version.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** These do the same integer arithmetic as the C drawers in r_drawt.cpp on
+** the four columns of a row at once, so they write exactly the same
+** pixels. SSE2 has no gather, so the table lookups are still done one
+** pixel at a time.
+**
+** The translated versions look the translation up on the fly instead of
+** translating dc_temp in place first. The rows they draw are never read
+** from dc_temp again, so that makes no difference to the result.
+*/
+
+#include <emmintrin.h>
+
+#include "doomtype.h"
+#include "doomdef.h"
+#include "r_defs.h"
+#include "r_draw.h"
+#include "v_video.h"
+
+#ifdef RT_SIMD_DRAWERS
+
+// The AVX2 drawers define blends with the same names but other code.
+namespace
+{
+
+// Each blend takes the fg2rgb and bg2rgb values of four pixels and returns
+// their RGB32k indices.
+
+struct FBlendAdd
+{
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		__m128i a = _mm_or_si128 (_mm_add_epi32 (fg, bg), _mm_set1_epi32 (0x1f07c1f));
+		return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+	}
+};
+
+struct FBlendAddClamp
+{
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		__m128i a = _mm_add_epi32 (fg, bg);
+		__m128i b = _mm_and_si128 (a, _mm_set1_epi32 (0x40100400));
+		a = _mm_or_si128 (a, _mm_set1_epi32 (0x01f07c1f));
+		a = _mm_and_si128 (a, _mm_set1_epi32 (0x3fffffff));
+		b = _mm_sub_epi32 (b, _mm_srli_epi32 (b, 5));
+		a = _mm_or_si128 (a, b);
+		return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+	}
+};
+
+static inline __m128i R_SubClamp (__m128i a)
+{
+	__m128i b = _mm_and_si128 (a, _mm_set1_epi32 (0x40100400));
+	b = _mm_sub_epi32 (b, _mm_srli_epi32 (b, 5));
+	a = _mm_and_si128 (a, b);
+	a = _mm_or_si128 (a, _mm_set1_epi32 (0x01f07c1f));
+	return _mm_and_si128 (a, _mm_srli_epi32 (a, 15));
+}
+
+struct FBlendSubClamp
+{
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		return R_SubClamp (_mm_sub_epi32 (_mm_or_si128 (fg, _mm_set1_epi32 (0x40100400)), bg));
+	}
+};
+
+struct FBlendRevSubClamp
+{
+	static inline __m128i Blend (__m128i fg, __m128i bg)
+	{
+		return R_SubClamp (_mm_sub_epi32 (_mm_or_si128 (bg, _mm_set1_epi32 (0x40100400)), fg));
+	}
+};
+
+} // namespace
+
+template<class Op, bool translate>
+static void rt_Blend4cols_SSE2 (int sx, int yl, int yh)
+{
+	union
+	{
+		__m128i v;
+		DWORD d[4];
+	} index;
+	const BYTE *colormap;
+	const BYTE *translation;
+	const BYTE *source;
+	BYTE *dest;
+	int count;
+	int pitch;
+
+	count = yh-yl;
+	if (count < 0)
+		return;
+	count++;
+
+	const DWORD *fg2rgb = dc_srcblend;
+	const DWORD *bg2rgb = dc_destblend;
+	dest = ylookup[yl] + sx + dc_destorg;
+	source = &dc_temp[yl*4];
+	pitch = dc_pitch;
+	colormap = dc_colormap;
+	translation = dc_translation;
+
+	do {
+		BYTE s0 = source[0], s1 = source[1], s2 = source[2], s3 = source[3];
+
+		if (translate)
+		{
+			s0 = translation[s0];
+			s1 = translation[s1];
+			s2 = translation[s2];
+			s3 = translation[s3];
+		}
+
+		__m128i fg = _mm_setr_epi32 (fg2rgb[colormap[s0]], fg2rgb[colormap[s1]], fg2rgb[colormap[s2]], fg2rgb[colormap[s3]]);
+		__m128i bg = _mm_setr_epi32 (bg2rgb[dest[0]], bg2rgb[dest[1]], bg2rgb[dest[2]], bg2rgb[dest[3]]);
+
+		index.v = Op::Blend (fg, bg);
+		dest[0] = RGB32k[0][0][index.d[0]];
+		dest[1] = RGB32k[0][0][index.d[1]];
+		dest[2] = RGB32k[0][0][index.d[2]];
+		dest[3] = RGB32k[0][0][index.d[3]];
+
+		source += 4;
+		dest += pitch;
+	} while (--count);
+}
+
+void STACK_ARGS rt_add4cols_sse2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_SSE2<FBlendAdd, false> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_tlateadd4cols_sse2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_SSE2<FBlendAdd, true> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_addclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_SSE2<FBlendAddClamp, false> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_tlateaddclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_SSE2<FBlendAddClamp, true> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_subclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_SSE2<FBlendSubClamp, false> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_tlatesubclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_SSE2<FBlendSubClamp, true> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_revsubclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_SSE2<FBlendRevSubClamp, false> (sx, yl, yh);
+}
+
+void STACK_ARGS rt_tlaterevsubclamp4cols_sse2 (int sx, int yl, int yh)
+{
+	rt_Blend4cols_SSE2<FBlendRevSubClamp, true> (sx, yl, yh);
+}
+
+// Shades all four spans to the screen starting at sx.
+void STACK_ARGS rt_shaded4cols_sse2 (int sx, int yl, int yh)
+{
+	union
+	{
+		__m128i v;
+		DWORD d[4];
+	} index;
+	const DWORD *fgstart;
+	const BYTE *colormap;
+	const BYTE *source;
+	BYTE *dest;
+	int count;
+	int pitch;
+
+	count = yh-yl;
+	if (count < 0)
+		return;
+	count++;
+
+	fgstart = &Col2RGB8[0][dc_color];
+	colormap = dc_colormap;
+	dest = ylookup[yl] + sx + dc_destorg;
+	source = &dc_temp[yl*4];
+	pitch = dc_pitch;
+
+	do {
+		DWORD v0 = colormap[source[0]], v1 = colormap[source[1]], v2 = colormap[source[2]], v3 = colormap[source[3]];
+
+		__m128i fg = _mm_setr_epi32 (fgstart[v0<<8], fgstart[v1<<8], fgstart[v2<<8], fgstart[v3<<8]);
+		__m128i bg = _mm_setr_epi32 (Col2RGB8[64-v0][dest[0]], Col2RGB8[64-v1][dest[1]], Col2RGB8[64-v2][dest[2]], Col2RGB8[64-v3][dest[3]]);
+
+		index.v = FBlendAdd::Blend (fg, bg);
+		dest[0] = RGB32k[0][0][index.d[0]];
+		dest[1] = RGB32k[0][0][index.d[1]];
+		dest[2] = RGB32k[0][0][index.d[2]];
+		dest[3] = RGB32k[0][0][index.d[3]];
+
+		source += 4;
+		dest += pitch;
+	} while (--count);
+}
+
+// Translates all four spans to the screen starting at sx.
+void STACK_ARGS rt_tlate4cols_sse2 (int sx, int yl, int yh)
+{
+	const BYTE *colormap;
+	const BYTE *translation;
+	const BYTE *source;
+	BYTE *dest;
+	int count;
+	int pitch;
+
+	count = yh-yl;
+	if (count < 0)
+		return;
+	count++;
+
+	dest = ylookup[yl] + sx + dc_destorg;
+	source = &dc_temp[yl*4];
+	pitch = dc_pitch;
+	colormap = dc_colormap;
+	translation = dc_translation;
+
+	do {
+		*(DWORD *)dest =
+			 (DWORD)colormap[translation[source[0]]] |
+			((DWORD)colormap[translation[source[1]]] << 8) |
+			((DWORD)colormap[translation[source[2]]] << 16) |
+			((DWORD)colormap[translation[source[3]]] << 24);
+		source += 4;
+		dest += pitch;
+	} while (--count);
+}
+
+#endif
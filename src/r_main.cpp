@@ -42,6 +42,7 @@
 #include "r_plane.h"
 #include "r_bsp.h"
 #include "r_3dfloors.h"
+#include "r_thread.h"
 #include "r_sky.h"
 #include "st_stuff.h"
 #include "c_cvars.h"
@@ -719,6 +720,7 @@ void R_EnterMirror (drawseg_t *ds, int depth)
 	WindowRight = ds->x2;
 	MirrorFlags = (depth + 1) & 1;
 
+	R_BeginDrawerCommands ();
 	R_RenderBSPNode (nodes + numnodes - 1);
 	R_3D_ResetClip(); // reset clips (floor/ceiling)
 
@@ -843,6 +845,7 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 	PO_LinkToSubsectors();
 	if (r_polymost < 2)
 	{
+		R_BeginDrawerCommands ();
 		R_RenderBSPNode (nodes + numnodes - 1);	// The head node is the last node output.
 		R_3D_ResetClip(); // reset clips (floor/ceiling)
 	}
@@ -883,6 +886,7 @@ void R_RenderActorView (AActor *actor, bool dontmaplines)
 			}
 		}
 	}
+	R_EndDrawerCommands ();
 	WallMirrors.Clear ();
 	interpolator.RestoreInterpolations ();
 	R_SetupBuffer ();
@@ -58,6 +58,7 @@
 #include "g_level.h"
 #include "r_bsp.h"
 #include "r_plane.h"
+#include "r_thread.h"
 #include "r_segs.h"
 #include "r_3dfloors.h"
 #include "v_palette.h"
@@ -244,7 +245,14 @@ void R_MapPlane (int y, int x1)
 	ds_x1 = x1;
 	ds_x2 = x2;
 
-	spanfunc ();
+	if (DrawersQueued)
+	{
+		R_QueueSpan (spanfunc);
+	}
+	else
+	{
+		spanfunc ();
+	}
 }
 
 //==========================================================================
@@ -491,6 +499,14 @@ void R_MapTiltedPlane (int y, int x1)
 
 void R_MapColoredPlane (int y, int x1)
 {
+	if (DrawersQueued)
+	{
+		ds_y = y;
+		ds_x1 = x1;
+		ds_x2 = spanend[y];
+		R_QueueSpan (R_FillSpan);
+		return;
+	}
 	memset (ylookup[y] + x1 + dc_destorg, ds_color, spanend[y] - x1 + 1);
 }
 
@@ -890,18 +906,27 @@ static const BYTE *R_GetTwoSkyColumns (FTexture *fronttex, int x)
 	// no reason to waste time building it again.
 	DWORD skycol = (angle1 << 16) | angle2;
 	int i;
+	BYTE *composite;
 
-	for (i = 0; i < 4; ++i)
+	// Queued columns are drawn later, so they each need their own buffer.
+	if (DrawersQueued)
+	{
+		composite = (BYTE *)R_AllocDrawerMemory (512);
+	}
+	else
 	{
-		if (lastskycol[i] == skycol)
+		for (i = 0; i < 4; ++i)
 		{
-			return skybuf[i];
+			if (lastskycol[i] == skycol)
+			{
+				return skybuf[i];
+			}
 		}
-	}
 
-	lastskycol[skycolplace] = skycol;
-	BYTE *composite = skybuf[skycolplace];
-	skycolplace = (skycolplace + 1) & 3;
+		lastskycol[skycolplace] = skycol;
+		composite = skybuf[skycolplace];
+		skycolplace = (skycolplace + 1) & 3;
+	}
 
 	// The ordering of the following code has been tuned to allow VC++ to optimize
 	// it well. In particular, this arrangement lets it keep count in a register
@@ -1644,6 +1669,12 @@ void R_DrawTiltedPlane (visplane_t *pl, fixed_t alpha, bool additive, bool maske
 		return;
 	}
 
+	// Tilted planes are drawn directly.
+	if (DrawersQueued)
+	{
+		R_WaitForDrawerCommands ();
+	}
+
 	double vx = FIXED2FLOAT(viewx);
 	double vy = FIXED2FLOAT(viewy);
 	double vz = FIXED2FLOAT(viewz);
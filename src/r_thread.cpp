@@ -0,0 +1,632 @@
+/*
+** r_thread.cpp
+**
+** Records the columns and spans of the opaque pass and draws them on
+** several threads.
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 Zandronum Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+** 4. When not used as part of ZDoom or a ZDoom derivative, this code will be
+**    covered by the terms of the GNU General Public License as published by
+**    the Free Software Foundation; either version 2 of the License, or (at
+**    your option) any later version.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** The queued drawers always run the C versions of the drawers. Rows are
+** split between the threads by y % numcores, relative to the top of the
+** view, so a span is drawn by a single thread and the rows of a column by
+** all of them. A column that starts skip rows down is continued with its
+** texture position advanced by skip steps, which is exactly what the
+** single threaded loop computes for that row.
+**
+*/
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include "templates.h"
+#include "doomtype.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "i_system.h"
+#include "doomstat.h"
+#include "d_player.h"
+#include "v_video.h"
+#include "stats.h"
+#include "md5.h"
+#include "r_local.h"
+#include "r_thread.h"
+
+// Memory for commands is handed out from blocks of this size.
+#define DRAWER_BLOCK_SIZE	(1024*1024)
+
+CUSTOM_CVAR (Int, r_drawthreads, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+{
+	if (self < 0)
+	{
+		self = 0;
+	}
+	else if (self > 64)
+	{
+		self = 64;
+	}
+}
+
+bool DrawersQueued;
+
+static TArray<FDrawerCommand *> Commands;
+
+struct FDrawerBlock
+{
+	BYTE *Memory;
+	size_t Size;
+};
+static TArray<FDrawerBlock> Blocks;
+static unsigned int CurrentBlock;
+static size_t BlockPos;
+
+static std::vector<std::thread> Workers;
+static std::mutex WorkerMutex;
+static std::condition_variable StartCondition;
+static std::condition_variable DoneCondition;
+static unsigned int Generation;
+static int PendingWorkers;
+static bool StopWorkers;
+static int NumCores = 1;
+
+static int vlinebits;
+
+//==========================================================================
+//
+// Executes the commands for one core
+//
+//==========================================================================
+
+static void R_ExecuteDrawerCommands (int core)
+{
+	for (unsigned int i = 0; i < Commands.Size(); ++i)
+	{
+		Commands[i]->Execute (core, NumCores);
+	}
+}
+
+//==========================================================================
+//
+// The worker threads take the cores after the main thread's core 0.
+//
+//==========================================================================
+
+static void R_DrawerWorker (int core)
+{
+	unsigned int seen = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock (WorkerMutex);
+			StartCondition.wait (lock, [&seen]() { return StopWorkers || Generation != seen; });
+			if (StopWorkers)
+			{
+				return;
+			}
+			seen = Generation;
+		}
+
+		R_ExecuteDrawerCommands (core);
+
+		std::unique_lock<std::mutex> lock (WorkerMutex);
+		if (--PendingWorkers == 0)
+		{
+			DoneCondition.notify_one ();
+		}
+	}
+}
+
+//==========================================================================
+//
+// R_StopDrawerThreads
+//
+//==========================================================================
+
+static void R_StopDrawerThreads ()
+{
+	{
+		std::unique_lock<std::mutex> lock (WorkerMutex);
+		StopWorkers = true;
+	}
+	StartCondition.notify_all ();
+	for (size_t i = 0; i < Workers.size(); ++i)
+	{
+		Workers[i].join ();
+	}
+	Workers.clear ();
+	StopWorkers = false;
+	NumCores = 1;
+
+	for (unsigned int i = 0; i < Blocks.Size(); ++i)
+	{
+		delete[] Blocks[i].Memory;
+	}
+	Blocks.Clear ();
+	CurrentBlock = 0;
+	BlockPos = 0;
+}
+
+//==========================================================================
+//
+// R_StartDrawerThreads
+//
+//==========================================================================
+
+static void R_StartDrawerThreads (int numcores)
+{
+	static bool registered;
+
+	if (!registered)
+	{
+		atterm (R_StopDrawerThreads);
+		registered = true;
+	}
+
+	R_StopDrawerThreads ();
+	NumCores = numcores;
+	Generation = 0;
+	for (int i = 1; i < numcores; ++i)
+	{
+		Workers.push_back (std::thread (R_DrawerWorker, i));
+	}
+}
+
+//==========================================================================
+//
+// R_BeginDrawerCommands
+//
+// Opens the queue, unless r_drawthreads leaves only one thread to draw.
+//
+//==========================================================================
+
+void R_BeginDrawerCommands ()
+{
+	if (DrawersQueued)
+	{
+		return;
+	}
+
+	int numcores = r_drawthreads;
+	if (numcores == 0)
+	{
+		numcores = clamp<int> (std::thread::hardware_concurrency(), 1, 8);
+	}
+	if (numcores != NumCores)
+	{
+		R_StartDrawerThreads (numcores);
+	}
+	DrawersQueued = (NumCores > 1);
+}
+
+//==========================================================================
+//
+// R_WaitForDrawerCommands
+//
+// Draws everything recorded so far. The queue stays open.
+//
+//==========================================================================
+
+void R_WaitForDrawerCommands ()
+{
+	if (Commands.Size() == 0)
+	{
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock (WorkerMutex);
+		PendingWorkers = NumCores - 1;
+		++Generation;
+	}
+	StartCondition.notify_all ();
+
+	R_ExecuteDrawerCommands (0);
+
+	{
+		std::unique_lock<std::mutex> lock (WorkerMutex);
+		DoneCondition.wait (lock, []() { return PendingWorkers == 0; });
+	}
+
+	Commands.Clear ();
+	CurrentBlock = 0;
+	BlockPos = 0;
+}
+
+//==========================================================================
+//
+// R_EndDrawerCommands
+//
+//==========================================================================
+
+void R_EndDrawerCommands ()
+{
+	if (DrawersQueued)
+	{
+		R_WaitForDrawerCommands ();
+		DrawersQueued = false;
+	}
+}
+
+//==========================================================================
+//
+// R_AllocDrawerMemory
+//
+//==========================================================================
+
+void *R_AllocDrawerMemory (size_t size)
+{
+	size = (size + 15) & ~(size_t)15;
+
+	while (CurrentBlock < Blocks.Size() && BlockPos + size > Blocks[CurrentBlock].Size)
+	{
+		CurrentBlock++;
+		BlockPos = 0;
+	}
+	if (CurrentBlock == Blocks.Size())
+	{
+		FDrawerBlock block;
+		block.Size = MAX<size_t> (size, DRAWER_BLOCK_SIZE);
+		block.Memory = new BYTE[block.Size];
+		Blocks.Push (block);
+	}
+
+	void *mem = Blocks[CurrentBlock].Memory + BlockPos;
+	BlockPos += size;
+	return mem;
+}
+
+//==========================================================================
+//
+// R_AddDrawerCommand
+//
+//==========================================================================
+
+void R_AddDrawerCommand (FDrawerCommand *command)
+{
+	Commands.Push (command);
+}
+
+//==========================================================================
+//
+// Returns the first row at or after y that belongs to the core.
+//
+//==========================================================================
+
+static inline int R_FirstRowSkip (int y, int core, int numcores)
+{
+	int skip = (core - y) % numcores;
+	return skip < 0 ? skip + numcores : skip;
+}
+
+//==========================================================================
+//
+// FVLine1Command
+//
+// Same as vlinec1.
+//
+//==========================================================================
+
+class FVLine1Command : public FDrawerCommand
+{
+	DWORD IScale;
+	DWORD TextureFrac;
+	const BYTE *Colormap;
+	const BYTE *Source;
+	BYTE *Dest;
+	int Count;
+	int Y;
+	int Bits;
+	int Pitch;
+
+public:
+	FVLine1Command ()
+	{
+		IScale = dc_iscale;
+		TextureFrac = dc_texturefrac;
+		Colormap = dc_colormap;
+		Source = dc_source;
+		Dest = dc_dest;
+		Count = dc_count;
+		Y = int(dc_dest - dc_destorg) / dc_pitch;
+		Bits = vlinebits;
+		Pitch = dc_pitch;
+	}
+
+	void Execute (int core, int numcores)
+	{
+		int skip = R_FirstRowSkip (Y, core, numcores);
+		if (skip >= Count)
+		{
+			return;
+		}
+
+		DWORD fracstep = IScale * numcores;
+		DWORD frac = TextureFrac + IScale * skip;
+		const BYTE *colormap = Colormap;
+		const BYTE *source = Source;
+		BYTE *dest = Dest + Pitch * skip;
+		int count = (Count - skip + numcores - 1) / numcores;
+		int bits = Bits;
+		int pitch = Pitch * numcores;
+
+		do
+		{
+			*dest = colormap[source[frac>>bits]];
+			frac += fracstep;
+			dest += pitch;
+		} while (--count);
+	}
+};
+
+//==========================================================================
+//
+// FVLine4Command
+//
+// Same as vlinec4.
+//
+//==========================================================================
+
+class FVLine4Command : public FDrawerCommand
+{
+	DWORD Place[4];
+	DWORD Step[4];
+	const BYTE *Colormap[4];
+	const BYTE *Source[4];
+	BYTE *Dest;
+	int Count;
+	int Y;
+	int Bits;
+	int Pitch;
+
+public:
+	FVLine4Command ()
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			Place[i] = vplce[i];
+			Step[i] = vince[i];
+			Colormap[i] = palookupoffse[i];
+			Source[i] = bufplce[i];
+		}
+		Dest = dc_dest;
+		Count = dc_count;
+		Y = int(dc_dest - dc_destorg) / dc_pitch;
+		Bits = vlinebits;
+		Pitch = dc_pitch;
+	}
+
+	void Execute (int core, int numcores)
+	{
+		int skip = R_FirstRowSkip (Y, core, numcores);
+		if (skip >= Count)
+		{
+			return;
+		}
+
+		DWORD place[4], step[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			place[i] = Place[i] + Step[i] * skip;
+			step[i] = Step[i] * numcores;
+		}
+		BYTE *dest = Dest + Pitch * skip;
+		int count = (Count - skip + numcores - 1) / numcores;
+		int bits = Bits;
+		int pitch = Pitch * numcores;
+
+		do
+		{
+			dest[0] = Colormap[0][Source[0][place[0]>>bits]]; place[0] += step[0];
+			dest[1] = Colormap[1][Source[1][place[1]>>bits]]; place[1] += step[1];
+			dest[2] = Colormap[2][Source[2][place[2]>>bits]]; place[2] += step[2];
+			dest[3] = Colormap[3][Source[3][place[3]>>bits]]; place[3] += step[3];
+			dest += pitch;
+		} while (--count);
+	}
+};
+
+//==========================================================================
+//
+// FSpanCommand
+//
+//==========================================================================
+
+class FSpanCommand : public FDrawerCommand
+{
+	FSpanState State;
+	void (*Drawer)(const FSpanState &);
+
+public:
+	FSpanCommand (void (*drawer)(const FSpanState &))
+		: Drawer(drawer)
+	{
+	}
+
+	void Execute (int core, int numcores)
+	{
+		if (State.y % numcores == core)
+		{
+			Drawer (State);
+		}
+	}
+};
+
+//==========================================================================
+//
+// The queued wall drawers. They leave behind the same texture positions
+// as the drawers they stand in for, since wallscan continues from them.
+//
+//==========================================================================
+
+static DWORD STACK_ARGS R_QueueVLine1 ()
+{
+	if (dc_count > 0)
+	{
+		R_QueueDrawerCommand (FVLine1Command());
+	}
+	return dc_texturefrac + dc_iscale * dc_count;
+}
+
+static void STACK_ARGS R_QueueVLine4 ()
+{
+	if (dc_count > 0)
+	{
+		R_QueueDrawerCommand (FVLine4Command());
+	}
+	for (int i = 0; i < 4; ++i)
+	{
+		vplce[i] += vince[i] * dc_count;
+	}
+}
+
+//==========================================================================
+//
+// R_SetupQueuedVLine
+//
+// Called by setupvline while the queue is open.
+//
+//==========================================================================
+
+void R_SetupQueuedVLine (int fracbits)
+{
+	vlinebits = fracbits;
+	dovline1 = R_QueueVLine1;
+	doprevline1 = R_QueueVLine1;
+	dovline4 = R_QueueVLine4;
+}
+
+//==========================================================================
+//
+// R_QueueSpan
+//
+// Records a span for one of the span drawers. Anything else is drawn
+// right away, after the spans before it.
+//
+//==========================================================================
+
+void R_QueueSpan (void (*spanfunc)(void))
+{
+	void (*drawer)(const FSpanState &);
+
+	if (spanfunc == R_DrawSpan)							drawer = R_DrawSpanP_C;
+	else if (spanfunc == R_DrawSpanMasked)				drawer = R_DrawSpanMaskedP_C;
+	else if (spanfunc == R_DrawSpanTranslucent)			drawer = R_DrawSpanTranslucentP_C;
+	else if (spanfunc == R_DrawSpanMaskedTranslucent)	drawer = R_DrawSpanMaskedTranslucentP_C;
+	else if (spanfunc == R_DrawSpanAddClamp)			drawer = R_DrawSpanAddClampP_C;
+	else if (spanfunc == R_DrawSpanMaskedAddClamp)		drawer = R_DrawSpanMaskedAddClampP_C;
+	else if (spanfunc == R_FillSpan)					drawer = R_FillSpanP_C;
+	else
+	{
+		R_WaitForDrawerCommands ();
+		spanfunc ();
+		return;
+	}
+	R_QueueDrawerCommand (FSpanCommand(drawer));
+}
+
+//==========================================================================
+//
+// renderbench
+//
+// Renders the current view offscreen a number of times with one drawing
+// thread and then with r_drawthreads, and checks that both give the same
+// picture.
+//
+//==========================================================================
+
+static double R_BenchRender (DCanvas *canvas, int frames, BYTE digest[16])
+{
+	cycle_t time;
+
+	time.Reset();
+	time.Clock();
+	for (int i = 0; i < frames; i++)
+	{
+		R_RenderViewToCanvas (players[consoleplayer].camera, canvas, 0, 0, canvas->GetWidth(), canvas->GetHeight());
+	}
+	time.Unclock();
+
+	MD5Context md5;
+	for (int y = 0; y < canvas->GetHeight(); y++)
+	{
+		md5.Update (canvas->GetBuffer() + y * canvas->GetPitch(), canvas->GetWidth());
+	}
+	md5.Final (digest);
+
+	return time.TimeMS() / frames;
+}
+
+CCMD (renderbench)
+{
+	if (gamestate != GS_LEVEL || players[consoleplayer].camera == NULL)
+	{
+		Printf ("You must be in a level to use this command.\n");
+		return;
+	}
+	if (currentrenderer != 0)
+	{
+		Printf ("This command needs the software renderer.\n");
+		return;
+	}
+
+	int frames = argv.argc() > 1 ? atoi(argv[1]) : 100;
+	int width = argv.argc() > 2 ? atoi(argv[2]) : SCREENWIDTH;
+	int height = argv.argc() > 3 ? atoi(argv[3]) : SCREENHEIGHT;
+
+	frames = MAX (frames, 1);
+	width = clamp (width, 320, MAXWIDTH);
+	height = clamp (height, 200, MAXHEIGHT);
+
+	DCanvas *pic = new DSimpleCanvas (width, height);
+	BYTE single[16], threaded[16];
+	int threads = r_drawthreads;
+
+	pic->ObjectFlags |= OF_Fixed;
+	pic->Lock ();
+
+	r_drawthreads = 1;
+	double singletime = R_BenchRender (pic, frames, single);
+	r_drawthreads = threads;
+	double threadedtime = R_BenchRender (pic, frames, threaded);
+
+	pic->Unlock ();
+	pic->Destroy();
+	pic->ObjectFlags |= OF_YesReallyDelete;
+	delete pic;
+
+	Printf ("%d frames at %dx%d: 1 thread %.2f ms, %d threads %.2f ms (%.2fx)\n", frames, width, height,
+		singletime, NumCores, threadedtime, threadedtime > 0 ? singletime / threadedtime : 0.);
+	Printf ("%s\n", memcmp (single, threaded, 16) == 0 ? "The pictures are identical." : "The pictures differ!");
+}
@@ -0,0 +1,45 @@
+#ifndef __R_THREAD__
+#define __R_THREAD__
+
+#include <new>
+
+// Drawer command queue
+//
+// While the queue is open, the columns and spans of the opaque pass (walls,
+// skies and flats) are recorded instead of drawn. R_WaitForDrawerCommands
+// then has r_drawthreads threads draw them, each one every Nth row of the
+// view, in the order they were recorded. Every pixel is written by the same
+// code from the same inputs in the same order as without the queue, so the
+// result is identical.
+//
+// Anything that draws to the screen directly while the queue is open has
+// to call R_WaitForDrawerCommands first.
+
+class FDrawerCommand
+{
+public:
+	// Draws the rows y of the command for which y % numcores == core.
+	virtual void Execute (int core, int numcores) = 0;
+};
+
+extern bool DrawersQueued;
+
+void R_BeginDrawerCommands ();
+void R_WaitForDrawerCommands ();
+void R_EndDrawerCommands ();
+
+// Returns memory that stays valid until the commands recorded so far have
+// been drawn.
+void *R_AllocDrawerMemory (size_t size);
+void R_AddDrawerCommand (FDrawerCommand *command);
+
+template<class T> inline void R_QueueDrawerCommand (const T &command)
+{
+	R_AddDrawerCommand (new (R_AllocDrawerMemory (sizeof(T))) T(command));
+}
+
+// Recording versions of the wall and span drawers
+void R_SetupQueuedVLine (int fracbits);
+void R_QueueSpan (void (*spanfunc)(void));
+
+#endif
@@ -356,12 +356,17 @@ void SERVERCOMMANDS_MovePlayer( ULONG ulPlayer, ULONG ulPlayerExtra, ServerComma
 	ServerCommands::MovePlayer stubCommand = fullCommand;
 	stubCommand.SetFlags( ulPlayerFlags );
 
+	// [BB] Encode both variants only once and share them between the clients,
+	// rather than rebuilding the command per client.
+	NetCommand fullNetCommand = fullCommand.BuildNetCommand( );
+	NetCommand stubNetCommand = stubCommand.BuildNetCommand( );
+
 	for ( ClientIterator it ( ulPlayerExtra, flags ); it.notAtEnd(); ++it )
 	{
 		if ( SERVER_IsPlayerVisible( *it, ulPlayer ))
-			fullCommand.sendCommandToClients( *it, SVCF_ONLYTHISCLIENT );
+			fullNetCommand.sendCommandToOneClient( *it );
 		else
-			stubCommand.sendCommandToClients( *it, SVCF_ONLYTHISCLIENT );
+			stubNetCommand.sendCommandToOneClient( *it );
 	}
 }
 
@@ -400,6 +405,7 @@ void SERVERCOMMANDS_DamagePlayer( ULONG ulPlayer )
 	fullCommand.SetHealth( players[ulPlayer].health );
 	fullCommand.SetArmor( ulArmorPoints );
 	fullCommand.SetAttacker( players[ulPlayer].attacker );
+	NetCommand fullNetCommand = fullCommand.BuildNetCommand( );
 
 	for ( ClientIterator it; it.notAtEnd(); ++it )
 	{
@@ -412,7 +418,7 @@ void SERVERCOMMANDS_DamagePlayer( ULONG ulPlayer )
 			if (( bSendDamageType ) && ( SERVER_GetClient( *it )->ulDisplayPlayer == ulPlayer ))
 				SERVERCOMMANDS_DamagePlayerWithType( ulPlayer, ulArmorPoints, *it );
 			else
-				fullCommand.sendCommandToClients( *it, SVCF_ONLYTHISCLIENT );
+				fullNetCommand.sendCommandToOneClient( *it );
 		}
 	}
 }
@@ -479,11 +485,12 @@ void SERVERCOMMANDS_SetPlayerHealth( ULONG ulPlayer, ULONG ulPlayerExtra, Server
 	ServerCommands::SetPlayerHealth command;
 	command.SetPlayer( &players[ulPlayer] );
 	command.SetHealth( players[ulPlayer].health );
+	NetCommand netCommand = command.BuildNetCommand( );
 
 	for ( ClientIterator it ( ulPlayerExtra, flags ); it.notAtEnd(); ++it )
 	{
 		if ( SERVER_IsPlayerAllowedToKnowHealth( *it, ulPlayer ))
-			command.sendCommandToClients( *it, SVCF_ONLYTHISCLIENT );
+			netCommand.sendCommandToOneClient( *it );
 	}
 }
 
@@ -503,11 +510,12 @@ void SERVERCOMMANDS_SetPlayerArmor( ULONG ulPlayer, ULONG ulPlayerExtra, ServerC
 	command.SetPlayer( &players[ulPlayer] );
 	command.SetArmorAmount( pArmor->Amount );
 	command.SetArmorIcon( pArmor->Icon.isValid() ? TexMan( pArmor->Icon )->Name : "" );
+	NetCommand netCommand = command.BuildNetCommand( );
 
 	for ( ClientIterator it ( ulPlayerExtra, flags ); it.notAtEnd(); ++it )
 	{
 		if ( SERVER_IsPlayerAllowedToKnowHealth( *it, ulPlayer ))
-			command.sendCommandToClients( *it, SVCF_ONLYTHISCLIENT );
+			netCommand.sendCommandToOneClient( *it );
 	}
 }
 
@@ -1222,6 +1230,7 @@ void SERVERCOMMANDS_PlayerSay( ULONG ulPlayer, const char *pszString, ULONG ulMo
 	command.SetPlayerNumber( ulPlayer );
 	command.SetMode( ulMode );
 	command.SetMessage( pszString );
+	NetCommand netCommand = command.BuildNetCommand( );
 
 	for ( ClientIterator it ( ulPlayerExtra, flags ); it.notAtEnd(); ++it )
 	{
@@ -1237,7 +1246,7 @@ void SERVERCOMMANDS_PlayerSay( ULONG ulPlayer, const char *pszString, ULONG ulMo
 				continue;
 		}
 
-		command.sendCommandToClients( *it, SVCF_ONLYTHISCLIENT );
+		netCommand.sendCommandToOneClient( *it );
 	}
 }
 
@@ -1318,6 +1327,7 @@ void SERVERCOMMANDS_PlayerVoIPAudioPacket( ULONG player, unsigned int frame, uns
 	command.SetPlayerNumber( player );
 	command.SetFrame( frame );
 	command.SetAudio( audio );
+	NetCommand netCommand = command.BuildNetCommand( );
 
 	for ( ClientIterator it( playerExtra, flags ); it.notAtEnd( ); ++it )
 	{
@@ -1355,7 +1365,7 @@ void SERVERCOMMANDS_PlayerVoIPAudioPacket( ULONG player, unsigned int frame, uns
 		if ( SERVER_GetPlayerIgnoreTic( *it, SERVER_GetClient( player )->Address, true ) != 0 )
 			continue;
 
-		command.sendCommandToClients( *it, SVCF_ONLYTHISCLIENT );
+		netCommand.sendCommandToOneClient( *it );
 	}
 }
 
@@ -1579,6 +1589,132 @@ void SERVERCOMMANDS_LevelSpawnThingNoNetID( AActor *pActor, ULONG ulPlayerExtra,
 	command.sendCommandToClients( ulPlayerExtra, flags );
 }
 
+//*****************************************************************************
+//
+static void servercommands_WriteSnapshotShort( TArray<BYTE> &Snapshot, int value )
+{
+	Snapshot.Push( static_cast<BYTE>( value & 0xFF ));
+	Snapshot.Push( static_cast<BYTE>(( value >> 8 ) & 0xFF ));
+}
+
+//*****************************************************************************
+//
+static void servercommands_WriteSnapshotLong( TArray<BYTE> &Snapshot, int value )
+{
+	servercommands_WriteSnapshotShort( Snapshot, value & 0xFFFF );
+	servercommands_WriteSnapshotShort( Snapshot, ( value >> 16 ) & 0xFFFF );
+}
+
+//*****************************************************************************
+//
+// Same encoding as BYTESTREAM_s::WriteNetID.
+//
+static void servercommands_WriteSnapshotNetID( TArray<BYTE> &Snapshot, unsigned int netID )
+{
+	if ( netID < 0x8000 )
+	{
+		servercommands_WriteSnapshotShort( Snapshot, netID );
+		return;
+	}
+
+	servercommands_WriteSnapshotShort( Snapshot, ( netID & 0x7FFF ) | 0x8000 );
+	servercommands_WriteSnapshotShort( Snapshot, netID >> 15 );
+}
+
+//*****************************************************************************
+//
+static void servercommands_FlushSnapshot( TArray<BYTE> &Snapshot, ULONG ulPlayerExtra, ServerCommandFlags flags )
+{
+	if ( Snapshot.Size( ) == 0 )
+		return;
+
+	BufferParameter buffer( &Snapshot[0], Snapshot.Size( ));
+	ServerCommands::LevelSpawnThingsSnapshot command;
+	command.SetSnapshot( buffer );
+	command.sendCommandToClients( ulPlayerExtra, flags );
+	Snapshot.Clear( );
+}
+
+//*****************************************************************************
+//
+// Spawns all the given level things with as few bytes as possible. Each entry only
+// contains what's needed to spawn the thing plus the CM_* fields whose values
+// differ from what the client has right after spawning it (the last position is
+// the spawn position, no velocity, pitch, movedir or angle). The client is told
+// everything else about these things by the regular commands afterwards.
+//
+void SERVERCOMMANDS_LevelSpawnThingsSnapshot( const TArray<AActor *> &Actors, ULONG ulPlayerExtra, ServerCommandFlags flags )
+{
+	TArray<BYTE>	Snapshot;
+	// Keep enough room for the packet and command headers, and the largest entry.
+	const unsigned int	ulMaxSnapshotSize = MAX<ULONG>( SERVER_GetMaxPacketSize( ), 128 ) - 64;
+
+	for ( unsigned int i = 0; i < Actors.Size( ); i++ )
+	{
+		AActor *pActor = Actors[i];
+
+		if (( pActor == NULL ) || ( pActor->NetID == 0 ))
+			continue;
+
+		// The client only gets the integral part of the position, and uses it
+		// as the thing's last position when spawning it.
+		const fixed_t spawnX = ( pActor->x >> FRACBITS ) << FRACBITS;
+		const fixed_t spawnY = ( pActor->y >> FRACBITS ) << FRACBITS;
+		const fixed_t spawnZ = ( pActor->z >> FRACBITS ) << FRACBITS;
+		ULONG ulBits = 0;
+
+		if ( pActor->lastX != spawnX )
+			ulBits |= CM_LAST_X;
+		if ( pActor->lastY != spawnY )
+			ulBits |= CM_LAST_Y;
+		if ( pActor->lastZ != spawnZ )
+			ulBits |= CM_LAST_Z;
+		if (( pActor->angle >> FRACBITS ) != 0 )
+			ulBits |= CM_ANGLE;
+		if ( pActor->velx != 0 )
+			ulBits |= CM_VELX;
+		if ( pActor->vely != 0 )
+			ulBits |= CM_VELY;
+		if ( pActor->velz != 0 )
+			ulBits |= CM_VELZ;
+		if ( pActor->pitch != 0 )
+			ulBits |= CM_PITCH;
+		if ( pActor->movedir != 0 )
+			ulBits |= CM_MOVEDIR;
+
+		servercommands_WriteSnapshotNetID( Snapshot, pActor->NetID );
+		servercommands_WriteSnapshotShort( Snapshot, pActor->GetClass( )->getActorNetworkIndex( ));
+		servercommands_WriteSnapshotShort( Snapshot, pActor->x >> FRACBITS );
+		servercommands_WriteSnapshotShort( Snapshot, pActor->y >> FRACBITS );
+		servercommands_WriteSnapshotShort( Snapshot, pActor->z >> FRACBITS );
+		servercommands_WriteSnapshotShort( Snapshot, ulBits );
+
+		if ( ulBits & CM_LAST_X )
+			servercommands_WriteSnapshotLong( Snapshot, pActor->lastX );
+		if ( ulBits & CM_LAST_Y )
+			servercommands_WriteSnapshotLong( Snapshot, pActor->lastY );
+		if ( ulBits & CM_LAST_Z )
+			servercommands_WriteSnapshotLong( Snapshot, pActor->lastZ );
+		if ( ulBits & CM_ANGLE )
+			servercommands_WriteSnapshotShort( Snapshot, pActor->angle >> FRACBITS );
+		if ( ulBits & CM_VELX )
+			servercommands_WriteSnapshotLong( Snapshot, pActor->velx );
+		if ( ulBits & CM_VELY )
+			servercommands_WriteSnapshotLong( Snapshot, pActor->vely );
+		if ( ulBits & CM_VELZ )
+			servercommands_WriteSnapshotLong( Snapshot, pActor->velz );
+		if ( ulBits & CM_PITCH )
+			servercommands_WriteSnapshotLong( Snapshot, pActor->pitch );
+		if ( ulBits & CM_MOVEDIR )
+			Snapshot.Push( static_cast<BYTE>( pActor->movedir ));
+
+		if ( Snapshot.Size( ) >= ulMaxSnapshotSize )
+			servercommands_FlushSnapshot( Snapshot, ulPlayerExtra, flags );
+	}
+
+	servercommands_FlushSnapshot( Snapshot, ulPlayerExtra, flags );
+}
+
 /*
  * [TP] Compares actor position data to a previous state and calls SERVERCOMMANDS_MoveThing to send appropriate updates.
  */
@@ -2003,7 +2139,7 @@ void SERVERCOMMANDS_SetThingSpecial( AActor *pActor, ULONG ulPlayerExtra, Server
 		return;
 
 	NetCommand command( SVC2_SETTHINGSPECIAL );
-	command.addShort( pActor->NetID );
+	command.addNetID( pActor->NetID );
 	command.addShort( pActor->special );
 	command.sendCommandToClients( ulPlayerExtra, flags );
 }
@@ -4195,7 +4331,7 @@ void SERVERCOMMANDS_SetFastChaseStrafeCount( AActor *mobj, ULONG ulPlayerExtra,
 		return;
 
 	NetCommand command( SVC2_SETFASTCHASESTRAFECOUNT );
-	command.addShort( mobj->NetID );
+	command.addNetID( mobj->NetID );
 	command.addByte( mobj->FastChaseStrafeCount );
 	command.sendCommandToClients( ulPlayerExtra, flags );
 }
@@ -4213,7 +4349,7 @@ void SERVERCOMMANDS_SetThingHealth( AActor* mobj, ULONG ulPlayerExtra, ServerCom
 		return;
 
 	NetCommand command( SVC2_SETTHINGHEALTH );
-	command.addShort( mobj->NetID );
+	command.addNetID( mobj->NetID );
 	command.addByte( mobj->health );
 	command.sendCommandToClients( ulPlayerExtra, flags );
 }
@@ -4229,7 +4365,7 @@ void SERVERCOMMANDS_SetThingScale( AActor* mobj, unsigned int scaleFlags, ULONG
 		return;
 
 	NetCommand command( SVC2_SETTHINGSCALE );
-	command.addShort( mobj->NetID );
+	command.addNetID( mobj->NetID );
 	command.addByte( scaleFlags );
 	if ( scaleFlags & ACTORSCALE_X )
 		command.addLong( mobj->scaleX );
@@ -4264,7 +4400,7 @@ void SERVERCOMMANDS_FlashStealthMonster( AActor* pActor, SBYTE direction, ULONG
 		return;
 
 	NetCommand command ( SVC2_FLASHSTEALTHMONSTER );
-	command.addShort( pActor->NetID );
+	command.addNetID( pActor->NetID );
 	command.addByte( direction );
 	command.sendCommandToClients();
 }
@@ -4277,7 +4413,7 @@ void SERVERCOMMANDS_StopAllSoundsOnThing( AActor *pActor, ULONG ulPlayerExtra, S
 		return;
 
 	NetCommand command ( SVC2_STOPALLSOUNDSONTHING );
-	command.addShort( pActor->NetID );
+	command.addNetID( pActor->NetID );
 	command.sendCommandToClients();
 }
 
@@ -4338,7 +4474,7 @@ void SERVERCOMMANDS_PlayBounceSound( const AActor *pActor, const bool bOnfloor,
 		return;
 
 	NetCommand command ( SVC2_PLAYBOUNCESOUND );
-	command.addShort ( pActor->NetID );
+	command.addNetID ( pActor->NetID );
 	command.addByte ( bOnfloor );
 	command.sendCommandToClients ( ulPlayerExtra, flags );
 }
@@ -4907,7 +5043,7 @@ void SERVERCOMMANDS_Earthquake( AActor *pCenter, LONG lIntensity, LONG lDuration
 	const char *pszQuakeSound = S_GetName( Quakesound );
 
 	NetCommand command ( SVC_EARTHQUAKE );
-	command.addShort ( pCenter->NetID );
+	command.addNetID ( pCenter->NetID );
 	command.addByte ( lIntensity );
 	command.addShort ( lDuration );
 	command.addShort ( lTemorRadius );
@@ -5040,7 +5176,7 @@ void SERVERCOMMANDS_SetCameraToTexture( AActor *pCamera, char *pszTexture, LONG
 	}
 
 	NetCommand command ( SVC_SETCAMERATOTEXTURE );
-	command.addShort ( pCamera->NetID );
+	command.addNetID ( pCamera->NetID );
 	command.addString ( pszTexture );
 	command.addByte ( lFOV );
 	command.sendCommandToClients ( ulPlayerExtra, flags );
@@ -5133,14 +5269,14 @@ void SERVERCOMMANDS_SetSectorLink( ULONG ulSector, int iArg1, int iArg2, int iAr
 void SERVERCOMMANDS_DoPusher( ULONG ulType, line_t *pLine, int iMagnitude, int iAngle, AActor *pSource, int iAffectee, ULONG ulPlayerExtra, ServerCommandFlags flags )
 {
 	const int iLineNum = pLine ? static_cast<ULONG>( pLine - lines ) : -1;
-	const unsigned short sourceNetID = pSource ? pSource->NetID : 0;
+	const unsigned int sourceNetID = pSource ? pSource->NetID : 0;
 
 	NetCommand command ( SVC_DOPUSHER );
 	command.addByte ( ulType );
 	command.addShort ( iLineNum );
 	command.addLong ( iMagnitude );
 	command.addLong ( iAngle );
-	command.addShort ( sourceNetID );
+	command.addNetID ( sourceNetID );
 	command.addShort ( iAffectee );
 	command.sendCommandToClients ( ulPlayerExtra, flags );
 }
@@ -5229,7 +5365,7 @@ void SERVERCOMMANDS_SyncCVarToAdmins( const FBaseCVar &CVar )
 void SERVERCOMMANDS_SetDefaultSkybox( ULONG ulPlayerExtra, ServerCommandFlags flags )
 {
 	NetCommand command( SVC2_SETDEFAULTSKYBOX );
-	command.addShort( ( level.DefaultSkybox != NULL ) ? level.DefaultSkybox->NetID : 0 );
+	command.addNetID( ( level.DefaultSkybox != NULL ) ? level.DefaultSkybox->NetID : 0 );
 	command.sendCommandToClients( ulPlayerExtra, flags );
 }
 //*****************************************************************************
@@ -5284,7 +5420,7 @@ void SERVERCOMMANDS_ShootDecal ( const FDecalTemplate* tpl, AActor* actor, fixed
 
 	NetCommand command ( SVC2_SHOOTDECAL );
 	command.addName( tpl->GetName() );
-	command.addShort( actor->NetID );
+	command.addNetID( actor->NetID );
 	command.addShort( z >> FRACBITS );
 	command.addShort( angle >> FRACBITS );
 	command.addLong( tracedist );
@@ -5492,9 +5628,9 @@ void APathFollower::SyncWithClient ( const ULONG ulClient )
 		return;
 
 	NetCommand command( SVC2_SYNCPATHFOLLOWER );
-	command.addShort( this->NetID );
-	command.addShort( this->CurrNode ? this->CurrNode->NetID : 0 );
-	command.addShort( this->PrevNode ? this->PrevNode->NetID : 0 );
+	command.addNetID( this->NetID );
+	command.addNetID( this->CurrNode ? this->CurrNode->NetID : 0 );
+	command.addNetID( this->PrevNode ? this->PrevNode->NetID : 0 );
 	command.addFloat( this->Time );
 	command.sendCommandToOneClient( ulClient );
 }
@@ -106,6 +106,7 @@
 #include "lastmanstanding.h"
 #include "survival.h"
 #include "sv_commands.h"
+#include "sv_profiler.h"
 #include "sv_save.h"
 #include "sv_rcon.h"
 #include "gamemode.h"
@@ -122,6 +123,7 @@
 #include "p_conversation.h"
 #include "p_enemy.h"
 #include "network/packetarchive.h"
+#include "network/netcommand.h"
 #include "p_lnspec.h"
 #include "unlagged.h"
 #include "scoreboard.h"
@@ -180,6 +182,9 @@ static	bool	server_ShouldPerformBacktrace( ULONG ulClient );
 static	void	server_FixZFromBacktrace( APlayerPawn *pmo, fixed_t oldFloorZ );
 static	void	server_ForceRenamePlayer( ULONG playerIndex ); // [SB]
 
+static	void	server_AddClientToAddressTable( ULONG ulClient );
+static	void	server_RemoveClientFromAddressTable( ULONG ulClient );
+
 // [RC]
 #ifdef CREATE_PACKET_LOG
 static  void	server_LogPacket( BYTESTREAM_s *pByteStream, NETADDRESS_s Address, const char *pszReason );
@@ -191,9 +196,23 @@ static  void	server_LogPacket( BYTESTREAM_s *pByteStream, NETADDRESS_s Address,
 // Global array of clients.
 static	CLIENT_s		g_aClients[MAXPLAYERS];
 
+// Open-addressed hash table mapping client addresses (including the port) to
+// their slot in g_aClients. Every inbound packet is looked up here, so this
+// avoids comparing the address against all MAXPLAYERS slots. Buckets store the
+// client index plus one, so that zero marks an empty bucket.
+enum
+{
+	CLIENT_ADDRESS_TABLE_SIZE = 4 * MAXPLAYERS,
+};
+
+static	BYTE			g_abClientAddressTable[CLIENT_ADDRESS_TABLE_SIZE];
+
 // The last client we received a packet from.
 static	LONG			g_lCurrentClient;
 
+// The client that is being sent a full update, if any.
+static	LONG			g_lFullUpdateClient = -1;
+
 // Number of ticks that have passed since start of... level?
 static	unsigned int	g_GameTime = 0;
 
@@ -232,6 +251,25 @@ static	QWORD		g_qwTotalInboundDataTransferred = 0;
 static	LONG		g_lMaxInboundDataTransfer = 0;
 static	LONG		g_lCurrentInboundDataTransfer = 0;
 static	LONG		g_lInboundDataTransferLastSecond = 0;
+static	QWORD		g_qwTotalReceiveCalls = 0;
+static	QWORD		g_qwEmptyReceiveCalls = 0;
+static	QWORD		g_qwTotalPacketsReceived = 0;
+static	QWORD		g_qwTotalSendCalls = 0;
+static	QWORD		g_qwTotalPacketsSent = 0;
+static	QWORD		g_qwClientAddressLookups = 0;
+static	QWORD		g_qwClientAddressLookupHits = 0;
+static	QWORD		g_qwNumTicStarts = 0;
+static	QWORD		g_qwMovePlayerUpdatesSent = 0;
+static	QWORD		g_qwMovePlayerUpdatesSkipped = 0;
+static	QWORD		g_qwMovePlayerBytesSent = 0;
+static	QWORD		g_qwNumFullUpdates = 0;
+static	QWORD		g_qwFullUpdateBytesSent = 0;
+static	QWORD		g_qwFullUpdatePacketsSent = 0;
+static	QWORD		g_qwFullUpdateSnapshotActors = 0;
+static	double		g_dTotalTicStartJitter = 0.0;
+static	double		g_dMaxTicStartJitter = 0.0;
+static	double		g_dCurrentIdleTime = 0.0;
+static	float		g_fIdlePercentageLastSecond = 0.0f;
 
 // This is the current font the "screen" is using when it displays messages.
 static	char		g_szCurrentFont[16];
@@ -294,6 +332,16 @@ CVAR( Int, sv_showcommands, 0, CVAR_ARCHIVE|CVAR_DEBUGONLY )
 CVAR( Int, sv_smoothplayers_debuginfo, 0, CVAR_ARCHIVE|CVAR_DEBUGONLY ) // [AK]
 CVAR( Bool, sv_noplayertimeout, false, CVAR_NOSETBYACS|CVAR_DEBUGONLY ) // [SB]
 
+// If greater than one, players that a client can't possibly see (according to the
+// reject table) are only sent to that client on every sv_hiddenplayerupdaterate-th
+// update, unless they're closer than sv_hiddenplayerdistance map units.
+CVAR( Int, sv_hiddenplayerupdaterate, 0, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+CVAR( Int, sv_hiddenplayerdistance, 1024, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
+// Spawn the level things that haven't moved yet with LevelSpawnThingsSnapshot during
+// full updates, instead of sending several commands for each of them.
+CVAR( Bool, sv_fullupdatesnapshots, true, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
 //*****************************************************************************
 // [AK] Smooths the movement of lagging players using extrapolation and correction.
 CUSTOM_CVAR( Int, sv_smoothplayers, 0, CVAR_ARCHIVE|CVAR_NOSETBYACS|CVAR_SERVERINFO|CVAR_DEBUGONLY )
@@ -543,6 +591,8 @@ void SERVER_Construct( void )
 		g_aClients[ulIdx].State = CLS_FREE;
 	}
 
+	memset( g_abClientAddressTable, 0, sizeof( g_abClientAddressTable ));
+
 	// If they used "-host <#>", make <#> the max number of players.
 	pszMaxClients = Args->CheckValue( "-host" );
 	if ( pszMaxClients )
@@ -615,6 +665,9 @@ void SERVER_Destruct( void )
 {
 	ULONG	ulIdx;
 
+	// Don't leave anything in the outbound queue, in case we're shutting down mid-tic.
+	NETWORK_EndOutboundBatch( );
+
 	// Free the clients' buffers.
 	for ( ulIdx = 0; ulIdx < MAXPLAYERS; ulIdx++ )
 	{
@@ -622,14 +675,24 @@ void SERVER_Destruct( void )
 		if ( SERVER_IsValidClient( ulIdx ))
 		{
 			SERVER_KickPlayer( ulIdx, "Server is shutting down" );
-			NETWORK_LaunchPacket( &SERVER_GetClient( ulIdx )->PacketBuffer, SERVER_GetClient( ulIdx )->Address );
+
+			NETBUFFER_s	TempBuffer;
+			TempBuffer.Init( MAX_UDP_PACKET, BUFFERTYPE_WRITE );
+			g_aClients[ulIdx].SharedCommands.WritePacketTo( g_aClients[ulIdx].PacketBuffer, TempBuffer.ByteStream );
+			NETWORK_LaunchPacket( &TempBuffer, g_aClients[ulIdx].Address );
+			TempBuffer.Free();
 		}
 
+		SERVER_ClearClientBuffer( ulIdx, true );
+		SERVER_ClearClientBuffer( ulIdx, false );
 		g_aClients[ulIdx].PacketBuffer.Free();
 		g_aClients[ulIdx].UnreliablePacketBuffer.Free();
 		g_aClients[ulIdx].SavedPackets.Free();
 	}
 
+	// Free the recycled NetCommand buffers.
+	NetCommand::freeBufferPool( );
+
 #ifdef CREATE_PACKET_LOG
 	if ( PacketLogFile )
 		fclose( PacketLogFile );
@@ -693,6 +756,28 @@ unsigned int server_GetDeltaTicks( unsigned int &nowTime, const unsigned int pre
 	return newTics - previousTics;
 }
 
+//*****************************************************************************
+//
+// Returns the I_MSTime at which the tic after previousTics starts.
+static double server_GetNextTicTime( const unsigned int previousTics )
+{
+	return ( ceil(( previousTics + 1 - g_GameTicShift ) * MS_PER_TIC ));
+}
+
+//*****************************************************************************
+//
+// Returns how many milliseconds are left until I_MSTime reaches the start of
+// the tic after previousTics.
+static double server_GetMSUntilNextTic( const unsigned int nowTime, const unsigned int previousTics )
+{
+	// [AK] The timer just overflowed, see server_GetDeltaTicks. Just check
+	// again in a millisecond until this has been sorted out.
+	if ( nowTime < g_GameTime )
+		return ( 1.0 );
+
+	return ( MAX( server_GetNextTicTime( previousTics ) - nowTime, 1.0 ));
+}
+
 //*****************************************************************************
 //
 void SERVER_Tick( void )
@@ -704,16 +789,36 @@ void SERVER_Tick( void )
 	const unsigned int previousTics = static_cast<unsigned>( g_GameTicShift + g_GameTime / MS_PER_TIC );
 	unsigned int deltaTics = server_GetDeltaTicks( nowTime, previousTics );
 
+	bool bWaited = false;
+
 	while ( deltaTics == 0 )
 	{
 		// [BB] Recieve packets whenever possible (not only once each tic) to allow
 		// for an accurate ping measurement.
 		SERVER_GetPackets( );
 
-		I_Sleep( 1 );
+		// Sleep until the next packet arrives or the next tic is due, whichever
+		// comes first. Handling the packets takes time, so check the clock again
+		// before deciding how long that is.
+		nowTime = I_MSTime( );
+		g_dCurrentIdleTime += I_WaitForEvents( server_GetMSUntilNextTic( nowTime, previousTics ));
+		bWaited = true;
+
 		deltaTics = server_GetDeltaTicks( nowTime, previousTics );
 	}
 
+	// Keep track of how late we woke up for this tic, measured against the
+	// time the tic was actually due. nowTime is when we noticed that it's due.
+	if ( bWaited && ( nowTime >= g_GameTime ))
+	{
+		const double jitter = MAX( nowTime - server_GetNextTicTime( previousTics ), 0.0 );
+
+		g_qwNumTicStarts++;
+		g_dTotalTicStartJitter += jitter;
+		if ( jitter > g_dMaxTicStartJitter )
+			g_dMaxTicStartJitter = jitter;
+	}
+
 #ifdef NO_SERVER_GUI
 	// console input
 	char *cmd = I_ConsoleInput();
@@ -732,8 +837,12 @@ void SERVER_Tick( void )
 	{
 		//DObject::BeginFrame ();
 
+		SERVER_PROFILER_BeginTic( );
+
 		// Recieve packets.
+		SERVER_PROFILER_BeginPhase( TICPHASE_GETPACKETS );
 		SERVER_GetPackets( );
+		SERVER_PROFILER_EndPhase( TICPHASE_GETPACKETS );
 
 		// [AK] After receiving packets, check if we didn't receive a movement
 		// command from an in-game players during this gametic. If that's the
@@ -756,9 +865,13 @@ void SERVER_Tick( void )
 
 		// We have to record player positions before their mobj moves.
 		// [BB] Tick the unlagged module.
+		SERVER_PROFILER_BeginPhase( TICPHASE_UNLAGGED );
 		UNLAGGED_Tick( );
+		SERVER_PROFILER_EndPhase( TICPHASE_UNLAGGED );
 
+		SERVER_PROFILER_BeginPhase( TICPHASE_TICKER );
 		G_Ticker ();
+		SERVER_PROFILER_EndPhase( TICPHASE_TICKER );
 
 		// However we need to spawn the unlagged debug actors here i.e. after having processed their
 		// movement commands which updated their last server gametic.
@@ -800,10 +913,18 @@ void SERVER_Tick( void )
 		}
 
 		// Drop anyone who's been disconnected.
+		SERVER_PROFILER_BeginPhase( TICPHASE_CHECKTIMEOUTS );
 		SERVER_CheckTimeouts( );
+		SERVER_PROFILER_EndPhase( TICPHASE_CHECKTIMEOUTS );
 
 		// Send out player's true position, etc.
+		SERVER_PROFILER_BeginPhase( TICPHASE_WRITECOMMANDS );
 		SERVER_WriteCommands( );
+		SERVER_PROFILER_EndPhase( TICPHASE_WRITECOMMANDS );
+
+		// Collect every client's packets of this tic and send them all at once.
+		SERVER_PROFILER_BeginPhase( TICPHASE_SENDPACKETS );
+		NETWORK_BeginOutboundBatch( );
 
 		// Check everyone's PacketBuffer for anything that needs to be sent.
 		SERVER_SendOutPackets( );
@@ -817,17 +938,28 @@ void SERVER_Tick( void )
 			SERVER_GetClient ( i )->SavedPackets.Tick ( );
 		}
 
+		NETWORK_EndOutboundBatch( );
+		SERVER_PROFILER_EndPhase( TICPHASE_SENDPACKETS );
+
 		// Potentially send an update to the master server.
+		SERVER_PROFILER_BeginPhase( TICPHASE_MASTER );
 		SERVER_MASTER_Tick( );
+		SERVER_PROFILER_EndPhase( TICPHASE_MASTER );
 
 		// Time out any old RCON sessions.
+		SERVER_PROFILER_BeginPhase( TICPHASE_RCON );
 		SERVER_RCON_Tick( );
+		SERVER_PROFILER_EndPhase( TICPHASE_RCON );
 
 		// Broadcast the server signal so it can be detected on a LAN.
+		SERVER_PROFILER_BeginPhase( TICPHASE_MASTER );
 		SERVER_MASTER_Broadcast( );
+		SERVER_PROFILER_EndPhase( TICPHASE_MASTER );
 
 		// Potentially re-parse the banfile.
+		SERVER_PROFILER_BeginPhase( TICPHASE_BANS );
 		SERVERBAN_Tick( );
+		SERVER_PROFILER_EndPhase( TICPHASE_BANS );
 
 		// Print stats and get out.
 		FStat::PrintStat( );
@@ -880,10 +1012,16 @@ void SERVER_Tick( void )
 			g_lInboundDataTransferLastSecond = g_lCurrentInboundDataTransfer;
 			g_lCurrentInboundDataTransfer = 0;
 
+			// Update how much of the last second was spent waiting.
+			g_fIdlePercentageLastSecond = static_cast<float>( MIN( g_dCurrentIdleTime / 10.0, 100.0 ));
+			g_dCurrentIdleTime = 0.0;
+
 			// Update the form.
 			SERVERCONSOLE_UpdateStatistics( );
 		}
 
+		SERVER_PROFILER_EndTic( );
+
 		//DObject::EndFrame ();
 	}
 /*
@@ -935,10 +1073,10 @@ void SERVER_SendOutPackets( void )
 		if ( SERVER_IsValidClient( ulIdx ) == false )
 			continue;
 
-		if ( g_aClients[ulIdx].PacketBuffer.CalcSize() > 0 )
+		if ( SERVER_CalcClientPacketSize( ulIdx, true ) > 0 )
 			SERVER_SendClientPacket( ulIdx, true );
 
-		if ( g_aClients[ulIdx].UnreliablePacketBuffer.CalcSize() > 0 )
+		if ( SERVER_CalcClientPacketSize( ulIdx, false ) > 0 )
 			SERVER_SendClientPacket( ulIdx, false );
 	}
 }
@@ -957,8 +1095,11 @@ void SERVER_SendClientPacket( ULONG ulClient, bool bReliable )
 
 	if ( bReliable )
 	{
-		pClient->SavedPackets.ScheduleUnsentPacket( pClient->PacketBuffer );
-		pClient->PacketBuffer.Clear();
+		if ( static_cast<LONG>( ulClient ) == g_lFullUpdateClient )
+			g_qwFullUpdatePacketsSent++;
+
+		pClient->SavedPackets.ScheduleUnsentPacket( pClient->PacketBuffer, &pClient->SharedCommands );
+		SERVER_ClearClientBuffer( ulClient, true );
 		return;
 	}
 
@@ -973,11 +1114,11 @@ void SERVER_SendClientPacket( ULONG ulClient, bool bReliable )
 	TempBuffer.ByteStream.WriteByte( SVC_UNRELIABLEPACKET );
 
 	// Write the body of the message to our temporary buffer.
-	pClient->UnreliablePacketBuffer.WriteTo ( TempBuffer.ByteStream );
+	pClient->UnreliableSharedCommands.WritePacketTo( pClient->UnreliablePacketBuffer, TempBuffer.ByteStream );
 
 	// Finally, send the packet, and clear the buffer.
 	NETWORK_LaunchPacket( &TempBuffer, pClient->Address );
-	pClient->UnreliablePacketBuffer.Clear();
+	SERVER_ClearClientBuffer( ulClient, false );
 }
 
 //*****************************************************************************
@@ -999,7 +1140,7 @@ void SERVER_CheckClientBuffer( ULONG ulClient, ULONG ulSize, bool bReliable )
 	// Make sure we have enough room for the upcoming message. If not, send
 	// out the current buffer and clear the packet.
 	pBuffer->ulCurrentSize = pBuffer->ByteStream.pbStream - pBuffer->pbData;
-	if (( pBuffer->ulCurrentSize + ( ulSize + 5 )) >= SERVER_GetMaxPacketSize( ))
+	if (( SERVER_CalcClientPacketSize( ulClient, bReliable ) + ( ulSize + 5 )) >= SERVER_GetMaxPacketSize( ))
 	{
 		if ( debugfile )
 			fprintf( debugfile, "Launching premature packet: %d\n", bReliable );
@@ -1009,6 +1150,43 @@ void SERVER_CheckClientBuffer( ULONG ulClient, ULONG ulSize, bool bReliable )
 	}
 }
 
+//*****************************************************************************
+//
+// Returns the size of the packet that would be sent to the client right now,
+// including the shared commands that aren't in the client's buffer yet.
+//
+LONG SERVER_CalcClientPacketSize( ULONG ulClient, bool bReliable )
+{
+	CLIENT_s	*pClient = SERVER_GetClient( ulClient );
+	if ( pClient == NULL )
+		return 0;
+
+	if ( bReliable )
+		return pClient->SharedCommands.CalcPacketSize( pClient->PacketBuffer );
+	else
+		return pClient->UnreliableSharedCommands.CalcPacketSize( pClient->UnreliablePacketBuffer );
+}
+
+//*****************************************************************************
+//
+void SERVER_ClearClientBuffer( ULONG ulClient, bool bReliable )
+{
+	CLIENT_s	*pClient = SERVER_GetClient( ulClient );
+	if ( pClient == NULL )
+		return;
+
+	if ( bReliable )
+	{
+		pClient->PacketBuffer.Clear();
+		pClient->SharedCommands.Clear();
+	}
+	else
+	{
+		pClient->UnreliablePacketBuffer.Clear();
+		pClient->UnreliableSharedCommands.Clear();
+	}
+}
+
 //*****************************************************************************
 //
 LONG SERVER_FindFreeClientSlot( void )
@@ -1037,20 +1215,98 @@ LONG SERVER_FindFreeClientSlot( void )
 	return ( -1 );
 }
 
+//*****************************************************************************
+//
+static ULONG server_HashClientAddress( const NETADDRESS_s &Address )
+{
+	// FNV-1a over the IP and port.
+	ULONG ulHash = 2166136261u;
+
+	for ( ULONG ulIdx = 0; ulIdx < 4; ulIdx++ )
+		ulHash = ( ulHash ^ Address.abIP[ulIdx] ) * 16777619u;
+
+	ulHash = ( ulHash ^ ( Address.usPort & 0xFF )) * 16777619u;
+	ulHash = ( ulHash ^ ( Address.usPort >> 8 )) * 16777619u;
+
+	return ( ulHash % CLIENT_ADDRESS_TABLE_SIZE );
+}
+
+//*****************************************************************************
+//
+// Must be called whenever a client slot gets a new address.
+static void server_AddClientToAddressTable( ULONG ulClient )
+{
+	ULONG ulBucket = server_HashClientAddress( g_aClients[ulClient].Address );
+
+	// The table is much bigger than MAXPLAYERS, so there's always a free bucket.
+	while ( g_abClientAddressTable[ulBucket] != 0 )
+	{
+		if ( g_abClientAddressTable[ulBucket] == ulClient + 1 )
+			return;
+
+		ulBucket = ( ulBucket + 1 ) % CLIENT_ADDRESS_TABLE_SIZE;
+	}
+
+	g_abClientAddressTable[ulBucket] = static_cast<BYTE>( ulClient + 1 );
+}
+
+//*****************************************************************************
+//
+// Must be called before a client slot's address is changed or cleared.
+static void server_RemoveClientFromAddressTable( ULONG ulClient )
+{
+	ULONG ulBucket = server_HashClientAddress( g_aClients[ulClient].Address );
+
+	while ( g_abClientAddressTable[ulBucket] != ulClient + 1 )
+	{
+		// The client isn't in the table.
+		if ( g_abClientAddressTable[ulBucket] == 0 )
+			return;
+
+		ulBucket = ( ulBucket + 1 ) % CLIENT_ADDRESS_TABLE_SIZE;
+	}
+
+	// Delete the entry by shifting back any following entries of the same
+	// probe chain, so that lookups never stop early at a hole.
+	ULONG ulHole = ulBucket;
+	g_abClientAddressTable[ulHole] = 0;
+
+	for ( ulBucket = ( ulHole + 1 ) % CLIENT_ADDRESS_TABLE_SIZE; g_abClientAddressTable[ulBucket] != 0; ulBucket = ( ulBucket + 1 ) % CLIENT_ADDRESS_TABLE_SIZE )
+	{
+		const ULONG ulHome = server_HashClientAddress( g_aClients[g_abClientAddressTable[ulBucket] - 1].Address );
+
+		// Only move the entry if its home bucket doesn't lie cyclically in (ulHole, ulBucket].
+		const bool bStaysPut = ( ulHole <= ulBucket )
+			? (( ulHome > ulHole ) && ( ulHome <= ulBucket ))
+			: (( ulHome > ulHole ) || ( ulHome <= ulBucket ));
+
+		if ( bStaysPut == false )
+		{
+			g_abClientAddressTable[ulHole] = g_abClientAddressTable[ulBucket];
+			g_abClientAddressTable[ulBucket] = 0;
+			ulHole = ulBucket;
+		}
+	}
+}
+
 //*****************************************************************************
 //
 LONG SERVER_FindClientByAddress( NETADDRESS_s Address )
 {
-	for ( ULONG ulIdx = 0; ulIdx < MAXPLAYERS; ulIdx++ )
+	g_qwClientAddressLookups++;
+
+	for ( ULONG ulBucket = server_HashClientAddress( Address ); g_abClientAddressTable[ulBucket] != 0; ulBucket = ( ulBucket + 1 ) % CLIENT_ADDRESS_TABLE_SIZE )
 	{
-	   if ( g_aClients[ulIdx].State == CLS_FREE )
-	       continue;
+		const LONG lClient = g_abClientAddressTable[ulBucket] - 1;
 
-	   // If the client's address matches the given IP, return the client's index.
-	   if ( g_aClients[ulIdx].Address.Compare( Address ))
-	       return ( ulIdx );
+		// If the client's address matches the given IP, return the client's index.
+		if (( g_aClients[lClient].State != CLS_FREE ) && ( g_aClients[lClient].Address.Compare( Address )))
+		{
+			g_qwClientAddressLookupHits++;
+			return ( lClient );
+		}
 	}
-	
+
 	return ( -1 );
 }
 
@@ -1357,7 +1613,7 @@ void SERVER_SendChatMessage( ULONG ulPlayer, ULONG ulMode, const char *pszString
 //
 void SERVER_RequestClientToAuthenticate( ULONG ulClient )
 {
-	g_aClients[ulClient].PacketBuffer.Clear();
+	SERVER_ClearClientBuffer( ulClient, true );
 	g_aClients[ulClient].PacketBuffer.ByteStream.WriteByte( SVCC_AUTHENTICATE );
 	g_aClients[ulClient].PacketBuffer.ByteStream.WriteString( level.mapname );
 	// [CK] This lets the client start off with a reasonable gametic. In case
@@ -1390,7 +1646,7 @@ void SERVER_AuthenticateClientLevel( BYTESTREAM_s *pByteStream )
 		g_aClients[g_lCurrentClient].State = CLS_AUTHENTICATED;
 
 	// Tell the client his level was authenticated.
-	g_aClients[g_lCurrentClient].PacketBuffer.Clear();
+	SERVER_ClearClientBuffer( g_lCurrentClient, true );
 	g_aClients[g_lCurrentClient].PacketBuffer.ByteStream.WriteByte( SVCC_MAPLOAD );
 	// [BB] Also tell him the game mode, otherwise the client can't decide whether 3D floors should be spawned or not.
 	g_aClients[g_lCurrentClient].PacketBuffer.ByteStream.WriteByte( GAMEMODE_GetCurrentMode( ) );
@@ -1450,6 +1706,7 @@ void SERVER_ConnectNewPlayer( BYTESTREAM_s *pByteStream )
 
 	// This player is now in the game.
 	playeringame[g_lCurrentClient] = true;
+	SERVER_MASTER_InvalidateLauncherResponses( );
 
 	// [BB] If necessary, spawn a voodoo doll for the player.
 	if ( COOP_PlayersVoodooDollsNeedToBeSpawned ( g_lCurrentClient ) )
@@ -1482,7 +1739,7 @@ void SERVER_ConnectNewPlayer( BYTESTREAM_s *pByteStream )
 	g_aClients[g_lCurrentClient].ulLastCommandTic = gametic;
 
 	// Clear out the client's netbuffer.
-	g_aClients[g_lCurrentClient].PacketBuffer.Clear();
+	SERVER_ClearClientBuffer( g_lCurrentClient, true );
 
 	// Tell the client that we're about to send him a snapshot of the level.
 	SERVERCOMMANDS_BeginSnapshot( g_lCurrentClient );
@@ -1845,6 +2102,7 @@ void SERVER_DetermineConnectionType( BYTESTREAM_s *pByteStream )
 		case CLRC_PONG:
 		case CLRC_DISCONNECT:
 		case CLRC_TABCOMPLETE:
+		case CLRC_TICPROFILE:
 
 			SERVER_RCON_ParseMessage( NETWORK_GetFromAddress( ), lCommand, pByteStream );
 			return;
@@ -2026,15 +2284,17 @@ void SERVER_SetupNewConnection( BYTESTREAM_s *pByteStream, bool bNewPlayer )
 	clientNetworkGameVersion = pByteStream->ReadByte();
 
 	g_aClients[lClient].SavedPackets.Clear();
-	g_aClients[lClient].PacketBuffer.Clear();
-	g_aClients[lClient].UnreliablePacketBuffer.Clear();
+	SERVER_ClearClientBuffer( lClient, true );
+	SERVER_ClearClientBuffer( lClient, false );
 
 	// Who is connecting?
 	Printf( "Connect (v%s): %s\n", clientVersion.GetChars(), NETWORK_GetFromAddress().ToString() );
 
 	// Setup the client.
 	g_aClients[lClient].State = CLS_CHALLENGE;
+	server_RemoveClientFromAddressTable( lClient );
 	g_aClients[lClient].Address = AddressFrom;
+	server_AddClientToAddressTable( lClient );
 
 	{
 		// Make sure the version matches.
@@ -2520,6 +2780,57 @@ void SERVER_ClientError( ULONG ulClient, ULONG ulErrorCode )
 	SERVER_DisconnectClient( ulClient, false, false, LEAVEREASON_ERROR );
 }
 
+//*****************************************************************************
+//
+// Checks if the client needs to be told about this actor during a full update.
+static bool server_ShouldSendActorInFullUpdate( AActor *pActor )
+{
+	// If the actor doesn't have a network ID, don't spawn it (it
+	// probably isn't important).
+	if ( pActor->NetID == 0 )
+		return ( false );
+
+	// [BB] The other clients already have destroyed this actor, so don't spawn it.
+	if ( pActor->NetworkFlags & NETFL_DESTROYED_ON_CLIENT )
+		return ( false );
+
+	// Don't spawn players, items about to be deleted, inventory items
+	// that have an owner, or items that the client spawns himself.
+	if (( pActor->IsKindOf( RUNTIME_CLASS( APlayerPawn ))) ||
+		( pActor->state == RUNTIME_CLASS ( AInventory )->ActorInfo->FindState("HoldAndDestroy") ) ||	// S_HOLDANDDESTROY
+		( pActor->state == RUNTIME_CLASS ( AInventory )->ActorInfo->FindState("Held") ) || // S_HELD
+		( pActor->NetworkFlags & NETFL_ALLOWCLIENTSPAWN ))
+	{
+		return ( false );
+	}
+
+	// [BB] Don't spawn things hidden by AActor::HideOrDestroyIfSafe().
+	// The clients don't need them at all, since the server will tell
+	// them to spawn a new actor during GAME_ResetMap anyway.
+	if ( !( pActor->IsKindOf( RUNTIME_CLASS( AInventory ) ) )
+	     && ( pActor->state == RUNTIME_CLASS ( AInventory )->ActorInfo->FindState("HideIndefinitely") ) // S_HIDEINDEFINITELY 
+	   )
+	{
+		return ( false );
+	}
+
+	return ( true );
+}
+
+//*****************************************************************************
+//
+// Checks if the actor is a level thing that hasn't moved on the X/Y axes yet, and
+// can therefore be spawned with SERVERCOMMANDS_LevelSpawnThingsSnapshot.
+static bool server_IsFullUpdateSnapshotActor( AActor *pActor )
+{
+	if (( sv_fullupdatesnapshots == false ) || ( pActor->flags & MF_MISSILE ) || ( pActor->NetworkFlags & NETFL_SERVERSIDEONLY ))
+		return ( false );
+
+	return ((( pActor->STFlags & STFL_LEVELSPAWNED ) != 0 )
+		&& ( pActor->x == pActor->SpawnPoint[0] )
+		&& ( pActor->y == pActor->SpawnPoint[1] ));
+}
+
 //*****************************************************************************
 //
 void SERVER_SendFullUpdate( ULONG ulClient )
@@ -2529,6 +2840,12 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 	player_t*					pPlayer;
 	AInventory					*pInventory;
 	TThinkerIterator<AActor>	Iterator;
+	TArray<AActor *>			SnapshotActors;
+
+	// Measure how much the full update costs.
+	g_qwNumFullUpdates++;
+	g_lFullUpdateClient = ulClient;
+	NETWORK_StartTrafficMeasurement( );
 
 	// Send active players to the client.
 	for ( ulIdx = 0; ulIdx < MAXPLAYERS; ulIdx++ )
@@ -2714,38 +3031,26 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 	if ( timelimit )
 		SERVERCOMMANDS_SetMapTime( ulClient, SVCF_ONLYTHISCLIENT );
 
-	// Go through all the items on the map, and tell the client to spawn those of which
-	// are important.
+	// Spawn the level things that haven't moved yet all at once. Only what differs
+	// from their spawn state is sent, everything else is sent below as usual.
 	while (( pActor = Iterator.Next( )))
 	{
-		// If the actor doesn't have a network ID, don't spawn it (it
-		// probably isn't important).
-		if ( pActor->NetID == 0 )
-			continue;
+		if ( server_ShouldSendActorInFullUpdate( pActor ) && server_IsFullUpdateSnapshotActor( pActor ))
+			SnapshotActors.Push( pActor );
+	}
 
-		// [BB] The other clients already have destroyed this actor, so don't spawn it.
-		if ( pActor->NetworkFlags & NETFL_DESTROYED_ON_CLIENT )
-			continue;
+	SERVERCOMMANDS_LevelSpawnThingsSnapshot( SnapshotActors, ulClient, SVCF_ONLYTHISCLIENT );
+	g_qwFullUpdateSnapshotActors += SnapshotActors.Size( );
+	Iterator.Reinit( );
 
-		// Don't spawn players, items about to be deleted, inventory items
-		// that have an owner, or items that the client spawns himself.
-		if (( pActor->IsKindOf( RUNTIME_CLASS( APlayerPawn ))) ||
-			( pActor->state == RUNTIME_CLASS ( AInventory )->ActorInfo->FindState("HoldAndDestroy") ) ||	// S_HOLDANDDESTROY
-			( pActor->state == RUNTIME_CLASS ( AInventory )->ActorInfo->FindState("Held") ) || // S_HELD
-			( pActor->NetworkFlags & NETFL_ALLOWCLIENTSPAWN ))
-		{
+	// Go through all the items on the map, and tell the client to spawn those of which
+	// are important.
+	while (( pActor = Iterator.Next( )))
+	{
+		if ( server_ShouldSendActorInFullUpdate( pActor ) == false )
 			continue;
-		}
 
-		// [BB] Don't spawn things hidden by AActor::HideOrDestroyIfSafe().
-		// The clients don't need them at all, since the server will tell
-		// them to spawn a new actor during GAME_ResetMap anyway.
-		if ( !( pActor->IsKindOf( RUNTIME_CLASS( AInventory ) ) )
-		     && ( pActor->state == RUNTIME_CLASS ( AInventory )->ActorInfo->FindState("HideIndefinitely") ) // S_HIDEINDEFINITELY 
-		   )
-		{
-			continue;
-		}
+		const bool bInSnapshot = server_IsFullUpdateSnapshotActor( pActor );
 
 		// Spawn a missile. Missiles must be handled differently because they have
 		// velocity.
@@ -2765,7 +3070,9 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 			}
 			if ( shouldLevelSpawn )
 			{
-				SERVERCOMMANDS_LevelSpawnThing( pActor, ulClient, SVCF_ONLYTHISCLIENT );
+				// The snapshot already spawned this thing.
+				if ( bInSnapshot == false )
+					SERVERCOMMANDS_LevelSpawnThing( pActor, ulClient, SVCF_ONLYTHISCLIENT );
 			}
 			else
 			{
@@ -2810,7 +3117,8 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 				if ( pActor->movedir != 0 )
 					ulBits |= CM_MOVEDIR;
 
-				if ( ulBits != 0 )
+				// The snapshot already told the client about all of these.
+				if (( ulBits != 0 ) && ( bInSnapshot == false ))
 					SERVERCOMMANDS_MoveThingExact( pActor, ulBits, ulClient, SVCF_ONLYTHISCLIENT );
 			}
 
@@ -2887,7 +3195,7 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 		}
 
 		// Check and see if it's important that the client know the angle of the object.
-		if ( pActor->angle != 0 )
+		if (( pActor->angle != 0 ) && ( bInSnapshot == false ))
 			SERVERCOMMANDS_SetThingAngle( pActor, ulClient, SVCF_ONLYTHISCLIENT );
 
 		// Spawned monster is a corpse.
@@ -2988,6 +3296,48 @@ void SERVER_SendFullUpdate( ULONG ulClient )
 			}
 		}
 	}
+
+	g_qwFullUpdateBytesSent += NETWORK_StopTrafficMeasurement( );
+
+	// Count whatever didn't fill a whole packet yet as well.
+	if ( SERVER_CalcClientPacketSize( ulClient, true ) > 0 )
+		g_qwFullUpdatePacketsSent++;
+
+	g_lFullUpdateClient = -1;
+}
+
+//*****************************************************************************
+//
+// Checks if ulPlayer's movement is worth sending to ulClient at the full rate.
+static bool server_IsPlayerRelevantToClient( ULONG ulClient, ULONG ulPlayer )
+{
+	// Clients who aren't allowed to see the player only get stub updates anyway.
+	if ( SERVER_IsPlayerVisible( ulClient, ulPlayer ) == false )
+		return ( false );
+
+	// Use the position of the player the client is watching through.
+	const ULONG ulViewPlayer = ( g_aClients[ulClient].ulDisplayPlayer < MAXPLAYERS ) ? g_aClients[ulClient].ulDisplayPlayer : ulClient;
+
+	if ( ulViewPlayer == ulPlayer )
+		return ( true );
+
+	const AActor *pViewer = players[ulViewPlayer].mo;
+	const AActor *pPlayer = players[ulPlayer].mo;
+
+	if (( pViewer == NULL ) || ( pPlayer == NULL ))
+		return ( true );
+
+	// Nearby players can still be heard, even if they can't be seen. Compare in map
+	// units, sv_hiddenplayerdistance * FRACUNIT overflows for large distances.
+	if (( P_AproxDistance( pViewer->x - pPlayer->x, pViewer->y - pPlayer->y ) >> FRACBITS ) < sv_hiddenplayerdistance )
+		return ( true );
+
+	// Without a reject table, there's no cheap way to tell whether they can see each other.
+	if ( rejectmatrix == NULL )
+		return ( true );
+
+	const int rejectIndex = static_cast<int>( pViewer->Sector - sectors ) * numsectors + static_cast<int>( pPlayer->Sector - sectors );
+	return (( rejectmatrix[rejectIndex >> 3] & ( 1 << ( rejectIndex & 7 ))) == 0 );
 }
 
 //*****************************************************************************
@@ -3041,7 +3391,20 @@ void SERVER_WriteCommands( void )
 				if ( ulPlayer == ulIdx )
 					continue;
 
+				// Players the client can't see don't need to be updated as often. Stagger
+				// the updates by player, so that they're spread out over several tics.
+				if (( sv_hiddenplayerupdaterate > 1 ) &&
+					((( gametic / players[ulIdx].userinfo.GetTicsPerUpdate() ) + ulPlayer ) % sv_hiddenplayerupdaterate != 0 ) &&
+					( server_IsPlayerRelevantToClient( ulIdx, ulPlayer ) == false ))
+				{
+					g_qwMovePlayerUpdatesSkipped++;
+					continue;
+				}
+
+				NETWORK_StartTrafficMeasurement( );
 				SERVERCOMMANDS_MovePlayer( ulPlayer, ulIdx, SVCF_ONLYTHISCLIENT );
+				g_qwMovePlayerBytesSent += NETWORK_StopTrafficMeasurement( );
+				g_qwMovePlayerUpdatesSent++;
 			}
 		}
 
@@ -3142,6 +3505,8 @@ void SERVER_DisconnectClient( ULONG ulClient, bool bBroadcast, bool bSaveInfo, L
 {
 	const CLIENTSTATE_e OldState = g_aClients[ulClient].State;
 
+	SERVER_MASTER_InvalidateLauncherResponses( );
+
 	// [RK] Disconnectd players need their vote removed/cancelled.
 	CALLVOTE_DisconnectedVoter( ulClient );
 
@@ -3226,6 +3591,7 @@ void SERVER_DisconnectClient( ULONG ulClient, bool bBroadcast, bool bSaveInfo, L
 	// [BB] Clear any cheats the player had. Note: This may not be done before the player dropped the important items!
 	players[ulClient].cheats = players[ulClient].cheats2 = 0;
 
+	server_RemoveClientFromAddressTable( ulClient );
 	g_aClients[ulClient].Address.Clear( );
 	g_aClients[ulClient].State = CLS_FREE;
 	g_aClients[ulClient].ulLastGameTic = 0;
@@ -3248,8 +3614,8 @@ void SERVER_DisconnectClient( ULONG ulClient, bool bBroadcast, bool bSaveInfo, L
 	SERVER_RCON_UpdateInfo( SVRCU_PLAYERDATA );
 
 	// Clear the client's buffers.
-	g_aClients[ulClient].PacketBuffer.Clear();
-	g_aClients[ulClient].UnreliablePacketBuffer.Clear();
+	SERVER_ClearClientBuffer( ulClient, true );
+	SERVER_ClearClientBuffer( ulClient, false );
 	g_aClients[ulClient].SavedPackets.Clear();
 
 	// Tell the join queue module that a player has left the game.
@@ -3773,6 +4139,8 @@ void SERVER_LoadNewLevel( const char *pszMapName )
 {
 	ULONG		ulIdx;
 
+	SERVER_MASTER_InvalidateLauncherResponses( );
+
 	for ( ulIdx = 0; ulIdx < MAXPLAYERS; ulIdx++ )
 	{
 		if ( SERVER_IsValidClient( ulIdx ) == false )
@@ -4806,6 +5174,168 @@ LONG SERVER_STATISTIC_GetCurrentInboundDataTransfer( void )
 	return ( g_lInboundDataTransferLastSecond );
 }
 
+//*****************************************************************************
+//
+// Called once per system call that reads from the network socket, with the
+// number of datagrams that call returned.
+void SERVER_STATISTIC_AddToReceiveCalls( ULONG ulNumPackets )
+{
+	g_qwTotalReceiveCalls++;
+	g_qwTotalPacketsReceived += ulNumPackets;
+
+	if ( ulNumPackets == 0 )
+		g_qwEmptyReceiveCalls++;
+}
+
+//*****************************************************************************
+//
+QWORD SERVER_STATISTIC_GetTotalReceiveCalls( void )
+{
+	return ( g_qwTotalReceiveCalls );
+}
+
+//*****************************************************************************
+//
+QWORD SERVER_STATISTIC_GetEmptyReceiveCalls( void )
+{
+	return ( g_qwEmptyReceiveCalls );
+}
+
+//*****************************************************************************
+//
+// Average number of datagrams returned by the receive calls that returned any.
+float SERVER_STATISTIC_GetPacketsPerReceiveCall( void )
+{
+	const QWORD qwCallsWithData = g_qwTotalReceiveCalls - g_qwEmptyReceiveCalls;
+
+	if ( qwCallsWithData == 0 )
+		return ( 0.0f );
+
+	return ( static_cast<float>( g_qwTotalPacketsReceived ) / qwCallsWithData );
+}
+
+//*****************************************************************************
+//
+// Called once per system call that sent datagrams from the network socket,
+// with the number of datagrams that call sent.
+void SERVER_STATISTIC_AddToSendCalls( ULONG ulNumPackets )
+{
+	g_qwTotalSendCalls++;
+	g_qwTotalPacketsSent += ulNumPackets;
+}
+
+//*****************************************************************************
+//
+QWORD SERVER_STATISTIC_GetTotalSendCalls( void )
+{
+	return ( g_qwTotalSendCalls );
+}
+
+//*****************************************************************************
+//
+float SERVER_STATISTIC_GetPacketsPerSendCall( void )
+{
+	if ( g_qwTotalSendCalls == 0 )
+		return ( 0.0f );
+
+	return ( static_cast<float>( g_qwTotalPacketsSent ) / g_qwTotalSendCalls );
+}
+
+//*****************************************************************************
+//
+QWORD SERVER_STATISTIC_GetClientAddressLookups( void )
+{
+	return ( g_qwClientAddressLookups );
+}
+
+//*****************************************************************************
+//
+// How many of the lookups found a connected client in the address table.
+QWORD SERVER_STATISTIC_GetClientAddressLookupHits( void )
+{
+	return ( g_qwClientAddressLookupHits );
+}
+
+//*****************************************************************************
+//
+QWORD SERVER_STATISTIC_GetMovePlayerUpdatesSent( void )
+{
+	return ( g_qwMovePlayerUpdatesSent );
+}
+
+//*****************************************************************************
+//
+// How many player movement updates sv_hiddenplayerupdaterate saved.
+QWORD SERVER_STATISTIC_GetMovePlayerUpdatesSkipped( void )
+{
+	return ( g_qwMovePlayerUpdatesSkipped );
+}
+
+//*****************************************************************************
+//
+QWORD SERVER_STATISTIC_GetMovePlayerBytesSent( void )
+{
+	return ( g_qwMovePlayerBytesSent );
+}
+
+//*****************************************************************************
+//
+QWORD SERVER_STATISTIC_GetNumFullUpdates( void )
+{
+	return ( g_qwNumFullUpdates );
+}
+
+//*****************************************************************************
+//
+QWORD SERVER_STATISTIC_GetFullUpdateBytesSent( void )
+{
+	return ( g_qwFullUpdateBytesSent );
+}
+
+//*****************************************************************************
+//
+// How many reliable packets the full updates were split into.
+QWORD SERVER_STATISTIC_GetFullUpdatePacketsSent( void )
+{
+	return ( g_qwFullUpdatePacketsSent );
+}
+
+//*****************************************************************************
+//
+// How many things were spawned by LevelSpawnThingsSnapshot during full updates.
+QWORD SERVER_STATISTIC_GetFullUpdateSnapshotActors( void )
+{
+	return ( g_qwFullUpdateSnapshotActors );
+}
+
+//*****************************************************************************
+//
+// Average time in milliseconds between a tic becoming due and the server
+// waking up to run it.
+double SERVER_STATISTIC_GetAverageTicStartJitter( void )
+{
+	if ( g_qwNumTicStarts == 0 )
+		return ( 0.0 );
+
+	return ( g_dTotalTicStartJitter / g_qwNumTicStarts );
+}
+
+//*****************************************************************************
+//
+double SERVER_STATISTIC_GetMaxTicStartJitter( void )
+{
+	return ( g_dMaxTicStartJitter );
+}
+
+//*****************************************************************************
+//
+// Percentage of the last second the server spent waiting for packets or the
+// next tic.
+float SERVER_STATISTIC_GetIdlePercentage( void )
+{
+	return ( g_fIdlePercentageLastSecond );
+}
+
 //*****************************************************************************
 //
 void SERVER_PrintCommand( LONG lCommand )
@@ -7755,7 +8285,7 @@ static bool server_CheckLogin ( const ULONG ulClient )
 //
 static bool server_InfoCheat( BYTESTREAM_s *pByteStream )
 {
-	unsigned short netID = pByteStream->ReadShort();
+	unsigned int netID = pByteStream->ReadNetID();
 	AActor* linetarget = CLIENT_FindThingByNetID( netID );
 	bool extended = !!pByteStream->ReadByte();
 
@@ -7825,15 +8355,21 @@ static void server_PerformBacktrace( ULONG ulClient, ULONG ulNumLateMoveCMDs )
 		// [AK] Hijack the unlagged's sector reconciliation for the backtrace too.
 		int unlaggedIndex = pClient->OldData->ulSavedGametic % UNLAGGEDTICS;
 
+		// Only the sectors that moved recently can be at a different height. Sectors that
+		// start moving during the backtrace are added to the end of the list, and are
+		// left alone here.
+		const TArray<sector_t *> &movingSectors = UNLAGGED_GetMovingSectors( );
+		const unsigned int numMovingSectors = movingSectors.Size( );
+
 		// [AK] Save the current sector ceiling/floor heights, then set them to whatever they
 		// were on the gametic that we started extrapolating this player.
-		for ( int i = 0; i < numsectors; i++ )
+		for ( unsigned int i = 0; i < numMovingSectors; i++ )
 		{
-			sectors[i].floorplane.backtraceRestoreD = sectors[i].floorplane.d;
-			sectors[i].ceilingplane.backtraceRestoreD = sectors[i].ceilingplane.d;
+			movingSectors[i]->floorplane.backtraceRestoreD = movingSectors[i]->floorplane.d;
+			movingSectors[i]->ceilingplane.backtraceRestoreD = movingSectors[i]->ceilingplane.d;
 
-			sectors[i].floorplane.d = sectors[i].floorplane.unlaggedD[unlaggedIndex];
-			sectors[i].ceilingplane.d = sectors[i].ceilingplane.unlaggedD[unlaggedIndex];
+			movingSectors[i]->floorplane.d = movingSectors[i]->floorplane.unlaggedD[unlaggedIndex];
+			movingSectors[i]->ceilingplane.d = movingSectors[i]->ceilingplane.unlaggedD[unlaggedIndex];
 		}
 
 		CLIENT_PLAYER_DATA_s oldData( &players[ulClient] );
@@ -7876,10 +8412,10 @@ static void server_PerformBacktrace( ULONG ulClient, ULONG ulNumLateMoveCMDs )
 				{
 					unlaggedIndex = ( unlaggedIndex + 1 ) % UNLAGGEDTICS;
 
-					for ( int i = 0; i < numsectors; i++ )
+					for ( unsigned int i = 0; i < numMovingSectors; i++ )
 					{
-						sectors[i].floorplane.d = sectors[i].floorplane.unlaggedD[unlaggedIndex];
-						sectors[i].ceilingplane.d = sectors[i].ceilingplane.unlaggedD[unlaggedIndex];
+						movingSectors[i]->floorplane.d = movingSectors[i]->floorplane.unlaggedD[unlaggedIndex];
+						movingSectors[i]->ceilingplane.d = movingSectors[i]->ceilingplane.unlaggedD[unlaggedIndex];
 					}
 
 					// [AK] Make sure the player doesn't get stuck in the floor/ceiling in case they moved.
@@ -7888,10 +8424,10 @@ static void server_PerformBacktrace( ULONG ulClient, ULONG ulNumLateMoveCMDs )
 			}
 
 			// [AK] Restore the sector ceiling/floor heights back to what they were before the backtrace.
-			for ( int i = 0; i < numsectors; i++ )
+			for ( unsigned int i = 0; i < numMovingSectors; i++ )
 			{
-				sectors[i].floorplane.d = sectors[i].floorplane.backtraceRestoreD;
-				sectors[i].ceilingplane.d = sectors[i].ceilingplane.backtraceRestoreD;
+				movingSectors[i]->floorplane.d = movingSectors[i]->floorplane.backtraceRestoreD;
+				movingSectors[i]->ceilingplane.d = movingSectors[i]->ceilingplane.backtraceRestoreD;
 			}
 
 			// [AK] As a final measure, fix the player's floorz/ceilingz and to ensure that they don't
@@ -7902,10 +8438,10 @@ static void server_PerformBacktrace( ULONG ulClient, ULONG ulNumLateMoveCMDs )
 		else
 		{
 			// [AK] Restore the sector ceiling/floor heights back to what they were before the backtrace.
-			for ( int i = 0; i < numsectors; i++ )
+			for ( unsigned int i = 0; i < numMovingSectors; i++ )
 			{
-				sectors[i].floorplane.d = sectors[i].floorplane.backtraceRestoreD;
-				sectors[i].ceilingplane.d = sectors[i].ceilingplane.backtraceRestoreD;
+				movingSectors[i]->floorplane.d = movingSectors[i]->floorplane.backtraceRestoreD;
+				movingSectors[i]->ceilingplane.d = movingSectors[i]->ceilingplane.backtraceRestoreD;
 			}
 
 			oldData.Restore( &players[ulClient] );
@@ -8332,6 +8868,51 @@ CCMD( forcerename )
 	Printf( "Unknown player: %s\n", argv[1] );
 }
 
+//*****************************************************************************
+CCMD( serverstats )
+{
+	if ( NETWORK_GetState( ) != NETSTATE_SERVER )
+		return;
+
+	const LONG lSeconds = SERVER_STATISTIC_GetTotalSecondsElapsed( );
+
+	Printf( "Uptime: %d seconds\n", static_cast<int>( lSeconds ));
+	Printf( "Average players: %.2f (peak %d)\n", lSeconds ? static_cast<float>( SERVER_STATISTIC_GetTotalPlayers( )) / lSeconds : 0.0f,
+		static_cast<int>( SERVER_STATISTIC_GetMaxNumPlayers( )));
+	Printf( "Total frags: %d\n", static_cast<int>( SERVER_STATISTIC_GetTotalFrags( )));
+	Printf( "Outbound: %llu bytes total, %d B/s (peak %d B/s)\n", static_cast<unsigned long long>( SERVER_STATISTIC_GetTotalOutboundDataTransferred( )),
+		static_cast<int>( SERVER_STATISTIC_GetCurrentOutboundDataTransfer( )), static_cast<int>( SERVER_STATISTIC_GetPeakOutboundDataTransfer( )));
+	Printf( "Inbound: %llu bytes total, %d B/s (peak %d B/s)\n", static_cast<unsigned long long>( SERVER_STATISTIC_GetTotalInboundDataTransferred( )),
+		static_cast<int>( SERVER_STATISTIC_GetCurrentInboundDataTransfer( )), static_cast<int>( SERVER_STATISTIC_GetPeakInboundDataTransfer( )));
+	Printf( "Receive calls: %llu (%llu empty), %.2f packets per call\n", static_cast<unsigned long long>( SERVER_STATISTIC_GetTotalReceiveCalls( )),
+		static_cast<unsigned long long>( SERVER_STATISTIC_GetEmptyReceiveCalls( )), SERVER_STATISTIC_GetPacketsPerReceiveCall( ));
+	Printf( "Send calls: %llu, %.2f packets per call\n", static_cast<unsigned long long>( SERVER_STATISTIC_GetTotalSendCalls( )),
+		SERVER_STATISTIC_GetPacketsPerSendCall( ));
+	Printf( "Client address lookups: %llu (%llu hits)\n", static_cast<unsigned long long>( SERVER_STATISTIC_GetClientAddressLookups( )),
+		static_cast<unsigned long long>( SERVER_STATISTIC_GetClientAddressLookupHits( )));
+	{
+		const QWORD qwSent = SERVER_STATISTIC_GetMovePlayerUpdatesSent( );
+		const QWORD qwSkipped = SERVER_STATISTIC_GetMovePlayerUpdatesSkipped( );
+		const QWORD qwBytes = SERVER_STATISTIC_GetMovePlayerBytesSent( );
+
+		// The skipped updates would have been about as big as the ones that were sent.
+		Printf( "Player movement updates: %llu sent (%llu bytes), %llu skipped (~%llu bytes saved)\n", static_cast<unsigned long long>( qwSent ),
+			static_cast<unsigned long long>( qwBytes ), static_cast<unsigned long long>( qwSkipped ),
+			static_cast<unsigned long long>( qwSent ? ( qwBytes * qwSkipped / qwSent ) : 0 ));
+	}
+	{
+		const QWORD qwNumFullUpdates = SERVER_STATISTIC_GetNumFullUpdates( );
+
+		// Compare these with sv_fullupdatesnapshots on and off.
+		Printf( "Full updates: %llu, %llu bytes and %.1f packets on average, %llu things spawned from snapshots\n", static_cast<unsigned long long>( qwNumFullUpdates ),
+			static_cast<unsigned long long>( qwNumFullUpdates ? SERVER_STATISTIC_GetFullUpdateBytesSent( ) / qwNumFullUpdates : 0 ),
+			qwNumFullUpdates ? static_cast<double>( SERVER_STATISTIC_GetFullUpdatePacketsSent( )) / qwNumFullUpdates : 0.0,
+			static_cast<unsigned long long>( SERVER_STATISTIC_GetFullUpdateSnapshotActors( )));
+	}
+	Printf( "Tic start jitter: %.3f ms average, %.3f ms max\n", SERVER_STATISTIC_GetAverageTicStartJitter( ), SERVER_STATISTIC_GetMaxTicStartJitter( ));
+	Printf( "Idle: %.1f%%\n", SERVER_STATISTIC_GetIdlePercentage( ));
+}
+
 //*****************************************************************************
 #ifdef	_DEBUG
 CCMD( testchecksum )
@@ -412,6 +412,11 @@ struct CLIENT_s
 	// A seperate buffer for non-critical commands that do not require sequencing.
 	NETBUFFER_s		UnreliablePacketBuffer;
 
+	// Commands sent to several clients at once that go into PacketBuffer and
+	// UnreliablePacketBuffer when the packets are assembled.
+	SharedCommandQueue	SharedCommands;
+	SharedCommandQueue	UnreliableSharedCommands;
+
 	// We back up the last PACKET_BUFFER_SIZE packets we've sent to the client so that we can
 	// retransmit them if necessary.
 	OutgoingPacketBuffer	SavedPackets;
@@ -626,6 +631,8 @@ void		SERVER_Tick( void );
 void		SERVER_SendOutPackets( void );
 void		SERVER_SendClientPacket( ULONG ulClient, bool bReliable );
 void		SERVER_CheckClientBuffer( ULONG ulClient, ULONG ulSize, bool bReliable );
+LONG		SERVER_CalcClientPacketSize( ULONG ulClient, bool bReliable );
+void		SERVER_ClearClientBuffer( ULONG ulClient, bool bReliable );
 LONG		SERVER_FindFreeClientSlot( void );
 LONG		SERVER_FindClientByAddress( NETADDRESS_s Address );
 CLIENT_s	*SERVER_GetClient( ULONG ulIdx );
@@ -726,6 +733,7 @@ const char	*SERVER_MASTER_GetGameName( void );
 NETADDRESS_s SERVER_MASTER_GetMasterAddress( void );
 void		SERVER_MASTER_HandleVerificationRequest( BYTESTREAM_s *pByteStream );
 void		SERVER_MASTER_SendBanlistReceipt( void );
+void		SERVER_MASTER_InvalidateLauncherResponses( void );
 
 // Statistic functions.
 LONG		SERVER_STATISTIC_GetTotalSecondsElapsed( void );
@@ -741,6 +749,25 @@ QWORD		SERVER_STATISTIC_GetTotalInboundDataTransferred( void );
 LONG		SERVER_STATISTIC_GetPeakInboundDataTransfer( void );
 void		SERVER_STATISTIC_AddToInboundDataTransfer( ULONG ulNumBytes );
 LONG		SERVER_STATISTIC_GetCurrentInboundDataTransfer( void );
+void		SERVER_STATISTIC_AddToReceiveCalls( ULONG ulNumPackets );
+QWORD		SERVER_STATISTIC_GetTotalReceiveCalls( void );
+QWORD		SERVER_STATISTIC_GetEmptyReceiveCalls( void );
+float		SERVER_STATISTIC_GetPacketsPerReceiveCall( void );
+void		SERVER_STATISTIC_AddToSendCalls( ULONG ulNumPackets );
+QWORD		SERVER_STATISTIC_GetTotalSendCalls( void );
+float		SERVER_STATISTIC_GetPacketsPerSendCall( void );
+QWORD		SERVER_STATISTIC_GetClientAddressLookups( void );
+QWORD		SERVER_STATISTIC_GetClientAddressLookupHits( void );
+QWORD		SERVER_STATISTIC_GetMovePlayerUpdatesSent( void );
+QWORD		SERVER_STATISTIC_GetMovePlayerUpdatesSkipped( void );
+QWORD		SERVER_STATISTIC_GetMovePlayerBytesSent( void );
+QWORD		SERVER_STATISTIC_GetNumFullUpdates( void );
+QWORD		SERVER_STATISTIC_GetFullUpdateBytesSent( void );
+QWORD		SERVER_STATISTIC_GetFullUpdatePacketsSent( void );
+QWORD		SERVER_STATISTIC_GetFullUpdateSnapshotActors( void );
+double		SERVER_STATISTIC_GetAverageTicStartJitter( void );
+double		SERVER_STATISTIC_GetMaxTicStartJitter( void );
+float		SERVER_STATISTIC_GetIdlePercentage( void );
 
 //*****************************************************************************
 //	EXTERNAL CONSOLE VARIABLES
@@ -85,6 +85,13 @@ struct LauncherResponseContext
 
 using LauncherFieldFunction = void(*)(const LauncherResponseContext &);
 
+// Everything of a launcher response that follows the time the launcher sent us.
+struct LauncherResponseCacheEntry
+{
+	ULONG ulBits, ulBits2;
+	TArray<BYTE> Data;
+};
+
 //--------------------------------------------------------------------------------------------------------------------------------------------------
 //-- VARIABLES -------------------------------------------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------------------------------------------------------
@@ -106,6 +113,11 @@ static	LONG				g_lStoredQueryIPHead;
 static	LONG				g_lStoredQueryIPTail;
 static	TArray<int>			g_OptionalWadIndices;
 
+// Launcher responses that were already assembled during the current tic. Launchers
+// poll constantly, so the same response is usually requested many times in a row.
+static	TArray<LauncherResponseCacheEntry>	g_LauncherResponseCache;
+static	int					g_LauncherResponseCacheTic = -1;
+
 extern	NETADDRESS_s		g_LocalAddress;
 
 FString g_VersionWithOS;
@@ -539,6 +551,90 @@ static const std::map<ULONG, LauncherFieldFunction> ResponseFunctions[] =
 	}
 };
 
+//*****************************************************************************
+//
+// Writes our version, the corrected flags and all fields these flags ask for.
+static void server_master_WriteResponseFields( BYTESTREAM_s *pByteStream, const ULONG ulBits, const ULONG ulBits2 )
+{
+	const ULONG flags[] = { ulBits, ulBits2 }; // [SB] The bits for each field set we'll be sending.
+	ULONG ulCurrentSetNum = 0; // [SB] Current field set. 0 -> SQF_, 1 -> SQF2_
+	const LauncherResponseContext ctx{ pByteStream, ulBits, ulBits2 };
+
+	// Send our version. [K6] ...with OS
+	pByteStream->WriteString( g_VersionWithOS.GetChars() );
+
+	pByteStream->WriteLong( ulBits );
+
+	// [SB] Reworked the packet assembly logic so that it tests each field and calls the relevant function,
+	// instead of being a giant list of bit-testing if statements.
+	for ( ULONG ulBit = 0; ulBit < 32; )
+	{
+		const ULONG ulCurrentSetValue = flags[ulCurrentSetNum];
+		const ULONG ulField = 1U << ulBit;
+
+		if ( ulCurrentSetValue & ulField )
+		{
+			const auto &map = ResponseFunctions[ulCurrentSetNum];
+
+			if ( map.count( ulField ) )
+			{
+				const auto pFunction = map.at( ulField );
+				pFunction( ctx );
+			}
+		}
+
+		// [SB] We exhausted all the bits in this set.
+		if ( ulBit == 31 )
+		{
+			// [SB] Move onto the next set of fields, if there is one.
+			if ( ulCurrentSetNum < countof( flags ) - 1 )
+			{
+				ulBit = 0;
+				ulCurrentSetNum++;
+			}
+			else
+			{
+				// [SB] Nothing more we can send.
+				break;
+			}
+		}
+		else
+		{
+			ulBit++;
+		}
+	}
+}
+
+//*****************************************************************************
+//
+static LauncherResponseCacheEntry *server_master_FindCachedResponse( const ULONG ulBits, const ULONG ulBits2 )
+{
+	// Player data like the pings and the scores changes every tic.
+	if ( g_LauncherResponseCacheTic != gametic )
+	{
+		g_LauncherResponseCache.Clear();
+		g_LauncherResponseCacheTic = gametic;
+	}
+
+	for ( unsigned int i = 0; i < g_LauncherResponseCache.Size(); i++ )
+	{
+		if (( g_LauncherResponseCache[i].ulBits == ulBits ) && ( g_LauncherResponseCache[i].ulBits2 == ulBits2 ))
+			return &g_LauncherResponseCache[i];
+	}
+
+	return NULL;
+}
+
+//*****************************************************************************
+//
+// Drops all cached launcher responses. Needs to be called whenever something that
+// goes into a response changes while we are still processing packets, e.g. when a
+// player joins or a server setting is changed through RCON.
+void SERVER_MASTER_InvalidateLauncherResponses( void )
+{
+	g_LauncherResponseCache.Clear();
+}
+
 //*****************************************************************************
 //
 void SERVER_MASTER_Construct( void )
@@ -589,6 +685,7 @@ void SERVER_MASTER_Destruct( void )
 {
 	// Free our local buffer.
 	g_MasterServerBuffer.Free();
+	g_LauncherResponseCache.Clear();
 }
 
 //*****************************************************************************
@@ -782,9 +879,6 @@ void SERVER_MASTER_SendServerInfo( NETADDRESS_s Address, ULONG ulFlags, ULONG ul
 	// Send the time the launcher sent to us.
 	g_MasterServerBuffer.ByteStream.WriteLong( ulTime );
 
-	// Send our version. [K6] ...with OS
-	g_MasterServerBuffer.ByteStream.WriteString( g_VersionWithOS.GetChars() );
-
 	// Send the information about the data that will be sent.
 	ulBits = ulFlags;
 
@@ -828,49 +922,23 @@ void SERVER_MASTER_SendServerInfo( NETADDRESS_s Address, ULONG ulFlags, ULONG ul
 			ulBits &= ~SQF_EXTENDED_INFO;
 	}
 
-	const ULONG flags[] = { ulBits, ulBits2 }; // [SB] The bits for each field set we'll be sending.
-	ULONG ulCurrentSetNum = 0; // [SB] Current field set. 0 -> SQF_, 1 -> SQF2_
-	const LauncherResponseContext ctx{ &g_MasterServerBuffer.ByteStream, ulBits, ulBits2 };
-
-	g_MasterServerBuffer.ByteStream.WriteLong( ulBits );
-
-	// [SB] Reworked the packet assembly logic so that it tests each field and calls the relevant function,
-	// instead of being a giant list of bit-testing if statements.
-	for ( ULONG ulBit = 0; ulBit < 32; )
+	// Everything from here on only depends on the flags and the state of the game, so
+	// reuse the response if it was already assembled this tic.
+	LauncherResponseCacheEntry *pCachedResponse = server_master_FindCachedResponse( ulBits, ulBits2 );
+	if ( pCachedResponse != NULL )
 	{
-		const ULONG ulCurrentSetValue = flags[ulCurrentSetNum];
-		const ULONG ulField = 1U << ulBit;
-
-		if ( ulCurrentSetValue & ulField )
-		{
-			const auto &map = ResponseFunctions[ulCurrentSetNum];
-
-			if ( map.count( ulField ) )
-			{
-				const auto pFunction = map.at( ulField );
-				pFunction( ctx );
-			}
-		}
-
-		// [SB] We exhausted all the bits in this set.
-		if ( ulBit == 31 )
-		{
-			// [SB] Move onto the next set of fields, if there is one.
-			if ( ulCurrentSetNum < countof( flags ) - 1 )
-			{
-				ulBit = 0;
-				ulCurrentSetNum++;
-			}
-			else
-			{
-				// [SB] Nothing more we can send.
-				break;
-			}
-		}
-		else
-		{
-			ulBit++;
-		}
+		g_MasterServerBuffer.ByteStream.WriteBuffer( &pCachedResponse->Data[0], pCachedResponse->Data.Size() );
+	}
+	else
+	{
+		BYTE *pbResponseStart = g_MasterServerBuffer.ByteStream.pbStream;
+		server_master_WriteResponseFields( &g_MasterServerBuffer.ByteStream, ulBits, ulBits2 );
+
+		LauncherResponseCacheEntry &entry = g_LauncherResponseCache[g_LauncherResponseCache.Reserve( 1 )];
+		entry.ulBits = ulBits;
+		entry.ulBits2 = ulBits2;
+		entry.Data.Resize( static_cast<unsigned int>( g_MasterServerBuffer.ByteStream.pbStream - pbResponseStart ));
+		memcpy( &entry.Data[0], pbResponseStart, entry.Data.Size() );
 	}
 
 	// [SB] Handle a segmented response.
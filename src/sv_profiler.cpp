@@ -0,0 +1,342 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: sv_profiler.cpp
+//
+// Description: Measures how long each part of the server's tic takes.
+//
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "doomdef.h"
+#include "doomstat.h"
+#include "network.h"
+#include "stats.h"
+#include "sv_main.h"
+#include "sv_profiler.h"
+#include "templates.h"
+
+//*****************************************************************************
+//	DEFINES
+
+// How many of the most recent tics are kept for the report.
+#define	PROFILER_NUM_TICS			( 10 * TICRATE )
+
+//*****************************************************************************
+//	VARIABLES
+
+// The time spent in each phase of a single tic, in milliseconds.
+struct TICPROFILE_s
+{
+	float			afPhaseMS[NUM_TICPHASES];
+	float			fTotalMS;
+};
+
+// Statistics over all tics in the ring buffer.
+struct PHASESTATS_s
+{
+	float			fAverage;
+	float			fMedian;
+	float			f95thPercentile;
+	float			f99thPercentile;
+	float			fMaximum;
+
+	// How many tics that overran had this phase as their most expensive one.
+	ULONG			ulOverrunsCaused;
+};
+
+static	const char	*g_pszTicPhaseNames[NUM_TICPHASES] =
+{
+	"getpackets",
+	"unlagged",
+	"ticker",
+	"checktimeouts",
+	"writecommands",
+	"sendpackets",
+	"master",
+	"rcon",
+	"bans",
+	"other",
+};
+
+// Ring buffer of the most recent tics.
+static	TICPROFILE_s	g_aTicProfiles[PROFILER_NUM_TICS];
+static	ULONG			g_ulNumTicProfiles = 0;
+static	ULONG			g_ulNextTicProfile = 0;
+
+// Timers of the tic that's currently running.
+static	cycle_t			g_TicTime;
+static	cycle_t			g_aPhaseTimes[NUM_TICPHASES];
+static	bool			g_bProfilingTic = false;
+
+// Number of tics that took longer than MS_PER_TIC since the profile was reset.
+static	QWORD			g_qwTotalOverruns = 0;
+
+//*****************************************************************************
+//	CONSOLE VARIABLES
+
+CVAR( Bool, sv_profiletics, true, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
+// Print a line to the console for every tic that takes longer than this many milliseconds.
+CVAR( Float, sv_ticoverrunwarning, 0.0f, CVAR_ARCHIVE|CVAR_NOSETBYACS )
+
+//*****************************************************************************
+//	FUNCTIONS
+
+void SERVER_PROFILER_BeginTic( void )
+{
+	g_bProfilingTic = sv_profiletics;
+	if ( g_bProfilingTic == false )
+		return;
+
+	for ( ULONG ulIdx = 0; ulIdx < NUM_TICPHASES; ulIdx++ )
+		g_aPhaseTimes[ulIdx].Reset( );
+
+	g_TicTime.Reset( );
+	g_TicTime.Clock( );
+}
+
+//*****************************************************************************
+//
+void SERVER_PROFILER_EndTic( void )
+{
+	if ( g_bProfilingTic == false )
+		return;
+
+	g_TicTime.Unclock( );
+	g_bProfilingTic = false;
+
+	TICPROFILE_s	&Profile = g_aTicProfiles[g_ulNextTicProfile];
+	float			fTrackedMS = 0.0f;
+	ULONG			ulWorstPhase = TICPHASE_OTHER;
+
+	for ( ULONG ulIdx = 0; ulIdx < TICPHASE_OTHER; ulIdx++ )
+	{
+		Profile.afPhaseMS[ulIdx] = static_cast<float>( g_aPhaseTimes[ulIdx].TimeMS( ));
+		fTrackedMS += Profile.afPhaseMS[ulIdx];
+	}
+
+	Profile.fTotalMS = static_cast<float>( g_TicTime.TimeMS( ));
+	Profile.afPhaseMS[TICPHASE_OTHER] = MAX( Profile.fTotalMS - fTrackedMS, 0.0f );
+
+	for ( ULONG ulIdx = 0; ulIdx < NUM_TICPHASES; ulIdx++ )
+	{
+		if ( Profile.afPhaseMS[ulIdx] > Profile.afPhaseMS[ulWorstPhase] )
+			ulWorstPhase = ulIdx;
+	}
+
+	if ( Profile.fTotalMS > MS_PER_TIC )
+		g_qwTotalOverruns++;
+
+	if (( sv_ticoverrunwarning > 0 ) && ( Profile.fTotalMS > sv_ticoverrunwarning ))
+	{
+		Printf( "Tic %d took %.2f ms (%s: %.2f ms)\n", gametic, Profile.fTotalMS,
+			g_pszTicPhaseNames[ulWorstPhase], Profile.afPhaseMS[ulWorstPhase] );
+	}
+
+	g_ulNextTicProfile = ( g_ulNextTicProfile + 1 ) % PROFILER_NUM_TICS;
+	if ( g_ulNumTicProfiles < PROFILER_NUM_TICS )
+		g_ulNumTicProfiles++;
+}
+
+//*****************************************************************************
+//
+void SERVER_PROFILER_BeginPhase( TICPHASE_e Phase )
+{
+	if ( g_bProfilingTic )
+		g_aPhaseTimes[Phase].Clock( );
+}
+
+//*****************************************************************************
+//
+void SERVER_PROFILER_EndPhase( TICPHASE_e Phase )
+{
+	if ( g_bProfilingTic )
+		g_aPhaseTimes[Phase].Unclock( );
+}
+
+//*****************************************************************************
+//
+void SERVER_PROFILER_Reset( void )
+{
+	g_ulNumTicProfiles = 0;
+	g_ulNextTicProfile = 0;
+	g_qwTotalOverruns = 0;
+}
+
+//*****************************************************************************
+//
+// Computes the statistics of one phase, or of the whole tic if ulPhase is
+// NUM_TICPHASES.
+static PHASESTATS_s server_profiler_ComputeStats( ULONG ulPhase )
+{
+	PHASESTATS_s	Stats;
+	float			afSorted[PROFILER_NUM_TICS];
+	float			fSum = 0.0f;
+
+	memset( &Stats, 0, sizeof( Stats ));
+	if ( g_ulNumTicProfiles == 0 )
+		return ( Stats );
+
+	for ( ULONG ulIdx = 0; ulIdx < g_ulNumTicProfiles; ulIdx++ )
+	{
+		const TICPROFILE_s &Profile = g_aTicProfiles[ulIdx];
+
+		afSorted[ulIdx] = ( ulPhase == NUM_TICPHASES ) ? Profile.fTotalMS : Profile.afPhaseMS[ulPhase];
+		fSum += afSorted[ulIdx];
+
+		// Find out which phase was the most expensive one in tics that overran.
+		if (( ulPhase != NUM_TICPHASES ) && ( Profile.fTotalMS > MS_PER_TIC ))
+		{
+			bool bWorst = true;
+
+			for ( ULONG ulOther = 0; ulOther < NUM_TICPHASES; ulOther++ )
+			{
+				if ( Profile.afPhaseMS[ulOther] > Profile.afPhaseMS[ulPhase] )
+					bWorst = false;
+			}
+
+			if ( bWorst )
+				Stats.ulOverrunsCaused++;
+		}
+	}
+
+	std::sort( afSorted, afSorted + g_ulNumTicProfiles );
+
+	Stats.fAverage = fSum / g_ulNumTicProfiles;
+	Stats.fMedian = afSorted[( g_ulNumTicProfiles - 1 ) / 2];
+	Stats.f95thPercentile = afSorted[( g_ulNumTicProfiles - 1 ) * 95 / 100];
+	Stats.f99thPercentile = afSorted[( g_ulNumTicProfiles - 1 ) * 99 / 100];
+	Stats.fMaximum = afSorted[g_ulNumTicProfiles - 1];
+	return ( Stats );
+}
+
+//*****************************************************************************
+//
+static ULONG server_profiler_CountOverruns( void )
+{
+	ULONG ulOverruns = 0;
+
+	for ( ULONG ulIdx = 0; ulIdx < g_ulNumTicProfiles; ulIdx++ )
+	{
+		if ( g_aTicProfiles[ulIdx].fTotalMS > MS_PER_TIC )
+			ulOverruns++;
+	}
+
+	return ( ulOverruns );
+}
+
+//*****************************************************************************
+//
+void SERVER_PROFILER_PrintReport( void )
+{
+	if ( g_ulNumTicProfiles == 0 )
+	{
+		Printf( "No tics have been profiled yet.\n" );
+		return;
+	}
+
+	Printf( "Last %lu tics (all times in ms):\n", g_ulNumTicProfiles );
+	Printf( "%-14s %8s %8s %8s %8s %8s %9s\n", "phase", "avg", "median", "95th", "99th", "max", "overruns" );
+
+	for ( ULONG ulIdx = 0; ulIdx <= NUM_TICPHASES; ulIdx++ )
+	{
+		const PHASESTATS_s Stats = server_profiler_ComputeStats( ulIdx );
+
+		if ( ulIdx < NUM_TICPHASES )
+		{
+			Printf( "%-14s %8.3f %8.3f %8.3f %8.3f %8.3f %9lu\n", g_pszTicPhaseNames[ulIdx], Stats.fAverage, Stats.fMedian,
+				Stats.f95thPercentile, Stats.f99thPercentile, Stats.fMaximum, Stats.ulOverrunsCaused );
+		}
+		else
+		{
+			Printf( "%-14s %8.3f %8.3f %8.3f %8.3f %8.3f %9lu\n", "total", Stats.fAverage, Stats.fMedian,
+				Stats.f95thPercentile, Stats.f99thPercentile, Stats.fMaximum, server_profiler_CountOverruns( ));
+		}
+	}
+
+	Printf( "Tics longer than %.2f ms since the last reset: %llu\n", MS_PER_TIC, static_cast<unsigned long long>( g_qwTotalOverruns ));
+}
+
+//*****************************************************************************
+//
+// Writes the report for an RCON utility. All times are in milliseconds.
+void SERVER_PROFILER_WriteReport( BYTESTREAM_s *pByteStream )
+{
+	pByteStream->WriteShort( g_ulNumTicProfiles );
+	pByteStream->WriteShort( server_profiler_CountOverruns( ));
+	pByteStream->WriteLong( static_cast<int>( MIN<QWORD>( g_qwTotalOverruns, INT_MAX )));
+	pByteStream->WriteByte( NUM_TICPHASES );
+
+	// The phases are followed by the whole tic, which has an empty name.
+	for ( ULONG ulIdx = 0; ulIdx <= NUM_TICPHASES; ulIdx++ )
+	{
+		const PHASESTATS_s Stats = server_profiler_ComputeStats( ulIdx );
+
+		pByteStream->WriteString(( ulIdx < NUM_TICPHASES ) ? g_pszTicPhaseNames[ulIdx] : "" );
+		pByteStream->WriteFloat( Stats.fAverage );
+		pByteStream->WriteFloat( Stats.fMedian );
+		pByteStream->WriteFloat( Stats.f95thPercentile );
+		pByteStream->WriteFloat( Stats.f99thPercentile );
+		pByteStream->WriteFloat( Stats.fMaximum );
+		pByteStream->WriteShort( Stats.ulOverrunsCaused );
+	}
+}
+
+//*****************************************************************************
+//	CONSOLE COMMANDS
+
+CCMD( ticprofile )
+{
+	if ( NETWORK_GetState( ) != NETSTATE_SERVER )
+		return;
+
+	if (( argv.argc( ) > 1 ) && ( stricmp( argv[1], "reset" ) == 0 ))
+	{
+		SERVER_PROFILER_Reset( );
+		Printf( "Tic profile reset.\n" );
+		return;
+	}
+
+	SERVER_PROFILER_PrintReport( );
+}
@@ -0,0 +1,86 @@
+//-----------------------------------------------------------------------------
+//
+// Zandronum Source
+// Copyright (C) 2026 Zandronum Development Team
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. Neither the name of the Zandronum Development Team nor the names of its
+//    contributors may be used to endorse or promote products derived from this
+//    software without specific prior written permission.
+// 4. Redistributions in any form must be accompanied by information on how to
+//    obtain complete source code for the software and any accompanying
+//    software that uses the software. The source code must either be included
+//    in the distribution or be available for no more than the cost of
+//    distribution plus a nominal fee, and must be freely redistributable
+//    under reasonable conditions. For an executable file, complete source
+//    code means the source code for all modules it contains. It does not
+//    include source code for modules or files that typically accompany the
+//    major components of the operating system on which the executable file
+//    runs.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// Filename: sv_profiler.h
+//
+// Description: Measures how long each part of the server's tic takes.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __SV_PROFILER_H__
+#define __SV_PROFILER_H__
+
+#include "networkshared.h"
+
+//*****************************************************************************
+//	DEFINES
+
+// The parts of a server tic that are timed separately.
+enum TICPHASE_e
+{
+	TICPHASE_GETPACKETS,
+	TICPHASE_UNLAGGED,
+	TICPHASE_TICKER,
+	TICPHASE_CHECKTIMEOUTS,
+	TICPHASE_WRITECOMMANDS,
+	TICPHASE_SENDPACKETS,
+	TICPHASE_MASTER,
+	TICPHASE_RCON,
+	TICPHASE_BANS,
+
+	// Everything in the tic that isn't covered by one of the phases above.
+	TICPHASE_OTHER,
+
+	NUM_TICPHASES
+};
+
+//*****************************************************************************
+//	PROTOTYPES
+
+void		SERVER_PROFILER_BeginTic( void );
+void		SERVER_PROFILER_EndTic( void );
+void		SERVER_PROFILER_BeginPhase( TICPHASE_e Phase );
+void		SERVER_PROFILER_EndPhase( TICPHASE_e Phase );
+void		SERVER_PROFILER_Reset( void );
+void		SERVER_PROFILER_PrintReport( void );
+void		SERVER_PROFILER_WriteReport( BYTESTREAM_s *pByteStream );
+
+#endif	// __SV_PROFILER_H__
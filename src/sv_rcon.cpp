@@ -53,6 +53,7 @@
 #include <list>
 #include <time.h>
 #include "sv_ban.h"
+#include "sv_profiler.h"
 #include "c_console.h"
 #include "doomstat.h"
 #include "network.h"
@@ -223,6 +224,19 @@ void SERVER_RCON_ParseMessage( NETADDRESS_s Address, LONG lMessage, BYTESTREAM_s
 			NETWORK_LaunchPacket( &g_MessageBuffer, g_AuthedClients[iIndex].Address );
 		}
 		break;
+	case CLRC_TICPROFILE:
+
+		// Send the RCON client the timings of the most recent tics.
+		iIndex = server_rcon_FindClient( Address );
+		if ( iIndex != -1 )
+		{
+			g_MessageBuffer.Clear();
+			g_MessageBuffer.ByteStream.WriteByte( SVRC_TICPROFILE );
+			SERVER_PROFILER_WriteReport( &g_MessageBuffer.ByteStream );
+			NETWORK_LaunchPacket( &g_MessageBuffer, g_AuthedClients[iIndex].Address );
+			g_AuthedClients[iIndex].iLastMessageTic = gametic;
+		}
+		break;
 	}
 }
 
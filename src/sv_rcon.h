@@ -78,6 +78,7 @@ enum
 	SVRC_UPDATE,
 	SVRC_TABCOMPLETE,
 	SVRC_TOOMANYTABCOMPLETES,
+	SVRC_TICPROFILE,
 };
 
 //*****************************************************************************
@@ -90,6 +91,7 @@ enum
 	CLRC_PONG,
 	CLRC_DISCONNECT,
 	CLRC_TABCOMPLETE,
+	CLRC_TICPROFILE,
 };
 
 //*****************************************************************************
@@ -42,6 +42,7 @@ INTBOOL CheckActorFlag(const AActor *owner, const char *flagname, bool printerro
 //
 //==========================================================================
 class FxExpression;
+class FxCode;
 
 struct FStateLabels;
 
@@ -121,6 +122,7 @@ public:
 struct FStateExpression
 {
 	FxExpression *expr;
+	FxCode *code;		// compiled form of expr, owned by this entry
 	const PClass *owner;
 	bool constant;
 	bool cloned;
@@ -139,6 +141,8 @@ public:
 	void Copy(int dest, int src, int cnt);
 	int ResolveAll();
 	FxExpression *Get(int no);
+	FxCode *GetCode(int no);
+	const PClass *GetOwner(int no);
 	unsigned int Size() { return expressions.Size(); }
 };
 
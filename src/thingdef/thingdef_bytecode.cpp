@@ -0,0 +1,872 @@
+/*
+** thingdef_bytecode.cpp
+**
+** Compiles resolved DECORATE expressions into a flat instruction list
+** and evaluates them without recursing through the expression tree.
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 Zandronum Development Team
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+** 4. When not used as part of ZDoom or a ZDoom derivative, this code will be
+**    covered by the terms of the GNU General Public License as published by
+**    the Free Software Foundation; either version 2 of the License, or (at
+**    your option) any later version.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Every Emit method has to produce exactly the result of the matching
+** EvalExpression, including the order in which operands and random
+** numbers are evaluated. Constant subexpressions have already been
+** folded by Resolve.
+**
+*/
+
+#include <math.h>
+#include "actor.h"
+#include "sc_man.h"
+#include "tarray.h"
+#include "templates.h"
+#include "i_system.h"
+#include "m_random.h"
+#include "c_dispatch.h"
+#include "doomstat.h"
+#include "stats.h"
+#include "thingdef.h"
+#include "thingdef_exp.h"
+#include "network.h"
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FxCode::FxCode()
+{
+	Depth = MaxDepth = 0;
+	Safe = true;
+}
+
+//==========================================================================
+//
+// If an expression needs more stack than the evaluator has, the whole
+// expression is evaluated through the tree instead.
+//
+//==========================================================================
+
+FxCode *FxCode::Compile(FxExpression *x)
+{
+	FxCode *code = new FxCode;
+
+	x->Emit(*code);
+	if (code->MaxDepth > MAX_STACK)
+	{
+		code->Code.Clear();
+		code->Depth = code->MaxDepth = 0;
+		code->Safe = true;
+		code->EmitEval(x);
+	}
+	code->EmitOp(FXOP_RETURN, -1);
+	code->Code.ShrinkToFit();
+	return code;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FxCode::EmitOp(EFxOpcode op, int stackchange, int arg)
+{
+	FxInstruction &inst = Code[Code.Reserve(1)];
+	inst.Opcode = op;
+	inst.Arg = arg;
+	inst.Value.Type = VAL_Unknown;
+	inst.Value.pointer = NULL;
+
+	Depth += stackchange;
+	if (Depth > MaxDepth) MaxDepth = Depth;
+}
+
+void FxCode::EmitConst(const ExpVal &value)
+{
+	EmitOp(FXOP_CONST, 1);
+	Code.Last().Value = value;
+}
+
+void FxCode::EmitEval(FxExpression *x)
+{
+	EmitOp(FXOP_EVAL, 1);
+	Code.Last().Value.pointer = x;
+	Safe = false;
+}
+
+void FxCode::EmitRandom(EFxOpcode op, int stackchange, FRandom *rng)
+{
+	EmitOp(op, stackchange);
+	Code.Last().Value.pointer = rng;
+	Safe = false;
+}
+
+void FxCode::EmitLoad(EFxOpcode op, int stackchange, PSymbolVariable *var)
+{
+	EmitOp(op, stackchange, int(var->offset));
+	Code.Last().Value.pointer = var;
+}
+
+int FxCode::EmitJump(EFxOpcode op, int stackchange)
+{
+	EmitOp(op, stackchange);
+	return Code.Size() - 1;
+}
+
+void FxCode::SetJumpTarget(int jump)
+{
+	Code[jump].Arg = Code.Size();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+ExpVal FxCode::Exec(AActor *self) const
+{
+	ExpVal stack[MAX_STACK];
+	ExpVal *sp = stack;
+	const FxInstruction *const base = &Code[0];
+	const FxInstruction *pc = base;
+
+	for (;;)
+	{
+		switch (pc->Opcode)
+		{
+		case FXOP_RETURN:
+			return sp[-1];
+
+		case FXOP_CONST:
+			*sp++ = pc->Value;
+			break;
+
+		case FXOP_EVAL:
+			*sp++ = static_cast<FxExpression *>(pc->Value.pointer)->EvalExpression(self);
+			break;
+
+		case FXOP_SELF:
+			sp->Type = VAL_Object;
+			sp->pointer = self;
+			sp++;
+			break;
+
+		case FXOP_INTCAST:
+		{
+			int v = sp[-1].GetInt();
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = v;
+			break;
+		}
+
+		case FXOP_NEG_I:
+		{
+			int v = -sp[-1].GetInt();
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = v;
+			break;
+		}
+
+		case FXOP_NEG_F:
+		{
+			double v = -sp[-1].GetFloat();
+			sp[-1].Type = VAL_Float;
+			sp[-1].Float = v;
+			break;
+		}
+
+		case FXOP_NOT_BITWISE:
+		{
+			int v = ~sp[-1].GetInt();
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = v;
+			break;
+		}
+
+		case FXOP_NOT_BOOL:
+		{
+			int v = !sp[-1].GetBool();
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = v;
+			break;
+		}
+
+		case FXOP_TOBOOL:
+		{
+			int v = sp[-1].GetBool();
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = v;
+			break;
+		}
+
+#define BINARY_INT(op) \
+		{ \
+			int v2 = sp[-1].GetInt(); \
+			int v1 = sp[-2].GetInt(); \
+			sp--; \
+			sp[-1].Type = VAL_Int; \
+			sp[-1].Int = (op); \
+			break; \
+		}
+#define BINARY_FLOAT(op) \
+		{ \
+			double v2 = sp[-1].GetFloat(); \
+			double v1 = sp[-2].GetFloat(); \
+			sp--; \
+			sp[-1].Type = VAL_Float; \
+			sp[-1].Float = (op); \
+			break; \
+		}
+#define COMPARE_FLOAT(op) \
+		{ \
+			double v2 = sp[-1].GetFloat(); \
+			double v1 = sp[-2].GetFloat(); \
+			sp--; \
+			sp[-1].Type = VAL_Int; \
+			sp[-1].Int = (op); \
+			break; \
+		}
+#define CHECK_DIVISOR(v) \
+			if ((v) == 0) \
+			{ \
+				if ( NETWORK_GetState( ) == NETSTATE_CLIENT ) \
+				{ \
+					sp--; \
+					sp[-1] = handleClientDivisionByZero(); \
+					break; \
+				} \
+				I_Error("Division by 0"); \
+			}
+
+		case FXOP_ADD_I:	BINARY_INT(v1 + v2)
+		case FXOP_SUB_I:	BINARY_INT(v1 - v2)
+		case FXOP_MUL_I:	BINARY_INT(v1 * v2)
+		case FXOP_ADD_F:	BINARY_FLOAT(v1 + v2)
+		case FXOP_SUB_F:	BINARY_FLOAT(v1 - v2)
+		case FXOP_MUL_F:	BINARY_FLOAT(v1 * v2)
+
+		case FXOP_DIV_I:
+		case FXOP_MOD_I:
+		{
+			int v2 = sp[-1].GetInt();
+			int v1 = sp[-2].GetInt();
+			CHECK_DIVISOR(v2);
+			sp--;
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = pc->Opcode == FXOP_DIV_I? v1 / v2 : v1 % v2;
+			break;
+		}
+
+		case FXOP_DIV_F:
+		case FXOP_MOD_F:
+		{
+			double v2 = sp[-1].GetFloat();
+			double v1 = sp[-2].GetFloat();
+			CHECK_DIVISOR(v2);
+			sp--;
+			sp[-1].Type = VAL_Float;
+			sp[-1].Float = pc->Opcode == FXOP_DIV_F? v1 / v2 : fmod(v1, v2);
+			break;
+		}
+
+		case FXOP_LT_I:		BINARY_INT(v1 < v2)
+		case FXOP_GT_I:		BINARY_INT(v1 > v2)
+		case FXOP_GE_I:		BINARY_INT(v1 >= v2)
+		case FXOP_LE_I:		BINARY_INT(v1 <= v2)
+		case FXOP_EQ_I:		BINARY_INT(v1 == v2)
+		case FXOP_NE_I:		BINARY_INT(v1 != v2)
+		case FXOP_LT_F:		COMPARE_FLOAT(v1 < v2)
+		case FXOP_GT_F:		COMPARE_FLOAT(v1 > v2)
+		case FXOP_GE_F:		COMPARE_FLOAT(v1 >= v2)
+		case FXOP_LE_F:		COMPARE_FLOAT(v1 <= v2)
+		case FXOP_EQ_F:		COMPARE_FLOAT(v1 == v2)
+		case FXOP_NE_F:		COMPARE_FLOAT(v1 != v2)
+
+		case FXOP_LSHIFT:	BINARY_INT(v1 << v2)
+		case FXOP_RSHIFT:	BINARY_INT(v1 >> v2)
+		case FXOP_URSHIFT:	BINARY_INT(int((unsigned int)(v1) >> v2))
+		case FXOP_AND:		BINARY_INT(v1 & v2)
+		case FXOP_OR:		BINARY_INT(v1 | v2)
+		case FXOP_XOR:		BINARY_INT(v1 ^ v2)
+
+#undef BINARY_INT
+#undef BINARY_FLOAT
+#undef COMPARE_FLOAT
+#undef CHECK_DIVISOR
+
+		case FXOP_ANDAND:
+			if (!sp[-1].GetBool())
+			{
+				sp[-1].Type = VAL_Int;
+				sp[-1].Int = 0;
+				pc = base + pc->Arg;
+				continue;
+			}
+			sp--;
+			break;
+
+		case FXOP_OROR:
+			if (sp[-1].GetBool())
+			{
+				sp[-1].Type = VAL_Int;
+				sp[-1].Int = 1;
+				pc = base + pc->Arg;
+				continue;
+			}
+			sp--;
+			break;
+
+		case FXOP_JUMP:
+			pc = base + pc->Arg;
+			continue;
+
+		case FXOP_JUMPIFNOT:
+			if (!(--sp)->GetBool())
+			{
+				pc = base + pc->Arg;
+				continue;
+			}
+			break;
+
+		case FXOP_ABS:
+			if (sp[-1].Type == VAL_Float)
+			{
+				sp[-1].Float = fabs(sp[-1].Float);
+			}
+			else
+			{
+				sp[-1].Int = abs(sp[-1].Int);
+			}
+			break;
+
+		case FXOP_RANDOM:
+			sp->Type = VAL_Int;
+			sp->Int = (*static_cast<FRandom *>(pc->Value.pointer))();
+			sp++;
+			break;
+
+		case FXOP_RANDOMRANGE:
+		{
+			int maxval = sp[-1].GetInt();
+			int minval = sp[-2].GetInt();
+
+			if (maxval < minval)
+			{
+				swapvalues (maxval, minval);
+			}
+			sp--;
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = (*static_cast<FRandom *>(pc->Value.pointer))(maxval - minval + 1) + minval;
+			break;
+		}
+
+		case FXOP_FRANDOM:
+		{
+			int random = (*static_cast<FRandom *>(pc->Value.pointer))(0x40000000);
+			sp->Type = VAL_Float;
+			sp->Float = random / double(0x40000000);
+			sp++;
+			break;
+		}
+
+		case FXOP_FRANDOMRANGE:
+		{
+			// The random number was pushed before the range was evaluated.
+			double maxval = sp[-1].GetFloat();
+			double minval = sp[-2].GetFloat();
+
+			if (maxval < minval)
+			{
+				swapvalues (maxval, minval);
+			}
+			sp -= 2;
+			sp[-1].Float = sp[-1].Float * (maxval - minval) + minval;
+			break;
+		}
+
+		case FXOP_RANDOM2:
+		{
+			int imaskval = sp[-1].GetInt();
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = static_cast<FRandom *>(pc->Value.pointer)->Random2(imaskval);
+			break;
+		}
+
+		case FXOP_LOADGLOBAL:
+		{
+			PSymbolVariable *var = static_cast<PSymbolVariable *>(pc->Value.pointer);
+			*sp++ = GetVariableValue((void*)var->offset, var->ValueType);
+			break;
+		}
+
+		case FXOP_LOADSELF_INT:
+		case FXOP_LOADSELF_FIXED:
+		case FXOP_LOADSELF_ANGLE:
+		case FXOP_LOADSELF:
+		case FXOP_SELFADDRESS:
+		{
+			if (self == NULL)
+			{
+				I_Error("Accessing member variable without valid object");
+			}
+
+			char *address = (char *)self + pc->Arg;
+			switch (pc->Opcode)
+			{
+			case FXOP_LOADSELF_INT:
+				sp->Type = VAL_Int;
+				sp->Int = *(int *)address;
+				break;
+
+			case FXOP_LOADSELF_FIXED:
+				sp->Type = VAL_Float;
+				sp->Float = (*(fixed_t *)address) / 65536.;
+				break;
+
+			case FXOP_LOADSELF_ANGLE:
+				sp->Type = VAL_Float;
+				sp->Float = (*(angle_t *)address) * 90./ANGLE_90;	// intentionally not using ANGLE_1
+				break;
+
+			case FXOP_LOADSELF:
+				*sp = GetVariableValue(address, static_cast<PSymbolVariable *>(pc->Value.pointer)->ValueType);
+				break;
+
+			default:
+				sp->Type = VAL_Pointer;
+				sp->pointer = address;
+				break;
+			}
+			sp++;
+			break;
+		}
+
+		case FXOP_LOADMEMBER:
+		{
+			char *object = sp[-1].GetPointer<char>();
+			if (object == NULL)
+			{
+				I_Error("Accessing member variable without valid object");
+			}
+			sp[-1] = GetVariableValue(object + pc->Arg, static_cast<PSymbolVariable *>(pc->Value.pointer)->ValueType);
+			break;
+		}
+
+		case FXOP_INDEX:
+		{
+			int *arraystart = sp[-2].GetPointer<int>();
+			int indexval = sp[-1].GetInt();
+
+			if (indexval < 0 || indexval >= pc->Arg)
+			{
+				I_Error("Array index out of bounds");
+			}
+			sp--;
+			sp[-1].Type = VAL_Int;
+			sp[-1].Int = arraystart[indexval];
+			break;
+		}
+
+		default:
+			I_Error("Invalid expression opcode %d", pc->Opcode);
+		}
+		pc++;
+	}
+}
+
+//==========================================================================
+//
+// Emit methods
+//
+//==========================================================================
+
+void FxExpression::Emit(FxCode &code)
+{
+	code.EmitEval(this);
+}
+
+void FxConstant::Emit(FxCode &code)
+{
+	code.EmitConst(value);
+}
+
+void FxIntCast::Emit(FxCode &code)
+{
+	basex->Emit(code);
+	code.EmitOp(FXOP_INTCAST, 0);
+}
+
+void FxMinusSign::Emit(FxCode &code)
+{
+	Operand->Emit(code);
+	code.EmitOp(ValueType == VAL_Int? FXOP_NEG_I : FXOP_NEG_F, 0);
+}
+
+void FxUnaryNotBitwise::Emit(FxCode &code)
+{
+	Operand->Emit(code);
+	code.EmitOp(FXOP_NOT_BITWISE, 0);
+}
+
+void FxUnaryNotBoolean::Emit(FxCode &code)
+{
+	Operand->Emit(code);
+	code.EmitOp(FXOP_NOT_BOOL, 0);
+}
+
+void FxAddSub::Emit(FxCode &code)
+{
+	left->Emit(code);
+	right->Emit(code);
+	if (ValueType == VAL_Float)
+	{
+		code.EmitOp(Operator == '+'? FXOP_ADD_F : FXOP_SUB_F, -1);
+	}
+	else
+	{
+		code.EmitOp(Operator == '+'? FXOP_ADD_I : FXOP_SUB_I, -1);
+	}
+}
+
+void FxMulDiv::Emit(FxCode &code)
+{
+	left->Emit(code);
+	right->Emit(code);
+	if (Operator != '*')
+	{
+		// Can abort the game on a division by 0.
+		code.SetUnsafe();
+	}
+	if (ValueType == VAL_Float)
+	{
+		code.EmitOp(Operator == '*'? FXOP_MUL_F : Operator == '/'? FXOP_DIV_F : FXOP_MOD_F, -1);
+	}
+	else
+	{
+		code.EmitOp(Operator == '*'? FXOP_MUL_I : Operator == '/'? FXOP_DIV_I : FXOP_MOD_I, -1);
+	}
+}
+
+void FxCompareRel::Emit(FxCode &code)
+{
+	left->Emit(code);
+	right->Emit(code);
+	if (left->ValueType == VAL_Float || right->ValueType == VAL_Float)
+	{
+		code.EmitOp(Operator == '<'? FXOP_LT_F : Operator == '>'? FXOP_GT_F : Operator == TK_Geq? FXOP_GE_F : FXOP_LE_F, -1);
+	}
+	else
+	{
+		code.EmitOp(Operator == '<'? FXOP_LT_I : Operator == '>'? FXOP_GT_I : Operator == TK_Geq? FXOP_GE_I : FXOP_LE_I, -1);
+	}
+}
+
+void FxCompareEq::Emit(FxCode &code)
+{
+	if (left->ValueType == VAL_Float || right->ValueType == VAL_Float)
+	{
+		left->Emit(code);
+		right->Emit(code);
+		code.EmitOp(Operator == TK_Eq? FXOP_EQ_F : FXOP_NE_F, -1);
+	}
+	else if (ValueType == VAL_Int)
+	{
+		left->Emit(code);
+		right->Emit(code);
+		code.EmitOp(Operator == TK_Eq? FXOP_EQ_I : FXOP_NE_I, -1);
+	}
+	else
+	{
+		// Pointer comparison isn't implemented, the operands aren't even evaluated.
+		ExpVal zero;
+		zero.Type = VAL_Int;
+		zero.Int = 0;
+		code.EmitConst(zero);
+	}
+}
+
+void FxBinaryInt::Emit(FxCode &code)
+{
+	left->Emit(code);
+	right->Emit(code);
+	code.EmitOp(
+		Operator == TK_LShift? FXOP_LSHIFT :
+		Operator == TK_RShift? FXOP_RSHIFT :
+		Operator == TK_URShift? FXOP_URSHIFT :
+		Operator == '&'? FXOP_AND :
+		Operator == '|'? FXOP_OR : FXOP_XOR, -1);
+}
+
+void FxBinaryLogical::Emit(FxCode &code)
+{
+	left->Emit(code);
+	int jump = code.EmitJump(Operator == TK_AndAnd? FXOP_ANDAND : FXOP_OROR, -1);
+	right->Emit(code);
+	code.EmitOp(FXOP_TOBOOL, 0);
+	code.SetJumpTarget(jump);
+}
+
+void FxConditional::Emit(FxCode &code)
+{
+	condition->Emit(code);
+	int falsejump = code.EmitJump(FXOP_JUMPIFNOT, -1);
+	int depth = code.GetDepth();
+	truex->Emit(code);
+	int endjump = code.EmitJump(FXOP_JUMP, 0);
+	code.SetJumpTarget(falsejump);
+	code.SetDepth(depth);
+	falsex->Emit(code);
+	code.SetJumpTarget(endjump);
+}
+
+void FxAbs::Emit(FxCode &code)
+{
+	val->Emit(code);
+	code.EmitOp(FXOP_ABS, 0);
+}
+
+void FxRandom::Emit(FxCode &code)
+{
+	if (min != NULL && max != NULL)
+	{
+		min->Emit(code);
+		max->Emit(code);
+		code.EmitRandom(FXOP_RANDOMRANGE, -1, rng);
+	}
+	else
+	{
+		code.EmitRandom(FXOP_RANDOM, 1, rng);
+	}
+}
+
+void FxFRandom::Emit(FxCode &code)
+{
+	// Unlike random, the number is generated before the range is evaluated.
+	code.EmitRandom(FXOP_FRANDOM, 1, rng);
+	if (min != NULL && max != NULL)
+	{
+		min->Emit(code);
+		max->Emit(code);
+		code.EmitOp(FXOP_FRANDOMRANGE, -2);
+	}
+}
+
+void FxRandom2::Emit(FxCode &code)
+{
+	mask->Emit(code);
+	code.EmitRandom(FXOP_RANDOM2, 0, rng);
+}
+
+void FxGlobalVariable::Emit(FxCode &code)
+{
+	if (AddressRequested)
+	{
+		code.EmitEval(this);
+	}
+	else
+	{
+		code.EmitLoad(FXOP_LOADGLOBAL, 1, var);
+	}
+}
+
+void FxClassMember::Emit(FxCode &code)
+{
+	if (classx->ValueType == VAL_Class)
+	{
+		code.EmitEval(this);
+	}
+	else if (classx->isSelf())
+	{
+		if (AddressRequested)
+		{
+			code.EmitLoad(FXOP_SELFADDRESS, 1, membervar);
+		}
+		else switch (membervar->ValueType.Type)
+		{
+		case VAL_Int:
+			code.EmitLoad(FXOP_LOADSELF_INT, 1, membervar);
+			break;
+
+		case VAL_Fixed:
+			code.EmitLoad(FXOP_LOADSELF_FIXED, 1, membervar);
+			break;
+
+		case VAL_Angle:
+			code.EmitLoad(FXOP_LOADSELF_ANGLE, 1, membervar);
+			break;
+
+		default:
+			code.EmitLoad(FXOP_LOADSELF, 1, membervar);
+			break;
+		}
+	}
+	else if (AddressRequested)
+	{
+		code.EmitEval(this);
+	}
+	else
+	{
+		classx->Emit(code);
+		code.EmitLoad(FXOP_LOADMEMBER, 0, membervar);
+		code.SetUnsafe();
+	}
+}
+
+void FxSelf::Emit(FxCode &code)
+{
+	code.EmitOp(FXOP_SELF, 1);
+}
+
+void FxArrayElement::Emit(FxCode &code)
+{
+	Array->Emit(code);
+	index->Emit(code);
+	if (!index->isConstant())
+	{
+		code.SetUnsafe();
+	}
+	else
+	{
+		int indexval = index->EvalExpression(NULL).GetInt();
+		if (indexval < 0 || indexval >= Array->ValueType.size)
+		{
+			code.SetUnsafe();
+		}
+	}
+	code.EmitOp(FXOP_INDEX, -1, Array->ValueType.size);
+}
+
+//==========================================================================
+//
+// decoratebench
+//
+// Times the tree walker against the compiled code for all expressions of
+// the loaded actors that can be evaluated without side effects, using an
+// actor of the right class from the current level, and checks that both
+// give the same result.
+//
+//==========================================================================
+
+static bool SameValue(const ExpVal &a, const ExpVal &b)
+{
+	if (a.Type != b.Type) return false;
+	switch (a.Type)
+	{
+	case VAL_Float:
+		return a.Float == b.Float || (a.Float != a.Float && b.Float != b.Float);
+
+	case VAL_Object:
+	case VAL_Class:
+	case VAL_Pointer:
+	case VAL_State:
+		return a.pointer == b.pointer;
+
+	default:
+		return a.Int == b.Int;
+	}
+}
+
+CCMD(decoratebench)
+{
+	if (gamestate != GS_LEVEL)
+	{
+		Printf("You must be in a level to use this command.\n");
+		return;
+	}
+
+	int iterations = argv.argc() > 1? atoi(argv[1]) : 10000;
+	if (iterations <= 0) iterations = 1;
+
+	// Find an instance of every class that has one in the level.
+	TMap<const PClass *, AActor *> instances;
+	TThinkerIterator<AActor> it;
+	AActor *mo;
+
+	while ((mo = it.Next()) != NULL)
+	{
+		for (const PClass *cls = mo->GetClass(); cls != NULL; cls = cls->ParentClass)
+		{
+			if (instances.CheckKey(cls) != NULL) break;
+			instances[cls] = mo;
+		}
+	}
+
+	cycle_t treetime, codetime;
+	unsigned int tested = 0, skipped = 0, mismatches = 0;
+
+	treetime.Reset();
+	codetime.Reset();
+
+	for (unsigned int i = 0; i < StateParams.Size(); i++)
+	{
+		FxExpression *x = StateParams.Get(i);
+		FxCode *code = StateParams.GetCode(i);
+		if (x == NULL || code == NULL) continue;
+
+		AActor **self = instances.CheckKey(StateParams.GetOwner(i));
+		if (!code->IsSafe() || self == NULL)
+		{
+			skipped++;
+			continue;
+		}
+
+		if (!SameValue(x->EvalExpression(*self), code->Exec(*self)))
+		{
+			if (mismatches++ == 0)
+			{
+				Printf("Expression %u gives different results\n", i);
+			}
+			continue;
+		}
+
+		treetime.Clock();
+		for (int j = 0; j < iterations; j++)
+		{
+			x->EvalExpression(*self);
+		}
+		treetime.Unclock();
+
+		codetime.Clock();
+		for (int j = 0; j < iterations; j++)
+		{
+			code->Exec(*self);
+		}
+		codetime.Unclock();
+		tested++;
+	}
+
+	Printf("%u expressions x %d: tree %.2f ms, compiled %.2f ms (%.2fx)\n", tested, iterations,
+		treetime.TimeMS(), codetime.TimeMS(), codetime.TimeMS() > 0? treetime.TimeMS() / codetime.TimeMS() : 0.);
+	Printf("%u skipped (side effects or no actor of their class), %u mismatches\n", skipped, mismatches);
+}
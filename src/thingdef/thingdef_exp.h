@@ -143,6 +143,115 @@ struct ExpVal
 };
 
 
+//==========================================================================
+//
+// FxCode
+// Resolved expressions are compiled into a flat list of instructions
+// for a small stack machine, so that evaluating them doesn't need to
+// recurse through the expression tree. Nodes that have no instructions
+// of their own are called through EvalExpression.
+//
+//==========================================================================
+
+class FxExpression;
+
+enum EFxOpcode
+{
+	FXOP_RETURN,
+	FXOP_CONST,
+	FXOP_EVAL,
+	FXOP_SELF,
+	FXOP_INTCAST,
+	FXOP_NEG_I,
+	FXOP_NEG_F,
+	FXOP_NOT_BITWISE,
+	FXOP_NOT_BOOL,
+	FXOP_TOBOOL,
+	FXOP_ADD_I,
+	FXOP_SUB_I,
+	FXOP_MUL_I,
+	FXOP_DIV_I,
+	FXOP_MOD_I,
+	FXOP_ADD_F,
+	FXOP_SUB_F,
+	FXOP_MUL_F,
+	FXOP_DIV_F,
+	FXOP_MOD_F,
+	FXOP_LT_I,
+	FXOP_GT_I,
+	FXOP_GE_I,
+	FXOP_LE_I,
+	FXOP_LT_F,
+	FXOP_GT_F,
+	FXOP_GE_F,
+	FXOP_LE_F,
+	FXOP_EQ_I,
+	FXOP_NE_I,
+	FXOP_EQ_F,
+	FXOP_NE_F,
+	FXOP_LSHIFT,
+	FXOP_RSHIFT,
+	FXOP_URSHIFT,
+	FXOP_AND,
+	FXOP_OR,
+	FXOP_XOR,
+	FXOP_ANDAND,		// pops; if false, pushes 0 and jumps
+	FXOP_OROR,			// pops; if true, pushes 1 and jumps
+	FXOP_JUMP,
+	FXOP_JUMPIFNOT,		// pops; jumps if false
+	FXOP_ABS,
+	FXOP_RANDOM,
+	FXOP_RANDOMRANGE,
+	FXOP_FRANDOM,
+	FXOP_FRANDOMRANGE,
+	FXOP_RANDOM2,
+	FXOP_LOADGLOBAL,
+	FXOP_LOADSELF_INT,
+	FXOP_LOADSELF_FIXED,
+	FXOP_LOADSELF_ANGLE,
+	FXOP_LOADSELF,
+	FXOP_LOADMEMBER,
+	FXOP_SELFADDRESS,
+	FXOP_INDEX,
+};
+
+struct FxInstruction
+{
+	int Opcode;
+	int Arg;		// jump target, member offset or array size
+	ExpVal Value;	// constants; nodes, RNGs and variables are in Value.pointer
+};
+
+class FxCode
+{
+	enum { MAX_STACK = 32 };
+
+	TArray<FxInstruction> Code;
+	int Depth;
+	int MaxDepth;
+	bool Safe;
+
+public:
+	FxCode();
+	static FxCode *Compile(FxExpression *x);
+
+	ExpVal Exec(AActor *self) const;
+
+	// True if running this can neither change the game state nor abort it.
+	bool IsSafe() const { return Safe; }
+
+	void EmitConst(const ExpVal &value);
+	void EmitEval(FxExpression *x);
+	void EmitOp(EFxOpcode op, int stackchange, int arg = 0);
+	void EmitRandom(EFxOpcode op, int stackchange, FRandom *rng);
+	void EmitLoad(EFxOpcode op, int stackchange, PSymbolVariable *var);
+	int EmitJump(EFxOpcode op, int stackchange);
+	void SetJumpTarget(int jump);
+	void SetDepth(int depth) { Depth = depth; }
+	int GetDepth() const { return Depth; }
+	void SetUnsafe() { Safe = false; }
+};
+
 //==========================================================================
 //
 //
@@ -163,7 +272,9 @@ public:
 	FxExpression *ResolveAsBoolean(FCompileContext &ctx);
 	
 	virtual ExpVal EvalExpression (AActor *self);
+	virtual void Emit(FxCode &code);
 	virtual bool isConstant() const;
+	virtual bool isSelf() const;
 	virtual void RequestAddress();
 
 	FScriptPosition ScriptPosition;
@@ -290,6 +401,7 @@ public:
 		return true;
 	}
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 
@@ -310,6 +422,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 
@@ -344,6 +457,7 @@ public:
 	~FxMinusSign();
 	FxExpression *Resolve(FCompileContext&);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -361,6 +475,7 @@ public:
 	~FxUnaryNotBitwise();
 	FxExpression *Resolve(FCompileContext&);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -378,6 +493,7 @@ public:
 	~FxUnaryNotBoolean();
 	FxExpression *Resolve(FCompileContext&);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -411,6 +527,7 @@ public:
 	FxAddSub(int, FxExpression*, FxExpression*);
 	FxExpression *Resolve(FCompileContext&);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -426,6 +543,7 @@ public:
 	FxMulDiv(int, FxExpression*, FxExpression*);
 	FxExpression *Resolve(FCompileContext&);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -441,6 +559,7 @@ public:
 	FxCompareRel(int, FxExpression*, FxExpression*);
 	FxExpression *Resolve(FCompileContext&);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -456,6 +575,7 @@ public:
 	FxCompareEq(int, FxExpression*, FxExpression*);
 	FxExpression *Resolve(FCompileContext&);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -471,6 +591,7 @@ public:
 	FxBinaryInt(int, FxExpression*, FxExpression*);
 	FxExpression *Resolve(FCompileContext&);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -491,6 +612,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -511,6 +633,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -530,6 +653,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -551,6 +675,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -564,6 +689,7 @@ class FxFRandom : public FxRandom
 public:
 	FxFRandom(FRandom *, FxExpression *mi, FxExpression *ma, const FScriptPosition &pos);
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -584,6 +710,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 
@@ -603,6 +730,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 	void RequestAddress();
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -623,6 +751,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 	void RequestAddress();
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -636,7 +765,12 @@ class FxSelf : public FxExpression
 public:
 	FxSelf(const FScriptPosition&);
 	FxExpression *Resolve(FCompileContext&);
+	bool isSelf() const
+	{
+		return true;
+	}
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 //==========================================================================
@@ -657,6 +791,7 @@ public:
 	FxExpression *Resolve(FCompileContext&);
 	//void RequestAddress();
 	ExpVal EvalExpression (AActor *self);
+	void Emit(FxCode &code);
 };
 
 
@@ -804,6 +939,8 @@ public:
 
 
 FxExpression *ParseExpression (FScanner &sc, PClass *cls);
+ExpVal GetVariableValue (void *address, FExpressionType &type);
+ExpVal handleClientDivisionByZero ( void );
 
 
 #endif
@@ -99,13 +99,19 @@ DEFINE_MEMBER_VARIABLE(meleerange, AActor)
 //
 //==========================================================================
 
+// Runs the compiled form if there is one.
+static inline ExpVal EvalStateParam (FxExpression *x, DWORD xi, AActor *self)
+{
+	FxCode *code = StateParams.GetCode(xi);
+	return code != NULL ? code->Exec(self) : x->EvalExpression(self);
+}
 
 int EvalExpressionI (DWORD xi, AActor *self)
 {
 	FxExpression *x = StateParams.Get(xi);
 	if (x == NULL) return 0;
 
-	return x->EvalExpression (self).GetInt();
+	return EvalStateParam (x, xi, self).GetInt();
 }
 
 int EvalExpressionCol (DWORD xi, AActor *self)
@@ -113,7 +119,7 @@ int EvalExpressionCol (DWORD xi, AActor *self)
 	FxExpression *x = StateParams.Get(xi);
 	if (x == NULL) return 0;
 
-	return x->EvalExpression (self).GetColor();
+	return EvalStateParam (x, xi, self).GetColor();
 }
 
 FSoundID EvalExpressionSnd (DWORD xi, AActor *self)
@@ -121,7 +127,7 @@ FSoundID EvalExpressionSnd (DWORD xi, AActor *self)
 	FxExpression *x = StateParams.Get(xi);
 	if (x == NULL) return 0;
 
-	return x->EvalExpression (self).GetSoundID();
+	return EvalStateParam (x, xi, self).GetSoundID();
 }
 
 double EvalExpressionF (DWORD xi, AActor *self)
@@ -129,7 +135,7 @@ double EvalExpressionF (DWORD xi, AActor *self)
 	FxExpression *x = StateParams.Get(xi);
 	if (x == NULL) return 0;
 
-	return x->EvalExpression (self).GetFloat();
+	return EvalStateParam (x, xi, self).GetFloat();
 }
 
 fixed_t EvalExpressionFix (DWORD xi, AActor *self)
@@ -137,7 +143,7 @@ fixed_t EvalExpressionFix (DWORD xi, AActor *self)
 	FxExpression *x = StateParams.Get(xi);
 	if (x == NULL) return 0;
 
-	ExpVal val = x->EvalExpression (self);
+	ExpVal val = EvalStateParam (x, xi, self);
 
 	switch (val.Type)
 	{
@@ -155,7 +161,7 @@ FName EvalExpressionName (DWORD xi, AActor *self)
 	FxExpression *x = StateParams.Get(xi);
 	if (x == NULL) return 0;
 
-	return x->EvalExpression (self).GetName();
+	return EvalStateParam (x, xi, self).GetName();
 }
 
 const PClass * EvalExpressionClass (DWORD xi, AActor *self)
@@ -163,7 +169,7 @@ const PClass * EvalExpressionClass (DWORD xi, AActor *self)
 	FxExpression *x = StateParams.Get(xi);
 	if (x == NULL) return 0;
 
-	return x->EvalExpression (self).GetClass();
+	return EvalStateParam (x, xi, self).GetClass();
 }
 
 FState *EvalExpressionState (DWORD xi, AActor *self)
@@ -171,7 +177,7 @@ FState *EvalExpressionState (DWORD xi, AActor *self)
 	FxExpression *x = StateParams.Get(xi);
 	if (x == NULL) return 0;
 
-	return x->EvalExpression (self).GetState();
+	return EvalStateParam (x, xi, self).GetState();
 }
 
 
@@ -181,7 +187,7 @@ FState *EvalExpressionState (DWORD xi, AActor *self)
 //
 //==========================================================================
 
-static ExpVal GetVariableValue (void *address, FExpressionType &type)
+ExpVal GetVariableValue (void *address, FExpressionType &type)
 {
 	// NOTE: This cannot access native variables of types
 	// char, short and float. These need to be redefined if necessary!
@@ -277,6 +283,17 @@ bool FxExpression::isConstant() const
 //
 //==========================================================================
 
+bool FxExpression::isSelf() const
+{
+	return false;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 FxExpression *FxExpression::Resolve(FCompileContext &ctx)
 {
 	isresolved = true;
@@ -976,7 +993,7 @@ FxExpression *FxMulDiv::Resolve(FCompileContext& ctx)
 
 
 // [BB]
-static inline ExpVal handleClientDivisionByZero ( void )
+ExpVal handleClientDivisionByZero ( void )
 {
 	ExpVal ret;
 
@@ -2781,6 +2798,10 @@ void FStateExpressions::Clear()
 		{
 			delete expressions[i].expr;
 		}
+		if (expressions[i].code != NULL)
+		{
+			delete expressions[i].code;
+		}
 	}
 	expressions.Clear();
 }
@@ -2796,6 +2817,7 @@ int FStateExpressions::Add(FxExpression *x, const PClass *o, bool c)
 	int idx = expressions.Reserve(1);
 	FStateExpression &exp = expressions[idx];
 	exp.expr = x;
+	exp.code = NULL;
 	exp.owner = o;
 	exp.constant = c;
 	exp.cloned = false;
@@ -2815,6 +2837,7 @@ int FStateExpressions::Reserve(int num, const PClass *cls)
 	for(int i=0; i<num; i++)
 	{
 		exp[i].expr = NULL;
+		exp[i].code = NULL;
 		exp[i].owner = cls;
 		exp[i].constant = false;
 		exp[i].cloned = false;
@@ -2903,6 +2926,19 @@ int FStateExpressions::ResolveAll()
 		}
 	}
 
+	// Compile everything so that the action functions don't have to walk the trees.
+	// Cloned entries get their own copy so that every entry owns its code.
+	if (errorcount == 0)
+	{
+		for(unsigned i=0; i<Size(); i++)
+		{
+			if (expressions[i].expr != NULL)
+			{
+				expressions[i].code = FxCode::Compile(expressions[i].expr);
+			}
+		}
+	}
+
 	return errorcount;
 }
 
@@ -2919,3 +2955,29 @@ FxExpression *FStateExpressions::Get(int num)
 	return NULL;
 }
 
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FxCode *FStateExpressions::GetCode(int num)
+{
+	if (num >= 0 && num < int(Size()))
+		return expressions[num].code;
+	return NULL;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+const PClass *FStateExpressions::GetOwner(int num)
+{
+	if (num >= 0 && num < int(Size()))
+		return expressions[num].owner;
+	return NULL;
+}
+
@@ -71,6 +71,11 @@ int reconciliationBlockers = 0;
 // To keep track of the shooter's height adjustement.
 fixed_t reconcilledZ;
 
+// The sectors whose floor or ceiling moved during the last UNLAGGEDTICS tics. Only
+// these need to be recorded, reconciled and restored. For all other sectors, all
+// recorded positions and the restore position are equal to the current position.
+static TArray<sector_t *> movingSectors;
+
 void UNLAGGED_Tick( void )
 {
 	// [BB] Only the server has to do anything here.
@@ -162,13 +167,15 @@ void UNLAGGED_Reconcile( AActor *actor )
 	const int unlaggedIndex = unlaggedGametic % UNLAGGEDTICS;
 
 	//reconcile the sectors
-	for (int i = 0; i < numsectors; ++i)
+	for (unsigned int i = 0; i < movingSectors.Size(); ++i)
 	{
-		sectors[i].floorplane.restoreD = sectors[i].floorplane.d;
-		sectors[i].ceilingplane.restoreD = sectors[i].ceilingplane.d;
+		sector_t *sector = movingSectors[i];
+
+		sector->floorplane.restoreD = sector->floorplane.d;
+		sector->ceilingplane.restoreD = sector->ceilingplane.d;
 
-		sectors[i].floorplane.d = sectors[i].floorplane.unlaggedD[unlaggedIndex];
-		sectors[i].ceilingplane.d = sectors[i].ceilingplane.unlaggedD[unlaggedIndex];
+		sector->floorplane.d = sector->floorplane.unlaggedD[unlaggedIndex];
+		sector->ceilingplane.d = sector->ceilingplane.unlaggedD[unlaggedIndex];
 	}
 
 	//reconcile the players
@@ -244,10 +251,10 @@ void UNLAGGED_SwapSectorUnlaggedStatus( )
 	if ( reconciledGame == false )
 		return;
 
-	for (int i = 0; i < numsectors; ++i)
+	for (unsigned int i = 0; i < movingSectors.Size(); ++i)
 	{
-		swapvalues ( sectors[i].floorplane.d, sectors[i].floorplane.restoreD );
-		swapvalues ( sectors[i].ceilingplane.d, sectors[i].ceilingplane.restoreD );
+		swapvalues ( movingSectors[i]->floorplane.d, movingSectors[i]->floorplane.restoreD );
+		swapvalues ( movingSectors[i]->ceilingplane.d, movingSectors[i]->ceilingplane.restoreD );
 	}
 }
 
@@ -263,10 +270,10 @@ void UNLAGGED_Restore( AActor *actor )
 		return;
 
 	//restore the sectors
-	for (int i = 0; i < numsectors; ++i)
+	for (unsigned int i = 0; i < movingSectors.Size(); ++i)
 	{
-		sectors[i].floorplane.d = sectors[i].floorplane.restoreD;
-		sectors[i].ceilingplane.d = sectors[i].ceilingplane.restoreD;
+		movingSectors[i]->floorplane.d = movingSectors[i]->floorplane.restoreD;
+		movingSectors[i]->ceilingplane.d = movingSectors[i]->ceilingplane.restoreD;
 	}
 
 	const int unlaggedIndex = UNLAGGED_Gametic( actor->player ) % UNLAGGEDTICS;
@@ -361,13 +368,89 @@ void UNLAGGED_RecordSectors( )
 	const int unlaggedIndex = gametic % UNLAGGEDTICS;
 
 	//record the sectors
+	for (unsigned int i = 0; i < movingSectors.Size(); )
+	{
+		sector_t *sector = movingSectors[i];
+
+		sector->floorplane.unlaggedD[unlaggedIndex] = sector->floorplane.d;
+		sector->ceilingplane.unlaggedD[unlaggedIndex] = sector->ceilingplane.d;
+
+		// Once the sector stood still for longer than UNLAGGEDTICS tics, all of its
+		// recorded positions are its current one, so we can stop tracking it.
+		if ( gametic - sector->unlaggedMoveTic > UNLAGGEDTICS )
+		{
+			sector->floorplane.restoreD = sector->floorplane.d;
+			sector->ceilingplane.restoreD = sector->ceilingplane.d;
+			sector->bUnlaggedMoving = false;
+
+			movingSectors[i] = movingSectors[movingSectors.Size() - 1];
+			movingSectors.Pop();
+		}
+		else
+			++i;
+	}
+}
+
+// Needs to be called before the floor or ceiling of the sector is moved
+// so that it's recorded, reconciled and restored
+void UNLAGGED_SectorMoved( sector_t *sector )
+{
+	//Only do anything if it's on a server
+	if (( sector == NULL ) || ( NETWORK_GetState() != NETSTATE_SERVER ))
+		return;
+
+	sector->unlaggedMoveTic = gametic;
+
+	if ( sector->bUnlaggedMoving == false )
+	{
+		// The sector wasn't recorded while it was outside the list. Its planes may
+		// still have changed without moving (e.g. when G_UnSnapshotLevel restores
+		// a hub), so its whole history and its restore position start out where
+		// it is now.
+		for ( int unlaggedIndex = 0; unlaggedIndex < UNLAGGEDTICS; ++unlaggedIndex )
+		{
+			sector->floorplane.unlaggedD[unlaggedIndex] = sector->floorplane.d;
+			sector->ceilingplane.unlaggedD[unlaggedIndex] = sector->ceilingplane.d;
+		}
+		sector->floorplane.restoreD = sector->floorplane.d;
+		sector->ceilingplane.restoreD = sector->ceilingplane.d;
+		sector->bUnlaggedMoving = true;
+
+		movingSectors.Push( sector );
+	}
+}
+
+// Fill the reconciliation buffers of all sectors with their current positions
+// Should be called after a level was loaded
+void UNLAGGED_ResetSectors( )
+{
+	movingSectors.Clear();
+
+	//Only do anything if it's on a server
+	if (NETWORK_GetState() != NETSTATE_SERVER)
+		return;
+
 	for (int i = 0; i < numsectors; ++i)
 	{
-		sectors[i].floorplane.unlaggedD[unlaggedIndex] = sectors[i].floorplane.d;
-		sectors[i].ceilingplane.unlaggedD[unlaggedIndex] = sectors[i].ceilingplane.d;
+		for (int unlaggedIndex = 0; unlaggedIndex < UNLAGGEDTICS; ++unlaggedIndex)
+		{
+			sectors[i].floorplane.unlaggedD[unlaggedIndex] = sectors[i].floorplane.d;
+			sectors[i].ceilingplane.unlaggedD[unlaggedIndex] = sectors[i].ceilingplane.d;
+		}
+
+		sectors[i].floorplane.restoreD = sectors[i].floorplane.d;
+		sectors[i].ceilingplane.restoreD = sectors[i].ceilingplane.d;
+		sectors[i].unlaggedMoveTic = gametic;
+		sectors[i].bUnlaggedMoving = false;
 	}
 }
 
+// The sectors that need to be reconciled, see UNLAGGED_SectorMoved
+const TArray<sector_t *> &UNLAGGED_GetMovingSectors( )
+{
+	return movingSectors;
+}
+
 bool UNLAGGED_DrawRailClientside ( AActor *attacker )
 {
 	if ( ( attacker == NULL ) || ( attacker->player == NULL ) )
@@ -1201,6 +1201,7 @@ void CALLBACK ExitFatally (ULONG_PTR dummy)
 		SERVER_KickAllPlayers( "The server encountered a fatal error and needs to shut down!" );
 		// [BB] It's crucial that we send the packets informing the clients now.
 		SERVER_SendOutPackets();
+		NETWORK_EndOutboundBatch();
 	}
 
 	SetUnhandledExceptionFilter (ExitMessedUp);
@@ -3,7 +3,7 @@
 
 #include "basictypes.h"
 
-struct CPUInfo	// 92 bytes
+struct CPUInfo	// 96 bytes
 {
 	union
 	{
@@ -97,6 +97,19 @@ struct CPUInfo	// 92 bytes
 		};
 		uint32 AMD_DataL1Info;
 	};
+
+	// Structured extended feature flags. These are only filled in if
+	// the OS saves the AVX registers.
+	union
+	{
+		struct
+		{
+			uint32 DontCare4:5;
+			uint32 bAVX2:1;
+			uint32 DontCare5:26;
+		};
+		uint32 FeatureFlags7;
+	};
 };
 
 